@@ -24,6 +24,7 @@ macro(ssig_add_module _name)
 	# files glob
 	file(GLOB MODULE_INCLUDE_FILES	"${MODULE_PATH}/include/ssiglib/${MODULE_NAME}/*.hpp")
 	file(GLOB MODULE_SOURCE_FILES	"${MODULE_PATH}/src/*.cpp")
+	ssig_set_simd_flags("${MODULE_SOURCE_FILES}")
 
 	# add library
 	add_library(${MODULE_NAME} ${MODULE_SOURCE_FILES} ${MODULE_INCLUDE_FILES})
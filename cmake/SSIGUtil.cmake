@@ -6,3 +6,36 @@ macro(ssig_append_target_property target property str)
       set_target_properties(${target} PROPERTIES ${property} "${current_property} ${str}")
   endif()
 endmacro()
+
+# Sources named *_sse42.cpp, *_avx2.cpp and *_avx512.cpp hold kernel variants
+# that are picked at runtime from cpuid, so only those files are built for
+# the wider instruction sets; everything else stays generic.
+macro(ssig_set_simd_flags files)
+  if(WITH_SIMD_DISPATCH AND CMAKE_SYSTEM_PROCESSOR MATCHES "^(x86_64|AMD64|amd64|i.86|x86)$")
+    if(MSVC)
+      set(SIMD_SSE42_FLAGS "")
+      set(SIMD_AVX2_FLAGS "/arch:AVX2")
+      set(SIMD_AVX512_FLAGS "/arch:AVX512")
+    else()
+      set(SIMD_SSE42_FLAGS "-msse4.2")
+      set(SIMD_AVX2_FLAGS "-mavx2 -mfma")
+      set(SIMD_AVX512_FLAGS "-mavx512f -mfma")
+      # GCC < 13 warns about uninitialized values inside the inlined AVX-512
+      # intrinsics (GCC bug 105593); only that source is silenced
+      if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU" AND
+         CMAKE_CXX_COMPILER_VERSION VERSION_LESS 13)
+        set(SIMD_AVX512_FLAGS
+          "${SIMD_AVX512_FLAGS} -Wno-uninitialized -Wno-maybe-uninitialized")
+      endif()
+    endif()
+    foreach(file ${files})
+      if(file MATCHES "_sse42\\.cpp$")
+        set_source_files_properties(${file} PROPERTIES COMPILE_FLAGS "${SIMD_SSE42_FLAGS}")
+      elseif(file MATCHES "_avx2\\.cpp$")
+        set_source_files_properties(${file} PROPERTIES COMPILE_FLAGS "${SIMD_AVX2_FLAGS}")
+      elseif(file MATCHES "_avx512\\.cpp$")
+        set_source_files_properties(${file} PROPERTIES COMPILE_FLAGS "${SIMD_AVX512_FLAGS}")
+      endif()
+    endforeach()
+  endif()
+endmacro()
@@ -42,6 +42,7 @@
 #ifndef _SSIG_CORE_ALGORITHM_HPP_
 #define _SSIG_CORE_ALGORITHM_HPP_
 // c++
+#include <memory>
 #include <string>
 #include <cstdarg>
 // opencv
@@ -49,6 +50,8 @@
 // ssiglib
 #include "ssiglib/core/core_defs.hpp"
 #include "ssiglib/core/resource.hpp"
+#include "ssiglib/core/binary_storage.hpp"
+#include "ssiglib/core/memory_footprint.hpp"
 
 namespace ssig {
 
@@ -67,6 +70,25 @@ class Algorithm : public Resource {
     const std::string& filename,
     const std::string& nodename) const;
 
+  /**
+  @brief Loads the model from a file written by saveBinary.
+
+  The file is memory mapped and the model matrices point straight into it.
+  The mapping is kept alive by this object (and its copies) and released
+  when the last of them is destroyed or loads another file.
+  */
+  CORE_EXPORT virtual void loadBinary(const std::string& filename);
+
+  CORE_EXPORT virtual void saveBinary(const std::string& filename) const;
+
+  /**
+  @brief Bytes held by the model, by member and child model
+
+  Overrides add their members to the footprint of their base class. The
+  default reports the file mapped by loadBinary.
+  */
+  CORE_EXPORT virtual MemoryFootprint memoryFootprint() const;
+
   /**
   * @brief: this function can be used to verboseLog messages 
    to file when setVerbose(true) is called.
@@ -87,12 +109,18 @@ class Algorithm : public Resource {
  protected:
   CORE_EXPORT virtual void read(const cv::FileNode& fn) = 0;
   CORE_EXPORT virtual void write(cv::FileStorage& fs) const = 0;
+  // the defaults throw: only some algorithms have a binary format
+  CORE_EXPORT virtual void readBinary(const BinaryNode& node);
+  CORE_EXPORT virtual void writeBinary(BinaryWriter& writer) const;
   CORE_EXPORT void vVerboseLog(
     FILE* file,
     const char* format,
     va_list args) const;
   bool mOpenClEnabled = false;
   bool mVerbose = false;
+
+ private:
+  std::shared_ptr<const BinaryStorage> mBinaryStorage;
 };
 
 }  // namespace ssig
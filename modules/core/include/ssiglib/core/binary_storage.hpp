@@ -0,0 +1,171 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#ifndef _SSIG_CORE_BINARY_STORAGE_HPP_
+#define _SSIG_CORE_BINARY_STORAGE_HPP_
+// c++
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+// opencv
+#include <opencv2/core.hpp>
+// ssiglib
+#include "core_defs.hpp"
+#include "mapped_file.hpp"
+
+namespace ssig {
+
+class BinaryStorage;
+
+/**
+Binary counterpart of cv::FileStorage for models. Entries are matrices
+stored as raw, 64 byte aligned blobs; scalars and strings are stored as
+one row matrices. Scopes nest entries the way "{" ... "}" does in a
+FileStorage.
+
+File layout (little endian): a 64 byte header with the magic "SSIGBIN",
+the format version and the position of the index, then the blobs, then the
+index listing for every entry its name, type, size and offset.
+*/
+class BinaryWriter {
+ public:
+  CORE_EXPORT BinaryWriter(void) = default;
+
+  CORE_EXPORT void beginScope(const std::string& name);
+  CORE_EXPORT void endScope();
+
+  CORE_EXPORT void write(const std::string& key, const cv::Mat& mat);
+  CORE_EXPORT void write(const std::string& key, const int value);
+  CORE_EXPORT void write(const std::string& key, const double value);
+  CORE_EXPORT void write(const std::string& key, const std::string& value);
+  CORE_EXPORT void write(const std::string& key,
+                         const std::unordered_map<int, int>& value);
+
+  CORE_EXPORT void save(const std::string& filename) const;
+
+ private:
+  std::string path(const std::string& key) const;
+
+  std::vector<std::string> mScopes;
+  std::vector<std::pair<std::string, cv::Mat>> mEntries;
+};
+
+/**
+@brief One scope of an opened BinaryStorage
+*/
+class BinaryNode {
+ public:
+  CORE_EXPORT BinaryNode(void) = default;
+
+  /**
+  @brief The nested scope called name
+  */
+  CORE_EXPORT BinaryNode operator[](const std::string& name) const;
+
+  CORE_EXPORT bool has(const std::string& key) const;
+
+  /**
+  The matrix points into the mapped file, no data is copied. It holds a
+  reference to the mapping, so it stays valid after the BinaryStorage is
+  gone; writing to it does not change the file.
+  */
+  CORE_EXPORT cv::Mat getMat(const std::string& key) const;
+  CORE_EXPORT int getInt(const std::string& key) const;
+  CORE_EXPORT double getDouble(const std::string& key) const;
+  CORE_EXPORT std::string getString(const std::string& key) const;
+  CORE_EXPORT std::unordered_map<int, int> getIntMap(
+    const std::string& key) const;
+
+ private:
+  friend class BinaryStorage;
+  BinaryNode(const BinaryStorage* storage, const std::string& prefix);
+
+  const BinaryStorage* mStorage = nullptr;
+  std::string mPrefix;
+};
+
+/**
+@brief Read only, memory mapped view of a file written by BinaryWriter
+*/
+class BinaryStorage {
+ public:
+  static const uint32_t kVersion = 1;
+
+  CORE_EXPORT explicit BinaryStorage(const std::string& filename);
+  CORE_EXPORT ~BinaryStorage(void);
+  BinaryStorage(const BinaryStorage&) = delete;
+  BinaryStorage& operator=(const BinaryStorage&) = delete;
+
+  CORE_EXPORT BinaryNode root() const;
+  CORE_EXPORT uint32_t getVersion() const;
+  /**
+  @brief Bytes of the mapped file
+  */
+  CORE_EXPORT size_t getSize() const;
+  /**
+  @brief The mapping shared by every matrix read from this storage
+  */
+  CORE_EXPORT const MappedFile* getMapping() const;
+
+ private:
+  friend class BinaryNode;
+  struct Entry {
+    int type;
+    int rows;
+    int cols;
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  cv::Mat get(const std::string& key) const;
+
+  // shared with every matrix returned by get()
+  std::shared_ptr<MappedFile> mFile;
+  std::unordered_map<std::string, Entry> mIndex;
+  uint32_t mVersion = 0;
+};
+
+}  // namespace ssig
+
+#endif  // !_SSIG_CORE_BINARY_STORAGE_HPP_
@@ -0,0 +1,126 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#ifndef _SSIG_CORE_CSR_MAT_HPP_
+#define _SSIG_CORE_CSR_MAT_HPP_
+// c++
+#include <cstddef>
+#include <vector>
+// opencv
+#include <opencv2/core.hpp>
+// ssiglib
+#include "core_defs.hpp"
+
+namespace ssig {
+
+/**
+Sparse float matrix in compressed sparse row (CSR) form, for features that
+are mostly zeros such as bag-of-words or spatial pyramid histograms.
+
+Row r owns the entries in the range
+[getRowPointers()[r], getRowPointers()[r + 1]) of the column and value
+arrays, with the columns of a row in increasing order.
+*/
+class CsrMat {
+ public:
+  CORE_EXPORT CsrMat(void) = default;
+  /**
+  An empty matrix of the given width, filled with appendRow.
+  */
+  CORE_EXPORT explicit CsrMat(const int cols);
+  /**
+  Keeps the elements of a single channel matrix whose magnitude is above
+  threshold.
+  */
+  CORE_EXPORT explicit CsrMat(const cv::Mat& dense, const float threshold = 0);
+  /**
+  Takes the three CSR arrays, which are validated.
+  */
+  CORE_EXPORT CsrMat(const int cols,
+                     std::vector<int> rowPointers,
+                     std::vector<int> columns,
+                     std::vector<float> values);
+
+  /**
+  Appends the elements of a 1 x cols matrix whose magnitude is above
+  threshold.
+  */
+  CORE_EXPORT void appendRow(const cv::Mat& denseRow,
+                             const float threshold = 0);
+  /**
+  Appends a row given by its sorted column indices and values.
+  */
+  CORE_EXPORT void appendRow(const int* columns, const float* values,
+                             const int len);
+
+  CORE_EXPORT int getNumRows() const;
+  CORE_EXPORT int getNumCols() const;
+  CORE_EXPORT int getNonZeros() const;
+  CORE_EXPORT int getRowLength(const int row) const;
+  CORE_EXPORT bool empty() const;
+  CORE_EXPORT size_t getMemorySize() const;
+
+  CORE_EXPORT const int* columns(const int row) const;
+  CORE_EXPORT const float* values(const int row) const;
+
+  CORE_EXPORT const std::vector<int>& getRowPointers() const;
+  CORE_EXPORT const std::vector<int>& getColumns() const;
+  CORE_EXPORT const std::vector<float>& getValues() const;
+
+  CORE_EXPORT cv::Mat_<float> toDense() const;
+
+  /**
+  out = this * dense, with dense a getNumCols() x k float matrix. Only the
+  stored elements are visited, the rows are computed in parallel.
+  */
+  CORE_EXPORT void multiply(const cv::Mat_<float>& dense,
+                            cv::Mat_<float>& out) const;
+
+ private:
+  int mCols = 0;
+  std::vector<int> mRowPointers = std::vector<int>(1, 0);
+  std::vector<int> mColumns;
+  std::vector<float> mValues;
+};
+
+}  // namespace ssig
+
+#endif  // !_SSIG_CORE_CSR_MAT_HPP_
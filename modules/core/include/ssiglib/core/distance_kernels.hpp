@@ -0,0 +1,256 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#ifndef _SSIG_CORE_DISTANCE_KERNELS_HPP_
+#define _SSIG_CORE_DISTANCE_KERNELS_HPP_
+
+// c++
+#include <cmath>
+#include <type_traits>
+#include <vector>
+// opencv
+#include <opencv2/core.hpp>
+// ssiglib
+#include "ssiglib/core/math.hpp"
+#include "ssiglib/core/quantized_mat.hpp"
+
+namespace ssig {
+
+/**
+@brief Compile-time distance kernels.
+
+A metric is a policy deriving from DistanceKernel<Metric>: it gives the
+per-element term and the final transform of the sum, and the base class
+builds the loops around them. Callers that know the metric instantiate
+their whole loop against it, so nothing in the inner loop is virtual and
+the fixed-dimension paths (64 to 512) get fully unrolled. The elements may
+be float, double or uchar; only double is accumulated in double.
+QuantizedMat rows are decoded one at a time as they are scored.
+*/
+template <class Metric>
+struct DistanceKernel {
+  template <class T>
+  using Accumulator = typename std::conditional<
+    std::is_same<T, double>::value, double, float>::type;
+
+  template <class T>
+  static float compute(const T* x, const T* y, const int len) {
+    return reduce(x, y, len);
+  }
+
+  template <int Dims, class T>
+  static float compute(const T* x, const T* y) {
+    return reduce(x, y, Dims);
+  }
+
+  /**
+  @brief Scores every row of A against every row of B, both with elements
+  of type T.
+  @param scores a A.rows x B.rows matrix
+  */
+  template <class T>
+  static void manyToMany(const cv::Mat& A, const cv::Mat& B,
+                         cv::Mat_<float>& scores) {
+    CV_Assert(A.type() == cv::DataType<T>::type &&
+              B.type() == cv::DataType<T>::type && A.cols == B.cols);
+    switch (A.cols) {
+    case 64: return rows<64, T>(A, B, scores);
+    case 128: return rows<128, T>(A, B, scores);
+    case 256: return rows<256, T>(A, B, scores);
+    case 512: return rows<512, T>(A, B, scores);
+    default: return rows<0, T>(A, B, scores);
+    }
+  }
+
+  /**
+  @brief Scores every row of A against every float row of B. Each row of A
+  is decoded once into a scratch row.
+  @param scores a A.getNumRows() x B.rows matrix
+  */
+  static void manyToMany(const QuantizedMat& A, const cv::Mat& B,
+                         cv::Mat_<float>& scores) {
+    CV_Assert(B.type() == CV_32F && A.getNumCols() == B.cols);
+    switch (B.cols) {
+    case 64: return rows<64>(A, B, scores);
+    case 128: return rows<128>(A, B, scores);
+    case 256: return rows<256>(A, B, scores);
+    case 512: return rows<512>(A, B, scores);
+    default: return rows<0>(A, B, scores);
+    }
+  }
+
+ private:
+  template <class T>
+  static inline float reduce(const T* x, const T* y, const int len) {
+    typedef Accumulator<T> Acc;
+    // four partial sums break the dependency chain of the additions
+    Acc s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    int i = 0;
+    for (; i + 4 <= len; i += 4) {
+      s0 += Metric::term(static_cast<Acc>(x[i]), static_cast<Acc>(y[i]));
+      s1 += Metric::term(static_cast<Acc>(x[i + 1]),
+                         static_cast<Acc>(y[i + 1]));
+      s2 += Metric::term(static_cast<Acc>(x[i + 2]),
+                         static_cast<Acc>(y[i + 2]));
+      s3 += Metric::term(static_cast<Acc>(x[i + 3]),
+                         static_cast<Acc>(y[i + 3]));
+    }
+    for (; i < len; ++i)
+      s0 += Metric::term(static_cast<Acc>(x[i]), static_cast<Acc>(y[i]));
+    return static_cast<float>(Metric::finish((s0 + s1) + (s2 + s3)));
+  }
+
+  // Dims == 0 is the runtime-length path
+  template <int Dims, class T>
+  static void rowAgainst(const T* a, const cv::Mat& B, float* out) {
+    for (int j = 0; j < B.rows; ++j) {
+      out[j] = Dims ? compute<Dims>(a, B.ptr<T>(j))
+                    : compute(a, B.ptr<T>(j), B.cols);
+    }
+  }
+
+  template <int Dims, class T>
+  static void rows(const cv::Mat& A, const cv::Mat& B,
+                   cv::Mat_<float>& scores) {
+    scores.create(A.rows, B.rows);
+    for (int i = 0; i < A.rows; ++i)
+      rowAgainst<Dims>(A.ptr<T>(i), B, scores[i]);
+  }
+
+  template <int Dims>
+  static void rows(const QuantizedMat& A, const cv::Mat& B,
+                   cv::Mat_<float>& scores) {
+    scores.create(A.getNumRows(), B.rows);
+    std::vector<float> decoded(B.cols);
+    for (int i = 0; i < A.getNumRows(); ++i) {
+      A.decodeRow(i, decoded.data());
+      rowAgainst<Dims>(decoded.data(), B, scores[i]);
+    }
+  }
+};
+
+struct L1Kernel : DistanceKernel<L1Kernel> {
+  template <class A>
+  static A term(const A x, const A y) { return std::abs(x - y); }
+  template <class A>
+  static A finish(const A sum) { return sum; }
+};
+
+struct SquaredL2Kernel : DistanceKernel<SquaredL2Kernel> {
+  template <class A>
+  static A term(const A x, const A y) { return (x - y) * (x - y); }
+  template <class A>
+  static A finish(const A sum) { return sum; }
+};
+
+struct L2Kernel : DistanceKernel<L2Kernel> {
+  template <class A>
+  static A term(const A x, const A y) { return (x - y) * (x - y); }
+  template <class A>
+  static A finish(const A sum) { return std::sqrt(sum); }
+};
+
+/**
+@brief Chi-square distance, bins where both histograms are zero are
+skipped.
+*/
+struct Chi2Kernel : DistanceKernel<Chi2Kernel> {
+  template <class A>
+  static A term(const A x, const A y) {
+    const A sum = x + y;
+    return sum != 0 ? (x - y) * (x - y) / sum : 0;
+  }
+  template <class A>
+  static A finish(const A sum) { return sum; }
+};
+
+struct DotKernel : DistanceKernel<DotKernel> {
+  template <class A>
+  static A term(const A x, const A y) { return x * y; }
+  template <class A>
+  static A finish(const A sum) { return sum; }
+};
+
+/**
+@brief Runtime-polymorphic front end of a kernel, e.g. for
+Math::buildSimilarity or the optimizers: the virtual call is paid once per
+batch, the batch itself runs the kernel on float rows.
+*/
+template <class Kernel>
+class KernelDistance : public DistanceFunctor {
+ public:
+  float operator()(const cv::Mat& x, const cv::Mat& y) const override {
+    const cv::Mat_<float> a = asFloat(x), b = asFloat(y);
+    return Kernel::compute(a.ptr<float>(), b.ptr<float>(),
+                           static_cast<int>(a.total()));
+  }
+
+  void oneToMany(const cv::Mat& query, const cv::Mat& samples,
+                 cv::Mat_<float>& scores) const override {
+    if (!isExactly<KernelDistance>()) {
+      DistanceFunctor::oneToMany(query, samples, scores);
+      return;
+    }
+    manyToMany(query, samples, scores);
+  }
+
+  void manyToMany(const cv::Mat& A, const cv::Mat& B,
+                  cv::Mat_<float>& scores) const override {
+    if (!isExactly<KernelDistance>()) {
+      DistanceFunctor::manyToMany(A, B, scores);
+      return;
+    }
+    Kernel::template manyToMany<float>(asFloat(A), asFloat(B), scores);
+  }
+
+ private:
+  static cv::Mat asFloat(const cv::Mat& m) {
+    if (m.type() == CV_32F && m.isContinuous())
+      return m;
+    cv::Mat ans;
+    m.convertTo(ans, CV_32F);
+    return ans;
+  }
+};
+
+}  // namespace ssig
+
+#endif  // !_SSIG_CORE_DISTANCE_KERNELS_HPP_
@@ -0,0 +1,127 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#ifndef _SSIG_CORE_EVALUATION_CACHE_HPP_
+#define _SSIG_CORE_EVALUATION_CACHE_HPP_
+// c++
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+// opencv
+#include <opencv2/core.hpp>
+// ssiglib
+#include "core_defs.hpp"
+
+namespace ssig {
+
+/**
+@brief Bounded, thread safe memo of utility values keyed on the candidate
+vector quantized to a multiple of getQuantum(). The least recently used
+entry is dropped when the cache is full. One cache may be shared by several
+optimizers (see Optimization::setEvaluationCache) as long as they score the
+same utility function.
+*/
+class EvaluationCache {
+ public:
+  typedef std::vector<int64_t> Key;
+  struct KeyHash {
+    size_t operator()(const Key& key) const {
+      uint64_t h = 1469598103934665603ULL;
+      for (const auto& v : key) {
+        h ^= static_cast<uint64_t>(v) + 0x9E3779B97F4A7C15ULL +
+          (h << 6) + (h >> 2);
+      }
+      return static_cast<size_t>(h);
+    }
+  };
+
+  /**
+  @param quantum candidates closer than this in every coordinate may share
+  an entry; zero keys on the exact float bits
+  */
+  CORE_EXPORT explicit EvaluationCache(const size_t capacity = 4096,
+    const float quantum = 1e-6f);
+  CORE_EXPORT virtual ~EvaluationCache(void) = default;
+
+  /**
+  Every NaN coordinate maps to one key. Infinities and coordinates too
+  large to quantize are keyed on their exact bits, apart from the
+  quantized ones.
+  */
+  CORE_EXPORT Key makeKey(const cv::Mat& candidate) const;
+
+  /**
+  @brief Returns true and sets utility when key is cached. Counts a hit or
+  a miss.
+  */
+  CORE_EXPORT bool lookup(const Key& key, float& utility);
+  CORE_EXPORT void insert(const Key& key, const float utility);
+  CORE_EXPORT void clear();
+
+  CORE_EXPORT size_t getHits() const;
+  CORE_EXPORT size_t getMisses() const;
+  CORE_EXPORT size_t getSize() const;
+  CORE_EXPORT size_t getCapacity() const;
+  CORE_EXPORT float getQuantum() const;
+  /**
+  @brief Approximate bytes held by the entries, node overheads included
+  */
+  CORE_EXPORT size_t getMemorySize() const;
+
+ private:
+  typedef std::list<std::pair<Key, float>> Entries;
+
+  size_t mCapacity;
+  float mQuantum;
+  size_t mHits = 0;
+  size_t mMisses = 0;
+  // most recently used first
+  Entries mEntries;
+  std::unordered_map<Key, Entries::iterator, KeyHash> mIndex;
+  mutable std::mutex mLock;
+};
+
+}  // namespace ssig
+
+#endif  // !_SSIG_CORE_EVALUATION_CACHE_HPP_
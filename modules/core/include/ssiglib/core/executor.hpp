@@ -0,0 +1,189 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#ifndef _SSIG_CORE_EXECUTOR_HPP_
+#define _SSIG_CORE_EXECUTOR_HPP_
+// c++
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+// ssiglib
+#include "core_defs.hpp"
+
+namespace ssig {
+
+/**
+Work-stealing thread pool shared by the library. Every worker owns a task
+deque: it pops its own tasks LIFO and steals from the others FIFO when it
+runs dry. A thread waiting for its tasks runs pending tasks instead of
+blocking, so parallel loops may be nested freely without deadlocks or extra
+threads; the pool never grows past the size given at construction.
+
+A concurrency limit caps how many threads one call may use. It can be set
+for the whole executor and lowered again per call, e.g. to bound the cores
+a model uses in a server process.
+*/
+class Executor {
+ public:
+  enum Backend {
+    // the work-stealing pool
+    POOL,
+    // OpenMP regions, when the library was built with OpenMP
+    OPENMP,
+    // everything runs on the calling thread
+    SERIAL
+  };
+
+  /**
+  @param nThreads Threads of the pool, the calling thread included. Zero
+  uses every hardware thread.
+  */
+  CORE_EXPORT explicit Executor(const int nThreads = 0);
+  CORE_EXPORT ~Executor(void);
+  Executor(const Executor&) = delete;
+  Executor& operator=(const Executor&) = delete;
+
+  /**
+  @brief The executor used by the library algorithms
+  */
+  CORE_EXPORT static Executor& global();
+
+  CORE_EXPORT Backend getBackend() const;
+  CORE_EXPORT void setBackend(const Backend backend);
+
+  CORE_EXPORT int getThreads() const;
+
+  CORE_EXPORT int getConcurrency() const;
+  /**
+  @brief Maximum number of threads a single call may use, zero or
+  negative means getThreads()
+  */
+  CORE_EXPORT void setConcurrency(const int concurrency);
+
+  /**
+  Calls body(first, last) on disjoint subranges covering [begin, end), each
+  with at least grain items unless it is the last one. Returns when all of
+  them are done and rethrows the first exception thrown by body.
+
+  @param concurrency Further limits the threads used by this call.
+  */
+  CORE_EXPORT void parallelFor(const int begin, const int end,
+    const std::function<void(int, int)>& body,
+    const int grain = 1,
+    const int concurrency = 0);
+
+  /**
+  Splits [begin, end) in chunks that depend only on the range and grain,
+  maps every chunk to a partial result with map(first, last) and folds the
+  partials in chunk order with reduce(accumulated, partial), starting from
+  identity. The result is therefore the same for any number of threads.
+  */
+  template <class T, class Map, class Reduce>
+  T parallelReduce(const int begin, const int end, const T& identity,
+                   const Map& map, const Reduce& reduce,
+                   const int grain = 1, const int concurrency = 0) {
+    const int len = end - begin;
+    if (len <= 0)
+      return identity;
+    const int chunk = std::max(std::max(grain, 1),
+      (len + kMaxReduceChunks - 1) / kMaxReduceChunks);
+    const int nChunks = (len + chunk - 1) / chunk;
+    std::vector<T> partials(nChunks);
+    parallelFor(0, nChunks, [&](const int first, const int last) {
+      for (int c = first; c < last; ++c) {
+        const int from = begin + c * chunk;
+        partials[c] = map(from, std::min(end, from + chunk));
+      }
+    }, 1, concurrency);
+    T result = identity;
+    for (int c = 0; c < nChunks; ++c)
+      result = reduce(result, partials[c]);
+    return result;
+  }
+
+  /**
+  Tasks run on the pool. wait() helps running pending tasks while there are
+  any, then sleeps until every task of the group has finished, and rethrows
+  the first exception one of them threw. Groups may be created from inside
+  tasks.
+  */
+  class TaskGroup {
+   public:
+    CORE_EXPORT explicit TaskGroup(Executor& executor);
+    CORE_EXPORT ~TaskGroup(void);
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    CORE_EXPORT void run(const std::function<void()>& task);
+    CORE_EXPORT void wait();
+
+   private:
+    // returns once no task of the group is pending or running
+    void join();
+
+    Executor& mExecutor;
+    std::atomic<int> mPending;
+    std::exception_ptr mError;
+    std::mutex mLock;
+    std::condition_variable mDone;
+  };
+
+ private:
+  static const int kMaxReduceChunks = 256;
+
+  struct Pool;
+
+  int effectiveConcurrency(const int concurrency) const;
+
+  std::unique_ptr<Pool> mPool;
+  int mThreads;
+  std::atomic<int> mConcurrency;
+  std::atomic<int> mBackend;
+};
+
+}  // namespace ssig
+
+#endif  // !_SSIG_CORE_EXECUTOR_HPP_
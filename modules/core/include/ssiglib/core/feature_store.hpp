@@ -0,0 +1,196 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#ifndef _SSIG_CORE_FEATURE_STORE_HPP_
+#define _SSIG_CORE_FEATURE_STORE_HPP_
+// c++
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+// opencv
+#include <opencv2/core.hpp>
+// ssiglib
+#include "core_defs.hpp"
+#include "mapped_file.hpp"
+
+namespace ssig {
+
+/**
+Append-only writer of a FeatureStore file: a float matrix too large to be
+held in memory, built a few rows at a time.
+
+Rows are buffered into blocks of getBlockSize() rows and each full block is
+written out; labels are streamed to a temporary side file that close()
+copies after the rows and removes. Memory use therefore does not grow with
+the number of rows. The number of columns is fixed by the first append.
+Per-column mean, standard deviation, minimum and maximum are updated on
+every append.
+*/
+class FeatureStoreWriter {
+ public:
+  CORE_EXPORT explicit FeatureStoreWriter(const std::string& filename,
+                                          const int blockSize = 1024);
+  /**
+  Closes the file if close() was not called; errors are lost, so prefer
+  calling close().
+  */
+  CORE_EXPORT ~FeatureStoreWriter(void);
+  FeatureStoreWriter(const FeatureStoreWriter&) = delete;
+  FeatureStoreWriter& operator=(const FeatureStoreWriter&) = delete;
+
+  /**
+  Appends every row of rows, converted to float. Either every row of the
+  store has a label or none has.
+  */
+  CORE_EXPORT void append(const cv::Mat& rows);
+  CORE_EXPORT void append(const cv::Mat& rows, const cv::Mat& labels);
+  CORE_EXPORT void append(const cv::Mat& rows, const int label);
+
+  CORE_EXPORT void setMetadata(const std::string& key,
+                               const std::string& value);
+
+  /**
+  Writes the pending rows, the labels, the statistics and the metadata.
+  Nothing can be appended afterwards.
+  */
+  CORE_EXPORT void close();
+
+  CORE_EXPORT int getNumRows() const;
+  CORE_EXPORT int getNumCols() const;
+  CORE_EXPORT int getBlockSize() const;
+  CORE_EXPORT cv::Mat_<float> getMean() const;
+  CORE_EXPORT cv::Mat_<float> getStd() const;
+
+ private:
+  void appendRows(const cv::Mat& rows, const int* labels);
+  void flush();
+  void writeLabels();
+
+  std::string mFilename;
+  std::ofstream mFile;
+  int mBlockSize;
+  int mRows = 0;
+  int mCols = 0;
+  // -1 while unknown, then 0 or 1
+  int mLabeled = -1;
+  bool mClosed = false;
+
+  cv::Mat_<float> mBlock;
+  int mBlockRows = 0;
+  // labels wait in <filename>.labels until close() moves them to the footer
+  std::string mLabelsFilename;
+  std::fstream mLabels;
+
+  // running statistics, merged block by block
+  std::vector<double> mMean;
+  std::vector<double> mM2;
+  std::vector<float> mMin;
+  std::vector<float> mMax;
+
+  std::map<std::string, std::string> mMetadata;
+};
+
+/**
+@brief Memory mapped reader of a file written by FeatureStoreWriter.
+
+Every matrix it returns is a view into the mapping: nothing is read from
+disk until used and nothing is copied. The views keep the file mapped, so
+they remain valid after the FeatureStore is destroyed. The mapping is
+private: writing to a view does not change the file, but it is seen by the
+other views of the same FeatureStore.
+*/
+class FeatureStore {
+ public:
+  static const uint32_t kVersion = 1;
+
+  CORE_EXPORT explicit FeatureStore(const std::string& filename);
+
+  CORE_EXPORT int getNumRows() const;
+  CORE_EXPORT int getNumCols() const;
+  CORE_EXPORT int getBlockSize() const;
+  CORE_EXPORT int getNumBlocks() const;
+  CORE_EXPORT const std::string& getFilename() const;
+
+  /**
+  @brief All the rows, as a single getNumRows() x getNumCols() matrix
+  */
+  CORE_EXPORT cv::Mat_<float> getData() const;
+  CORE_EXPORT cv::Mat_<float> getRows(const int begin, const int end) const;
+  CORE_EXPORT cv::Mat_<float> getBlock(const int index) const;
+
+  CORE_EXPORT bool hasLabels() const;
+  /**
+  @brief getNumRows() x 1 labels, empty when the store has none
+  */
+  CORE_EXPORT cv::Mat_<int> getLabels() const;
+  CORE_EXPORT cv::Mat_<int> getLabels(const int begin, const int end) const;
+
+  // population statistics of every column, 1 x getNumCols()
+  CORE_EXPORT cv::Mat_<float> getMean() const;
+  CORE_EXPORT cv::Mat_<float> getStd() const;
+  CORE_EXPORT cv::Mat_<float> getMin() const;
+  CORE_EXPORT cv::Mat_<float> getMax() const;
+
+  CORE_EXPORT bool hasMetadata(const std::string& key) const;
+  CORE_EXPORT std::string getMetadata(const std::string& key) const;
+
+ private:
+  std::string mFilename;
+  std::shared_ptr<MappedFile> mFile;
+  int mRows = 0;
+  int mCols = 0;
+  int mBlockSize = 0;
+  uint64_t mLabelsOffset = 0;
+  bool mLabeled = false;
+
+  cv::Mat_<float> mMean;
+  cv::Mat_<float> mStd;
+  cv::Mat_<float> mMin;
+  cv::Mat_<float> mMax;
+  std::map<std::string, std::string> mMetadata;
+};
+
+}  // namespace ssig
+
+#endif  // !_SSIG_CORE_FEATURE_STORE_HPP_
@@ -85,6 +85,15 @@ class Firefly : public Optimization {
 
   CORE_EXPORT void setStep(float step);
 
+  /**
+  @brief Seed of the random walk. Every firefly draws from its own stream
+  so runs are reproducible for any number of threads.
+  */
+  CORE_EXPORT void setSeed(int seed);
+  CORE_EXPORT int getSeed() const;
+
+  CORE_EXPORT MemoryFootprint memoryFootprint() const override;
+
  protected:
   CORE_EXPORT Firefly(
     cv::Ptr<UtilityFunctor>& utilityFunction,
@@ -95,12 +104,23 @@ class Firefly : public Optimization {
   CORE_EXPORT void read(const cv::FileNode& fn) override;
   CORE_EXPORT void write(cv::FileStorage& fs) const override;
 
+  /**
+  @brief Sorts the population and the utilities by ascending utility
+  without allocating new matrices.
+  */
+  CORE_EXPORT void sortPopulation();
+
  private:
   float mAbsorption = 1.5f;
   int mIterations = 0;
   float mAnnealling = 0.97f;
   float mStep = 0.9f;
-  cv::RNG mRng;
+  int mSeed = 0;
+
+  // scratch reused across iterations
+  cv::Mat_<float> mSnapshot;
+  cv::Mat_<float> mDistances;
+  cv::Mat_<int> mOrder;
 };
 }  // namespace ssig
 #endif  // !_SSF_ALGORITHMS_FIREFLY_METHOD_HPP_
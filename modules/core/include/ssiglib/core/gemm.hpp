@@ -0,0 +1,81 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#ifndef _SSIG_CORE_GEMM_HPP_
+#define _SSIG_CORE_GEMM_HPP_
+// opencv
+#include <opencv2/core.hpp>
+// ssiglib
+#include "core_defs.hpp"
+
+namespace ssig {
+
+/**
+@brief D = alpha * op(A) * op(B) + beta * op(C), with the cv::gemm contract.
+
+flags combines cv::GEMM_1_T, cv::GEMM_2_T and cv::GEMM_3_T to use the
+transposed operands in place, so callers need no .t() copies. C may be
+empty, and D may be the same matrix as C (e.g. X = X - t * p.t() is
+gemm(t, p, -1, X, 1, X, cv::GEMM_2_T)).
+
+When the library is built WITH_BLAS, single channel float and double
+operands go to the CBLAS found at configure time (OpenBLAS, MKL, ...),
+using GEMV when op(A) or op(B) is a vector. Everything else, and every
+call without BLAS, goes to cv::gemm.
+*/
+CORE_EXPORT void gemm(const cv::Mat& A, const cv::Mat& B, const double alpha,
+                      const cv::Mat& C, const double beta, cv::Mat& D,
+                      const int flags = 0);
+
+/**
+@brief D = op(A) * op(B)
+*/
+CORE_EXPORT void gemm(const cv::Mat& A, const cv::Mat& B, cv::Mat& D,
+                      const int flags = 0);
+
+/**
+@brief "cblas" or "opencv"
+*/
+CORE_EXPORT const char* getGemmBackend();
+
+}  // namespace ssig
+
+#endif  // !_SSIG_CORE_GEMM_HPP_
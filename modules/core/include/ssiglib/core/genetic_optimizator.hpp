@@ -46,6 +46,7 @@
 #include <vector>
 
 #include "optimization.hpp"
+#include "rng.hpp"
 
 namespace ssig {
 /*
@@ -104,6 +105,25 @@ class GeneticOptimizator : public Optimization {
   CORE_EXPORT int getDimensions() const;
   CORE_EXPORT void setDimensions(const int dimensions);
 
+  /**
+  @brief Number of sub-populations. With more than one island learn() evolves
+  them concurrently, each with its own RNG, and only synchronizes them to
+  migrate the best individuals along a ring every migration interval. The
+  utility and crossover functors must be thread safe in this mode.
+  */
+  CORE_EXPORT int getIslands() const;
+  CORE_EXPORT void setIslands(const int islands);
+  /**
+  @brief Generations an island evolves between two migrations
+  */
+  CORE_EXPORT int getMigrationInterval() const;
+  CORE_EXPORT void setMigrationInterval(const int migrationInterval);
+  /**
+  @brief Individuals each island sends to the next one at every migration
+  */
+  CORE_EXPORT int getMigrants() const;
+  CORE_EXPORT void setMigrants(const int migrants);
+
  protected:
   CORE_EXPORT GeneticOptimizator(void) = default;
   CORE_EXPORT GeneticOptimizator(
@@ -111,12 +131,35 @@ class GeneticOptimizator : public Optimization {
     cv::Ptr<CrossOverFunctor>& crossOverFunction);
   CORE_EXPORT GeneticOptimizator(GeneticOptimizator& rhs);
 
+  /**
+  @brief Replaces population by its next generation, returns the best
+  utility of the generation that was replaced.
+  */
+  CORE_EXPORT float evolve(cv::Mat_<float>& population, PhiloxRng& rng) const;
+
+  CORE_EXPORT void learnIslands();
+
+  /**
+  @brief Asynchronous learning: each thread breeds one child from two
+  tournament winners, evaluates it and lets it replace the worst individual
+  if it is better.
+  */
+  CORE_EXPORT void learnSteadyState();
+
+  /**
+  @brief Copies the best individuals of island i over the worst ones of
+  island (i + 1) % islands.size().
+  */
+  CORE_EXPORT static void migrate(const int migrants,
+    std::vector<cv::Mat_<float>>& islands,
+    std::vector<cv::Mat_<float>>& utilities);
+
   static void applyReproduction(
     const cv::Mat& pop,
     const cv::Mat& utilities,
     const int newPopLen,
     const CrossOverFunctor& crossover,
-    float &bestUtil,
+    PhiloxRng& rng,
     cv::Mat& newPop);
 
   static void applyMutation(
@@ -125,23 +168,28 @@ class GeneticOptimizator : public Optimization {
     const cv::Mat& pop,
     const int infLim,
     const int supLim,
-    cv::RNG& rng,
+    PhiloxRng& rng,
     cv::Mat& newPop);
 
   cv::Ptr<CrossOverFunctor> crossOver;
-  cv::Ptr<UtilityFunctor> utility;
 
   int mPopulationLength;
   int mDimensions = 2;
   double mElistimFactor,
          mMutationRate;
   float mBestUtil = 0.0f;
-  cv::RNG mRng;
+  int mSeed = 0;
+  // sequential generator of the single population mode
+  PhiloxRng mRng;
 
   cv::Point2d mMutationRange;
 
   MutationType mMutationType = Gaussian;
 
+  int mIslands = 1;
+  int mMigrationInterval = 10;
+  int mMigrants = 1;
+
  private:
   // private members
 };
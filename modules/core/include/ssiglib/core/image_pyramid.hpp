@@ -0,0 +1,103 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#ifndef _SSIG_CORE_IMAGE_PYRAMID_HPP_
+#define _SSIG_CORE_IMAGE_PYRAMID_HPP_
+// c++
+#include <vector>
+// opencv
+#include <opencv2/core.hpp>
+// ssiglib
+#include "core_defs.hpp"
+
+namespace ssig {
+
+/**
+Multi-scale copies of one image, built once and shared by every consumer of
+the frame (Sampling::windowRange, Descriptor2D::setData). Level 0 is the
+image itself and level i is downsampled by getScaleFactor()^i. Levels are
+read only: consumers share their data.
+*/
+class ImagePyramid {
+ public:
+  CORE_EXPORT ImagePyramid(void) = default;
+  CORE_EXPORT ImagePyramid(const cv::Mat& image,
+                           const float scaleFactor,
+                           const cv::Size& minSize = cv::Size(1, 1),
+                           const int maxLevels = 64);
+  CORE_EXPORT virtual ~ImagePyramid(void) = default;
+
+  /**
+  Builds the levels, resizing every one of them directly from the image in
+  parallel.
+
+  @param scaleFactor The ratio between two consecutive levels, greater
+  than 1.
+  @param minSize Levels smaller than this in any dimension are not built.
+  @param maxLevels The maximum number of levels, level 0 included.
+  */
+  CORE_EXPORT void build(const cv::Mat& image,
+                         const float scaleFactor,
+                         const cv::Size& minSize = cv::Size(1, 1),
+                         const int maxLevels = 64);
+
+  CORE_EXPORT int getLevels() const;
+  CORE_EXPORT const cv::Mat& getLevel(const int level) const;
+  CORE_EXPORT float getScaleFactor() const;
+  /**
+  @brief The factor by which level was downsampled from the image
+  */
+  CORE_EXPORT double getScale(const int level) const;
+
+  /**
+  @brief Maps a rectangle of level back to the image coordinates
+  */
+  CORE_EXPORT cv::Rect toBase(const cv::Rect& rect, const int level) const;
+
+ private:
+  std::vector<cv::Mat> mLevels;
+  std::vector<double> mScales;
+  float mScaleFactor = 1.f;
+};
+
+}  // namespace ssig
+
+#endif  // !_SSIG_CORE_IMAGE_PYRAMID_HPP_
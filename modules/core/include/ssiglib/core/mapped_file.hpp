@@ -0,0 +1,96 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#ifndef _SSIG_CORE_MAPPED_FILE_HPP_
+#define _SSIG_CORE_MAPPED_FILE_HPP_
+// c++
+#include <cstddef>
+#include <memory>
+#include <string>
+// opencv
+#include <opencv2/core.hpp>
+// ssiglib
+#include "core_defs.hpp"
+
+namespace ssig {
+
+/**
+@brief A whole file mapped copy-on-write: the pages are shared with the page
+cache until written, and writes never reach the file.
+*/
+class MappedFile {
+ public:
+  CORE_EXPORT explicit MappedFile(const std::string& filename);
+  CORE_EXPORT ~MappedFile(void);
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  CORE_EXPORT unsigned char* getData() const;
+  CORE_EXPORT size_t getSize() const;
+
+  /**
+  A rows x cols matrix over the bytes at offset. The matrix (and every
+  matrix sharing its data) holds a reference to the file, so it stays valid
+  after every other owner is gone.
+  */
+  CORE_EXPORT static cv::Mat view(const std::shared_ptr<MappedFile>& file,
+                                  const size_t offset,
+                                  const int rows,
+                                  const int cols,
+                                  const int type);
+  /**
+  The file mat (or the matrix it was taken from) is a view of, nullptr when
+  it does not come from view().
+  */
+  CORE_EXPORT static const MappedFile* getMapping(const cv::Mat& mat);
+
+ private:
+  unsigned char* mData = nullptr;
+  size_t mSize = 0;
+#ifdef _WIN32
+  void* mFile = nullptr;
+  void* mMapping = nullptr;
+#endif
+};
+
+}  // namespace ssig
+
+#endif  // !_SSIG_CORE_MAPPED_FILE_HPP_
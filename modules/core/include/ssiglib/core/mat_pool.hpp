@@ -0,0 +1,160 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#ifndef _SSIG_CORE_MAT_POOL_HPP_
+#define _SSIG_CORE_MAT_POOL_HPP_
+// c++
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+// opencv
+#include <opencv2/core.hpp>
+// ssiglib
+#include "core_defs.hpp"
+
+namespace ssig {
+
+/**
+cv::MatAllocator that recycles the buffers of short lived matrices instead
+of returning them to malloc.
+
+Requests are rounded up to size classes (four per power of two, so at most
+25% is wasted) and freed buffers wait in a free list of the thread that
+released them, which the next request of that class on the same thread
+takes without any locking. Buffers larger than kMaxPooledSize, or released
+while the thread already caches getMaxCachedBytes(), go back to the system.
+
+It is opt-in: matrices use it only while a MatPoolScope is alive,
+
+  {
+    ssig::MatPoolScope pool;
+    hog.extract(windows, features);
+  }
+
+Matrices allocated inside the scope can safely outlive it.
+*/
+class MatPool : public cv::MatAllocator {
+ public:
+  struct Stats {
+    // buffers requested, and how many of them came from a free list
+    uint64_t allocations;
+    uint64_t reused;
+    // bytes held by live matrices, and waiting in the free lists
+    uint64_t bytesInUse;
+    uint64_t bytesCached;
+    // largest bytesInUse + bytesCached seen since the last resetStats()
+    uint64_t peakBytes;
+
+    double getReuseRate() const {
+      return allocations ? static_cast<double>(reused) / allocations : 0.0;
+    }
+  };
+
+  static const size_t kMaxPooledSize = size_t(64) << 20;
+
+  CORE_EXPORT static MatPool& instance();
+
+  CORE_EXPORT Stats getStats() const;
+  CORE_EXPORT void resetStats();
+
+  /**
+  @brief Returns the buffers cached by the calling thread to the system
+  */
+  CORE_EXPORT void trim();
+
+  CORE_EXPORT size_t getMaxCachedBytes() const;
+  /**
+  @brief Limit of the bytes each thread keeps in its free lists
+  */
+  CORE_EXPORT void setMaxCachedBytes(const size_t bytes);
+
+#if CV_VERSION_MAJOR >= 4
+  typedef cv::AccessFlag AccessFlags;
+#else
+  typedef int AccessFlags;
+#endif
+  CORE_EXPORT cv::UMatData* allocate(int dims, const int* sizes, int type,
+                                     void* data, size_t* step,
+                                     AccessFlags flags,
+                                     cv::UMatUsageFlags usageFlags)
+  const override;
+  CORE_EXPORT bool allocate(cv::UMatData* data, AccessFlags accessFlags,
+                            cv::UMatUsageFlags usageFlags) const override;
+  CORE_EXPORT void deallocate(cv::UMatData* data) const override;
+
+ private:
+  struct ThreadCache;
+  MatPool() = default;
+
+  void* acquire(const size_t size) const;
+  void release(void* buffer, const size_t size) const;
+  void addFootprint(const int64_t inUse, const int64_t cached) const;
+
+  std::atomic<size_t> mMaxCachedBytes{size_t(32) << 20};
+  mutable std::atomic<uint64_t> mAllocations{0};
+  mutable std::atomic<uint64_t> mReused{0};
+  mutable std::atomic<int64_t> mBytesInUse{0};
+  mutable std::atomic<int64_t> mBytesCached{0};
+  mutable std::atomic<int64_t> mPeakBytes{0};
+};
+
+/**
+Makes MatPool the default allocator of cv::Mat while alive. Scopes nest and
+may be opened from several threads at once; the previous allocator is put
+back when the last one closes.
+*/
+class MatPoolScope {
+ public:
+  CORE_EXPORT MatPoolScope(void);
+  CORE_EXPORT ~MatPoolScope(void);
+  MatPoolScope(const MatPoolScope&) = delete;
+  MatPoolScope& operator=(const MatPoolScope&) = delete;
+
+ private:
+  static std::mutex sMutex;
+  static int sDepth;
+  static cv::MatAllocator* sPrevious;
+};
+
+}  // namespace ssig
+
+#endif  // !_SSIG_CORE_MAT_POOL_HPP_
@@ -41,11 +41,17 @@
 #ifndef _SSIG_CORE_MATH_HPP_
 #define _SSIG_CORE_MATH_HPP_
 
+// c++
+#include <algorithm>
+#include <cmath>
+#include <typeinfo>
+#include <vector>
 // opencv
 #include <opencv2/core.hpp>
 #include <opencv2/ml.hpp>
 // ssiglib
 #include "ssiglib/core/core_defs.hpp"
+#include "ssiglib/core/executor.hpp"
 
 namespace ssig {
 class UtilityFunctor {
@@ -59,6 +65,41 @@ class UtilityFunctor {
   CORE_EXPORT virtual float operator()(const cv::Mat& vector) const = 0;
 };
 
+/**
+@brief Scores a whole population (one candidate per row) in a single call,
+so objectives can batch their work (e.g. one predict per generation).
+*/
+class BatchUtilityFunctor {
+ public:
+  virtual ~BatchUtilityFunctor() {}
+
+  BatchUtilityFunctor() = default;
+
+  BatchUtilityFunctor(const BatchUtilityFunctor& rhs) {}
+
+  /**
+  @param utilities a population.rows x 1 matrix
+  */
+  CORE_EXPORT virtual void operator()(const cv::Mat& population,
+                                      cv::Mat_<float>& utilities) const = 0;
+};
+
+/**
+@brief Exposes a UtilityFunctor as a BatchUtilityFunctor, the rows are
+scored in parallel.
+*/
+class UtilityBatchAdapter : public BatchUtilityFunctor {
+ public:
+  CORE_EXPORT explicit UtilityBatchAdapter(
+    const cv::Ptr<UtilityFunctor>& utility);
+
+  CORE_EXPORT void operator()(const cv::Mat& population,
+                              cv::Mat_<float>& utilities) const override;
+
+ private:
+  cv::Ptr<UtilityFunctor> mUtility;
+};
+
 class DistanceFunctor {
  public:
   virtual ~DistanceFunctor() = default;
@@ -68,27 +109,82 @@ class DistanceFunctor {
 
   CORE_EXPORT virtual float operator()(const cv::Mat& x,
                                        const cv::Mat& y) const = 0;
+
+  /**
+  @brief Scores the query row against every row of samples.
+
+  The default implementation calls the pairwise operator once per sample.
+  @param scores a 1 x samples.rows matrix
+  */
+  CORE_EXPORT virtual void oneToMany(const cv::Mat& query,
+                                     const cv::Mat& samples,
+                                     cv::Mat_<float>& scores) const;
+
+  /**
+  @brief Scores every row of A against every row of B.
+
+  The default implementation calls oneToMany once per row of A.
+  @param scores a A.rows x B.rows matrix
+  */
+  CORE_EXPORT virtual void manyToMany(const cv::Mat& A,
+                                      const cv::Mat& B,
+                                      cv::Mat_<float>& scores) const;
+
+ protected:
+  /**
+  The batch overrides of the built-in functors run only on the exact
+  built-in type, so a functor deriving from one that overrides just the
+  pairwise operator is still scored through its own operator.
+  */
+  template <class Builtin>
+  bool isExactly() const {
+    return typeid(*this) == typeid(Builtin);
+  }
 };
 
 struct CosineSimilarity : DistanceFunctor {
   CORE_EXPORT float operator()(const cv::Mat& x,
                                const cv::Mat& y) const override;
+  CORE_EXPORT void oneToMany(const cv::Mat& query,
+                             const cv::Mat& samples,
+                             cv::Mat_<float>& scores) const override;
+  CORE_EXPORT void manyToMany(const cv::Mat& A,
+                              const cv::Mat& B,
+                              cv::Mat_<float>& scores) const override;
 };
 
 struct CorrelationSimilarity : DistanceFunctor {
   CORE_EXPORT float operator()(const cv::Mat& x,
                                const cv::Mat& y) const override;
+  CORE_EXPORT void oneToMany(const cv::Mat& query,
+                             const cv::Mat& samples,
+                             cv::Mat_<float>& scores) const override;
+  CORE_EXPORT void manyToMany(const cv::Mat& A,
+                              const cv::Mat& B,
+                              cv::Mat_<float>& scores) const override;
 };
 
 struct Chi2Similarity : DistanceFunctor {
   CORE_EXPORT float operator()(const cv::Mat& x,
                                const cv::Mat& y) const override;
+  CORE_EXPORT void oneToMany(const cv::Mat& query,
+                             const cv::Mat& samples,
+                             cv::Mat_<float>& scores) const override;
+  CORE_EXPORT void manyToMany(const cv::Mat& A,
+                              const cv::Mat& B,
+                              cv::Mat_<float>& scores) const override;
 };
 
 struct EuclideanDistance : DistanceFunctor {
   CORE_EXPORT float operator()(
     const cv::Mat& x,
     const cv::Mat& y) const override;
+  CORE_EXPORT void oneToMany(const cv::Mat& query,
+                             const cv::Mat& samples,
+                             cv::Mat_<float>& scores) const override;
+  CORE_EXPORT void manyToMany(const cv::Mat& A,
+                              const cv::Mat& B,
+                              cv::Mat_<float>& scores) const override;
 };
 
 typedef DistanceFunctor SimilarityFunctor;
@@ -100,57 +196,139 @@ class Math {
   Math(const Math& rhs);
   Math& operator=(const Math& rhs);
 
+  /**
+  @brief Builds the symmetric similarity matrix among the rows of input.
+
+  The matrix is split in tiles that are scored in parallel through
+  SimilarityFunctor::manyToMany. The built-in GEMM functors norm (and
+  center) the rows once, then reduce a tile to one GEMM plus row-norm
+  corrections (Chi2 uses a SIMD kernel), other functors,
+  including those deriving from a built-in one, fall back to one pairwise
+  call per element. Only the upper tiles are
+  scored and mirrored, the diagonal is left at zero.
+  */
   CORE_EXPORT static cv::Mat_<float> buildSimilarity(
     const cv::Mat_<float>& input,
     SimilarityFunctor
     & similarityFunction);
 };
 
+/**
+@brief Population mean and standard deviation of every row (ROW_SAMPLE) or
+column (COL_SAMPLE) of m.
+
+The matrix is streamed once in row order. Each value is shifted by the first
+sample before it is accumulated in double precision, which keeps the
+sum-of-squares formula from cancelling. For COL_SAMPLE the rows are split in
+a fixed number of chunks reduced in parallel, so the result does not depend
+on the number of threads.
+*/
 template <class T>
 void computeMeanStd(cv::Mat_<T>& m, const int layout, cv::Mat_<T>& mean,
                     cv::Mat_<T>& std) {
-  cv::Mat aux, auxMean, auxStd;
-  int x;
-  int len;
+  const int rows = m.rows;
+  const int cols = m.cols;
+
   if (layout == cv::ml::ROW_SAMPLE) {
-    len = m.rows;
-    mean = cv::Mat_<T>::zeros(len, 1);
-    std = cv::Mat_<T>::zeros(len, 1);
-  } else {
-    len = m.cols;
-    mean = cv::Mat_<T>::zeros(1, len);
-    std = cv::Mat_<T>::zeros(1, len);
+    mean = cv::Mat_<T>::zeros(rows, 1);
+    std = cv::Mat_<T>::zeros(rows, 1);
+    if (cols == 0)
+      return;
+    Executor::global().parallelFor(0, rows,
+      [&](const int first, const int last) {
+      for (int r = first; r < last; ++r) {
+        const T* row = m[r];
+        const double shift = static_cast<double>(row[0]);
+        double sum = 0, sqrSum = 0;
+        for (int x = 0; x < cols; ++x) {
+          const double d = static_cast<double>(row[x]) - shift;
+          sum += d;
+          sqrSum += d * d;
+        }
+        const double avg = sum / cols;
+        const double var = std::max(sqrSum / cols - avg * avg, 0.0);
+        mean[r][0] = static_cast<T>(shift + avg);
+        std[r][0] = static_cast<T>(std::sqrt(var));
+      }
+    });
+    return;
   }
 
-  for (x = 0; x < len; x++) {
-    if (layout == cv::ml::ROW_SAMPLE) {
-      aux = m.row(x);
-    } else {
-      aux = m.col(x);
+  mean = cv::Mat_<T>::zeros(1, cols);
+  std = cv::Mat_<T>::zeros(1, cols);
+  if (rows == 0)
+    return;
+
+  const int nChunks = std::max(1, std::min(32, rows / 64));
+  std::vector<double> sums(static_cast<size_t>(nChunks) * cols, 0.0);
+  std::vector<double> sqrSums(static_cast<size_t>(nChunks) * cols, 0.0);
+  const T* shift = m[0];
+
+  Executor::global().parallelFor(0, nChunks,
+    [&](const int first, const int last) {
+    for (int c = first; c < last; ++c) {
+      const int begin =
+        static_cast<int>(static_cast<int64>(rows) * c / nChunks);
+      const int end =
+        static_cast<int>(static_cast<int64>(rows) * (c + 1) / nChunks);
+      double* sum = &sums[static_cast<size_t>(c) * cols];
+      double* sqrSum = &sqrSums[static_cast<size_t>(c) * cols];
+      for (int r = begin; r < end; ++r) {
+        const T* row = m[r];
+        for (int x = 0; x < cols; ++x) {
+          const double d = static_cast<double>(row[x]) - shift[x];
+          sum[x] += d;
+          sqrSum[x] += d * d;
+        }
+      }
     }
+  });
 
-    cv::meanStdDev(aux, auxMean, auxStd);
-    if (layout == cv::ml::ROW_SAMPLE) {
-      mean[x][0] = static_cast<T>(auxMean.at<double>(0, 0));
-      std[x][0] = static_cast<T>(auxStd.at<double>(0, 0));
-    } else {
-      mean[0][x] = static_cast<T>(auxMean.at<double>(0, 0));
-      std[0][x] = static_cast<T>(auxStd.at<double>(0, 0));
+  // every chunk shares the same shift, so the partial sums simply add up
+  for (int c = 1; c < nChunks; ++c) {
+    const double* sum = &sums[static_cast<size_t>(c) * cols];
+    const double* sqrSum = &sqrSums[static_cast<size_t>(c) * cols];
+    for (int x = 0; x < cols; ++x) {
+      sums[x] += sum[x];
+      sqrSums[x] += sqrSum[x];
     }
   }
+  for (int x = 0; x < cols; ++x) {
+    const double avg = sums[x] / rows;
+    const double var = std::max(sqrSums[x] / rows - avg * avg, 0.0);
+    mean[0][x] = static_cast<T>(shift[x] + avg);
+    std[0][x] = static_cast<T>(std::sqrt(var));
+  }
 }
 
-
-
+/**
+@brief Subtracts mean and divides by std (both 1 x M.cols) every row of M, in
+place and in a single pass. A zero deviation yields zero, as cv::divide does.
+*/
 template <typename Type>
 void computeZScore(cv::Mat_<Type>& M, cv::Mat_<Type>& mean,
                    cv::Mat_<Type>& std) {
-  int y;
+  const int cols = M.cols;
+  CV_Assert(static_cast<int>(mean.total()) == cols && mean.isContinuous());
+  CV_Assert(static_cast<int>(std.total()) == cols && std.isContinuous());
 
-  for (y = 0; y < M.rows; y++) {
-    M.row(y) -= mean;
-    M.row(y) /= std;
+  const Type* mu = reinterpret_cast<const Type*>(mean.data);
+  const Type* sigma = reinterpret_cast<const Type*>(std.data);
+  std::vector<Type> inverse(cols);
+  for (int x = 0; x < cols; ++x) {
+    inverse[x] = (sigma[x] != 0) ? static_cast<Type>(1) / sigma[x] : 0;
   }
+  const Type* inv = inverse.data();
+
+  Executor::global().parallelFor(0, M.rows,
+    [&](const int first, const int last) {
+    for (int y = first; y < last; ++y) {
+      Type* row = M[y];
+      for (int x = 0; x < cols; ++x) {
+        row[x] = (row[x] - mu[x]) * inv[x];
+      }
+    }
+  });
 }
 
 CORE_EXPORT void clComputeMeanStd(
@@ -0,0 +1,189 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#ifndef _SSIG_CORE_MEMORY_FOOTPRINT_HPP_
+#define _SSIG_CORE_MEMORY_FOOTPRINT_HPP_
+// c++
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+// opencv
+#include <opencv2/core.hpp>
+// ssiglib
+#include "core_defs.hpp"
+
+namespace ssig {
+
+class Algorithm;
+
+/**
+Bytes held by a model, broken down by member, as returned by
+Algorithm::memoryFootprint.
+
+Owned bytes are held by the model alone. Shared bytes belong to buffers
+other objects may reference too (matrices with several headers, mapped
+files, evaluation caches); they carry the address of the buffer so totals
+over several models count each buffer once. Child models, such as the
+binary classifiers of a one against all, are nested footprints.
+*/
+class MemoryFootprint {
+ public:
+  struct Entry {
+    std::string name;
+    size_t bytes;
+    // the shared buffer, nullptr for owned bytes
+    const void* buffer;
+  };
+
+  CORE_EXPORT void addOwned(const std::string& name, const size_t bytes);
+  CORE_EXPORT void addShared(const std::string& name, const size_t bytes,
+                             const void* buffer);
+  /**
+  Adds the whole buffer behind mat: owned when mat is its only header,
+  shared otherwise. Views of a MappedFile are shared under the mapping, so
+  the file is counted once however many views there are, and once with the
+  BinaryStorage over it. Headers over memory OpenCV does not manage are
+  skipped: that memory is reported by its owner.
+  */
+  CORE_EXPORT void addMat(const std::string& name, const cv::Mat& mat);
+  CORE_EXPORT void addMats(const std::string& name,
+                           const std::vector<cv::Mat>& mats);
+  /**
+  @brief Adds the elements of nested vectors, such as index lists
+  */
+  template <class T>
+  void addVectors(const std::string& name,
+                  const std::vector<std::vector<T>>& vectors) {
+    size_t bytes = vectors.capacity() * sizeof(std::vector<T>);
+    for (const auto& vector : vectors)
+      bytes += vector.capacity() * sizeof(T);
+    addOwned(name, bytes);
+  }
+  CORE_EXPORT void addChild(const std::string& name,
+                            const MemoryFootprint& child);
+
+  CORE_EXPORT const std::string& getName() const;
+  CORE_EXPORT void setName(const std::string& name);
+  CORE_EXPORT const std::vector<Entry>& getEntries() const;
+  CORE_EXPORT const std::vector<MemoryFootprint>& getChildren() const;
+
+  /**
+  @brief Owned bytes of this model and its children
+  */
+  CORE_EXPORT size_t getOwnedBytes() const;
+  /**
+  @brief Shared bytes of this model and its children, each buffer once
+  */
+  CORE_EXPORT size_t getSharedBytes() const;
+  CORE_EXPORT size_t getTotalBytes() const;
+
+  /**
+  @brief {"name", "owned", "shared", "entries": [{"name", "bytes",
+  "shared"}], "children": [...]}
+  */
+  CORE_EXPORT std::string toJson() const;
+
+ private:
+  friend class MemoryTally;
+  void collectShared(std::unordered_map<const void*, size_t>& buffers) const;
+  void appendJson(std::string& out) const;
+
+  std::string mName;
+  std::vector<Entry> mEntries;
+  std::vector<MemoryFootprint> mChildren;
+};
+
+/**
+Process wide tally of the models a process keeps loaded, to budget memory
+across them. Models are tracked by name; their footprints are taken again
+on every query, so the tally follows retraining and reloading.
+
+A tracked model must not be trained or destroyed by another thread while
+the tally is queried. Destroying a model untracks it.
+*/
+class MemoryTally {
+ public:
+  CORE_EXPORT static MemoryTally& instance();
+
+  /**
+  Tracks model under name, replacing the model tracked under that name.
+  Throws std::length_error, leaving the tally unchanged, when the total
+  would go over the limit.
+  */
+  CORE_EXPORT void track(const std::string& name, const Algorithm& model);
+  CORE_EXPORT void untrack(const std::string& name);
+  CORE_EXPORT void untrack(const Algorithm* model);
+  CORE_EXPORT void clear();
+
+  /**
+  @brief Limit in bytes for track, zero (the default) for none
+  */
+  CORE_EXPORT void setLimit(const size_t bytes);
+  CORE_EXPORT size_t getLimit() const;
+
+  /**
+  @brief Bytes of every tracked model, buffers shared by several models
+  counted once
+  */
+  CORE_EXPORT size_t getTotalBytes() const;
+  /**
+  @brief Footprint of every tracked model, the largest first
+  */
+  CORE_EXPORT std::vector<MemoryFootprint> getFootprints() const;
+
+ private:
+  MemoryTally(void) = default;
+  MemoryTally(const MemoryTally&) = delete;
+  MemoryTally& operator=(const MemoryTally&) = delete;
+
+  size_t totalBytes(const std::vector<MemoryFootprint>& footprints) const;
+
+  mutable std::mutex mLock;
+  size_t mLimit = 0;
+  std::vector<std::pair<std::string, const Algorithm*>> mModels;
+};
+
+}  // namespace ssig
+
+#endif  // !_SSIG_CORE_MEMORY_FOOTPRINT_HPP_
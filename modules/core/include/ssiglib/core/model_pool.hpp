@@ -0,0 +1,182 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+
+#ifndef _SSIG_CORE_MODEL_POOL_HPP_
+#define _SSIG_CORE_MODEL_POOL_HPP_
+// c++
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+// opencv
+#include <opencv2/core.hpp>
+
+namespace ssig {
+
+/**
+Hands out instances of a model whose inference path keeps per-call state,
+such as a Descriptor2D that holds the image it extracts from, so request
+threads stop deep copying whole models.
+
+Instances come from the factory only when every instance is leased, so a
+pool never holds more instances than the peak number of concurrent
+leases. The factory should copy a prototype so that the weights are
+shared, not cloned,
+
+  ssig::ModelPool<ssig::HOG> pool([&prototype] {
+    return cv::Ptr<ssig::HOG>(new ssig::HOG(prototype));
+  });
+  // on every request thread
+  auto hog = pool.acquire();
+  hog->setData(image);
+  hog->extract(windows, features);
+
+Models with a re-entrant const predict, such as every Classifier, serve
+concurrent threads from one instance and do not need a pool. Every Lease
+must be released before its pool is destroyed.
+*/
+template <class Model>
+class ModelPool {
+ public:
+  typedef std::function<cv::Ptr<Model>()> Factory;
+
+  /**
+  An instance owned by one thread until the lease goes out of scope, when
+  it returns to the pool.
+  */
+  class Lease {
+   public:
+    Lease(Lease&& rhs) : mPool(rhs.mPool), mModel(rhs.mModel) {
+      rhs.mPool = nullptr;
+      rhs.mModel.release();
+    }
+    Lease(const Lease&) = delete;
+    Lease& operator=(const Lease&) = delete;
+    ~Lease(void) {
+      if (mPool)
+        mPool->release(mModel);
+    }
+
+    Model* get() const {
+      return mModel.get();
+    }
+    Model* operator->() const {
+      return mModel.get();
+    }
+    Model& operator*() const {
+      return *mModel;
+    }
+
+   private:
+    friend class ModelPool;
+    Lease(ModelPool* pool, const cv::Ptr<Model>& model)
+      : mPool(pool), mModel(model) {}
+
+    ModelPool* mPool;
+    cv::Ptr<Model> mModel;
+  };
+
+  explicit ModelPool(const Factory& factory) : mFactory(factory) {}
+  ModelPool(const ModelPool&) = delete;
+  ModelPool& operator=(const ModelPool&) = delete;
+
+  /**
+  @brief Leases an idle instance, or a new one from the factory
+  */
+  Lease acquire() {
+    {
+      std::lock_guard<std::mutex> lock(mLock);
+      if (!mIdle.empty()) {
+        cv::Ptr<Model> model = mIdle.back();
+        mIdle.pop_back();
+        return Lease(this, model);
+      }
+      ++mNumInstances;
+    }
+    // built outside the lock, so a slow factory does not serialize leases
+    cv::Ptr<Model> model = mFactory();
+    if (!model) {
+      std::lock_guard<std::mutex> lock(mLock);
+      --mNumInstances;
+      throw std::runtime_error("The model pool factory returned no model");
+    }
+    return Lease(this, model);
+  }
+
+  /**
+  @brief Instances built by the factory, leased or idle
+  */
+  size_t getNumInstances() const {
+    std::lock_guard<std::mutex> lock(mLock);
+    return mNumInstances;
+  }
+
+  size_t getNumIdle() const {
+    std::lock_guard<std::mutex> lock(mLock);
+    return mIdle.size();
+  }
+
+  /**
+  @brief Drops the idle instances, the leased ones are kept when returned
+  */
+  void clear() {
+    std::lock_guard<std::mutex> lock(mLock);
+    mNumInstances -= mIdle.size();
+    mIdle.clear();
+  }
+
+ private:
+  void release(const cv::Ptr<Model>& model) {
+    std::lock_guard<std::mutex> lock(mLock);
+    mIdle.push_back(model);
+  }
+
+  Factory mFactory;
+  mutable std::mutex mLock;
+  std::vector<cv::Ptr<Model>> mIdle;
+  size_t mNumInstances = 0;
+};
+
+}  // namespace ssig
+
+#endif  // !_SSIG_CORE_MODEL_POOL_HPP_
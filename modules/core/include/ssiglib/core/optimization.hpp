@@ -51,7 +51,9 @@
 
 namespace ssig {
 class UtilityFunctor;
+class BatchUtilityFunctor;
 class DistanceFunctor;
+class EvaluationCache;
 
 class Optimization : public Algorithm {
  public:
@@ -73,36 +75,73 @@ class Optimization : public Algorithm {
   CORE_EXPORT cv::Ptr<UtilityFunctor> getUtility() const;
   CORE_EXPORT cv::Ptr<DistanceFunctor> getDistance() const;
   CORE_EXPORT void setUtilityFunctor(cv::Ptr<UtilityFunctor>& utilityFunctor);
+  CORE_EXPORT cv::Ptr<BatchUtilityFunctor> getBatchUtility() const;
+  /**
+  @brief When set, the population is scored by one call to this functor per
+  generation instead of one call to the utility functor per individual.
+  */
+  CORE_EXPORT void setBatchUtilityFunctor(
+    cv::Ptr<BatchUtilityFunctor>& batchUtilityFunctor);
   CORE_EXPORT void setDistanceFunctor(
     cv::Ptr<DistanceFunctor>& distanceFunctor);
 
   CORE_EXPORT double getEps() const;
   CORE_EXPORT void setEps(const double eps);
 
+  CORE_EXPORT cv::Ptr<EvaluationCache> getEvaluationCache() const;
+  /**
+  @brief Candidates found in the cache are not scored again. Pass the same
+  cache to several optimizers to share it; an empty pointer disables it.
+  */
+  CORE_EXPORT void setEvaluationCache(cv::Ptr<EvaluationCache>& cache);
+
+  CORE_EXPORT bool getSteadyState() const;
+  /**
+  @brief In steady-state mode the optimizers that support it (PSO and
+  GeneticOptimizator) drop the barrier after each generation: every thread
+  produces a candidate, evaluates it and merges the result as soon as it
+  finishes. learn() then stops after getMaxIterations() times the population
+  length evaluations, eps is not used, and runs are not reproducible.
+  */
+  CORE_EXPORT void setSteadyState(const bool steadyState);
+
+  /**
+  The evaluation cache is reported as shared: several optimizers may use it.
+  */
+  CORE_EXPORT MemoryFootprint memoryFootprint() const override;
+
  protected:
   CORE_EXPORT Optimization() = default;
   CORE_EXPORT Optimization(
     cv::Ptr<UtilityFunctor>& utilityFunction,
     cv::Ptr<DistanceFunctor>& distanceFunction);
-  CORE_EXPORT static cv::Mat_<float> randomVector(
-    const int dimensionality,
-    const double minRange = 0.5,
-    const double maxRange = 0.5);
+
+  /**
+  @brief Scores every row of population with the batch utility when one is
+  set, otherwise with the utility functor wrapped by UtilityBatchAdapter.
+  With an evaluation cache only the rows missing from it are scored, once
+  per distinct key.
+  */
+  CORE_EXPORT void evaluate(const cv::Mat& population,
+                            cv::Mat_<float>& utilities) const;
 
   CORE_EXPORT void read(const cv::FileNode& fn) override {};
 
   CORE_EXPORT void write(cv::FileStorage& fs) const override {};
 
   cv::Ptr<UtilityFunctor> utility;
+  cv::Ptr<BatchUtilityFunctor> batchUtility;
   cv::Ptr<DistanceFunctor> distance;
+  cv::Ptr<EvaluationCache> mCache;
   cv::Mat_<float> mPopulation;
   cv::Mat_<float> mUtilities;
 
   int mMaxIterations = 100;
   double mEps = 0.0001;
+  bool mSteadyState = false;
 
  private:
-  // private members
+  void score(const cv::Mat& population, cv::Mat_<float>& utilities) const;
 };
 }  // namespace ssig
 #endif  // !_SSIG_CORE_OPTIMIZATION_HPP_
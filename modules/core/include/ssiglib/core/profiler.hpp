@@ -0,0 +1,186 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#ifndef _SSIG_CORE_PROFILER_HPP_
+#define _SSIG_CORE_PROFILER_HPP_
+// c++
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+// ssiglib
+#include "core_defs.hpp"
+
+/**
+The library stages are instrumented with the macros below. They expand to
+nothing unless the library is configured with WITH_PROFILER (which defines
+SSIG_WITH_PROFILER), so a default build pays nothing for them.
+
+  SSIG_PROFILE_SCOPE("HOG::beforeProcess");
+  SSIG_PROFILE_COUNT("Descriptor2D::extract.bytes", bytes);
+
+Names must be string literals, they are used as keys without copying.
+*/
+#define SSIG_PROFILE_CONCAT_(a, b) a##b
+#define SSIG_PROFILE_CONCAT(a, b) SSIG_PROFILE_CONCAT_(a, b)
+#ifdef SSIG_WITH_PROFILER
+#define SSIG_PROFILE_SCOPE(name) \
+  ssig::ScopedTimer SSIG_PROFILE_CONCAT(ssigScopedTimer, __LINE__)(name)
+#define SSIG_PROFILE_COUNT(name, value) \
+  ssig::Profiler::instance().addCount(name, static_cast<int64_t>(value))
+#else
+#define SSIG_PROFILE_SCOPE(name) static_cast<void>(0)
+#define SSIG_PROFILE_COUNT(name, value) static_cast<void>(0)
+#endif
+
+namespace ssig {
+
+/**
+Process wide collector of stage timings and counters. Every thread records
+into its own tables, without contention; readers merge the tables of the
+live threads with the ones left by the threads that already finished.
+
+Latencies go to log-linear histograms (16 buckets per power of two, so the
+reported percentiles are within 1/16 of the true value).
+*/
+class Profiler {
+ public:
+  struct Timing {
+    std::string name;
+    int64_t calls;
+    // all in seconds
+    double total;
+    double min;
+    double max;
+    double p50;
+    double p99;
+  };
+
+  /**
+  @brief The profiler fed by ScopedTimer and the SSIG_PROFILE macros
+  */
+  CORE_EXPORT static Profiler& instance();
+  /**
+  @brief True when the library stages are instrumented
+  */
+  CORE_EXPORT static bool isCompiledIn();
+
+  CORE_EXPORT void addSample(const char* name, const double seconds);
+  CORE_EXPORT void addCount(const char* name, const int64_t value);
+
+  /**
+  @brief Merged timings of every thread, sorted by name
+  */
+  CORE_EXPORT std::vector<Timing> getTimings() const;
+  /**
+  @brief Merged counters of every thread, sorted by name
+  */
+  CORE_EXPORT std::vector<std::pair<std::string, int64_t>> getCounters()
+  const;
+  CORE_EXPORT void reset();
+
+  /**
+  @brief {"timings": [{"name", "calls", "total_ms", "mean_ms", "min_ms",
+  "p50_ms", "p99_ms", "max_ms"}], "counters": [{"name", "value"}]}
+  */
+  CORE_EXPORT std::string toJson() const;
+  CORE_EXPORT void dump(const std::string& filename) const;
+
+ private:
+  struct ThreadTables;
+  struct Histogram {
+    // 16 linear buckets per power of two of the latency in nanoseconds
+    static const int kSubBuckets = 16;
+    static const int kBuckets = 61 * kSubBuckets;
+
+    int64_t calls = 0;
+    double total = 0;
+    double min = 0;
+    double max = 0;
+    std::vector<uint32_t> counts;
+
+    void add(const double seconds);
+    void merge(const Histogram& rhs);
+    double percentile(const double p) const;
+    static int bucket(const uint64_t nanoseconds);
+    static uint64_t lowerBound(const int bucket);
+  };
+
+  Profiler(void) = default;
+  Profiler(const Profiler&) = delete;
+  Profiler& operator=(const Profiler&) = delete;
+
+  ThreadTables& local();
+  void retire(ThreadTables* tables);
+
+  mutable std::mutex mLock;
+  std::vector<ThreadTables*> mThreads;
+  // tables of the threads that have exited
+  std::unordered_map<std::string, Histogram> mRetiredTimings;
+  std::unordered_map<std::string, int64_t> mRetiredCounters;
+};
+
+/**
+@brief Adds the lifetime of the object to the named timing
+*/
+class ScopedTimer {
+ public:
+  explicit ScopedTimer(const char* name)
+    : mName(name), mStart(std::chrono::steady_clock::now()) {}
+  ~ScopedTimer(void) {
+    const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - mStart;
+    Profiler::instance().addSample(mName, elapsed.count());
+  }
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+ private:
+  const char* mName;
+  std::chrono::steady_clock::time_point mStart;
+};
+
+}  // namespace ssig
+
+#endif  // !_SSIG_CORE_PROFILER_HPP_
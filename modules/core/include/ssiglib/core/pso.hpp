@@ -93,6 +93,15 @@ class PSO : public Optimization {
 
   CORE_EXPORT float getBestUtil() const;
 
+  /**
+  @brief Every random draw of a run is derived from this seed, the iteration
+  and the particle index, so a run is reproducible for any number of threads.
+  */
+  CORE_EXPORT void setSeed(int seed);
+  CORE_EXPORT int getSeed() const;
+
+  CORE_EXPORT MemoryFootprint memoryFootprint() const override;
+
  protected:
   CORE_EXPORT PSO(
     cv::Ptr<UtilityFunctor>& utility,
@@ -103,11 +112,21 @@ class PSO : public Optimization {
 
 
   CORE_EXPORT void iterate();
+  /**
+  @brief Asynchronous learning: each thread moves one idle particle towards
+  the current global best, evaluates it and returns it to the idle queue.
+  */
+  CORE_EXPORT void learnSteadyState();
+  /**
+  @brief Moves the whole swarm in a single pass over the velocity and
+  position matrices. Row r of coefficients holds the R1 and R2 of particle r.
+  */
   CORE_EXPORT static void update(const cv::Mat& globalBest,
-    const cv::Mat& localBest,
+    const cv::Mat& localBests,
     const cv::Vec3f& inertia,
-    cv::Mat& velocity,
-    cv::Mat& position);
+    const cv::Mat_<float>& coefficients,
+    cv::Mat& velocities,
+    cv::Mat& positions);
 
  private:
   // private members
@@ -120,6 +139,8 @@ class PSO : public Optimization {
 
   int mPopulationLength = 100;
   int mDimensions = 1;
+  int mSeed = 0;
+  int mIteration = 0;
 
   float mBestUtil = -FLT_MAX;
   std::vector<float> mLocalUtils;
@@ -0,0 +1,125 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#ifndef _SSIG_CORE_QUANTIZED_MAT_HPP_
+#define _SSIG_CORE_QUANTIZED_MAT_HPP_
+// c++
+#include <cstddef>
+#include <cstdint>
+// opencv
+#include <opencv2/core.hpp>
+// ssiglib
+#include "core_defs.hpp"
+
+namespace ssig {
+
+/**
+Row-major matrix of features stored with fewer bits than float.
+
+FLOAT16 keeps every element as an IEEE half (2 bytes, about three
+significant digits). UINT8 maps each column affinely onto 0..255 between
+its minimum and maximum (1 byte, value = offset + scale * code). The
+consumers decode one row, or a small block of rows, at a time into float
+scratch memory, so a quantized gallery is never expanded as a whole.
+*/
+class QuantizedMat {
+ public:
+  enum Format {
+    FLOAT16,
+    UINT8
+  };
+
+  CORE_EXPORT QuantizedMat(void) = default;
+  /**
+  Converts every element of a single channel matrix of any depth.
+  */
+  CORE_EXPORT QuantizedMat(const cv::Mat& m, const Format format);
+
+  CORE_EXPORT Format getFormat() const;
+  CORE_EXPORT int getNumRows() const;
+  CORE_EXPORT int getNumCols() const;
+  CORE_EXPORT bool empty() const;
+  /**
+  Bytes taken by the codes and the column parameters.
+  */
+  CORE_EXPORT size_t getMemorySize() const;
+
+  /**
+  CV_16U half bit patterns for FLOAT16, CV_8U codes for UINT8
+  */
+  CORE_EXPORT const cv::Mat& getCodes() const;
+  /**
+  1 x cols decoding parameters of UINT8, empty for FLOAT16
+  */
+  CORE_EXPORT const cv::Mat_<float>& getScale() const;
+  CORE_EXPORT const cv::Mat_<float>& getOffset() const;
+
+  /**
+  Rows [begin, end) sharing the codes of this matrix, like cv::Mat::rowRange
+  */
+  CORE_EXPORT QuantizedMat rowRange(const int begin, const int end) const;
+
+  /**
+  Writes the getNumCols() values of a row to out.
+  */
+  CORE_EXPORT void decodeRow(const int row, float* out) const;
+  /**
+  Decodes rows [begin, end) into out, reallocated only if its size changes.
+  */
+  CORE_EXPORT void decodeRows(const int begin, const int end,
+                              cv::Mat_<float>& out) const;
+  CORE_EXPORT cv::Mat_<float> toFloat() const;
+
+  /**
+  Round to nearest even, values beyond the half range become infinite.
+  */
+  CORE_EXPORT static uint16_t toHalf(const float value);
+  CORE_EXPORT static float fromHalf(const uint16_t value);
+
+ private:
+  Format mFormat = FLOAT16;
+  cv::Mat mCodes;
+  cv::Mat_<float> mScale, mOffset;
+};
+
+}  // namespace ssig
+
+#endif  // !_SSIG_CORE_QUANTIZED_MAT_HPP_
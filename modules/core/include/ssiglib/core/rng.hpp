@@ -0,0 +1,212 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#ifndef _SSIG_CORE_RNG_HPP_
+#define _SSIG_CORE_RNG_HPP_
+
+// c++
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "core_defs.hpp"
+
+namespace ssig {
+
+/**
+@brief Philox4x32-10 counter-based random number generator.
+
+The sequence is a pure function of (seed, stream, position), so generators
+created for different streams are independent, need no locking and give the
+same numbers whatever thread draws them. Derive one stream per work item
+(e.g. particle and iteration) to make parallel runs reproducible.
+*/
+class PhiloxRng {
+ public:
+  // UniformRandomBitGenerator interface, for the <random> distributions
+  typedef uint32_t result_type;
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return 0xFFFFFFFFu; }
+  result_type operator()() { return next(); }
+
+  explicit PhiloxRng(const uint64_t seed = 0, const uint64_t stream = 0) {
+    mKey[0] = static_cast<uint32_t>(seed);
+    mKey[1] = static_cast<uint32_t>(seed >> 32);
+    mCounter[0] = 0;
+    mCounter[1] = 0;
+    mCounter[2] = static_cast<uint32_t>(stream);
+    mCounter[3] = static_cast<uint32_t>(stream >> 32);
+    mPosition = 4;
+  }
+
+  /**
+  @brief Combines two identifiers into one stream id (splitmix64 finalizer)
+  */
+  static uint64_t stream(const uint64_t a, const uint64_t b) {
+    uint64_t z = a * 0x9E3779B97F4A7C15ULL + b;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+
+  /**
+  @brief The Philox bijection: 10 rounds over one 128 bits counter block
+  */
+  static void block(const uint32_t counter[4], const uint32_t key[2],
+                    uint32_t out[4]) {
+    uint32_t c0 = counter[0], c1 = counter[1],
+        c2 = counter[2], c3 = counter[3];
+    uint32_t k0 = key[0], k1 = key[1];
+    for (int round = 0; round < 10; ++round) {
+      const uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * c0;
+      const uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * c2;
+      const uint32_t hi0 = static_cast<uint32_t>(p0 >> 32);
+      const uint32_t hi1 = static_cast<uint32_t>(p1 >> 32);
+      c0 = hi1 ^ c1 ^ k0;
+      c1 = static_cast<uint32_t>(p1);
+      c2 = hi0 ^ c3 ^ k1;
+      c3 = static_cast<uint32_t>(p0);
+      k0 += 0x9E3779B9u;
+      k1 += 0xBB67AE85u;
+    }
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+  }
+
+  uint32_t next() {
+    if (mPosition == 4) {
+      block(mCounter, mKey, mBuffer);
+      if (++mCounter[0] == 0)
+        ++mCounter[1];
+      mPosition = 0;
+    }
+    return mBuffer[mPosition++];
+  }
+
+  /**
+  @brief Uniform float in [0, 1)
+  */
+  float uniform() {
+    return static_cast<float>(next() >> 8) * (1.f / 16777216.f);
+  }
+
+  /**
+  @brief Uniform float in [a, b)
+  */
+  float uniform(const float a, const float b) {
+    return a + (b - a) * uniform();
+  }
+
+  /**
+  @brief Uniform integer in [a, b)
+  */
+  int uniform(const int a, const int b) {
+    const uint64_t range = static_cast<uint64_t>(
+      static_cast<int64_t>(b) - static_cast<int64_t>(a));
+    return a + static_cast<int>((range * next()) >> 32);
+  }
+
+  /**
+  @brief Normally distributed float with zero mean (Box-Muller)
+  */
+  float gaussian(const float sigma) {
+    // shifted to (0, 1] so the logarithm is finite
+    const double u1 = (static_cast<double>(next() >> 8) + 1.0) / 16777216.0;
+    const double u2 = static_cast<double>(next() >> 8) / 16777216.0;
+    const double radius = std::sqrt(-2.0 * std::log(u1));
+    return static_cast<float>(sigma * radius *
+      std::cos(6.283185307179586 * u2));
+  }
+
+  void fillUniform(float* data, const size_t len, const float a,
+                   const float b) {
+    for (size_t i = 0; i < len; ++i)
+      data[i] = uniform(a, b);
+  }
+
+  void fillGaussian(float* data, const size_t len, const float sigma) {
+    for (size_t i = 0; i < len; ++i)
+      data[i] = gaussian(sigma);
+  }
+
+ private:
+  uint32_t mKey[2];
+  uint32_t mCounter[4];
+  uint32_t mBuffer[4];
+  int mPosition;
+};
+
+/**
+@brief Consumers of the random number service. Each one keys its
+generators apart from the others, so adding draws to one algorithm does not
+shift the numbers seen by another.
+*/
+enum RngDomain {
+  RNG_OPTIMIZATION = 1,
+  RNG_PSO,
+  RNG_FIREFLY,
+  RNG_GENETIC,
+  RNG_MLP,
+  RNG_HASHING,
+  RNG_CLUSTERING,
+  RNG_SAMPLING
+};
+
+/**
+@brief Seed every generator of the library is derived from. It starts from
+the SSIG_SEED environment variable, or zero when it is not set.
+*/
+CORE_EXPORT void setGlobalSeed(const uint64_t seed);
+CORE_EXPORT uint64_t getGlobalSeed();
+
+/**
+@brief Key of the generators of one algorithm instance: mixes the global
+seed, the domain and the seed of the instance. Streams of that key are then
+picked per thread or work item with the PhiloxRng constructor.
+*/
+CORE_EXPORT uint64_t deriveSeed(const RngDomain domain,
+                                const uint64_t seed = 0);
+
+}  // namespace ssig
+
+#endif  // !_SSIG_CORE_RNG_HPP_
@@ -45,12 +45,106 @@
 // opencv
 #include <opencv2/core.hpp>
 // c++
+#include <cstddef>
+#include <iterator>
 #include <vector>
 // ssiglib
 #include "core_defs.hpp"
+#include "image_pyramid.hpp"
 
 namespace ssig {
 
+/**
+Lazy sequence of sliding windows. Windows are stored as one grid per scale,
+so the total count is known up front and any window can be computed from its
+index, which lets callers preallocate their output and split the scan across
+threads. Windows are ordered by scale, then row, then column, exactly as the
+Sampling::sampleImage overloads return them.
+*/
+class WindowRange {
+ public:
+  class Iterator {
+   public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef cv::Rect value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const cv::Rect* pointer;
+    typedef cv::Rect reference;
+
+    Iterator(const WindowRange* range, const size_t index)
+      : mRange(range), mIndex(index) {}
+
+    cv::Rect operator*() const { return (*mRange)[mIndex]; }
+    Iterator& operator++() {
+      ++mIndex;
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator old = *this;
+      ++mIndex;
+      return old;
+    }
+    Iterator& operator+=(const std::ptrdiff_t n) {
+      mIndex += n;
+      return *this;
+    }
+    Iterator operator+(const std::ptrdiff_t n) const {
+      return Iterator(mRange, mIndex + n);
+    }
+    std::ptrdiff_t operator-(const Iterator& rhs) const {
+      return static_cast<std::ptrdiff_t>(mIndex) -
+        static_cast<std::ptrdiff_t>(rhs.mIndex);
+    }
+    bool operator==(const Iterator& rhs) const { return mIndex == rhs.mIndex; }
+    bool operator!=(const Iterator& rhs) const { return mIndex != rhs.mIndex; }
+
+   private:
+    const WindowRange* mRange;
+    size_t mIndex;
+  };
+
+  CORE_EXPORT WindowRange(void) = default;
+
+  /**
+  Appends the windows of one scale: nCols x nRows windows of size winSize
+  whose top left corners lie on a grid with the given steps.
+  */
+  CORE_EXPORT void addGrid(const cv::Size& winSize, const int stepX,
+                           const int stepY, const int nCols, const int nRows);
+
+  CORE_EXPORT size_t size() const;
+  CORE_EXPORT bool empty() const;
+
+  /**
+  @brief The window at position index, in O(log(number of scales))
+  */
+  CORE_EXPORT cv::Rect operator[](const size_t index) const;
+
+  Iterator begin() const { return Iterator(this, 0); }
+  Iterator end() const { return Iterator(this, size()); }
+
+  /**
+  @brief Writes the windows [first, last) to out, reusing its storage. Meant
+  for processing the range in fixed size chunks.
+  */
+  CORE_EXPORT void chunk(const size_t first, const size_t last,
+                         std::vector<cv::Rect>& out) const;
+
+  CORE_EXPORT std::vector<cv::Rect> toVector() const;
+
+ private:
+  struct Grid {
+    cv::Size winSize;
+    int stepX, stepY;
+    int nCols, nRows;
+    // index of the first window of this grid
+    size_t offset;
+  };
+
+  std::vector<Grid> mGrids;
+  size_t mSize = 0;
+};
+
 class Sampling {
  public:
   Sampling(void);
@@ -126,6 +220,35 @@ class Sampling {
     const int winHeight, const float minScale, const float maxScale,
     const float deltaScale, const float strideX, const float strideY);
 
+  /**
+  Lazy counterparts of the sampleImage overloads above. They take the same
+  arguments, throw the same std::invalid_argument and produce the same
+  windows in the same order, but never materialize them. An empty range is
+  returned where sampleImage would throw std::runtime_error.
+  */
+  CORE_EXPORT static WindowRange windowRange(
+    const int width, const int height, const int winWidth,
+    const int winHeight, const float strideX, const float strideY);
+
+  CORE_EXPORT static WindowRange windowRange(
+    const int width, const int height, const int winWidth,
+    const int winHeight, const float minScale, const float maxScale,
+    const int nScales, const float strideX, const float strideY);
+
+  CORE_EXPORT static WindowRange windowRange(
+    const int width, const int height, const int winWidth,
+    const int winHeight, const float minScale, const float maxScale,
+    const float deltaScale, const float strideX, const float strideY);
+
+  /**
+  Slides a fixed size window over one level of a pyramid, with the scan of
+  the single scale overload. Windows are in the coordinates of that level,
+  ImagePyramid::toBase maps them back to the image.
+  */
+  CORE_EXPORT static WindowRange windowRange(
+    const ImagePyramid& pyramid, const int level, const int winWidth,
+    const int winHeight, const float strideX, const float strideY);
+
   // TODO(Ricardo): unimplemented
   /* std::vector<cv::Rect> sampleImage(const int width,
                                                                     const int
@@ -0,0 +1,119 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#ifndef _SSIG_CORE_SIMD_HPP_
+#define _SSIG_CORE_SIMD_HPP_
+// ssiglib
+#include "core_defs.hpp"
+
+namespace ssig {
+
+/**
+Float kernels for the innermost loops of the library, with SSE4.2, AVX2 and
+AVX-512 variants next to a scalar reference.
+
+The variant is picked once, from cpuid, the first time a kernel runs, so a
+generically compiled library still uses the widest instructions the machine
+has. The SSIG_SIMD environment variable (scalar, sse42, avx2 or avx512)
+lowers the choice, and setIsa() changes it at runtime, which the tests use
+to compare every variant against the scalar one.
+
+The vector exp and log are polynomial approximations with a relative error
+below 1e-6; exp saturates outside [-87.3, 88.3] and log expects positive
+normal inputs.
+*/
+namespace simd {
+
+enum Isa {
+  ISA_SCALAR,
+  ISA_SSE42,
+  ISA_AVX2,
+  ISA_AVX512
+};
+
+/**
+@brief Widest variant supported by both this build and the running cpu
+*/
+CORE_EXPORT Isa detectIsa();
+CORE_EXPORT Isa getIsa();
+/**
+@brief Selects the kernels of isa, or of detectIsa() if it is wider
+@return the variant actually selected
+*/
+CORE_EXPORT Isa setIsa(const Isa isa);
+CORE_EXPORT const char* getIsaName(const Isa isa);
+
+CORE_EXPORT float dot(const float* x, const float* y, const int len);
+/**
+@brief y += alpha * x
+*/
+CORE_EXPORT void axpy(const float alpha, const float* x, float* y,
+                      const int len);
+
+CORE_EXPORT float l1Distance(const float* x, const float* y, const int len);
+CORE_EXPORT float squaredL2Distance(const float* x, const float* y,
+                                    const int len);
+/**
+@brief Sum of (x - y)^2 / (x + y), bins where x + y == 0 contribute nothing
+*/
+CORE_EXPORT float chi2Distance(const float* x, const float* y,
+                               const int len);
+
+/**
+@brief hist[bins[i]] += weights[i], or += 1 when weights is null
+*/
+CORE_EXPORT void accumulateHistogram(const int* bins, const float* weights,
+                                     const int len, float* hist);
+
+CORE_EXPORT void exp(const float* x, float* y, const int len);
+CORE_EXPORT void log(const float* x, float* y, const int len);
+CORE_EXPORT void sigmoid(const float* x, float* y, const int len);
+CORE_EXPORT void tanh(const float* x, float* y, const int len);
+
+/**
+@brief Index of the first maximum, -1 when len is zero
+*/
+CORE_EXPORT int argmax(const float* x, const int len);
+
+}  // namespace simd
+}  // namespace ssig
+
+#endif  // !_SSIG_CORE_SIMD_HPP_
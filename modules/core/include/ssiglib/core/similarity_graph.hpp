@@ -0,0 +1,138 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#ifndef _SSIG_CORE_SIMILARITY_GRAPH_HPP_
+#define _SSIG_CORE_SIMILARITY_GRAPH_HPP_
+
+// c++
+#include <vector>
+// opencv
+#include <opencv2/core.hpp>
+// ssiglib
+#include "ssiglib/core/core_defs.hpp"
+#include "ssiglib/core/math.hpp"
+
+namespace ssig {
+
+/**
+@brief Sparse similarity graph stored in compressed sparse row (CSR) form.
+
+Each node keeps only its k most similar neighbours, so the memory grows with
+N*k instead of N*N. Node r owns the entries in the range
+[getRowPointers()[r], getRowPointers()[r + 1]) of the column and score arrays.
+*/
+class SimilarityGraph {
+ public:
+  enum NeighbourOrder {
+    HIGHEST_SCORE,
+    LOWEST_SCORE
+  };
+
+  CORE_EXPORT SimilarityGraph(void) = default;
+  CORE_EXPORT virtual ~SimilarityGraph(void) = default;
+
+  /**
+  @brief Exact top-k graph computed by scoring blocks of rows through
+  SimilarityFunctor::manyToMany.
+
+  @param order HIGHEST_SCORE keeps the largest scores (similarities),
+  LOWEST_SCORE keeps the smallest ones (distances such as EuclideanDistance).
+  */
+  CORE_EXPORT static void buildExact(
+    const cv::Mat_<float>& input,
+    const SimilarityFunctor& similarityFunction,
+    const int k,
+    SimilarityGraph& graph,
+    const NeighbourOrder order = HIGHEST_SCORE);
+
+  /**
+  @brief Approximate top-k graph using randomized kd-trees from FLANN.
+
+  Only the built-in functors are supported: cosine and correlation are
+  searched as L2 over normalized rows, EuclideanDistance as L2 (nearest
+  first) and Chi2Similarity with the chi-square distance. The stored scores
+  are the ones the functor would return.
+
+  @param checks the number of leaves FLANN visits per query, higher is
+  more accurate and slower.
+  @param trees the number of randomized kd-trees.
+  */
+  CORE_EXPORT static void buildApproximate(
+    const cv::Mat_<float>& input,
+    const SimilarityFunctor& similarityFunction,
+    const int k,
+    SimilarityGraph& graph,
+    const int checks = 128,
+    const int trees = 4);
+
+  /**
+  @brief Adds the reverse of every edge, turning the kNN graph into an
+  undirected one. Neighbours end up sorted by node index.
+  */
+  CORE_EXPORT void symmetrize();
+
+  /**
+  @brief Expands the graph to the dense layout of Math::buildSimilarity,
+  missing edges are zero.
+  */
+  CORE_EXPORT cv::Mat_<float> toDense() const;
+
+  CORE_EXPORT int getNodes() const;
+  CORE_EXPORT int getEdges() const;
+  CORE_EXPORT int getDegree(const int node) const;
+
+  CORE_EXPORT const int* neighbours(const int node) const;
+  CORE_EXPORT const float* scores(const int node) const;
+
+  CORE_EXPORT const std::vector<int>& getRowPointers() const;
+  CORE_EXPORT const std::vector<int>& getColumns() const;
+  CORE_EXPORT const std::vector<float>& getScores() const;
+
+ private:
+  int mNodes = 0;
+  std::vector<int> mRowPointers;
+  std::vector<int> mColumns;
+  std::vector<float> mScores;
+};
+
+}  // namespace ssig
+
+#endif  // !_SSIG_CORE_SIMILARITY_GRAPH_HPP_
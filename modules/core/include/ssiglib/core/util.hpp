@@ -76,6 +76,14 @@ class Util {
   CORE_EXPORT static void reorder(const cv::Mat& collection,
     cv::Mat_<int>& ordering, cv::Mat& out);
 
+  /**
+  @brief In place version of reorder: row i of collection becomes the former
+  row ordering[i]. The permutation is applied cycle by cycle using a single
+  row of scratch memory; ordering is left unchanged on return.
+  */
+  CORE_EXPORT static void reorder(cv::Mat& collection,
+    cv::Mat_<int>& ordering);
+
   template <class T>
   static flann::Matrix<T> convert(cv::Mat& m) {
       flann::Matrix<T> fMat(
@@ -46,16 +46,22 @@
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
+#include <memory>
+#include <stdexcept>
 
 namespace ssig {
 
 Algorithm::Algorithm() {}
 
-Algorithm::~Algorithm() {}
+Algorithm::~Algorithm() {
+  MemoryTally::instance().untrack(this);
+}
 
-Algorithm::Algorithm(const Algorithm& rhs) {}
+Algorithm::Algorithm(const Algorithm& rhs)
+  : mBinaryStorage(rhs.mBinaryStorage) {}
 
 Algorithm& Algorithm::operator=(const Algorithm& rhs) {
+  mBinaryStorage = rhs.mBinaryStorage;
   return *this;
 }
 
@@ -88,6 +94,35 @@ void Algorithm::save(const std::string& filename,
   fileStorage.release();
 }
 
+void Algorithm::loadBinary(const std::string& filename) {
+  auto storage = std::make_shared<const BinaryStorage>(filename);
+  readBinary(storage->root());
+  mBinaryStorage = storage;
+}
+
+void Algorithm::saveBinary(const std::string& filename) const {
+  BinaryWriter writer;
+  writeBinary(writer);
+  writer.save(filename);
+}
+
+MemoryFootprint Algorithm::memoryFootprint() const {
+  MemoryFootprint ans;
+  if (mBinaryStorage) {
+    ans.addShared("binaryStorage", mBinaryStorage->getSize(),
+                  mBinaryStorage->getMapping());
+  }
+  return ans;
+}
+
+void Algorithm::readBinary(const BinaryNode& node) {
+  throw std::runtime_error("This algorithm has no binary format");
+}
+
+void Algorithm::writeBinary(BinaryWriter& writer) const {
+  throw std::runtime_error("This algorithm has no binary format");
+}
+
 void Algorithm::verboseLog(FILE* file, const char* format, ...) const {
   if (mVerbose) {
     va_list args;
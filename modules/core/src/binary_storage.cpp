@@ -0,0 +1,320 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include "ssiglib/core/binary_storage.hpp"
+// c++
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace ssig {
+
+namespace {
+const char kMagic[8] = {'S', 'S', 'I', 'G', 'B', 'I', 'N', '\0'};
+const uint32_t kByteOrder = 0x01020304;
+// blobs start at multiples of a cache line, enough for any element type
+const uint64_t kAlignment = 64;
+
+struct Header {
+  char magic[8];
+  uint32_t byteOrder;
+  uint32_t version;
+  uint64_t indexOffset;
+  uint64_t indexSize;
+  uint32_t entries;
+  char reserved[28];
+};
+static_assert(sizeof(Header) == kAlignment, "unexpected header padding");
+
+template <class T>
+void put(std::string& buffer, const T& value) {
+  buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <class T>
+T take(const unsigned char*& cursor, const unsigned char* end) {
+  if (static_cast<size_t>(end - cursor) < sizeof(T))
+    throw std::runtime_error("Truncated binary storage index");
+  T value;
+  std::memcpy(&value, cursor, sizeof(T));
+  cursor += sizeof(T);
+  return value;
+}
+}  // namespace
+
+const uint32_t BinaryStorage::kVersion;
+
+void BinaryWriter::beginScope(const std::string& name) {
+  mScopes.push_back(name);
+}
+
+void BinaryWriter::endScope() {
+  if (mScopes.empty())
+    throw std::logic_error("endScope() without a matching beginScope()");
+  mScopes.pop_back();
+}
+
+std::string BinaryWriter::path(const std::string& key) const {
+  std::string ans;
+  for (const auto& scope : mScopes)
+    ans += scope + "/";
+  return ans + key;
+}
+
+void BinaryWriter::write(const std::string& key, const cv::Mat& mat) {
+  if (mat.dims > 2)
+    throw std::invalid_argument("Only 2D matrices can be stored: " + key);
+  mEntries.emplace_back(path(key), mat.isContinuous() ? mat : mat.clone());
+}
+
+void BinaryWriter::write(const std::string& key, const int value) {
+  write(key, cv::Mat(1, 1, CV_32S, cv::Scalar(value)));
+}
+
+void BinaryWriter::write(const std::string& key, const double value) {
+  write(key, cv::Mat(1, 1, CV_64F, cv::Scalar(value)));
+}
+
+void BinaryWriter::write(const std::string& key, const std::string& value) {
+  cv::Mat bytes;
+  if (!value.empty()) {
+    bytes.create(1, static_cast<int>(value.size()), CV_8U);
+    std::memcpy(bytes.data, value.data(), value.size());
+  }
+  write(key, bytes);
+}
+
+void BinaryWriter::write(const std::string& key,
+                         const std::unordered_map<int, int>& value) {
+  std::vector<std::pair<int, int>> pairs(value.begin(), value.end());
+  std::sort(pairs.begin(), pairs.end());
+  cv::Mat_<int> table(static_cast<int>(pairs.size()), 2);
+  for (int r = 0; r < table.rows; ++r) {
+    table(r, 0) = pairs[r].first;
+    table(r, 1) = pairs[r].second;
+  }
+  write(key, table);
+}
+
+void BinaryWriter::save(const std::string& filename) const {
+  std::unordered_set<std::string> names;
+  for (const auto& entry : mEntries) {
+    if (!names.insert(entry.first).second)
+      throw std::invalid_argument("Duplicated entry: " + entry.first);
+  }
+
+  std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+  if (!file)
+    throw std::runtime_error("Could not open " + filename);
+
+  Header header;
+  std::memset(&header, 0, sizeof(header));
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  std::string index;
+  uint64_t position = sizeof(header);
+  const char padding[kAlignment] = {0};
+  for (const auto& entry : mEntries) {
+    const cv::Mat& mat = entry.second;
+    const uint64_t aligned =
+      (position + kAlignment - 1) / kAlignment * kAlignment;
+    file.write(padding, static_cast<std::streamsize>(aligned - position));
+    const uint64_t size = static_cast<uint64_t>(mat.total() * mat.elemSize());
+    if (size)
+      file.write(reinterpret_cast<const char*>(mat.data),
+                 static_cast<std::streamsize>(size));
+    position = aligned + size;
+
+    put(index, static_cast<uint32_t>(entry.first.size()));
+    index += entry.first;
+    put(index, static_cast<int32_t>(mat.type()));
+    put(index, static_cast<int32_t>(mat.rows));
+    put(index, static_cast<int32_t>(mat.cols));
+    put(index, aligned);
+    put(index, size);
+  }
+  file.write(index.data(), static_cast<std::streamsize>(index.size()));
+
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.byteOrder = kByteOrder;
+  header.version = BinaryStorage::kVersion;
+  header.indexOffset = position;
+  header.indexSize = index.size();
+  header.entries = static_cast<uint32_t>(mEntries.size());
+  file.seekp(0);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  if (!file)
+    throw std::runtime_error("Could not write " + filename);
+}
+
+BinaryNode::BinaryNode(const BinaryStorage* storage,
+                       const std::string& prefix)
+  : mStorage(storage), mPrefix(prefix) {}
+
+BinaryNode BinaryNode::operator[](const std::string& name) const {
+  return BinaryNode(mStorage, mPrefix + name + "/");
+}
+
+bool BinaryNode::has(const std::string& key) const {
+  return mStorage && mStorage->mIndex.count(mPrefix + key) > 0;
+}
+
+cv::Mat BinaryNode::getMat(const std::string& key) const {
+  if (!mStorage)
+    throw std::logic_error("Reading from an empty BinaryNode");
+  return mStorage->get(mPrefix + key);
+}
+
+int BinaryNode::getInt(const std::string& key) const {
+  const cv::Mat value = getMat(key);
+  if (value.type() != CV_32S || value.total() != 1)
+    throw std::runtime_error("Entry is not an int: " + mPrefix + key);
+  return value.at<int>(0);
+}
+
+double BinaryNode::getDouble(const std::string& key) const {
+  const cv::Mat value = getMat(key);
+  if (value.type() != CV_64F || value.total() != 1)
+    throw std::runtime_error("Entry is not a double: " + mPrefix + key);
+  return value.at<double>(0);
+}
+
+std::string BinaryNode::getString(const std::string& key) const {
+  const cv::Mat value = getMat(key);
+  if (value.empty())
+    return std::string();
+  if (value.type() != CV_8U)
+    throw std::runtime_error("Entry is not a string: " + mPrefix + key);
+  return std::string(reinterpret_cast<const char*>(value.data),
+                     value.total());
+}
+
+std::unordered_map<int, int> BinaryNode::getIntMap(
+  const std::string& key) const {
+  const cv::Mat value = getMat(key);
+  std::unordered_map<int, int> ans;
+  if (value.empty())
+    return ans;
+  if (value.type() != CV_32S || value.cols != 2)
+    throw std::runtime_error("Entry is not an int map: " + mPrefix + key);
+  for (int r = 0; r < value.rows; ++r)
+    ans[value.at<int>(r, 0)] = value.at<int>(r, 1);
+  return ans;
+}
+
+BinaryStorage::BinaryStorage(const std::string& filename)
+  : mFile(std::make_shared<MappedFile>(filename)) {
+  const unsigned char* data = mFile->getData();
+  const size_t fileSize = mFile->getSize();
+  if (fileSize < sizeof(Header))
+    throw std::runtime_error("Not a binary storage: " + filename);
+
+  Header header;
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.byteOrder != kByteOrder) {
+    throw std::runtime_error("Not a binary storage: " + filename);
+  }
+  if (header.version > kVersion) {
+    throw std::runtime_error("Unsupported binary storage version in " +
+                             filename);
+  }
+  mVersion = header.version;
+
+  if (header.indexOffset > fileSize ||
+      header.indexSize > fileSize - header.indexOffset)
+    throw std::runtime_error("Truncated binary storage index");
+  const unsigned char* cursor = data + header.indexOffset;
+  const unsigned char* end = cursor + header.indexSize;
+  for (uint32_t e = 0; e < header.entries; ++e) {
+    const uint32_t length = take<uint32_t>(cursor, end);
+    if (static_cast<size_t>(end - cursor) < length)
+      throw std::runtime_error("Truncated binary storage index");
+    std::string name(reinterpret_cast<const char*>(cursor), length);
+    cursor += length;
+    Entry entry;
+    entry.type = take<int32_t>(cursor, end);
+    entry.rows = take<int32_t>(cursor, end);
+    entry.cols = take<int32_t>(cursor, end);
+    entry.offset = take<uint64_t>(cursor, end);
+    entry.size = take<uint64_t>(cursor, end);
+    if (entry.offset > fileSize || entry.size > fileSize - entry.offset)
+      throw std::runtime_error("Entry outside of the file: " + name);
+    mIndex.emplace(std::move(name), entry);
+  }
+}
+
+BinaryStorage::~BinaryStorage() {}
+
+BinaryNode BinaryStorage::root() const {
+  return BinaryNode(this, "");
+}
+
+uint32_t BinaryStorage::getVersion() const {
+  return mVersion;
+}
+
+size_t BinaryStorage::getSize() const {
+  return mFile->getSize();
+}
+
+const MappedFile* BinaryStorage::getMapping() const {
+  return mFile.get();
+}
+
+cv::Mat BinaryStorage::get(const std::string& key) const {
+  const auto it = mIndex.find(key);
+  if (it == mIndex.end())
+    throw std::runtime_error("Missing entry: " + key);
+  const Entry& entry = it->second;
+  if (entry.rows == 0 || entry.cols == 0)
+    return cv::Mat();
+  const size_t expected = static_cast<size_t>(entry.rows) * entry.cols *
+    CV_ELEM_SIZE(entry.type);
+  if (expected != entry.size)
+    throw std::runtime_error("Corrupted entry: " + key);
+  return MappedFile::view(mFile, entry.offset, entry.rows, entry.cols,
+                          entry.type);
+}
+
+}  // namespace ssig
@@ -0,0 +1,192 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include "ssiglib/core/csr_mat.hpp"
+// c++
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+// ssiglib
+#include "ssiglib/core/executor.hpp"
+
+namespace ssig {
+
+CsrMat::CsrMat(const int cols) : mCols(cols) {
+  if (cols < 0)
+    throw std::invalid_argument("Negative number of columns");
+}
+
+CsrMat::CsrMat(const cv::Mat& dense, const float threshold)
+  : mCols(dense.cols) {
+  if (dense.channels() != 1)
+    throw std::invalid_argument("CsrMat needs a single channel matrix");
+  mRowPointers.reserve(dense.rows + 1);
+  for (int r = 0; r < dense.rows; ++r)
+    appendRow(dense.row(r), threshold);
+}
+
+CsrMat::CsrMat(const int cols,
+               std::vector<int> rowPointers,
+               std::vector<int> columns,
+               std::vector<float> values)
+  : mCols(cols), mRowPointers(std::move(rowPointers)),
+    mColumns(std::move(columns)), mValues(std::move(values)) {
+  if (mRowPointers.empty() || mRowPointers.front() != 0 ||
+      mRowPointers.back() != static_cast<int>(mColumns.size()) ||
+      mColumns.size() != mValues.size()) {
+    throw std::invalid_argument("Inconsistent CSR arrays");
+  }
+  for (size_t r = 0; r + 1 < mRowPointers.size(); ++r) {
+    if (mRowPointers[r] > mRowPointers[r + 1])
+      throw std::invalid_argument("Decreasing CSR row pointers");
+    for (int e = mRowPointers[r]; e < mRowPointers[r + 1]; ++e) {
+      if (mColumns[e] < 0 || mColumns[e] >= mCols ||
+          (e > mRowPointers[r] && mColumns[e] <= mColumns[e - 1]))
+        throw std::invalid_argument("Unsorted or out of range CSR column");
+    }
+  }
+}
+
+void CsrMat::appendRow(const cv::Mat& denseRow, const float threshold) {
+  if (denseRow.rows != 1 || denseRow.cols != mCols)
+    throw std::invalid_argument("The row does not match the matrix width");
+  cv::Mat_<float> row;
+  denseRow.convertTo(row, CV_32F);
+  const float* values = row[0];
+  for (int c = 0; c < mCols; ++c) {
+    if (std::abs(values[c]) > threshold) {
+      mColumns.push_back(c);
+      mValues.push_back(values[c]);
+    }
+  }
+  mRowPointers.push_back(static_cast<int>(mColumns.size()));
+}
+
+void CsrMat::appendRow(const int* columns, const float* values,
+                       const int len) {
+  for (int e = 0; e < len; ++e) {
+    if (columns[e] < 0 || columns[e] >= mCols ||
+        (e > 0 && columns[e] <= columns[e - 1]))
+      throw std::invalid_argument("Unsorted or out of range CSR column");
+  }
+  mColumns.insert(mColumns.end(), columns, columns + len);
+  mValues.insert(mValues.end(), values, values + len);
+  mRowPointers.push_back(static_cast<int>(mColumns.size()));
+}
+
+int CsrMat::getNumRows() const {
+  return static_cast<int>(mRowPointers.size()) - 1;
+}
+
+int CsrMat::getNumCols() const {
+  return mCols;
+}
+
+int CsrMat::getNonZeros() const {
+  return static_cast<int>(mColumns.size());
+}
+
+int CsrMat::getRowLength(const int row) const {
+  return mRowPointers[row + 1] - mRowPointers[row];
+}
+
+bool CsrMat::empty() const {
+  return getNumRows() == 0 || mCols == 0;
+}
+
+size_t CsrMat::getMemorySize() const {
+  return mRowPointers.size() * sizeof(int) +
+    mColumns.size() * (sizeof(int) + sizeof(float));
+}
+
+const int* CsrMat::columns(const int row) const {
+  return mColumns.data() + mRowPointers[row];
+}
+
+const float* CsrMat::values(const int row) const {
+  return mValues.data() + mRowPointers[row];
+}
+
+const std::vector<int>& CsrMat::getRowPointers() const {
+  return mRowPointers;
+}
+
+const std::vector<int>& CsrMat::getColumns() const {
+  return mColumns;
+}
+
+const std::vector<float>& CsrMat::getValues() const {
+  return mValues;
+}
+
+cv::Mat_<float> CsrMat::toDense() const {
+  cv::Mat_<float> dense = cv::Mat_<float>::zeros(getNumRows(), mCols);
+  for (int r = 0; r < getNumRows(); ++r) {
+    for (int e = mRowPointers[r]; e < mRowPointers[r + 1]; ++e)
+      dense[r][mColumns[e]] = mValues[e];
+  }
+  return dense;
+}
+
+void CsrMat::multiply(const cv::Mat_<float>& dense,
+                      cv::Mat_<float>& out) const {
+  if (dense.rows != mCols)
+    throw std::invalid_argument("The dense operand has the wrong height");
+  const int k = dense.cols;
+  out.create(getNumRows(), k);
+  Executor::global().parallelFor(0, getNumRows(),
+    [&](const int first, const int last) {
+    for (int r = first; r < last; ++r) {
+      float* dst = out[r];
+      for (int j = 0; j < k; ++j)
+        dst[j] = 0;
+      // every stored element scales one row of the dense operand
+      for (int e = mRowPointers[r]; e < mRowPointers[r + 1]; ++e) {
+        const float value = mValues[e];
+        const float* src = dense[mColumns[e]];
+        for (int j = 0; j < k; ++j)
+          dst[j] += value * src[j];
+      }
+    }
+  });
+}
+
+}  // namespace ssig
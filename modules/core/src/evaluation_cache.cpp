@@ -0,0 +1,172 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include "ssiglib/core/evaluation_cache.hpp"
+// c++
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+// quantized coordinates stay below this magnitude, so the keys beyond it
+// are free to encode the coordinates that cannot be quantized
+const int64_t kQuantizedLimit = int64_t(1) << 62;
+// every NaN shares one key, whatever its payload
+const int64_t kNaNKey = std::numeric_limits<int64_t>::min();
+
+int32_t floatBits(const float v) {
+  int32_t bits;
+  std::memcpy(&bits, &v, sizeof(bits));
+  return bits;
+}
+}  // namespace
+
+namespace ssig {
+
+EvaluationCache::EvaluationCache(const size_t capacity, const float quantum)
+  : mCapacity(capacity), mQuantum(quantum) {}
+
+EvaluationCache::Key EvaluationCache::makeKey(
+  const cv::Mat& candidate) const {
+  cv::Mat_<float> values;
+  if (candidate.depth() == CV_32F && candidate.isContinuous())
+    values = candidate;
+  else
+    candidate.convertTo(values, CV_32F);
+
+  const float* data = values.ptr<float>(0);
+  const size_t len = values.total() * values.channels();
+  Key key(len);
+  for (size_t i = 0; i < len; ++i) {
+    if (std::isnan(data[i])) {
+      key[i] = kNaNKey;
+    } else if (mQuantum > 0) {
+      const float q = data[i] / mQuantum;
+      if (std::fabs(q) < static_cast<float>(kQuantizedLimit)) {
+        key[i] = static_cast<int64_t>(std::llround(q));
+      } else {
+        // infinities, and values too large to round, keep their exact bits
+        const int64_t bits = floatBits(std::fabs(data[i]));
+        key[i] = (q > 0) ? kQuantizedLimit + bits : -kQuantizedLimit - bits;
+      }
+    } else {
+      // -0 and +0 must share the key
+      key[i] = floatBits((data[i] == 0.f) ? 0.f : data[i]);
+    }
+  }
+  return key;
+}
+
+bool EvaluationCache::lookup(const Key& key, float& utility) {
+  std::lock_guard<std::mutex> guard(mLock);
+  auto it = mIndex.find(key);
+  if (it == mIndex.end()) {
+    ++mMisses;
+    return false;
+  }
+  ++mHits;
+  mEntries.splice(mEntries.begin(), mEntries, it->second);
+  utility = it->second->second;
+  return true;
+}
+
+void EvaluationCache::insert(const Key& key, const float utility) {
+  if (mCapacity == 0)
+    return;
+  std::lock_guard<std::mutex> guard(mLock);
+  auto it = mIndex.find(key);
+  if (it != mIndex.end()) {
+    it->second->second = utility;
+    mEntries.splice(mEntries.begin(), mEntries, it->second);
+    return;
+  }
+  if (mEntries.size() >= mCapacity) {
+    mIndex.erase(mEntries.back().first);
+    mEntries.pop_back();
+  }
+  mEntries.emplace_front(key, utility);
+  mIndex[key] = mEntries.begin();
+}
+
+void EvaluationCache::clear() {
+  std::lock_guard<std::mutex> guard(mLock);
+  mEntries.clear();
+  mIndex.clear();
+  mHits = 0;
+  mMisses = 0;
+}
+
+size_t EvaluationCache::getHits() const {
+  std::lock_guard<std::mutex> guard(mLock);
+  return mHits;
+}
+
+size_t EvaluationCache::getMisses() const {
+  std::lock_guard<std::mutex> guard(mLock);
+  return mMisses;
+}
+
+size_t EvaluationCache::getSize() const {
+  std::lock_guard<std::mutex> guard(mLock);
+  return mEntries.size();
+}
+
+size_t EvaluationCache::getCapacity() const {
+  return mCapacity;
+}
+
+size_t EvaluationCache::getMemorySize() const {
+  std::lock_guard<std::mutex> guard(mLock);
+  size_t ans = mIndex.bucket_count() * sizeof(void*);
+  for (const auto& entry : mEntries) {
+    // the key is stored twice: in the list node and in the index node
+    const size_t key = sizeof(Key) + entry.first.capacity() * sizeof(int64_t);
+    ans += key + sizeof(float) + 2 * sizeof(void*);
+    ans += key + sizeof(Entries::iterator) + sizeof(void*) + sizeof(size_t);
+  }
+  return ans;
+}
+
+float EvaluationCache::getQuantum() const {
+  return mQuantum;
+}
+
+}  // namespace ssig
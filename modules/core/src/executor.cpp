@@ -0,0 +1,306 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include "ssiglib/core/executor.hpp"
+// c++
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <utility>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace ssig {
+
+struct Executor::Pool {
+  typedef std::function<void()> Task;
+
+  struct Queue {
+    std::mutex lock;
+    std::deque<Task> tasks;
+  };
+
+  explicit Pool(const int nWorkers) {
+    // the last queue receives tasks pushed by threads outside the pool
+    for (int i = 0; i <= nWorkers; ++i)
+      queues.emplace_back(new Queue);
+    for (int i = 0; i < nWorkers; ++i)
+      threads.emplace_back([this, i]() { workerLoop(i); });
+  }
+
+  ~Pool() {
+    {
+      std::lock_guard<std::mutex> guard(sleepLock);
+      stop = true;
+    }
+    wake.notify_all();
+    for (auto& thread : threads)
+      thread.join();
+  }
+
+  int self() const {
+    return (tPool == this) ? tIndex : static_cast<int>(threads.size());
+  }
+
+  void push(Task task) {
+    Queue& queue = *queues[self()];
+    {
+      std::lock_guard<std::mutex> guard(queue.lock);
+      queue.tasks.push_back(std::move(task));
+    }
+    ++queued;
+    // taking the lock orders the push with a worker about to sleep
+    { std::lock_guard<std::mutex> guard(sleepLock); }
+    wake.notify_one();
+  }
+
+  // runs one pending task, preferring the newest of the own queue and the
+  // oldest of the others
+  bool tryRun(const int index) {
+    Task task;
+    const int nQueues = static_cast<int>(queues.size());
+    {
+      Queue& own = *queues[index];
+      std::lock_guard<std::mutex> guard(own.lock);
+      if (!own.tasks.empty()) {
+        task = std::move(own.tasks.back());
+        own.tasks.pop_back();
+      }
+    }
+    for (int k = 1; !task && k < nQueues; ++k) {
+      Queue& victim = *queues[(index + k) % nQueues];
+      std::lock_guard<std::mutex> guard(victim.lock);
+      if (!victim.tasks.empty()) {
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+      }
+    }
+    if (!task)
+      return false;
+    --queued;
+    task();
+    return true;
+  }
+
+  void workerLoop(const int index) {
+    tPool = this;
+    tIndex = index;
+    while (true) {
+      if (tryRun(index))
+        continue;
+      std::unique_lock<std::mutex> guard(sleepLock);
+      wake.wait(guard, [this]() { return stop || queued > 0; });
+      if (stop && queued == 0)
+        return;
+    }
+  }
+
+  std::vector<std::unique_ptr<Queue>> queues;
+  std::vector<std::thread> threads;
+  std::atomic<int> queued{0};
+  std::mutex sleepLock;
+  std::condition_variable wake;
+  bool stop = false;
+
+  static thread_local Pool* tPool;
+  static thread_local int tIndex;
+};
+
+thread_local Executor::Pool* Executor::Pool::tPool = nullptr;
+thread_local int Executor::Pool::tIndex = 0;
+
+Executor::Executor(const int nThreads)
+  : mConcurrency(0), mBackend(POOL) {
+  int threads = nThreads;
+  if (threads <= 0)
+    threads = static_cast<int>(std::thread::hardware_concurrency());
+  mThreads = std::max(1, threads);
+  // the calling thread is a worker too
+  mPool.reset(new Pool(mThreads - 1));
+}
+
+Executor::~Executor(void) {}
+
+Executor& Executor::global() {
+  static Executor executor;
+  return executor;
+}
+
+Executor::Backend Executor::getBackend() const {
+  return static_cast<Backend>(mBackend.load());
+}
+
+void Executor::setBackend(const Backend backend) {
+  mBackend = backend;
+}
+
+int Executor::getThreads() const {
+  return mThreads;
+}
+
+int Executor::getConcurrency() const {
+  return effectiveConcurrency(0);
+}
+
+void Executor::setConcurrency(const int concurrency) {
+  mConcurrency = concurrency;
+}
+
+int Executor::effectiveConcurrency(const int concurrency) const {
+  int limit = mThreads;
+  const int global = mConcurrency;
+  if (global > 0)
+    limit = std::min(limit, global);
+  if (concurrency > 0)
+    limit = std::min(limit, concurrency);
+  return limit;
+}
+
+void Executor::parallelFor(const int begin, const int end,
+                           const std::function<void(int, int)>& body,
+                           const int grain,
+                           const int concurrency) {
+  const int len = end - begin;
+  if (len <= 0)
+    return;
+  const int nThreads = effectiveConcurrency(concurrency);
+  const int minChunk = std::max(grain, 1);
+  // a few chunks per thread balance uneven iterations
+  const int chunk = std::max(minChunk, len / (4 * nThreads));
+  const int nChunks = (len + chunk - 1) / chunk;
+  const Backend backend = getBackend();
+
+  if (nThreads <= 1 || nChunks <= 1 || backend == SERIAL) {
+    body(begin, end);
+    return;
+  }
+
+  std::exception_ptr error;
+  std::mutex errorLock;
+  auto runChunk = [&](const int c) {
+    try {
+      const int from = begin + c * chunk;
+      body(from, std::min(end, from + chunk));
+    } catch (...) {
+      std::lock_guard<std::mutex> guard(errorLock);
+      if (!error)
+        error = std::current_exception();
+    }
+  };
+
+  if (backend == OPENMP) {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(nThreads)
+#endif
+    for (int c = 0; c < nChunks; ++c)
+      runChunk(c);
+  } else {
+    // the helpers and the caller take chunks from a shared counter
+    std::atomic<int> next(0);
+    auto participate = [&]() {
+      for (int c = next++; c < nChunks; c = next++)
+        runChunk(c);
+    };
+    TaskGroup group(*this);
+    const int helpers = std::min(nThreads, nChunks) - 1;
+    for (int h = 0; h < helpers; ++h)
+      group.run(participate);
+    participate();
+    group.wait();
+  }
+
+  if (error)
+    std::rethrow_exception(error);
+}
+
+Executor::TaskGroup::TaskGroup(Executor& executor)
+  : mExecutor(executor), mPending(0) {}
+
+Executor::TaskGroup::~TaskGroup(void) {
+  // tasks reference the group, it cannot go away before them
+  join();
+}
+
+void Executor::TaskGroup::run(const std::function<void()>& task) {
+  ++mPending;
+  mExecutor.mPool->push([this, task]() {
+    try {
+      task();
+    } catch (...) {
+      std::lock_guard<std::mutex> guard(mLock);
+      if (!mError)
+        mError = std::current_exception();
+    }
+    // decremented under the lock, so the waiter cannot destroy the group
+    // between the decrement and the notification
+    std::lock_guard<std::mutex> guard(mLock);
+    if (--mPending == 0)
+      mDone.notify_all();
+  });
+}
+
+void Executor::TaskGroup::join() {
+  Pool& pool = *mExecutor.mPool;
+  const int self = pool.self();
+  while (mPending > 0) {
+    if (pool.tryRun(self))
+      continue;
+    // nothing left to help with: the remaining tasks of the group are
+    // running on other threads, sleep until the last one finishes
+    std::unique_lock<std::mutex> guard(mLock);
+    mDone.wait(guard, [this]() { return mPending == 0; });
+  }
+}
+
+void Executor::TaskGroup::wait() {
+  join();
+  std::exception_ptr error;
+  {
+    std::lock_guard<std::mutex> guard(mLock);
+    std::swap(error, mError);
+  }
+  if (error)
+    std::rethrow_exception(error);
+}
+
+}  // namespace ssig
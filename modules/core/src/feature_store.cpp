@@ -0,0 +1,466 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include "ssiglib/core/feature_store.hpp"
+// c++
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ssig {
+
+namespace {
+const char kMagic[8] = {'S', 'S', 'I', 'G', 'F', 'E', 'A', 'T'};
+const uint32_t kByteOrder = 0x01020304;
+const uint64_t kAlignment = 64;
+
+struct Header {
+  char magic[8];
+  uint32_t byteOrder;
+  uint32_t version;
+  uint64_t rows;
+  uint32_t cols;
+  uint32_t blockSize;
+  uint32_t labeled;
+  uint32_t reserved0;
+  uint64_t footerOffset;
+  uint64_t footerSize;
+  char reserved[8];
+};
+static_assert(sizeof(Header) == kAlignment, "unexpected header padding");
+
+uint64_t align(const uint64_t position) {
+  return (position + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+template <class T>
+void put(std::string& buffer, const T& value) {
+  buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <class T>
+T take(const unsigned char*& cursor, const unsigned char* end) {
+  if (static_cast<size_t>(end - cursor) < sizeof(T))
+    throw std::runtime_error("Truncated feature store footer");
+  T value;
+  std::memcpy(&value, cursor, sizeof(T));
+  cursor += sizeof(T);
+  return value;
+}
+
+std::string takeString(const unsigned char*& cursor,
+                       const unsigned char* end) {
+  const uint32_t length = take<uint32_t>(cursor, end);
+  if (static_cast<size_t>(end - cursor) < length)
+    throw std::runtime_error("Truncated feature store footer");
+  std::string ans(reinterpret_cast<const char*>(cursor), length);
+  cursor += length;
+  return ans;
+}
+}  // namespace
+
+const uint32_t FeatureStore::kVersion;
+
+FeatureStoreWriter::FeatureStoreWriter(const std::string& filename,
+                                       const int blockSize)
+  : mFilename(filename),
+    mFile(filename, std::ios::binary | std::ios::trunc),
+    mBlockSize(blockSize) {
+  if (blockSize <= 0)
+    throw std::invalid_argument("The block size must be positive");
+  if (!mFile)
+    throw std::runtime_error("Could not open " + filename);
+  const Header header = {};
+  mFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+FeatureStoreWriter::~FeatureStoreWriter() {
+  if (!mClosed) {
+    try {
+      close();
+    } catch (...) {
+    }
+  }
+  if (mLabels.is_open()) {
+    mLabels.close();
+    std::remove(mLabelsFilename.c_str());
+  }
+}
+
+void FeatureStoreWriter::append(const cv::Mat& rows) {
+  if (mLabeled == 1)
+    throw std::logic_error("Every row of this store needs a label");
+  mLabeled = 0;
+  appendRows(rows, nullptr);
+}
+
+void FeatureStoreWriter::append(const cv::Mat& rows, const cv::Mat& labels) {
+  if (mLabeled == 0)
+    throw std::logic_error("This store was started without labels");
+  if (static_cast<int>(labels.total()) != rows.rows)
+    throw std::invalid_argument("Expected one label per row");
+  cv::Mat_<int> intLabels;
+  labels.reshape(1, rows.rows).convertTo(intLabels, CV_32S);
+  if (mLabeled == -1) {
+    mLabelsFilename = mFilename + ".labels";
+    mLabels.open(mLabelsFilename, std::ios::binary | std::ios::in |
+                 std::ios::out | std::ios::trunc);
+    if (!mLabels)
+      throw std::runtime_error("Could not open " + mLabelsFilename);
+  }
+  mLabeled = 1;
+  appendRows(rows, reinterpret_cast<const int*>(intLabels.data));
+}
+
+void FeatureStoreWriter::append(const cv::Mat& rows, const int label) {
+  append(rows, cv::Mat_<int>(rows.rows, 1, label));
+}
+
+void FeatureStoreWriter::appendRows(const cv::Mat& rows, const int* labels) {
+  if (mClosed)
+    throw std::logic_error("Appending to a closed feature store");
+  if (rows.empty())
+    return;
+  cv::Mat_<float> data;
+  rows.reshape(1, rows.rows).convertTo(data, CV_32F);
+  if (mCols == 0) {
+    mCols = data.cols;
+    mBlock.create(mBlockSize, mCols);
+    mMean.assign(mCols, 0.0);
+    mM2.assign(mCols, 0.0);
+    mMin.assign(mCols, std::numeric_limits<float>::max());
+    mMax.assign(mCols, std::numeric_limits<float>::lowest());
+  } else if (data.cols != mCols) {
+    throw std::invalid_argument("Every row must have " +
+                                std::to_string(mCols) + " columns");
+  }
+
+  // statistics of the new rows, merged into the running ones (Chan et al.)
+  const int n = data.rows;
+  std::vector<double> mean(mCols, 0.0), m2(mCols, 0.0);
+  for (int r = 0; r < n; ++r) {
+    const float* row = data[r];
+    for (int x = 0; x < mCols; ++x) {
+      mean[x] += row[x];
+      mMin[x] = std::min(mMin[x], row[x]);
+      mMax[x] = std::max(mMax[x], row[x]);
+    }
+  }
+  for (int x = 0; x < mCols; ++x)
+    mean[x] /= n;
+  for (int r = 0; r < n; ++r) {
+    const float* row = data[r];
+    for (int x = 0; x < mCols; ++x) {
+      const double d = row[x] - mean[x];
+      m2[x] += d * d;
+    }
+  }
+  const double total = static_cast<double>(mRows) + n;
+  for (int x = 0; x < mCols; ++x) {
+    const double delta = mean[x] - mMean[x];
+    mMean[x] += delta * n / total;
+    mM2[x] += m2[x] + delta * delta * mRows * n / total;
+  }
+
+  for (int r = 0; r < n; ++r) {
+    data.row(r).copyTo(mBlock.row(mBlockRows));
+    if (++mBlockRows == mBlockSize)
+      flush();
+  }
+  if (labels) {
+    mLabels.write(reinterpret_cast<const char*>(labels),
+                  static_cast<std::streamsize>(n) * sizeof(int));
+    if (!mLabels)
+      throw std::runtime_error("Could not write " + mLabelsFilename);
+  }
+  mRows += n;
+}
+
+void FeatureStoreWriter::flush() {
+  if (mBlockRows == 0)
+    return;
+  mFile.write(reinterpret_cast<const char*>(mBlock.data),
+              static_cast<std::streamsize>(mBlockRows) * mCols *
+              sizeof(float));
+  mBlockRows = 0;
+  if (!mFile)
+    throw std::runtime_error("Could not write " + mFilename);
+}
+
+void FeatureStoreWriter::writeLabels() {
+  mLabels.flush();
+  mLabels.seekg(0);
+  std::vector<char> chunk(static_cast<size_t>(mBlockSize) * sizeof(int));
+  while (mLabels.read(chunk.data(),
+                      static_cast<std::streamsize>(chunk.size())) ||
+         mLabels.gcount() > 0)
+    mFile.write(chunk.data(), mLabels.gcount());
+  mLabels.close();
+  std::remove(mLabelsFilename.c_str());
+}
+
+void FeatureStoreWriter::setMetadata(const std::string& key,
+                                     const std::string& value) {
+  mMetadata[key] = value;
+}
+
+void FeatureStoreWriter::close() {
+  if (mClosed)
+    return;
+  mClosed = true;
+  flush();
+
+  const uint64_t dataEnd = sizeof(Header) +
+    static_cast<uint64_t>(mRows) * mCols * sizeof(float);
+  const uint64_t footerOffset = align(dataEnd);
+  const char padding[kAlignment] = {0};
+  mFile.write(padding, static_cast<std::streamsize>(footerOffset - dataEnd));
+
+  uint64_t labelsSize = 0;
+  if (mLabeled == 1) {
+    labelsSize = static_cast<uint64_t>(mRows) * sizeof(int);
+    writeLabels();
+  }
+  std::string footer;
+  const cv::Mat_<float> mean = getMean();
+  const cv::Mat_<float> std = getStd();
+  for (int x = 0; x < mCols; ++x) {
+    put(footer, mean(x));
+    put(footer, std(x));
+    put(footer, mMin[x]);
+    put(footer, mMax[x]);
+  }
+  put(footer, static_cast<uint32_t>(mMetadata.size()));
+  for (const auto& entry : mMetadata) {
+    put(footer, static_cast<uint32_t>(entry.first.size()));
+    footer += entry.first;
+    put(footer, static_cast<uint32_t>(entry.second.size()));
+    footer += entry.second;
+  }
+  mFile.write(footer.data(), static_cast<std::streamsize>(footer.size()));
+
+  Header header = {};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.byteOrder = kByteOrder;
+  header.version = FeatureStore::kVersion;
+  header.rows = static_cast<uint64_t>(mRows);
+  header.cols = static_cast<uint32_t>(mCols);
+  header.blockSize = static_cast<uint32_t>(mBlockSize);
+  header.labeled = mLabeled == 1 ? 1 : 0;
+  header.footerOffset = footerOffset;
+  header.footerSize = labelsSize + footer.size();
+  mFile.seekp(0);
+  mFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  mFile.close();
+  if (!mFile)
+    throw std::runtime_error("Could not write " + mFilename);
+}
+
+int FeatureStoreWriter::getNumRows() const {
+  return mRows;
+}
+
+int FeatureStoreWriter::getNumCols() const {
+  return mCols;
+}
+
+int FeatureStoreWriter::getBlockSize() const {
+  return mBlockSize;
+}
+
+cv::Mat_<float> FeatureStoreWriter::getMean() const {
+  cv::Mat_<float> ans(1, mCols);
+  for (int x = 0; x < mCols; ++x)
+    ans(x) = static_cast<float>(mMean[x]);
+  return ans;
+}
+
+cv::Mat_<float> FeatureStoreWriter::getStd() const {
+  cv::Mat_<float> ans(1, mCols);
+  for (int x = 0; x < mCols; ++x)
+    ans(x) = mRows ? static_cast<float>(std::sqrt(mM2[x] / mRows)) : 0.f;
+  return ans;
+}
+
+FeatureStore::FeatureStore(const std::string& filename)
+  : mFilename(filename), mFile(std::make_shared<MappedFile>(filename)) {
+  const unsigned char* data = mFile->getData();
+  const size_t fileSize = mFile->getSize();
+  Header header;
+  if (fileSize < sizeof(header))
+    throw std::runtime_error("Not a feature store: " + filename);
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.byteOrder != kByteOrder)
+    throw std::runtime_error("Not a feature store: " + filename);
+  if (header.version > kVersion)
+    throw std::runtime_error("Unsupported feature store version in " +
+                             filename);
+  if (header.rows > static_cast<uint64_t>(INT_MAX) ||
+      header.cols > static_cast<uint32_t>(INT_MAX) ||
+      header.footerOffset > fileSize ||
+      header.footerSize > fileSize - header.footerOffset ||
+      sizeof(Header) + header.rows * header.cols * sizeof(float) >
+      header.footerOffset)
+    throw std::runtime_error("Truncated feature store: " + filename);
+
+  mRows = static_cast<int>(header.rows);
+  mCols = static_cast<int>(header.cols);
+  mBlockSize = static_cast<int>(header.blockSize);
+  mLabeled = header.labeled != 0;
+  mLabelsOffset = header.footerOffset;
+
+  const unsigned char* cursor = data + header.footerOffset;
+  const unsigned char* end = cursor + header.footerSize;
+  if (mLabeled) {
+    const size_t labelsSize = static_cast<size_t>(mRows) * sizeof(int);
+    if (static_cast<size_t>(end - cursor) < labelsSize)
+      throw std::runtime_error("Truncated feature store: " + filename);
+    cursor += labelsSize;
+  }
+  mMean.create(1, mCols);
+  mStd.create(1, mCols);
+  mMin.create(1, mCols);
+  mMax.create(1, mCols);
+  for (int x = 0; x < mCols; ++x) {
+    mMean(x) = take<float>(cursor, end);
+    mStd(x) = take<float>(cursor, end);
+    mMin(x) = take<float>(cursor, end);
+    mMax(x) = take<float>(cursor, end);
+  }
+  const uint32_t nMetadata = take<uint32_t>(cursor, end);
+  for (uint32_t i = 0; i < nMetadata; ++i) {
+    std::string key = takeString(cursor, end);
+    mMetadata[key] = takeString(cursor, end);
+  }
+}
+
+int FeatureStore::getNumRows() const {
+  return mRows;
+}
+
+int FeatureStore::getNumCols() const {
+  return mCols;
+}
+
+int FeatureStore::getBlockSize() const {
+  return mBlockSize;
+}
+
+int FeatureStore::getNumBlocks() const {
+  return mBlockSize ? (mRows + mBlockSize - 1) / mBlockSize : 0;
+}
+
+const std::string& FeatureStore::getFilename() const {
+  return mFilename;
+}
+
+cv::Mat_<float> FeatureStore::getData() const {
+  return getRows(0, mRows);
+}
+
+cv::Mat_<float> FeatureStore::getRows(const int begin, const int end) const {
+  if (begin < 0 || end > mRows || begin > end)
+    throw std::out_of_range("Invalid row range");
+  return MappedFile::view(mFile,
+    sizeof(Header) + static_cast<size_t>(begin) * mCols * sizeof(float),
+    end - begin, mCols, CV_32F);
+}
+
+cv::Mat_<float> FeatureStore::getBlock(const int index) const {
+  if (index < 0 || index >= getNumBlocks())
+    throw std::out_of_range("Invalid block index");
+  const int begin = index * mBlockSize;
+  return getRows(begin, std::min(begin + mBlockSize, mRows));
+}
+
+bool FeatureStore::hasLabels() const {
+  return mLabeled;
+}
+
+cv::Mat_<int> FeatureStore::getLabels() const {
+  return getLabels(0, mRows);
+}
+
+cv::Mat_<int> FeatureStore::getLabels(const int begin, const int end) const {
+  if (begin < 0 || end > mRows || begin > end)
+    throw std::out_of_range("Invalid row range");
+  if (!mLabeled)
+    return cv::Mat_<int>();
+  return MappedFile::view(mFile,
+    mLabelsOffset + static_cast<size_t>(begin) * sizeof(int),
+    end - begin, 1, CV_32S);
+}
+
+cv::Mat_<float> FeatureStore::getMean() const {
+  return mMean.clone();
+}
+
+cv::Mat_<float> FeatureStore::getStd() const {
+  return mStd.clone();
+}
+
+cv::Mat_<float> FeatureStore::getMin() const {
+  return mMin.clone();
+}
+
+cv::Mat_<float> FeatureStore::getMax() const {
+  return mMax.clone();
+}
+
+bool FeatureStore::hasMetadata(const std::string& key) const {
+  return mMetadata.count(key) > 0;
+}
+
+std::string FeatureStore::getMetadata(const std::string& key) const {
+  const auto it = mMetadata.find(key);
+  if (it == mMetadata.end())
+    throw std::out_of_range("Missing metadata: " + key);
+  return it->second;
+}
+
+}  // namespace ssig
@@ -39,16 +39,24 @@
 *  POSSIBILITY OF SUCH DAMAGE.
 *****************************************************************************L*/
 
-#ifdef _OPENMP
-#include <omp.h>
-#endif
 // opencv
 #include <opencv2/core.hpp>
 // c++
+#include <algorithm>
 #include <string>
 // ssiglib
 #include "ssiglib/core/util.hpp"
+#include "ssiglib/core/executor.hpp"
 #include "ssiglib/core/firefly.hpp"
+#include "ssiglib/core/rng.hpp"
+#include "ssiglib/core/profiler.hpp"
+
+namespace {
+// rows of the pairwise distance matrix held in memory at once
+const int kFireflyChunk = 256;
+// rows handed to the distance functor by one thread
+const int kFireflyBlock = 32;
+}  // namespace
 
 ssig::Firefly::Firefly(cv::Ptr<UtilityFunctor>& utilityFunction,
   cv::Ptr<DistanceFunctor>& distanceFunction) :
@@ -59,6 +67,7 @@ ssig::Firefly::Firefly(const Firefly& rhs) {
   setAbsorption(rhs.getAbsorption());
   setAnnealling(rhs.getAnnealling());
   setStep(rhs.getStep());
+  setSeed(rhs.getSeed());
   setEps(rhs.getEps());
   setMaxIterations(rhs.getMaxIterations());
 }
@@ -78,72 +87,77 @@ cv::Ptr<ssig::Firefly> ssig::Firefly::create(
 
 void ssig::Firefly::setup(const cv::Mat_<float>& input) {
   mIterations = 0;
-  mPopulation = input;
-  mUtilities = cv::Mat::zeros(mPopulation.rows, 1, CV_32F);
-
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-  for (int i = 0; i < mPopulation.rows; ++i) {
-    mUtilities[0][i] = (*utility)(mPopulation.row(i));
-  }
-
-  mRng = cv::theRNG();
-
-  cv::Mat_<int> order;
-  cv::sortIdx(mUtilities, order, cv::SORT_EVERY_COLUMN + cv::SORT_ASCENDING);
-  cv::Mat_<float> npop;
-  cv::Mat_<float> nuti;
-  ssig::Util::reorder(mPopulation, order, npop);
-  ssig::Util::reorder(mUtilities, order, nuti);
-  mPopulation = npop;
-  mUtilities = nuti;
+  mPopulation = input.clone();
+  evaluate(mPopulation, mUtilities);
+  sortPopulation();
 }
 
+void ssig::Firefly::sortPopulation() {
+  cv::sortIdx(mUtilities, mOrder, cv::SORT_EVERY_COLUMN + cv::SORT_ASCENDING);
+  ssig::Util::reorder(mPopulation, mOrder);
+  ssig::Util::reorder(mUtilities, mOrder);
+}
 
 bool ssig::Firefly::iterate() {
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-  for (int i = 0; i < mPopulation.rows; ++i) {
-    for (int j = 0; j < mPopulation.rows; ++j) {
-      if (mUtilities[0][j] > mUtilities[0][i]) {
-        auto xj = mPopulation.row(j);
-        auto xi = mPopulation.row(i);
-        auto dist = (*distance)(xi, xj);
-        auto expX = (mAbsorption * dist * dist);
-        auto attractiveness = mUtilities[0][j] / (1 + expX + expX * expX / 2);
-        mPopulation.row(i) = xi * (1 - attractiveness) +
-          attractiveness * (xj)+mStep * randomVector(mPopulation.cols);
+  const int len = mPopulation.rows;
+  const int dims = mPopulation.cols;
+  // every firefly moves towards the brighter ones as they were at the start
+  // of the iteration, so the rows can be updated in place concurrently
+  mPopulation.copyTo(mSnapshot);
+  const float* utilities = mUtilities.ptr<float>(0);
+  ++mIterations;
+
+  mDistances.create(std::min(len, kFireflyChunk), len);
+  const uint64_t key = deriveSeed(RNG_FIREFLY, static_cast<uint64_t>(mSeed));
+  for (int chunk = 0; chunk < len; chunk += kFireflyChunk) {
+    const int chunkEnd = std::min(len, chunk + kFireflyChunk);
+    const int nBlocks = (chunkEnd - chunk + kFireflyBlock - 1) / kFireflyBlock;
+    Executor::global().parallelFor(0, nBlocks,
+      [&](const int first, const int last) {
+      for (int b = first; b < last; ++b) {
+        const int start = chunk + b * kFireflyBlock;
+        const int end = std::min(chunkEnd, start + kFireflyBlock);
+        cv::Mat_<float> block = mDistances.rowRange(start - chunk, end - chunk);
+        distance->manyToMany(mSnapshot.rowRange(start, end), mSnapshot, block);
+      }
+    });
+
+    Executor::global().parallelFor(chunk, chunkEnd,
+      [&](const int first, const int last) {
+      for (int i = first; i < last; ++i) {
+        PhiloxRng rng(key, PhiloxRng::stream(mIterations, i));
+        const float* dist = mDistances[i - chunk];
+        float* xi = mPopulation[i];
+        for (int j = 0; j < len; ++j) {
+          if (utilities[j] > utilities[i]) {
+            const float* xj = mSnapshot[j];
+            const float expX = mAbsorption * dist[j] * dist[j];
+            const float attractiveness = utilities[j] /
+              (1 + expX + expX * expX / 2);
+            for (int d = 0; d < dims; ++d) {
+              xi[d] = xi[d] * (1 - attractiveness) + attractiveness * xj[d] +
+                mStep * rng.uniform(-0.5f, 0.5f);
+            }
+          }
+        }
       }
-    }
+    }, 8);
   }
 
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-  for (int i = 0; i < mPopulation.rows; ++i) {
-    mUtilities[0][i] = (*utility)(mPopulation.row(i));
-  }
+  evaluate(mPopulation, mUtilities);
 
   mStep = mStep * mAnnealling;
 
-  cv::Mat_<int> order;
-  cv::sortIdx(mUtilities, order, cv::SORT_EVERY_COLUMN + cv::SORT_ASCENDING);
-  cv::Mat_<float> npop;
-  cv::Mat_<float> nuti;
-  ssig::Util::reorder(mPopulation, order, npop);
-  ssig::Util::reorder(mUtilities, order, nuti);
-  mPopulation = npop;
-  mUtilities = nuti;
+  sortPopulation();
 
-  if (++mIterations > mMaxIterations) return true;
+  if (mIterations > mMaxIterations) return true;
   if (mStep < 0.001f) return true;
   return false;
 }
 
 
 void ssig::Firefly::learn(const cv::Mat_<float>& input) {
+  SSIG_PROFILE_SCOPE("Firefly::learn");
   setup(input);
   while (!iterate()) {
   }
@@ -191,3 +205,19 @@ float ssig::Firefly::getStep() const {
 void ssig::Firefly::setStep(float step) {
   mStep = step;
 }
+
+void ssig::Firefly::setSeed(int seed) {
+  mSeed = seed;
+}
+
+int ssig::Firefly::getSeed() const {
+  return mSeed;
+}
+
+ssig::MemoryFootprint ssig::Firefly::memoryFootprint() const {
+  MemoryFootprint ans = Optimization::memoryFootprint();
+  ans.addMat("snapshot", mSnapshot);
+  ans.addMat("distances", mDistances);
+  ans.addMat("order", mOrder);
+  return ans;
+}
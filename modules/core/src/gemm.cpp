@@ -0,0 +1,206 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include "ssiglib/core/gemm.hpp"
+
+#ifdef SSIG_WITH_CBLAS
+#include <cblas.h>
+#endif
+
+namespace ssig {
+
+namespace {
+#ifdef SSIG_WITH_CBLAS
+template <class T>
+struct Cblas;
+
+template <>
+struct Cblas<float> {
+  static void gemm(const CBLAS_TRANSPOSE transA, const CBLAS_TRANSPOSE transB,
+                   const int m, const int n, const int k, const double alpha,
+                   const float* a, const int lda, const float* b,
+                   const int ldb, const double beta, float* c,
+                   const int ldc) {
+    cblas_sgemm(CblasRowMajor, transA, transB, m, n, k,
+                static_cast<float>(alpha), a, lda, b, ldb,
+                static_cast<float>(beta), c, ldc);
+  }
+
+  static void gemv(const CBLAS_TRANSPOSE trans, const int rows,
+                   const int cols, const double alpha, const float* a,
+                   const int lda, const float* x, const int incx,
+                   const double beta, float* y, const int incy) {
+    cblas_sgemv(CblasRowMajor, trans, rows, cols, static_cast<float>(alpha),
+                a, lda, x, incx, static_cast<float>(beta), y, incy);
+  }
+};
+
+template <>
+struct Cblas<double> {
+  static void gemm(const CBLAS_TRANSPOSE transA, const CBLAS_TRANSPOSE transB,
+                   const int m, const int n, const int k, const double alpha,
+                   const double* a, const int lda, const double* b,
+                   const int ldb, const double beta, double* c,
+                   const int ldc) {
+    cblas_dgemm(CblasRowMajor, transA, transB, m, n, k, alpha, a, lda, b, ldb,
+                beta, c, ldc);
+  }
+
+  static void gemv(const CBLAS_TRANSPOSE trans, const int rows,
+                   const int cols, const double alpha, const double* a,
+                   const int lda, const double* x, const int incx,
+                   const double beta, double* y, const int incy) {
+    cblas_dgemv(CblasRowMajor, trans, rows, cols, alpha, a, lda, x, incx,
+                beta, y, incy);
+  }
+};
+
+// elements between the starts of two consecutive rows
+int leadingDim(const cv::Mat& m) {
+  return static_cast<int>(m.step[0] / m.elemSize());
+}
+
+bool overlaps(const cv::Mat& a, const cv::Mat& b) {
+  if (a.empty() || b.empty())
+    return false;
+  return a.datastart < b.dataend && b.datastart < a.dataend;
+}
+
+bool blasSupports(const cv::Mat& A, const cv::Mat& B, const cv::Mat& C) {
+  const int type = A.type();
+  if (type != CV_32FC1 && type != CV_64FC1)
+    return false;
+  if (B.type() != type || (!C.empty() && C.type() != type))
+    return false;
+  return A.dims == 2 && B.dims == 2 && !A.empty() && !B.empty();
+}
+
+template <class T>
+void blasGemm(const cv::Mat& A, const cv::Mat& B, const double alpha,
+              const cv::Mat& C, double beta, cv::Mat& D, const int flags) {
+  const bool transA = (flags & cv::GEMM_1_T) != 0;
+  const bool transB = (flags & cv::GEMM_2_T) != 0;
+  const bool transC = (flags & cv::GEMM_3_T) != 0;
+  const int m = transA ? A.cols : A.rows;
+  const int k = transA ? A.rows : A.cols;
+  const int n = transB ? B.rows : B.cols;
+  CV_Assert((transB ? B.cols : B.rows) == k);
+
+  // the product must not be written over its own operands
+  cv::Mat out;
+  if (!overlaps(D, A) && !overlaps(D, B))
+    out = D;
+
+  if (!C.empty() && beta != 0) {
+    CV_Assert(transC ? (C.rows == n && C.cols == m)
+                     : (C.rows == m && C.cols == n));
+    const bool inPlace = !transC && out.data == C.data &&
+      out.size() == C.size() && out.step[0] == C.step[0];
+    if (!inPlace) {
+      cv::Mat src;
+      if (transC)
+        cv::transpose(C, src);
+      else
+        src = overlaps(out, C) ? C.clone() : C;
+      out.create(m, n, A.type());
+      src.copyTo(out);
+    }
+  } else {
+    beta = 0;
+    out.create(m, n, A.type());
+  }
+
+  const T* a = A.ptr<T>();
+  const T* b = B.ptr<T>();
+  const int lda = leadingDim(A), ldb = leadingDim(B), ldo = leadingDim(out);
+  if (n == 1) {
+    // op(B) is a column vector
+    Cblas<T>::gemv(transA ? CblasTrans : CblasNoTrans, A.rows, A.cols,
+                   alpha, a, lda, b, transB ? 1 : ldb, beta, out.ptr<T>(),
+                   ldo);
+  } else if (m == 1) {
+    // op(A) is a row vector: out' = op(B)' * op(A)'
+    Cblas<T>::gemv(transB ? CblasNoTrans : CblasTrans, B.rows, B.cols,
+                   alpha, b, ldb, a, transA ? lda : 1, beta, out.ptr<T>(),
+                   1);
+  } else {
+    Cblas<T>::gemm(transA ? CblasTrans : CblasNoTrans,
+                   transB ? CblasTrans : CblasNoTrans, m, n, k, alpha,
+                   a, lda, b, ldb, beta, out.ptr<T>(), ldo);
+  }
+
+  if (out.data != D.data) {
+    if (D.size() == out.size() && D.type() == out.type())
+      out.copyTo(D);
+    else
+      D = out;
+  }
+}
+#endif
+}  // namespace
+
+void gemm(const cv::Mat& A, const cv::Mat& B, const double alpha,
+          const cv::Mat& C, const double beta, cv::Mat& D, const int flags) {
+#ifdef SSIG_WITH_CBLAS
+  if (blasSupports(A, B, C)) {
+    if (A.type() == CV_32F)
+      blasGemm<float>(A, B, alpha, C, beta, D, flags);
+    else
+      blasGemm<double>(A, B, alpha, C, beta, D, flags);
+    return;
+  }
+#endif
+  cv::gemm(A, B, alpha, C, beta, D, flags);
+}
+
+void gemm(const cv::Mat& A, const cv::Mat& B, cv::Mat& D, const int flags) {
+  ssig::gemm(A, B, 1.0, cv::Mat(), 0.0, D, flags);
+}
+
+const char* getGemmBackend() {
+#ifdef SSIG_WITH_CBLAS
+  return "cblas";
+#else
+  return "opencv";
+#endif
+}
+
+}  // namespace ssig
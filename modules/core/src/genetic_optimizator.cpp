@@ -43,13 +43,15 @@
 // c++
 #include <vector>
 #include <algorithm>
-#include <random>
+#include <cfloat>
+#include <cmath>
+#include <mutex>
 // ssiglib
+#include <ssiglib/core/executor.hpp>
 #include <ssiglib/core/math.hpp>
+#include <ssiglib/core/rng.hpp>
 #include <ssiglib/core/util.hpp>
-
-
-static std::mt19937 gen(static_cast<uint>(time(nullptr)));
+#include <ssiglib/core/profiler.hpp>
 
 namespace ssig {
 cv::Ptr<GeneticOptimizator> GeneticOptimizator::create(
@@ -71,67 +73,224 @@ cv::Ptr<GeneticOptimizator> GeneticOptimizator::create(
 }
 
 void GeneticOptimizator::learn(const cv::Mat_<float>& input) {
+  SSIG_PROFILE_SCOPE("GeneticOptimizator::learn");
   setup(input);
 
-  float pastUtil = -FLT_MAX;
-  for (int it = 0; it < mMaxIterations; ++it) {
-    iterate();
-    if (std::abs(mBestUtil - pastUtil) < mEps)
-      break;
-    pastUtil = mBestUtil;
+  if (mSteadyState) {
+    learnSteadyState();
+    return;
   }
-  mUtilities = cv::Mat_<float>::zeros(mPopulationLength, 1);
-  #ifdef _OPENMP
-  #pragma omp parallel for
-  #endif
-  for (int p = 0; p < mPopulationLength; ++p) {
-    mUtilities.at<float>(p) = (*utility)(mPopulation.row(p));
+
+  if (mIslands > 1) {
+    learnIslands();
+  } else {
+    float pastUtil = -FLT_MAX;
+    for (int it = 0; it < mMaxIterations; ++it) {
+      iterate();
+      if (std::abs(mBestUtil - pastUtil) < mEps)
+        break;
+      pastUtil = mBestUtil;
+    }
   }
+  evaluate(mPopulation, mUtilities);
 }
 
 void GeneticOptimizator::setup(const cv::Mat_<float>& input) {
-  mPopulation = input;
+  // stream 0 is the sequential one, the islands and the steady state
+  // workers use streams 1 and 2
+  mRng = PhiloxRng(deriveSeed(RNG_GENETIC, static_cast<uint64_t>(mSeed)));
+  mPopulation = input.clone();
   if (mPopulation.empty()) {
     mPopulation = cv::Mat_<float>::zeros(mPopulationLength, mDimensions);
     for (int i = 0; i < mPopulationLength; ++i) {
       for (int d = 0; d < mDimensions; ++d) {
-        std::uniform_real_distribution<float> randu(-5.f, 5.f);
-        mPopulation.at<float>(i, d) = randu(gen);
+        mPopulation.at<float>(i, d) = mRng.uniform(-5.f, 5.f);
       }
     }
   }
 }
 
 void GeneticOptimizator::iterate() {
+  mBestUtil = evolve(mPopulation, mRng);
+}
+
+float GeneticOptimizator::evolve(cv::Mat_<float>& population,
+                                 PhiloxRng& rng) const {
   // evaluation
-  cv::Mat_<float> popUtil = cv::Mat_<float>::zeros(mPopulationLength, 1);
-  #ifdef _OPENMP
-  #pragma omp parallel for
-  #endif
-  for (int p = 0; p < mPopulationLength; ++p) {
-    popUtil.at<float>(p) = (*utility)(mPopulation.row(p));
-  }
-  cv::exp(popUtil, popUtil);
+  cv::Mat_<float> popUtil;
+  evaluate(population, popUtil);
+  double bestUtil;
+  cv::minMaxIdx(popUtil, nullptr, &bestUtil);
+  // shifting by the best utility keeps exp() finite, the normalization
+  // removes the shift
+  cv::exp(popUtil - bestUtil, popUtil);
   cv::normalize(popUtil, popUtil, 1, 0, cv::NORM_L1);
 
-  int newPopLen = static_cast<int>(mPopulationLength * (1 - mElistimFactor));
+  const int newPopLen =
+    static_cast<int>(population.rows * (1 - mElistimFactor));
 
   // reproduction
   cv::Mat newPopulation;
-  applyReproduction(mPopulation, popUtil,
+  applyReproduction(population, popUtil,
                     newPopLen,
                     *crossOver,
-                    mBestUtil,
+                    rng,
                     newPopulation);
-  // mutation
+  // mutation, the elite rows are kept untouched
+  cv::Mat children = newPopulation.rowRange(0, newPopLen);
+  cv::Mat mutated;
   applyMutation(
                 mMutationRate,
                 mMutationType,
-                newPopulation,
+                children,
                 static_cast<int>(mMutationRange.x),
                 static_cast<int>(mMutationRange.y),
-                mRng,
-                newPopulation);
+                rng,
+                mutated);
+  mutated.copyTo(children);
+
+  population = newPopulation;
+  return static_cast<float>(bestUtil);
+}
+
+void GeneticOptimizator::learnIslands() {
+  const int len = mPopulation.rows;
+  const int nIslands = std::max(1, std::min(mIslands, len));
+  const int interval = std::max(1, mMigrationInterval);
+
+  std::vector<cv::Mat_<float>> islands(nIslands), utilities(nIslands);
+  std::vector<PhiloxRng> rngs(nIslands);
+  std::vector<float> bests(nIslands, -FLT_MAX);
+  const uint64_t key = deriveSeed(RNG_GENETIC, static_cast<uint64_t>(mSeed));
+  for (int k = 0; k < nIslands; ++k) {
+    islands[k] = mPopulation.rowRange(k * len / nIslands,
+                                      (k + 1) * len / nIslands).clone();
+    rngs[k] = PhiloxRng(key, PhiloxRng::stream(1, k));
+  }
+
+  float pastUtil = -FLT_MAX;
+  for (int it = 0; it < mMaxIterations; it += interval) {
+    const int generations = std::min(interval, mMaxIterations - it);
+    // the islands only meet at the migration barrier
+    Executor::global().parallelFor(0, nIslands,
+      [&](const int first, const int last) {
+      for (int k = first; k < last; ++k) {
+        for (int g = 0; g < generations; ++g)
+          evolve(islands[k], rngs[k]);
+        evaluate(islands[k], utilities[k]);
+        double best;
+        cv::minMaxIdx(utilities[k], nullptr, &best);
+        bests[k] = static_cast<float>(best);
+      }
+    });
+
+    mBestUtil = *std::max_element(bests.begin(), bests.end());
+    if (std::abs(mBestUtil - pastUtil) < mEps)
+      break;
+    pastUtil = mBestUtil;
+    migrate(mMigrants, islands, utilities);
+  }
+
+  cv::vconcat(islands, mPopulation);
+}
+
+void GeneticOptimizator::learnSteadyState() {
+  evaluate(mPopulation, mUtilities);
+  const int len = mPopulation.rows;
+  const int budget = mMaxIterations * len;
+  const uint64_t key = deriveSeed(RNG_GENETIC, static_cast<uint64_t>(mSeed));
+  double best;
+  cv::minMaxIdx(mUtilities, nullptr, &best);
+  mBestUtil = static_cast<float>(best);
+  int issued = 0;
+  std::mutex lock;
+
+  // one long running loop per thread, each with its own generator
+  auto work = [&](const int worker) {
+    PhiloxRng rng(key, PhiloxRng::stream(2, worker));
+    cv::Mat parentA, parentB, child, mutated;
+    cv::Mat_<float> utility;
+    // binary tournament, called with the lock held
+    auto select = [&]() {
+      const int a = rng.uniform(0, len), b = rng.uniform(0, len);
+      return (mUtilities(a) >= mUtilities(b)) ? a : b;
+    };
+
+    while (true) {
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        if (issued >= budget)
+          break;
+        ++issued;
+        mPopulation.row(select()).copyTo(parentA);
+        mPopulation.row(select()).copyTo(parentB);
+      }
+
+      child.create(1, mPopulation.cols, CV_32F);
+      (*crossOver)(parentA, parentB, child);
+      applyMutation(
+                    mMutationRate,
+                    mMutationType,
+                    child,
+                    static_cast<int>(mMutationRange.x),
+                    static_cast<int>(mMutationRange.y),
+                    rng,
+                    mutated);
+      evaluate(mutated, utility);
+      const float childUtil = utility(0);
+
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        double worstUtil;
+        int worst[2];
+        cv::minMaxIdx(mUtilities, &worstUtil, nullptr, worst);
+        if (childUtil > worstUtil) {
+          mutated.copyTo(mPopulation.row(worst[0]));
+          mUtilities(worst[0]) = childUtil;
+        }
+        mBestUtil = std::max(mBestUtil, childUtil);
+      }
+    }
+  };
+  Executor::global().parallelFor(0, Executor::global().getConcurrency(),
+    [&](const int first, const int last) {
+    for (int worker = first; worker < last; ++worker)
+      work(worker);
+  });
+}
+
+void GeneticOptimizator::migrate(const int migrants,
+  std::vector<cv::Mat_<float>>& islands,
+  std::vector<cv::Mat_<float>>& utilities) {
+  const int nIslands = static_cast<int>(islands.size());
+  if (nIslands < 2 || migrants <= 0)
+    return;
+
+  // every island sends copies of its best individuals before any of them
+  // is overwritten, so the ring migration is simultaneous
+  std::vector<cv::Mat_<float>> emigrants(nIslands), emigrantUtils(nIslands);
+  std::vector<cv::Mat_<int>> orderings(nIslands);
+  for (int k = 0; k < nIslands; ++k) {
+    cv::sortIdx(utilities[k], orderings[k],
+                cv::SORT_EVERY_COLUMN + cv::SORT_DESCENDING);
+    const int n = std::min(migrants, islands[k].rows);
+    for (int m = 0; m < n; ++m) {
+      const int idx = orderings[k](m);
+      emigrants[k].push_back(islands[k].row(idx));
+      emigrantUtils[k].push_back(utilities[k](idx));
+    }
+  }
+
+  for (int k = 0; k < nIslands; ++k) {
+    const int dst = (k + 1) % nIslands;
+    cv::Mat_<float>& island = islands[dst];
+    const int n = std::min(emigrants[k].rows, island.rows);
+    for (int m = 0; m < n; ++m) {
+      const int worst = orderings[dst](island.rows - 1 - m);
+      emigrants[k].row(m).copyTo(island.row(worst));
+      utilities[dst](worst) = emigrantUtils[k](m);
+    }
+  }
 }
 
 int GeneticOptimizator::getPopulationLength() const {
@@ -179,11 +338,35 @@ float GeneticOptimizator::getBestUtil() const {
 }
 
 void GeneticOptimizator::setSeed(int seed) {
-  mRng.state = static_cast<uint64>(seed);
+  mSeed = seed;
 }
 
 int GeneticOptimizator::getSeed() const {
-  return static_cast<int>(mRng.state);
+  return mSeed;
+}
+
+int GeneticOptimizator::getIslands() const {
+  return mIslands;
+}
+
+void GeneticOptimizator::setIslands(const int islands) {
+  mIslands = islands;
+}
+
+int GeneticOptimizator::getMigrationInterval() const {
+  return mMigrationInterval;
+}
+
+void GeneticOptimizator::setMigrationInterval(const int migrationInterval) {
+  mMigrationInterval = migrationInterval;
+}
+
+int GeneticOptimizator::getMigrants() const {
+  return mMigrants;
+}
+
+void GeneticOptimizator::setMigrants(const int migrants) {
+  mMigrants = migrants;
 }
 
 int GeneticOptimizator::getDimensions() const {
@@ -197,9 +380,11 @@ void GeneticOptimizator::setDimensions(const int dimensions) {
 GeneticOptimizator::GeneticOptimizator(
   cv::Ptr<UtilityFunctor>& utilityFunction,
   cv::Ptr<CrossOverFunctor>& crossOverFunction)
-  : crossOver(crossOverFunction), utility(utilityFunction),
+  : crossOver(crossOverFunction),
     mPopulationLength(100), mElistimFactor(0.1),
-    mMutationRate(0.1) { }
+    mMutationRate(0.1) {
+  utility = utilityFunction;
+}
 
 GeneticOptimizator::GeneticOptimizator(GeneticOptimizator& rhs) {
   setEps(getEps());
@@ -210,6 +395,9 @@ GeneticOptimizator::GeneticOptimizator(GeneticOptimizator& rhs) {
   setMutationRange(getMutationRange());
   setMutationType(getMutationType());
   setPopulationLength(getPopulationLength());
+  setIslands(rhs.getIslands());
+  setMigrationInterval(rhs.getMigrationInterval());
+  setMigrants(rhs.getMigrants());
 
   crossOver = rhs.crossOver;
   utility = rhs.utility;
@@ -220,42 +408,47 @@ void GeneticOptimizator::applyReproduction(
   const cv::Mat& utilities,
   const int newPopLen,
   const CrossOverFunctor& crossover,
-  float& bestUtil,
+  PhiloxRng& rng,
   cv::Mat& newPop) {
   cv::Mat_<int> ordering;
   cv::sortIdx(utilities, ordering, cv::SORT_EVERY_COLUMN + cv::SORT_ASCENDING);
-  bestUtil = utilities.at<float>(ordering.at<int>(utilities.rows - 1));
 
+  // roulette wheel: the sorted raffles are matched against the cumulative
+  // fitness in a single sweep
   std::vector<float> raffles(newPopLen);
   for (int i = 0; i < static_cast<int>(raffles.size()); ++i) {
-    raffles[i] = cv::theRNG().uniform(0.f, 1.f);
+    raffles[i] = rng.uniform(0.f, 1.f);
   }
-  std::vector<int> parents(raffles.size());
   std::sort(raffles.begin(), raffles.end());
-  int rafflePtr = 0;
-  for (int p = 0; p < pop.rows; ++p) {
-    if (raffles[rafflePtr] <= utilities.at<float>(ordering.at<int>(p))) {
-      parents[rafflePtr] = ordering.at<int>(p);
-      ++rafflePtr;
+  std::vector<int> parents(raffles.size());
+  float cumulative = 0;
+  int p = 0;
+  for (int r = 0; r < newPopLen; ++r) {
+    while (p < pop.rows - 1 &&
+           cumulative + utilities.at<float>(ordering(p)) < raffles[r]) {
+      cumulative += utilities.at<float>(ordering(p));
+      ++p;
     }
+    parents[r] = ordering(p);
+  }
+  for (int i = static_cast<int>(parents.size()) - 1; i > 0; --i) {
+    std::swap(parents[i], parents[rng.uniform(0, i + 1)]);
   }
-  parents.resize(rafflePtr);
+
   newPop = cv::Mat::zeros(pop.rows, pop.cols, CV_32F);
-  std::shuffle(parents.begin(), parents.end(),
-               std::default_random_engine(static_cast<uint>(time(nullptr))));
-  int popPtr = -1;
   const int nParents = static_cast<int>(parents.size());
-  for (int p = 0; p < nParents; ++p) {
-    const auto& parentA = parents[p];
-    const auto& parentB = parents[(p + 1) % nParents];
-    cv::Mat child = newPop.row(++popPtr);
+  for (int c = 0; c < nParents; ++c) {
+    const auto& parentA = parents[c];
+    const auto& parentB = parents[(c + 1) % nParents];
+    cv::Mat child = newPop.row(c);
     crossover(
               pop.row(parentA),
               pop.row(parentB),
               child);
   }
-  for (++popPtr; popPtr < pop.rows; ++popPtr) {
-    newPop.row(popPtr) = pop.row(ordering.at<int>(popPtr - nParents)) + 0;
+  // the remaining rows keep the best individuals
+  for (int e = nParents; e < pop.rows; ++e) {
+    pop.row(ordering(pop.rows - 1 - (e - nParents))).copyTo(newPop.row(e));
   }
 }
 
@@ -265,21 +458,19 @@ void GeneticOptimizator::applyMutation(
   const cv::Mat& pop,
   const int infLim,
   const int supLim,
-  cv::RNG& rng,
+  PhiloxRng& rng,
   cv::Mat& newPop) {
   cv::Mat ans = pop.clone();
   float left = static_cast<float>(infLim),
       right = static_cast<float>(supLim);
 
   for (int i = 0; i < pop.rows; ++i) {
-    float raffle = cv::theRNG().uniform(0.f, 1.f);
+    float raffle = rng.uniform(0.f, 1.f);
     if (raffle < mutationRate) {
       switch (type) {
       case Gaussian: {
-        cv::Mat mu = cv::Mat::zeros(1, 1, CV_32F),
-            sigma = cv::Mat::zeros(1, 1, CV_32F);
         cv::Mat noise(1, pop.cols, CV_32F);
-        rng.fill(noise, cv::RNG::NORMAL, mu, sigma);
+        rng.fillGaussian(noise.ptr<float>(), pop.cols, 1.f);
         ans.row(i) = pop.row(i) + noise;
       }
         break;
@@ -291,7 +482,7 @@ void GeneticOptimizator::applyMutation(
         break;
       case Boundary: {
         int selectedFeat = rng.uniform(0, pop.cols);
-        int flip = rng.uniform(0, 1);
+        int flip = rng.uniform(0, 2);
         ans.at<float>(i, selectedFeat) = (flip) ? left : right;
       }
         break;
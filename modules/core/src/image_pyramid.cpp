@@ -0,0 +1,126 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include "ssiglib/core/image_pyramid.hpp"
+// c++
+#include <cmath>
+#include <stdexcept>
+// opencv
+#include <opencv2/imgproc.hpp>
+// ssiglib
+#include "ssiglib/core/executor.hpp"
+
+namespace ssig {
+
+ImagePyramid::ImagePyramid(const cv::Mat& image,
+                           const float scaleFactor,
+                           const cv::Size& minSize,
+                           const int maxLevels) {
+  build(image, scaleFactor, minSize, maxLevels);
+}
+
+void ImagePyramid::build(const cv::Mat& image,
+                         const float scaleFactor,
+                         const cv::Size& minSize,
+                         const int maxLevels) {
+  if (image.empty())
+    throw std::invalid_argument("The image must not be empty");
+  if (scaleFactor <= 1.f)
+    throw std::invalid_argument("scaleFactor must be greater than 1");
+  if (maxLevels <= 0)
+    throw std::invalid_argument("maxLevels must be greater than 0");
+
+  mScaleFactor = scaleFactor;
+  mScales.clear();
+  std::vector<cv::Size> sizes;
+  double scale = 1.0;
+  while (static_cast<int>(sizes.size()) < maxLevels) {
+    const cv::Size size(
+      static_cast<int>(std::lround(image.cols / scale)),
+      static_cast<int>(std::lround(image.rows / scale)));
+    if (size.width < minSize.width || size.height < minSize.height ||
+        size.width <= 0 || size.height <= 0)
+      break;
+    sizes.push_back(size);
+    mScales.push_back(scale);
+    scale *= scaleFactor;
+  }
+
+  const int nLevels = static_cast<int>(sizes.size());
+  mLevels.assign(nLevels, cv::Mat());
+  if (nLevels > 0)
+    mLevels[0] = image.clone();
+  // each level is taken from the image itself, so levels are independent
+  Executor::global().parallelFor(1, nLevels,
+    [&](const int first, const int last) {
+    for (int l = first; l < last; ++l) {
+      cv::resize(image, mLevels[l], sizes[l], 0, 0, cv::INTER_AREA);
+    }
+  });
+}
+
+int ImagePyramid::getLevels() const {
+  return static_cast<int>(mLevels.size());
+}
+
+const cv::Mat& ImagePyramid::getLevel(const int level) const {
+  CV_Assert(level >= 0 && level < getLevels());
+  return mLevels[level];
+}
+
+float ImagePyramid::getScaleFactor() const {
+  return mScaleFactor;
+}
+
+double ImagePyramid::getScale(const int level) const {
+  CV_Assert(level >= 0 && level < getLevels());
+  return mScales[level];
+}
+
+cv::Rect ImagePyramid::toBase(const cv::Rect& rect, const int level) const {
+  const double scale = getScale(level);
+  return cv::Rect(static_cast<int>(std::lround(rect.x * scale)),
+                  static_cast<int>(std::lround(rect.y * scale)),
+                  static_cast<int>(std::lround(rect.width * scale)),
+                  static_cast<int>(std::lround(rect.height * scale)));
+}
+
+}  // namespace ssig
@@ -0,0 +1,190 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include "ssiglib/core/mapped_file.hpp"
+// c++
+#include <memory>
+#include <stdexcept>
+#include <string>
+// platform
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ssig {
+
+namespace {
+#if CV_VERSION_MAJOR >= 4
+typedef cv::AccessFlag AccessFlags;
+#else
+typedef int AccessFlags;
+#endif
+
+/**
+Never allocates: it only owns the UMatData of views created by
+MappedFile::view, whose userdata is a reference to the mapping.
+*/
+class MappedFileAllocator : public cv::MatAllocator {
+ public:
+  cv::UMatData* allocate(int dims, const int* sizes, int type, void* data,
+                         size_t* step, AccessFlags flags,
+                         cv::UMatUsageFlags usageFlags) const override {
+    return cv::Mat::getDefaultAllocator()->allocate(dims, sizes, type, data,
+                                                    step, flags, usageFlags);
+  }
+
+  bool allocate(cv::UMatData* data, AccessFlags accessFlags,
+                cv::UMatUsageFlags usageFlags) const override {
+    return data != nullptr;
+  }
+
+  void deallocate(cv::UMatData* u) const override {
+    if (!u)
+      return;
+    delete static_cast<std::shared_ptr<MappedFile>*>(u->userdata);
+    u->userdata = nullptr;
+    delete u;
+  }
+};
+
+MappedFileAllocator* mappedFileAllocator() {
+  // leaked on purpose: views may outlive static destruction order
+  static MappedFileAllocator* allocator = new MappedFileAllocator();
+  return allocator;
+}
+}  // namespace
+
+MappedFile::MappedFile(const std::string& filename) {
+#ifdef _WIN32
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+    nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    throw std::runtime_error("Could not open " + filename);
+  mFile = file;
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+    CloseHandle(file);
+    throw std::runtime_error("Could not map " + filename);
+  }
+  mSize = static_cast<size_t>(size.QuadPart);
+  mMapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+  if (mMapping)
+    mData = static_cast<unsigned char*>(
+      MapViewOfFile(mMapping, FILE_MAP_COPY, 0, 0, 0));
+  if (!mData) {
+    if (mMapping)
+      CloseHandle(mMapping);
+    CloseHandle(file);
+    throw std::runtime_error("Could not map " + filename);
+  }
+#else
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("Could not open " + filename);
+  struct stat status;
+  if (fstat(fd, &status) != 0 || status.st_size == 0) {
+    close(fd);
+    throw std::runtime_error("Could not map " + filename);
+  }
+  mSize = static_cast<size_t>(status.st_size);
+  void* data = mmap(nullptr, mSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd,
+                    0);
+  close(fd);
+  if (data == MAP_FAILED)
+    throw std::runtime_error("Could not map " + filename);
+  mData = static_cast<unsigned char*>(data);
+#endif
+}
+
+MappedFile::~MappedFile() {
+#ifdef _WIN32
+  UnmapViewOfFile(mData);
+  CloseHandle(mMapping);
+  CloseHandle(mFile);
+#else
+  munmap(mData, mSize);
+#endif
+}
+
+unsigned char* MappedFile::getData() const {
+  return mData;
+}
+
+size_t MappedFile::getSize() const {
+  return mSize;
+}
+
+cv::Mat MappedFile::view(const std::shared_ptr<MappedFile>& file,
+                         const size_t offset,
+                         const int rows,
+                         const int cols,
+                         const int type) {
+  if (rows == 0 || cols == 0)
+    return cv::Mat();
+  unsigned char* data = file->getData() + offset;
+  const size_t size = static_cast<size_t>(rows) * cols * CV_ELEM_SIZE(type);
+  if (offset > file->getSize() || size > file->getSize() - offset)
+    throw std::out_of_range("View outside of the mapped file");
+
+  cv::Mat ans(rows, cols, type, data);
+  auto u = new cv::UMatData(mappedFileAllocator());
+  u->data = u->origdata = data;
+  u->size = size;
+  u->refcount = 1;
+  u->userdata = new std::shared_ptr<MappedFile>(file);
+  ans.u = u;
+  ans.allocator = mappedFileAllocator();
+  return ans;
+}
+
+const MappedFile* MappedFile::getMapping(const cv::Mat& mat) {
+  const cv::UMatData* u = mat.u;
+  if (!u || u->currAllocator != mappedFileAllocator())
+    return nullptr;
+  return static_cast<const std::shared_ptr<MappedFile>*>(u->userdata)->get();
+}
+
+}  // namespace ssig
@@ -0,0 +1,263 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include "ssiglib/core/mat_pool.hpp"
+// c++
+#include <mutex>
+#include <vector>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace ssig {
+
+namespace {
+// class 0 holds up to 64 bytes, then there are four classes per power of two
+const int kClasses = 81;
+
+int floorLog2(const uint64_t value) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanReverse64(&index, value);
+  return static_cast<int>(index);
+#else
+  return 63 - __builtin_clzll(value);
+#endif
+}
+
+int sizeClass(const size_t size) {
+  if (size <= 64)
+    return 0;
+  const uint64_t s = size - 1;
+  const int e = floorLog2(s);
+  const int sub = static_cast<int>((s >> (e - 2)) & 3);
+  return 1 + (e - 6) * 4 + sub;
+}
+
+size_t classSize(const int sizeClass) {
+  if (sizeClass == 0)
+    return 64;
+  const int e = (sizeClass - 1) / 4 + 6;
+  const int sub = (sizeClass - 1) % 4;
+  return static_cast<size_t>(5 + sub) << (e - 2);
+}
+
+thread_local bool tCacheDestroyed = false;
+}  // namespace
+
+struct MatPool::ThreadCache {
+  std::vector<void*> lists[kClasses];
+  size_t bytes = 0;
+
+  ~ThreadCache() {
+    for (int c = 0; c < kClasses; ++c) {
+      for (void* buffer : lists[c])
+        cv::fastFree(buffer);
+    }
+    MatPool::instance().addFootprint(0, -static_cast<int64_t>(bytes));
+    tCacheDestroyed = true;
+  }
+
+  // nullptr while the thread is exiting
+  static ThreadCache* get() {
+    if (tCacheDestroyed)
+      return nullptr;
+    static thread_local ThreadCache cache;
+    return &cache;
+  }
+};
+
+const size_t MatPool::kMaxPooledSize;
+
+MatPool& MatPool::instance() {
+  // never destroyed: pooled matrices may be released during static
+  // destruction
+  static MatPool* pool = new MatPool();
+  return *pool;
+}
+
+MatPool::Stats MatPool::getStats() const {
+  Stats ans;
+  ans.allocations = mAllocations.load();
+  ans.reused = mReused.load();
+  ans.bytesInUse = static_cast<uint64_t>(mBytesInUse.load());
+  ans.bytesCached = static_cast<uint64_t>(mBytesCached.load());
+  ans.peakBytes = static_cast<uint64_t>(mPeakBytes.load());
+  return ans;
+}
+
+void MatPool::resetStats() {
+  mAllocations = 0;
+  mReused = 0;
+  mPeakBytes = mBytesInUse.load() + mBytesCached.load();
+}
+
+void MatPool::trim() {
+  ThreadCache* cache = ThreadCache::get();
+  if (!cache)
+    return;
+  for (int c = 0; c < kClasses; ++c) {
+    for (void* buffer : cache->lists[c])
+      cv::fastFree(buffer);
+    cache->lists[c].clear();
+  }
+  addFootprint(0, -static_cast<int64_t>(cache->bytes));
+  cache->bytes = 0;
+}
+
+size_t MatPool::getMaxCachedBytes() const {
+  return mMaxCachedBytes;
+}
+
+void MatPool::setMaxCachedBytes(const size_t bytes) {
+  mMaxCachedBytes = bytes;
+}
+
+cv::UMatData* MatPool::allocate(int dims, const int* sizes, int type,
+                                void* data0, size_t* step,
+                                AccessFlags flags,
+                                cv::UMatUsageFlags usageFlags) const {
+  // same layout as the default cv::Mat allocator
+  size_t total = CV_ELEM_SIZE(type);
+  for (int i = dims - 1; i >= 0; i--) {
+    if (step) {
+      if (data0 && step[i] != cv::Mat::AUTO_STEP) {
+        CV_Assert(total <= step[i]);
+        total = step[i];
+      } else {
+        step[i] = total;
+      }
+    }
+    total *= sizes[i];
+  }
+  auto data = static_cast<unsigned char*>(data0 ? data0 : acquire(total));
+  cv::UMatData* u = new cv::UMatData(this);
+  u->data = u->origdata = data;
+  u->size = total;
+  if (data0)
+    u->flags |= cv::UMatData::USER_ALLOCATED;
+  return u;
+}
+
+bool MatPool::allocate(cv::UMatData* u, AccessFlags accessFlags,
+                       cv::UMatUsageFlags usageFlags) const {
+  return u != nullptr;
+}
+
+void MatPool::deallocate(cv::UMatData* u) const {
+  if (!u)
+    return;
+  CV_Assert(u->urefcount == 0);
+  CV_Assert(u->refcount == 0);
+  if (!(u->flags & cv::UMatData::USER_ALLOCATED)) {
+    release(u->origdata, u->size);
+    u->origdata = nullptr;
+  }
+  delete u;
+}
+
+void* MatPool::acquire(const size_t size) const {
+  ++mAllocations;
+  if (size > kMaxPooledSize) {
+    addFootprint(static_cast<int64_t>(size), 0);
+    return cv::fastMalloc(size);
+  }
+  const int c = sizeClass(size);
+  const auto bytes = static_cast<int64_t>(classSize(c));
+  ThreadCache* cache = ThreadCache::get();
+  if (cache && !cache->lists[c].empty()) {
+    void* buffer = cache->lists[c].back();
+    cache->lists[c].pop_back();
+    cache->bytes -= bytes;
+    ++mReused;
+    addFootprint(bytes, -bytes);
+    return buffer;
+  }
+  addFootprint(bytes, 0);
+  return cv::fastMalloc(classSize(c));
+}
+
+void MatPool::release(void* buffer, const size_t size) const {
+  if (size > kMaxPooledSize) {
+    cv::fastFree(buffer);
+    addFootprint(-static_cast<int64_t>(size), 0);
+    return;
+  }
+  const int c = sizeClass(size);
+  const size_t bytes = classSize(c);
+  ThreadCache* cache = ThreadCache::get();
+  if (cache && cache->bytes + bytes <= mMaxCachedBytes) {
+    cache->lists[c].push_back(buffer);
+    cache->bytes += bytes;
+    addFootprint(-static_cast<int64_t>(bytes), static_cast<int64_t>(bytes));
+  } else {
+    cv::fastFree(buffer);
+    addFootprint(-static_cast<int64_t>(bytes), 0);
+  }
+}
+
+void MatPool::addFootprint(const int64_t inUse, const int64_t cached) const {
+  const int64_t footprint = (mBytesInUse += inUse) + (mBytesCached += cached);
+  int64_t peak = mPeakBytes.load(std::memory_order_relaxed);
+  while (footprint > peak &&
+         !mPeakBytes.compare_exchange_weak(peak, footprint)) {
+  }
+}
+
+std::mutex MatPoolScope::sMutex;
+int MatPoolScope::sDepth = 0;
+cv::MatAllocator* MatPoolScope::sPrevious = nullptr;
+
+MatPoolScope::MatPoolScope() {
+  std::lock_guard<std::mutex> lock(sMutex);
+  if (sDepth++ == 0) {
+    sPrevious = cv::Mat::getDefaultAllocator();
+    cv::Mat::setDefaultAllocator(&MatPool::instance());
+  }
+}
+
+MatPoolScope::~MatPoolScope() {
+  std::lock_guard<std::mutex> lock(sMutex);
+  if (--sDepth == 0)
+    cv::Mat::setDefaultAllocator(sPrevious);
+}
+
+}  // namespace ssig
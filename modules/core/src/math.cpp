@@ -41,9 +41,116 @@
 
 #include "ssiglib/core/math.hpp"
 #include <opencv2/core.hpp>
+// c++
+#include <algorithm>
+#include <cmath>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+// ssiglib
+#include "ssiglib/core/gemm.hpp"
+#include "ssiglib/core/simd.hpp"
 
 namespace ssig {
 
+namespace {
+// number of rows on each side of a similarity tile
+const int kSimilarityTile = 64;
+
+enum GemmMetric {
+  GEMM_COSINE,
+  GEMM_CORRELATION,
+  GEMM_EUCLIDEAN
+};
+
+// returns a header when the input already holds floats
+cv::Mat_<float> asFloat(const cv::Mat& m) {
+  if (m.type() == CV_32F)
+    return m;
+  cv::Mat_<float> converted;
+  m.convertTo(converted, CV_32F);
+  return converted;
+}
+
+// Prepares the operand of the GEMM and the per row correction:
+// the inverse L2 norm for cosine/correlation, the squared norm for euclidean
+void prepareGemmOperand(const cv::Mat_<float>& input,
+                        const GemmMetric metric,
+                        cv::Mat_<float>& operand,
+                        std::vector<double>& rowFactor) {
+  const int len = input.rows;
+  if (metric == GEMM_CORRELATION) {
+    operand.create(input.rows, input.cols);
+  } else {
+    operand = input;
+  }
+  rowFactor.resize(len);
+
+  for (int i = 0; i < len; ++i) {
+    if (metric == GEMM_CORRELATION) {
+      const double rowMean = cv::mean(input.row(i))[0];
+      cv::Mat_<float> centered = operand.row(i);
+      cv::subtract(input.row(i), cv::Scalar::all(rowMean), centered);
+    }
+    const double sqrNorm = cv::norm(operand.row(i), cv::NORM_L2SQR);
+    if (metric == GEMM_EUCLIDEAN) {
+      rowFactor[i] = sqrNorm;
+    } else {
+      rowFactor[i] = (sqrNorm > 0) ? 1.0 / std::sqrt(sqrNorm) : 0.0;
+    }
+  }
+}
+
+// One GEMM between prepared rows of A and B followed by the row-norm
+// corrections; factorA and factorB point at the factors of those rows
+void gemmPrepared(const cv::Mat_<float>& opA,
+                  const double* factorA,
+                  const cv::Mat_<float>& opB,
+                  const double* factorB,
+                  const GemmMetric metric,
+                  cv::Mat_<float>& scores) {
+  ssig::gemm(opA, opB, scores, cv::GEMM_2_T);
+
+  for (int i = 0; i < scores.rows; ++i) {
+    float* row = scores[i];
+    for (int j = 0; j < scores.cols; ++j) {
+      if (metric == GEMM_EUCLIDEAN) {
+        const double sqrDist = factorA[i] + factorB[j] - 2.0 * row[j];
+        row[j] = static_cast<float>(std::sqrt(std::max(sqrDist, 0.0)));
+      } else {
+        row[j] = static_cast<float>(row[j] * factorA[i] * factorB[j]);
+      }
+    }
+  }
+}
+
+void gemmScores(const cv::Mat& A,
+                const cv::Mat& B,
+                const GemmMetric metric,
+                cv::Mat_<float>& scores) {
+  cv::Mat_<float> opA, opB;
+  std::vector<double> factorA, factorB;
+  prepareGemmOperand(asFloat(A), metric, opA, factorA);
+  prepareGemmOperand(asFloat(B), metric, opB, factorB);
+  gemmPrepared(opA, factorA.data(), opB, factorB.data(), metric, scores);
+}
+
+// The GEMM metric of the built-in functors, false for any other functor,
+// including those deriving from a built-in one
+bool gemmMetricOf(const SimilarityFunctor& functor, GemmMetric& metric) {
+  const std::type_info& type = typeid(functor);
+  if (type == typeid(CosineSimilarity))
+    metric = GEMM_COSINE;
+  else if (type == typeid(CorrelationSimilarity))
+    metric = GEMM_CORRELATION;
+  else if (type == typeid(EuclideanDistance))
+    metric = GEMM_EUCLIDEAN;
+  else
+    return false;
+  return true;
+}
+}  // namespace
+
 Math::Math() {
   // Constructor
 }
@@ -63,6 +170,41 @@ Math& Math::operator=(const Math& rhs) {
   return *this;
 }
 
+UtilityBatchAdapter::UtilityBatchAdapter(
+  const cv::Ptr<UtilityFunctor>& utility) : mUtility(utility) {}
+
+void UtilityBatchAdapter::operator()(const cv::Mat& population,
+                                     cv::Mat_<float>& utilities) const {
+  const int len = population.rows;
+  utilities.create(len, 1);
+  Executor::global().parallelFor(0, len,
+    [&](const int first, const int last) {
+    for (int i = first; i < last; ++i) {
+      utilities(i) = (*mUtility)(population.row(i));
+    }
+  });
+}
+
+void DistanceFunctor::oneToMany(const cv::Mat& query,
+                                const cv::Mat& samples,
+                                cv::Mat_<float>& scores) const {
+  scores.create(1, samples.rows);
+  for (int j = 0; j < samples.rows; ++j) {
+    scores[0][j] = (*this)(query, samples.row(j));
+  }
+}
+
+void DistanceFunctor::manyToMany(const cv::Mat& A,
+                                 const cv::Mat& B,
+                                 cv::Mat_<float>& scores) const {
+  scores.create(A.rows, B.rows);
+  cv::Mat_<float> rowScores;
+  for (int i = 0; i < A.rows; ++i) {
+    oneToMany(A.row(i), B, rowScores);
+    rowScores.copyTo(scores.row(i));
+  }
+}
+
 float CosineSimilarity::operator()(const cv::Mat& x,
                                    const cv::Mat& y) const {
   return static_cast<float>(
@@ -70,6 +212,26 @@ float CosineSimilarity::operator()(const cv::Mat& x,
       * cv::norm(y, cv::NORM_L2)));
 }
 
+void CosineSimilarity::oneToMany(const cv::Mat& query,
+                                 const cv::Mat& samples,
+                                 cv::Mat_<float>& scores) const {
+  if (!isExactly<CosineSimilarity>()) {
+    DistanceFunctor::oneToMany(query, samples, scores);
+    return;
+  }
+  gemmScores(query, samples, GEMM_COSINE, scores);
+}
+
+void CosineSimilarity::manyToMany(const cv::Mat& A,
+                                  const cv::Mat& B,
+                                  cv::Mat_<float>& scores) const {
+  if (!isExactly<CosineSimilarity>()) {
+    DistanceFunctor::manyToMany(A, B, scores);
+    return;
+  }
+  gemmScores(A, B, GEMM_COSINE, scores);
+}
+
 float CorrelationSimilarity::operator()(const cv::Mat& x,
                                         const cv::Mat& y) const {
   float correlation;
@@ -83,11 +245,38 @@ float CorrelationSimilarity::operator()(const cv::Mat& x,
   return correlation;
 }
 
+void CorrelationSimilarity::oneToMany(const cv::Mat& query,
+                                      const cv::Mat& samples,
+                                      cv::Mat_<float>& scores) const {
+  if (!isExactly<CorrelationSimilarity>()) {
+    DistanceFunctor::oneToMany(query, samples, scores);
+    return;
+  }
+  gemmScores(query, samples, GEMM_CORRELATION, scores);
+}
+
+void CorrelationSimilarity::manyToMany(const cv::Mat& A,
+                                       const cv::Mat& B,
+                                       cv::Mat_<float>& scores) const {
+  if (!isExactly<CorrelationSimilarity>()) {
+    DistanceFunctor::manyToMany(A, B, scores);
+    return;
+  }
+  gemmScores(A, B, GEMM_CORRELATION, scores);
+}
+
 float Chi2Similarity::operator()(const cv::Mat& x, const cv::Mat& y) const {
   // The advantage of this distance is that it is weighted by the bin scale
   // That is, if the bin tends to have large values, a large distance in the
   // bin has less weight than in a bin that tend to have smaller values
 
+  if (x.type() == CV_32F && y.type() == CV_32F &&
+      x.isContinuous() && y.isContinuous()) {
+    const float sim = simd::chi2Distance(x.ptr<float>(), y.ptr<float>(),
+                                         static_cast<int>(x.total()));
+    return -std::sqrt(0.5f * sim);
+  }
+
   float sim = 0;
 
   cv::Mat squareDiff = x - y;
@@ -101,31 +290,117 @@ float Chi2Similarity::operator()(const cv::Mat& x, const cv::Mat& y) const {
   return -sim;
 }
 
+void Chi2Similarity::oneToMany(const cv::Mat& query,
+                               const cv::Mat& samples,
+                               cv::Mat_<float>& scores) const {
+  if (!isExactly<Chi2Similarity>()) {
+    DistanceFunctor::oneToMany(query, samples, scores);
+    return;
+  }
+  manyToMany(query, samples, scores);
+}
+
+void Chi2Similarity::manyToMany(const cv::Mat& A,
+                                const cv::Mat& B,
+                                cv::Mat_<float>& scores) const {
+  if (!isExactly<Chi2Similarity>()) {
+    DistanceFunctor::manyToMany(A, B, scores);
+    return;
+  }
+  const cv::Mat_<float> a = asFloat(A), b = asFloat(B);
+  const int dims = a.cols;
+  scores.create(a.rows, b.rows);
+  for (int i = 0; i < a.rows; ++i) {
+    float* row = scores[i];
+    for (int j = 0; j < b.rows; ++j) {
+      row[j] = -std::sqrt(0.5f * simd::chi2Distance(a[i], b[j], dims));
+    }
+  }
+}
+
 float EuclideanDistance::operator()(
   const cv::Mat& x,
   const cv::Mat& y) const {
-  return static_cast<float>(cv::norm(x - y));
+  return static_cast<float>(cv::norm(x, y, cv::NORM_L2));
+}
+
+void EuclideanDistance::oneToMany(const cv::Mat& query,
+                                  const cv::Mat& samples,
+                                  cv::Mat_<float>& scores) const {
+  if (!isExactly<EuclideanDistance>()) {
+    DistanceFunctor::oneToMany(query, samples, scores);
+    return;
+  }
+  gemmScores(query, samples, GEMM_EUCLIDEAN, scores);
+}
+
+void EuclideanDistance::manyToMany(const cv::Mat& A,
+                                   const cv::Mat& B,
+                                   cv::Mat_<float>& scores) const {
+  if (!isExactly<EuclideanDistance>()) {
+    DistanceFunctor::manyToMany(A, B, scores);
+    return;
+  }
+  gemmScores(A, B, GEMM_EUCLIDEAN, scores);
 }
 
 cv::Mat_<float> Math::buildSimilarity(
   const cv::Mat_<float>& input,
   SimilarityFunctor
   & similarityFunction) {
-  int len = input.rows;
+  const int len = input.rows;
   cv::Mat_<float> similarity(len, len);
   similarity = 0;
 
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-  for (int i = 0; i < len; ++i) {
-    for (int j = i + 1; j < len; ++j) {
-      cv::Mat_<float> x = input.row(i);
-      cv::Mat_<float> y = input.row(j);
-
-      similarity[i][j] = similarityFunction(x, y);
+  // only the tiles on and above the diagonal are computed, each one is
+  // mirrored to fill the lower triangle
+  const int nBlocks = (len + kSimilarityTile - 1) / kSimilarityTile;
+  std::vector<std::pair<int, int>> tiles;
+  tiles.reserve(nBlocks * (nBlocks + 1) / 2);
+  for (int bi = 0; bi < nBlocks; ++bi) {
+    for (int bj = bi; bj < nBlocks; ++bj) {
+      tiles.push_back(std::make_pair(bi, bj));
     }
   }
+  const int nTiles = static_cast<int>(tiles.size());
+
+  // the GEMM functors prepare the rows once, not once per tile
+  GemmMetric metric;
+  const bool prepared = gemmMetricOf(similarityFunction, metric);
+  cv::Mat_<float> operand;
+  std::vector<double> factor;
+  if (prepared)
+    prepareGemmOperand(input, metric, operand, factor);
+
+  Executor::global().parallelFor(0, nTiles,
+    [&](const int first, const int last) {
+    cv::Mat_<float> block;
+    for (int t = first; t < last; ++t) {
+      const int rowBegin = tiles[t].first * kSimilarityTile;
+      const int rowEnd = std::min(rowBegin + kSimilarityTile, len);
+      const int colBegin = tiles[t].second * kSimilarityTile;
+      const int colEnd = std::min(colBegin + kSimilarityTile, len);
+
+      if (prepared) {
+        gemmPrepared(operand.rowRange(rowBegin, rowEnd),
+                     factor.data() + rowBegin,
+                     operand.rowRange(colBegin, colEnd),
+                     factor.data() + colBegin, metric, block);
+      } else {
+        similarityFunction.manyToMany(input.rowRange(rowBegin, rowEnd),
+                                      input.rowRange(colBegin, colEnd),
+                                      block);
+      }
+
+      for (int i = rowBegin; i < rowEnd; ++i) {
+        const float* values = block[i - rowBegin];
+        for (int j = std::max(colBegin, i + 1); j < colEnd; ++j) {
+          similarity[i][j] = values[j - colBegin];
+          similarity[j][i] = values[j - colBegin];
+        }
+      }
+    }
+  });
   return similarity;
 }
 
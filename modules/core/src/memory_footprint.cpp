@@ -0,0 +1,277 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include "ssiglib/core/memory_footprint.hpp"
+// c++
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+// ssiglib
+#include "ssiglib/core/algorithm.hpp"
+#include "ssiglib/core/mapped_file.hpp"
+
+namespace ssig {
+
+void MemoryFootprint::addOwned(const std::string& name, const size_t bytes) {
+  mEntries.push_back(Entry{name, bytes, nullptr});
+}
+
+void MemoryFootprint::addShared(const std::string& name, const size_t bytes,
+                                const void* buffer) {
+  mEntries.push_back(Entry{name, bytes, buffer});
+}
+
+void MemoryFootprint::addMat(const std::string& name, const cv::Mat& mat) {
+  const cv::UMatData* u = mat.u;
+  if (mat.empty() || !u)
+    return;
+  const MappedFile* mapping = MappedFile::getMapping(mat);
+  if (mapping)
+    addShared(name, mapping->getSize(), mapping);
+  else if (u->refcount > 1 || (u->flags & cv::UMatData::USER_ALLOCATED))
+    addShared(name, u->size, u);
+  else
+    addOwned(name, u->size);
+}
+
+void MemoryFootprint::addMats(const std::string& name,
+                              const std::vector<cv::Mat>& mats) {
+  for (size_t i = 0; i < mats.size(); ++i)
+    addMat(name + "[" + std::to_string(i) + "]", mats[i]);
+}
+
+void MemoryFootprint::addChild(const std::string& name,
+                               const MemoryFootprint& child) {
+  mChildren.push_back(child);
+  mChildren.back().mName = name;
+}
+
+const std::string& MemoryFootprint::getName() const {
+  return mName;
+}
+
+void MemoryFootprint::setName(const std::string& name) {
+  mName = name;
+}
+
+const std::vector<MemoryFootprint::Entry>&
+MemoryFootprint::getEntries() const {
+  return mEntries;
+}
+
+const std::vector<MemoryFootprint>& MemoryFootprint::getChildren() const {
+  return mChildren;
+}
+
+size_t MemoryFootprint::getOwnedBytes() const {
+  size_t ans = 0;
+  for (const auto& entry : mEntries) {
+    if (!entry.buffer)
+      ans += entry.bytes;
+  }
+  for (const auto& child : mChildren)
+    ans += child.getOwnedBytes();
+  return ans;
+}
+
+size_t MemoryFootprint::getSharedBytes() const {
+  std::unordered_map<const void*, size_t> buffers;
+  collectShared(buffers);
+  size_t ans = 0;
+  for (const auto& buffer : buffers)
+    ans += buffer.second;
+  return ans;
+}
+
+size_t MemoryFootprint::getTotalBytes() const {
+  return getOwnedBytes() + getSharedBytes();
+}
+
+void MemoryFootprint::collectShared(
+  std::unordered_map<const void*, size_t>& buffers) const {
+  for (const auto& entry : mEntries) {
+    if (entry.buffer) {
+      size_t& bytes = buffers[entry.buffer];
+      bytes = std::max(bytes, entry.bytes);
+    }
+  }
+  for (const auto& child : mChildren)
+    child.collectShared(buffers);
+}
+
+static std::string quote(const std::string& text) {
+  std::string ans = "\"";
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      ans += '\\';
+      ans += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char escaped[8];
+      snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      ans += escaped;
+    } else {
+      ans += c;
+    }
+  }
+  return ans + "\"";
+}
+
+std::string MemoryFootprint::toJson() const {
+  std::string ans;
+  appendJson(ans);
+  return ans + "\n";
+}
+
+void MemoryFootprint::appendJson(std::string& out) const {
+  std::ostringstream json;
+  json << "{\"name\": " << quote(mName)
+    << ", \"owned\": " << getOwnedBytes()
+    << ", \"shared\": " << getSharedBytes() << ", \"entries\": [";
+  for (size_t i = 0; i < mEntries.size(); ++i) {
+    json << (i ? ", " : "") << "{\"name\": " << quote(mEntries[i].name)
+      << ", \"bytes\": " << mEntries[i].bytes << ", \"shared\": "
+      << (mEntries[i].buffer ? "true" : "false") << "}";
+  }
+  json << "], \"children\": [";
+  out += json.str();
+  for (size_t i = 0; i < mChildren.size(); ++i) {
+    if (i)
+      out += ", ";
+    mChildren[i].appendJson(out);
+  }
+  out += "]}";
+}
+
+MemoryTally& MemoryTally::instance() {
+  // leaked on purpose: models may be destroyed during static destruction
+  static MemoryTally* tally = new MemoryTally();
+  return *tally;
+}
+
+void MemoryTally::track(const std::string& name, const Algorithm& model) {
+  std::lock_guard<std::mutex> lock(mLock);
+  std::vector<MemoryFootprint> footprints;
+  footprints.push_back(model.memoryFootprint());
+  for (const auto& tracked : mModels) {
+    if (tracked.first != name)
+      footprints.push_back(tracked.second->memoryFootprint());
+  }
+  if (mLimit && totalBytes(footprints) > mLimit)
+    throw std::length_error("Tracking " + name + " goes over the memory limit");
+
+  for (auto& tracked : mModels) {
+    if (tracked.first == name) {
+      tracked.second = &model;
+      return;
+    }
+  }
+  mModels.emplace_back(name, &model);
+}
+
+void MemoryTally::untrack(const std::string& name) {
+  std::lock_guard<std::mutex> lock(mLock);
+  mModels.erase(std::remove_if(mModels.begin(), mModels.end(),
+    [&](const std::pair<std::string, const Algorithm*>& tracked) {
+    return tracked.first == name;
+  }), mModels.end());
+}
+
+void MemoryTally::untrack(const Algorithm* model) {
+  std::lock_guard<std::mutex> lock(mLock);
+  mModels.erase(std::remove_if(mModels.begin(), mModels.end(),
+    [&](const std::pair<std::string, const Algorithm*>& tracked) {
+    return tracked.second == model;
+  }), mModels.end());
+}
+
+void MemoryTally::clear() {
+  std::lock_guard<std::mutex> lock(mLock);
+  mModels.clear();
+}
+
+void MemoryTally::setLimit(const size_t bytes) {
+  std::lock_guard<std::mutex> lock(mLock);
+  mLimit = bytes;
+}
+
+size_t MemoryTally::getLimit() const {
+  std::lock_guard<std::mutex> lock(mLock);
+  return mLimit;
+}
+
+size_t MemoryTally::getTotalBytes() const {
+  return totalBytes(getFootprints());
+}
+
+std::vector<MemoryFootprint> MemoryTally::getFootprints() const {
+  std::vector<MemoryFootprint> ans;
+  {
+    std::lock_guard<std::mutex> lock(mLock);
+    for (const auto& tracked : mModels) {
+      ans.push_back(tracked.second->memoryFootprint());
+      ans.back().setName(tracked.first);
+    }
+  }
+  std::stable_sort(ans.begin(), ans.end(),
+    [](const MemoryFootprint& a, const MemoryFootprint& b) {
+    return a.getTotalBytes() > b.getTotalBytes();
+  });
+  return ans;
+}
+
+size_t MemoryTally::totalBytes(
+  const std::vector<MemoryFootprint>& footprints) const {
+  size_t owned = 0;
+  std::unordered_map<const void*, size_t> buffers;
+  for (const auto& footprint : footprints) {
+    owned += footprint.getOwnedBytes();
+    footprint.collectShared(buffers);
+  }
+  size_t shared = 0;
+  for (const auto& buffer : buffers)
+    shared += buffer.second;
+  return owned + shared;
+}
+
+}  // namespace ssig
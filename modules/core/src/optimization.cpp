@@ -40,6 +40,12 @@
 *****************************************************************************L*/
 
 #include "ssiglib/core/optimization.hpp"
+#include "ssiglib/core/math.hpp"
+#include "ssiglib/core/evaluation_cache.hpp"
+#include "ssiglib/core/profiler.hpp"
+// c++
+#include <unordered_map>
+#include <vector>
 
 namespace ssig {
 cv::Mat_<float> Optimization::getResults() const {
@@ -75,6 +81,90 @@ void Optimization::setUtilityFunctor(
   utility = utilityFunctor;
 }
 
+cv::Ptr<BatchUtilityFunctor> Optimization::getBatchUtility() const {
+  return batchUtility;
+}
+
+void Optimization::setBatchUtilityFunctor(
+  cv::Ptr<BatchUtilityFunctor>& batchUtilityFunctor) {
+  batchUtility = batchUtilityFunctor;
+}
+
+void Optimization::evaluate(const cv::Mat& population,
+                            cv::Mat_<float>& utilities) const {
+  SSIG_PROFILE_SCOPE("Optimization::evaluate");
+  if (!mCache) {
+    score(population, utilities);
+    return;
+  }
+
+  const int len = population.rows;
+  cv::Mat_<float> answer(len, 1);
+  // rows sharing a key within the population are scored once
+  std::vector<EvaluationCache::Key> pendingKeys;
+  std::vector<std::vector<int>> pendingRows;
+  std::unordered_map<EvaluationCache::Key, int,
+    EvaluationCache::KeyHash> slots;
+  for (int i = 0; i < len; ++i) {
+    EvaluationCache::Key key = mCache->makeKey(population.row(i));
+    float utility;
+    if (mCache->lookup(key, utility)) {
+      answer(i) = utility;
+      continue;
+    }
+    auto slot = slots.find(key);
+    if (slot == slots.end()) {
+      slot = slots.emplace(key, static_cast<int>(pendingKeys.size())).first;
+      pendingKeys.push_back(std::move(key));
+      pendingRows.emplace_back();
+    }
+    pendingRows[slot->second].push_back(i);
+  }
+
+  if (!pendingKeys.empty()) {
+    cv::Mat pending(static_cast<int>(pendingKeys.size()), population.cols,
+                    population.type());
+    for (int p = 0; p < pending.rows; ++p)
+      population.row(pendingRows[p][0]).copyTo(pending.row(p));
+    cv::Mat_<float> scores;
+    score(pending, scores);
+    for (int p = 0; p < pending.rows; ++p) {
+      mCache->insert(pendingKeys[p], scores(p));
+      for (const int row : pendingRows[p])
+        answer(row) = scores(p);
+    }
+  }
+  utilities = answer;
+}
+
+cv::Ptr<EvaluationCache> Optimization::getEvaluationCache() const {
+  return mCache;
+}
+
+void Optimization::setEvaluationCache(cv::Ptr<EvaluationCache>& cache) {
+  mCache = cache;
+}
+
+MemoryFootprint Optimization::memoryFootprint() const {
+  MemoryFootprint ans = Algorithm::memoryFootprint();
+  ans.addMat("population", mPopulation);
+  ans.addMat("utilities", mUtilities);
+  if (mCache)
+    ans.addShared("evaluationCache", mCache->getMemorySize(), mCache.get());
+  return ans;
+}
+
+void Optimization::score(const cv::Mat& population,
+                         cv::Mat_<float>& utilities) const {
+  SSIG_PROFILE_COUNT("Optimization::score.candidates", population.rows);
+  if (batchUtility) {
+    (*batchUtility)(population, utilities);
+  } else {
+    UtilityBatchAdapter adapter(utility);
+    adapter(population, utilities);
+  }
+}
+
 void Optimization::setDistanceFunctor(
   cv::Ptr<DistanceFunctor>& distanceFunctor) {
   distance = distanceFunctor;
@@ -88,22 +178,20 @@ void Optimization::setEps(const double eps) {
   mEps = eps;
 }
 
+bool Optimization::getSteadyState() const {
+  return mSteadyState;
+}
+
+void Optimization::setSteadyState(const bool steadyState) {
+  mSteadyState = steadyState;
+}
+
 Optimization::Optimization(
   cv::Ptr<UtilityFunctor>& utilityFunction,
   cv::Ptr<DistanceFunctor>& distanceFunction) :
   utility(utilityFunction),
   distance(distanceFunction) {}
 
-cv::Mat_<float> ssig::Optimization::
-randomVector(const int dimensionality,
-  const double minRange,
-  const double maxRange) {
-  cv::Mat_<float> vec(1, dimensionality);
-  cv::randu(vec, cv::Scalar::all(minRange),
-            cv::Scalar::all(maxRange));
-  return vec;
-}
-
 }  // namespace ssig
 
 
@@ -0,0 +1,289 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include "ssiglib/core/profiler.hpp"
+// c++
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+namespace ssig {
+
+const int Profiler::Histogram::kSubBuckets;
+const int Profiler::Histogram::kBuckets;
+
+struct Profiler::ThreadTables {
+  // keyed on the literal itself, names are merged by value when read
+  std::unordered_map<const char*, Histogram> timings;
+  std::unordered_map<const char*, int64_t> counters;
+  // only contended while the tables are being read
+  std::mutex lock;
+
+  ~ThreadTables() {
+    Profiler::instance().retire(this);
+  }
+};
+
+Profiler& Profiler::instance() {
+  // never destroyed, threads may still retire their tables at exit
+  static Profiler* profiler = new Profiler();
+  return *profiler;
+}
+
+bool Profiler::isCompiledIn() {
+#ifdef SSIG_WITH_PROFILER
+  return true;
+#else
+  return false;
+#endif
+}
+
+Profiler::ThreadTables& Profiler::local() {
+  thread_local std::unique_ptr<ThreadTables> tables;
+  if (!tables) {
+    tables.reset(new ThreadTables());
+    std::lock_guard<std::mutex> guard(mLock);
+    mThreads.push_back(tables.get());
+  }
+  return *tables;
+}
+
+void Profiler::retire(ThreadTables* tables) {
+  std::lock_guard<std::mutex> guard(mLock);
+  for (const auto& timing : tables->timings)
+    mRetiredTimings[timing.first].merge(timing.second);
+  for (const auto& counter : tables->counters)
+    mRetiredCounters[counter.first] += counter.second;
+  mThreads.erase(std::remove(mThreads.begin(), mThreads.end(), tables),
+                 mThreads.end());
+}
+
+void Profiler::addSample(const char* name, const double seconds) {
+  ThreadTables& tables = local();
+  std::lock_guard<std::mutex> guard(tables.lock);
+  tables.timings[name].add(seconds);
+}
+
+void Profiler::addCount(const char* name, const int64_t value) {
+  ThreadTables& tables = local();
+  std::lock_guard<std::mutex> guard(tables.lock);
+  tables.counters[name] += value;
+}
+
+std::vector<Profiler::Timing> Profiler::getTimings() const {
+  std::map<std::string, Histogram> merged;
+  {
+    std::lock_guard<std::mutex> guard(mLock);
+    for (const auto& timing : mRetiredTimings)
+      merged[timing.first].merge(timing.second);
+    for (ThreadTables* tables : mThreads) {
+      std::lock_guard<std::mutex> tablesGuard(tables->lock);
+      for (const auto& timing : tables->timings)
+        merged[timing.first].merge(timing.second);
+    }
+  }
+
+  std::vector<Timing> timings;
+  timings.reserve(merged.size());
+  for (const auto& entry : merged) {
+    const Histogram& histogram = entry.second;
+    Timing timing;
+    timing.name = entry.first;
+    timing.calls = histogram.calls;
+    timing.total = histogram.total;
+    timing.min = histogram.min;
+    timing.max = histogram.max;
+    timing.p50 = histogram.percentile(0.5);
+    timing.p99 = histogram.percentile(0.99);
+    timings.push_back(timing);
+  }
+  return timings;
+}
+
+std::vector<std::pair<std::string, int64_t>> Profiler::getCounters() const {
+  std::map<std::string, int64_t> merged;
+  {
+    std::lock_guard<std::mutex> guard(mLock);
+    for (const auto& counter : mRetiredCounters)
+      merged[counter.first] += counter.second;
+    for (ThreadTables* tables : mThreads) {
+      std::lock_guard<std::mutex> tablesGuard(tables->lock);
+      for (const auto& counter : tables->counters)
+        merged[counter.first] += counter.second;
+    }
+  }
+  return std::vector<std::pair<std::string, int64_t>>(merged.begin(),
+                                                      merged.end());
+}
+
+void Profiler::reset() {
+  std::lock_guard<std::mutex> guard(mLock);
+  mRetiredTimings.clear();
+  mRetiredCounters.clear();
+  for (ThreadTables* tables : mThreads) {
+    std::lock_guard<std::mutex> tablesGuard(tables->lock);
+    tables->timings.clear();
+    tables->counters.clear();
+  }
+}
+
+static std::string quote(const std::string& text) {
+  std::string ans = "\"";
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      ans += '\\';
+      ans += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char escaped[8];
+      snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      ans += escaped;
+    } else {
+      ans += c;
+    }
+  }
+  return ans + "\"";
+}
+
+std::string Profiler::toJson() const {
+  const auto timings = getTimings();
+  const auto counters = getCounters();
+  std::ostringstream json;
+  json.precision(6);
+  json << std::fixed;
+  json << "{\n  \"timings\": [";
+  for (size_t i = 0; i < timings.size(); ++i) {
+    const Timing& t = timings[i];
+    json << (i ? ",\n" : "\n") << "    {\"name\": " << quote(t.name)
+      << ", \"calls\": " << t.calls
+      << ", \"total_ms\": " << 1e3 * t.total
+      << ", \"mean_ms\": " << 1e3 * t.total / std::max<int64_t>(t.calls, 1)
+      << ", \"min_ms\": " << 1e3 * t.min
+      << ", \"p50_ms\": " << 1e3 * t.p50
+      << ", \"p99_ms\": " << 1e3 * t.p99
+      << ", \"max_ms\": " << 1e3 * t.max << "}";
+  }
+  json << (timings.empty() ? "]" : "\n  ]") << ",\n  \"counters\": [";
+  for (size_t i = 0; i < counters.size(); ++i) {
+    json << (i ? ",\n" : "\n") << "    {\"name\": "
+      << quote(counters[i].first) << ", \"value\": "
+      << counters[i].second << "}";
+  }
+  json << (counters.empty() ? "]" : "\n  ]") << "\n}\n";
+  return json.str();
+}
+
+void Profiler::dump(const std::string& filename) const {
+  std::ofstream file(filename);
+  if (!file)
+    throw std::runtime_error("Could not open " + filename);
+  file << toJson();
+}
+
+void Profiler::Histogram::add(const double seconds) {
+  if (counts.empty())
+    counts.assign(kBuckets, 0);
+  if (calls == 0 || seconds < min)
+    min = seconds;
+  if (calls == 0 || seconds > max)
+    max = seconds;
+  ++calls;
+  total += seconds;
+  const double ns = std::max(seconds, 0.0) * 1e9;
+  ++counts[bucket(static_cast<uint64_t>(ns))];
+}
+
+void Profiler::Histogram::merge(const Histogram& rhs) {
+  if (rhs.calls == 0)
+    return;
+  if (counts.empty())
+    counts.assign(kBuckets, 0);
+  min = (calls == 0) ? rhs.min : std::min(min, rhs.min);
+  max = (calls == 0) ? rhs.max : std::max(max, rhs.max);
+  calls += rhs.calls;
+  total += rhs.total;
+  for (int b = 0; b < kBuckets; ++b)
+    counts[b] += rhs.counts[b];
+}
+
+double Profiler::Histogram::percentile(const double p) const {
+  if (calls == 0)
+    return 0;
+  const int64_t rank = std::max<int64_t>(1,
+    static_cast<int64_t>(std::ceil(p * static_cast<double>(calls))));
+  int64_t seen = 0;
+  int b = 0;
+  for (; b < kBuckets - 1; ++b) {
+    seen += counts[b];
+    if (seen >= rank)
+      break;
+  }
+  // the middle of the bucket, never outside the observed range
+  const double lower = static_cast<double>(lowerBound(b));
+  const double upper = (b + 1 < kBuckets) ?
+    static_cast<double>(lowerBound(b + 1)) : lower;
+  const double value = 0.5 * (lower + upper) * 1e-9;
+  return std::min(max, std::max(min, value));
+}
+
+int Profiler::Histogram::bucket(const uint64_t nanoseconds) {
+  if (nanoseconds < kSubBuckets)
+    return static_cast<int>(nanoseconds);
+  int msb = 0;
+  for (uint64_t v = nanoseconds; v > 1; v >>= 1)
+    ++msb;
+  const int sub = static_cast<int>(nanoseconds >> (msb - 4)) - kSubBuckets;
+  return (msb - 3) * kSubBuckets + sub;
+}
+
+uint64_t Profiler::Histogram::lowerBound(const int bucket) {
+  if (bucket < kSubBuckets)
+    return static_cast<uint64_t>(bucket);
+  const int msb = bucket / kSubBuckets + 3;
+  const uint64_t sub = static_cast<uint64_t>(bucket % kSubBuckets);
+  return (kSubBuckets + sub) << (msb - 4);
+}
+
+}  // namespace ssig
@@ -39,17 +39,17 @@
 *  POSSIBILITY OF SUCH DAMAGE.
 *****************************************************************************L*/
 // c++
+#include <deque>
+#include <mutex>
 #include <utility>
-#include <random>
-// c
-#include <ctime>
+#include <vector>
 // opencv
 #include <opencv2/core.hpp>
 // ssiglib
 #include "ssiglib/core/pso.hpp"
 #include "ssiglib/core/math.hpp"
-
-static std::mt19937 gen(static_cast<uint>(time(nullptr)));
+#include "ssiglib/core/rng.hpp"
+#include "ssiglib/core/profiler.hpp"
 
 namespace ssig {
 cv::Ptr<PSO> PSO::create(
@@ -67,17 +67,11 @@ cv::Ptr<PSO> PSO::create(
 }
 
 void PSO::setup(const cv::Mat_<float>& input) {
-  if (input.empty()) {
-    mPopulation = cv::Mat_<float>::zeros(mPopulationLength, mDimensions);
-    for (int i = 0; i < mPopulationLength; ++i) {
-      for (int d = 0; d < mDimensions; ++d) {
-        std::uniform_real_distribution<float> randu(mMinRange.at<float>(d),
-          mMaxRange.at<float>(d));
-        mPopulation.at<float>(i, d) = randu(gen);
-      }
-    }
+  const bool randomPopulation = input.empty();
+  if (randomPopulation) {
+    mPopulation.create(mPopulationLength, mDimensions);
   } else {
-    mPopulation = input;
+    mPopulation = input.clone();
     const int D = mPopulation.cols;
     double min, max;
     mMinRange = cv::Mat::zeros(1, D, CV_32F);
@@ -89,49 +83,55 @@ void PSO::setup(const cv::Mat_<float>& input) {
     }
   }
 
-  mVelocities = cv::Mat::zeros(mPopulationLength, mPopulation.cols, CV_32F);
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-  for (int i = 0; i < mPopulationLength; ++i) {
-    cv::RNG lRng(static_cast<uint64>(time(nullptr)));
-
-    cv::Scalar stddev(2);
-    cv::Scalar mean(0);
-    cv::randn(mVelocities.row(i), mean, stddev);
-  }
-
   mDimensions = mPopulation.cols;
   mPopulationLength = mPopulation.rows;
+  mIteration = 0;
+  mBestUtil = -FLT_MAX;
+
+  mVelocities.create(mPopulationLength, mDimensions, CV_32F);
+  const uint64_t key = deriveSeed(RNG_PSO, static_cast<uint64_t>(mSeed));
+  Executor::global().parallelFor(0, mPopulationLength,
+    [&](const int first, const int last) {
+    for (int i = first; i < last; ++i) {
+      // stream (0, i) belongs to the initialization of particle i
+      PhiloxRng rng(key, PhiloxRng::stream(0, i));
+      if (randomPopulation) {
+        for (int d = 0; d < mDimensions; ++d) {
+          mPopulation(i, d) = rng.uniform(mMinRange.at<float>(d),
+                                          mMaxRange.at<float>(d));
+        }
+      }
+      float* velocity = mVelocities.ptr<float>(i);
+      for (int d = 0; d < mDimensions; ++d)
+        velocity[d] = rng.gaussian(2.f);
+    }
+  });
 
   mLocalBests = mPopulation.clone();
   mLocalUtils.resize(mPopulationLength);
   mUtilities = cv::Mat_<float>::zeros(mPopulationLength, 1);
   mBestPosition = mPopulation.row(0).clone();
 
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
+  evaluate(mPopulation, mUtilities);
   for (int i = 0; i < mPopulationLength; ++i) {
-    cv::Mat row = mPopulation.row(i);
-    float util = (*utility)(row);
+    const float util = mUtilities(i);
     mLocalUtils[i] = util;
-    mUtilities.at<float>(i) = util;
-#ifdef _OPENMP
-#pragma omp critical
-#endif
     if (util > mBestUtil) {
       mBestUtil = util;
-      for (int d = 0; d < mBestPosition.cols; ++d) {
-        mBestPosition.at<float>(d) = row.at<float>(d);
-      }
+      mPopulation.row(i).copyTo(mBestPosition);
     }
   }
 }
 
 void PSO::learn(const cv::Mat_<float>& input) {
+  SSIG_PROFILE_SCOPE("PSO::learn");
   setup(input);
 
+  if (mSteadyState) {
+    learnSteadyState();
+    return;
+  }
+
   float pastUtil = -FLT_MAX;
   for (int it = 0; it < mMaxIterations; ++it) {
     iterate();
@@ -142,35 +142,112 @@ void PSO::learn(const cv::Mat_<float>& input) {
 }
 
 void PSO::iterate() {
-  #ifdef _OPENMP
-  #pragma omp parallel for
-  #endif
-  for (int r = 0; r < mPopulationLength; ++r) {
-    cv::Mat position = mPopulation.row(r),
-      localBest = mLocalBests.row(r),
-      vel = mVelocities.row(r);
-    update(mBestPosition, localBest, mInertia, vel, position);
-
-    float currentUtil = (*utility)(position);
-    mLocalUtils[r] = currentUtil;
-    #ifdef _OPENMP
-    #pragma omp critical
-    #endif
-    {
-      if (currentUtil >= mBestUtil) {
-        for (int d = 0; d < position.cols; ++d) {
-          mBestPosition.at<float>(d) = position.at<float>(d);
-        }
-        mBestUtil = currentUtil;
+  ++mIteration;
+  cv::Mat_<float> coefficients(mPopulationLength, 2);
+  const uint64_t key = deriveSeed(RNG_PSO, static_cast<uint64_t>(mSeed));
+  Executor::global().parallelFor(0, mPopulationLength,
+    [&](const int first, const int last) {
+    for (int r = first; r < last; ++r) {
+      PhiloxRng rng(key, PhiloxRng::stream(mIteration, r));
+      coefficients(r, 0) = rng.uniform();
+      coefficients(r, 1) = rng.uniform();
+    }
+  });
+  update(mBestPosition, mLocalBests, mInertia, coefficients,
+         mVelocities, mPopulation);
+
+  // the whole swarm is scored at once, the bests are updated afterwards
+  cv::Mat_<float> utilities;
+  evaluate(mPopulation, utilities);
+
+  // every chunk keeps its own candidate for the global best. Ties are broken
+  // explicitly by the highest particle index, as in a serial scan, so the
+  // winner does not depend on how the chunks are combined
+  typedef std::pair<float, int> Candidate;
+  const Candidate best = Executor::global().parallelReduce(0,
+    mPopulationLength, std::make_pair(-FLT_MAX, -1),
+    [&](const int first, const int last) {
+    Candidate chunkBest(-FLT_MAX, -1);
+    for (int r = first; r < last; ++r) {
+      const float currentUtil = utilities(r);
+      mLocalUtils[r] = currentUtil;
+      if (currentUtil >= mUtilities(r)) {
+        mPopulation.row(r).copyTo(mLocalBests.row(r));
+        mUtilities(r) = currentUtil;
       }
-      if (currentUtil >= mUtilities.at<float>(r)) {
-        for (int d = 0; d < position.cols; ++d) {
-          mLocalBests.at<float>(r, d) = position.at<float>(d);
+      if (currentUtil >= chunkBest.first)
+        chunkBest = std::make_pair(currentUtil, r);
+    }
+    return chunkBest;
+  },
+    [](const Candidate& acc, const Candidate& candidate) {
+    const bool better = candidate.second >= 0 &&
+      (candidate.first > acc.first ||
+       (candidate.first == acc.first && candidate.second > acc.second));
+    return better ? candidate : acc;
+  });
+  if (best.second >= 0 && best.first >= mBestUtil) {
+    mPopulation.row(best.second).copyTo(mBestPosition);
+    mBestUtil = best.first;
+  }
+}
+
+void PSO::learnSteadyState() {
+  const int budget = mMaxIterations * mPopulationLength;
+  std::deque<int> idle;
+  for (int i = 0; i < mPopulationLength; ++i)
+    idle.push_back(i);
+  int issued = 0;
+  std::mutex lock;
+
+  // one long running loop per thread, each claims the next idle particle
+  const int nWorkers = Executor::global().getConcurrency();
+  const uint64_t key = deriveSeed(RNG_PSO, static_cast<uint64_t>(mSeed));
+  Executor::global().parallelFor(0, nWorkers,
+    [&](const int, const int) {
+    cv::Mat globalBest;
+    cv::Mat_<float> coefficients(1, 2);
+    cv::Mat_<float> utility;
+    while (true) {
+      int particle, evaluation;
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        if (issued >= budget || idle.empty())
+          break;
+        evaluation = issued++;
+        particle = idle.front();
+        idle.pop_front();
+        mBestPosition.copyTo(globalBest);
+      }
+
+      // a particle is owned by one thread until it is back in the queue
+      PhiloxRng rng(key,
+        PhiloxRng::stream(1 + evaluation / mPopulationLength, particle));
+      coefficients(0, 0) = rng.uniform();
+      coefficients(0, 1) = rng.uniform();
+      cv::Mat position = mPopulation.row(particle),
+        velocity = mVelocities.row(particle);
+      update(globalBest, mLocalBests.row(particle), mInertia, coefficients,
+             velocity, position);
+
+      evaluate(position, utility);
+      const float currentUtil = utility(0);
+      mLocalUtils[particle] = currentUtil;
+      if (currentUtil >= mUtilities(particle)) {
+        position.copyTo(mLocalBests.row(particle));
+        mUtilities(particle) = currentUtil;
+      }
+
+      {
+        std::lock_guard<std::mutex> guard(lock);
+        if (currentUtil >= mBestUtil) {
+          position.copyTo(mBestPosition);
+          mBestUtil = currentUtil;
         }
-        mUtilities.at<float>(r) = currentUtil;
+        idle.push_back(particle);
       }
     }
-  }
+  });
 }
 
 cv::Vec3f PSO::getInertia() const {
@@ -215,9 +292,29 @@ float PSO::getBestUtil() const {
   return mBestUtil;
 }
 
+void PSO::setSeed(int seed) {
+  mSeed = seed;
+}
+
+int PSO::getSeed() const {
+  return mSeed;
+}
+
+MemoryFootprint PSO::memoryFootprint() const {
+  MemoryFootprint ans = Optimization::memoryFootprint();
+  ans.addMat("bestPosition", mBestPosition);
+  ans.addMat("localBests", mLocalBests);
+  ans.addMat("velocities", mVelocities);
+  ans.addMat("minRange", mMinRange);
+  ans.addMat("maxRange", mMaxRange);
+  ans.addOwned("localUtils", mLocalUtils.capacity() * sizeof(float));
+  return ans;
+}
+
 PSO::PSO(const PSO& rhs) {
   setDimensionality(rhs.mDimensions);
   setInertia(rhs.getInertia());
+  setSeed(rhs.getSeed());
   getPopulationConstraint(mMinRange, mMaxRange);
   setPopulationLength(getPopulationLength());
   setEps(getEps());
@@ -230,24 +327,31 @@ PSO::PSO(
   Optimization(utility, distance) {}
 
 void PSO::update(const cv::Mat& globalBest,
-  const cv::Mat& localBest,
+  const cv::Mat& localBests,
   const cv::Vec3f& inertia,
-  cv::Mat& velocity,
-  cv::Mat& position) {
-  static std::uniform_real_distribution<float> dist(0.0f, 1000.0f);
-
-  float R1 = (dist(gen)) / 1000.f;
-  float R2 = (dist(gen)) / 1000.f;
-  // v = w_1*v + w_2*R1(LB - X)+ w_3*R2(GB - X) :
-  cv::Mat term1 = velocity * inertia[0];
-  cv::Mat term2 = (localBest - position) * inertia[1] * R1;
-  cv::Mat term3 = (globalBest - position) * (inertia[2] * R2);
-
-  velocity = term1 + term2 + term3;
-
-  // X = X + v :
-  position = position + velocity;
+  const cv::Mat_<float>& coefficients,
+  cv::Mat& velocities,
+  cv::Mat& positions) {
+  const int D = positions.cols;
+  const float* gb = globalBest.ptr<float>(0);
+  Executor::global().parallelFor(0, positions.rows,
+    [&](const int first, const int last) {
+    for (int r = first; r < last; ++r) {
+      const float* lb = localBests.ptr<float>(r);
+      float* v = velocities.ptr<float>(r);
+      float* x = positions.ptr<float>(r);
+      const float c1 = inertia[1] * coefficients(r, 0);
+      const float c2 = inertia[2] * coefficients(r, 1);
+      for (int d = 0; d < D; ++d) {
+        // v = w_1*v + w_2*R1(LB - X)+ w_3*R2(GB - X) :
+        const float vel = inertia[0] * v[d] + c1 * (lb[d] - x[d]) +
+          c2 * (gb[d] - x[d]);
+        v[d] = vel;
+        // X = X + v :
+        x[d] += vel;
+      }
+    }
+  });
 }
 
 }  // namespace ssig
-
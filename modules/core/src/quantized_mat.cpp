@@ -0,0 +1,207 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include "ssiglib/core/quantized_mat.hpp"
+// c++
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace ssig {
+
+QuantizedMat::QuantizedMat(const cv::Mat& m, const Format format)
+  : mFormat(format) {
+  if (m.channels() != 1)
+    throw std::invalid_argument("QuantizedMat needs a single channel matrix");
+  cv::Mat_<float> values;
+  m.convertTo(values, CV_32F);
+  const int rows = values.rows, cols = values.cols;
+
+  if (format == FLOAT16) {
+    mCodes.create(rows, cols, CV_16U);
+    for (int r = 0; r < rows; ++r) {
+      const float* src = values[r];
+      uint16_t* dst = mCodes.ptr<uint16_t>(r);
+      for (int c = 0; c < cols; ++c)
+        dst[c] = toHalf(src[c]);
+    }
+    return;
+  }
+
+  cv::Mat_<float> minimum, maximum;
+  cv::reduce(values, minimum, 0, cv::REDUCE_MIN);
+  cv::reduce(values, maximum, 0, cv::REDUCE_MAX);
+  mOffset = minimum;
+  mScale = (maximum - minimum) / 255.f;
+  // a constant column keeps the zero scale and encodes to zero
+  cv::Mat_<float> inverse(1, cols);
+  for (int c = 0; c < cols; ++c)
+    inverse(c) = mScale(c) > 0 ? 1.f / mScale(c) : 0.f;
+
+  mCodes.create(rows, cols, CV_8U);
+  for (int r = 0; r < rows; ++r) {
+    const float* src = values[r];
+    uint8_t* dst = mCodes.ptr<uint8_t>(r);
+    for (int c = 0; c < cols; ++c) {
+      const float code = std::round((src[c] - mOffset(c)) * inverse(c));
+      dst[c] = static_cast<uint8_t>(std::min(255.f, std::max(0.f, code)));
+    }
+  }
+}
+
+QuantizedMat::Format QuantizedMat::getFormat() const {
+  return mFormat;
+}
+
+int QuantizedMat::getNumRows() const {
+  return mCodes.rows;
+}
+
+int QuantizedMat::getNumCols() const {
+  return mCodes.cols;
+}
+
+bool QuantizedMat::empty() const {
+  return mCodes.empty();
+}
+
+size_t QuantizedMat::getMemorySize() const {
+  return mCodes.total() * mCodes.elemSize() +
+    (mScale.total() + mOffset.total()) * sizeof(float);
+}
+
+const cv::Mat& QuantizedMat::getCodes() const {
+  return mCodes;
+}
+
+const cv::Mat_<float>& QuantizedMat::getScale() const {
+  return mScale;
+}
+
+const cv::Mat_<float>& QuantizedMat::getOffset() const {
+  return mOffset;
+}
+
+QuantizedMat QuantizedMat::rowRange(const int begin, const int end) const {
+  QuantizedMat ans;
+  ans.mFormat = mFormat;
+  ans.mCodes = mCodes.rowRange(begin, end);
+  ans.mScale = mScale;
+  ans.mOffset = mOffset;
+  return ans;
+}
+
+void QuantizedMat::decodeRow(const int row, float* out) const {
+  const int cols = mCodes.cols;
+  if (mFormat == FLOAT16) {
+    const uint16_t* codes = mCodes.ptr<uint16_t>(row);
+    for (int c = 0; c < cols; ++c)
+      out[c] = fromHalf(codes[c]);
+  } else {
+    const uint8_t* codes = mCodes.ptr<uint8_t>(row);
+    const float* scale = mScale[0];
+    const float* offset = mOffset[0];
+    for (int c = 0; c < cols; ++c)
+      out[c] = offset[c] + scale[c] * static_cast<float>(codes[c]);
+  }
+}
+
+void QuantizedMat::decodeRows(const int begin, const int end,
+                              cv::Mat_<float>& out) const {
+  out.create(end - begin, mCodes.cols);
+  for (int r = begin; r < end; ++r)
+    decodeRow(r, out[r - begin]);
+}
+
+cv::Mat_<float> QuantizedMat::toFloat() const {
+  cv::Mat_<float> ans;
+  decodeRows(0, mCodes.rows, ans);
+  return ans;
+}
+
+uint16_t QuantizedMat::toHalf(const float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000u);
+  const uint32_t magnitude = bits & 0x7FFFFFFFu;
+
+  if (magnitude >= 0x7F800000u) {
+    // infinity, or a quiet NaN
+    return static_cast<uint16_t>(
+      sign | 0x7C00u | (magnitude > 0x7F800000u ? 0x200u : 0u));
+  }
+  if (magnitude >= 0x477FF000u) {
+    // 65520 and above round past the largest half
+    return static_cast<uint16_t>(sign | 0x7C00u);
+  }
+  if (magnitude < 0x38800000u) {
+    // subnormal half: the scaled value is exact, rint rounds it to even
+    float scaled;
+    std::memcpy(&scaled, &magnitude, sizeof(scaled));
+    return static_cast<uint16_t>(
+      sign | static_cast<uint16_t>(std::rint(scaled * 16777216.f)));
+  }
+  // rebias the exponent and round the mantissa to 10 bits, ties to even
+  uint32_t half = magnitude - 0x38000000u;
+  half += 0xFFFu + ((half >> 13) & 1u);
+  return static_cast<uint16_t>(sign | (half >> 13));
+}
+
+float QuantizedMat::fromHalf(const uint16_t value) {
+  const uint32_t sign = static_cast<uint32_t>(value & 0x8000u) << 16;
+  const uint32_t exponent = (value >> 10) & 0x1Fu;
+  const uint32_t mantissa = value & 0x3FFu;
+  uint32_t bits;
+  if (exponent == 0) {
+    const float magnitude = static_cast<float>(mantissa) / 16777216.f;
+    return sign ? -magnitude : magnitude;
+  } else if (exponent == 0x1F) {
+    bits = sign | 0x7F800000u | (mantissa << 13);
+  } else {
+    bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+  }
+  float ans;
+  std::memcpy(&ans, &bits, sizeof(ans));
+  return ans;
+}
+
+}  // namespace ssig
@@ -44,11 +44,100 @@
 #include <opencv2/features2d.hpp>
 #include <opencv2/imgproc.hpp>
 // c++
+#include <algorithm>
 #include <stdexcept>
 #include <vector>
 
 namespace ssig {
 
+namespace {
+// positions of a window of length win sliding by step over [0, len) with
+// start + win < len when strict, start + win <= len otherwise
+int gridPositions(const int len, const int win, const int step,
+                  const bool strict) {
+  const int last = strict ? len - win - 1 : len - win;
+  if (last < 0)
+    return 0;
+  return last / step + 1;
+}
+
+// a stride shorter than one pixel would never advance
+int strideStep(const float stride, const int win) {
+  return std::max(1, static_cast<int>(stride * win));
+}
+
+void checkStride(const float strideX, const float strideY) {
+  if ((strideX <= 0 && strideX > 1.0f) || (strideY <= 0 && strideY > 1.0f))
+    throw std::invalid_argument("stride must be in range (0,1]");
+}
+}  // namespace
+
+void WindowRange::addGrid(const cv::Size& winSize, const int stepX,
+                          const int stepY, const int nCols, const int nRows) {
+  if (nCols <= 0 || nRows <= 0)
+    return;
+  Grid grid;
+  grid.winSize = winSize;
+  grid.stepX = stepX;
+  grid.stepY = stepY;
+  grid.nCols = nCols;
+  grid.nRows = nRows;
+  grid.offset = mSize;
+  mGrids.push_back(grid);
+  mSize += static_cast<size_t>(nCols) * nRows;
+}
+
+size_t WindowRange::size() const {
+  return mSize;
+}
+
+bool WindowRange::empty() const {
+  return mSize == 0;
+}
+
+cv::Rect WindowRange::operator[](const size_t index) const {
+  CV_Assert(index < mSize);
+  // last grid whose offset is not past index
+  auto it = std::upper_bound(mGrids.begin(), mGrids.end(), index,
+    [](const size_t i, const Grid& grid) { return i < grid.offset; });
+  const Grid& grid = *(--it);
+  const size_t local = index - grid.offset;
+  const int row = static_cast<int>(local / grid.nCols);
+  const int col = static_cast<int>(local % grid.nCols);
+  return cv::Rect(col * grid.stepX, row * grid.stepY,
+                  grid.winSize.width, grid.winSize.height);
+}
+
+void WindowRange::chunk(const size_t first, const size_t last,
+                        std::vector<cv::Rect>& out) const {
+  const size_t end = std::min(last, mSize);
+  out.clear();
+  if (first >= end)
+    return;
+  out.reserve(end - first);
+  auto it = std::upper_bound(mGrids.begin(), mGrids.end(), first,
+    [](const size_t i, const Grid& grid) { return i < grid.offset; });
+  size_t g = static_cast<size_t>(it - mGrids.begin()) - 1;
+  size_t local = first - mGrids[g].offset;
+  for (size_t i = first; i < end; ++i) {
+    const Grid& grid = mGrids[g];
+    const int row = static_cast<int>(local / grid.nCols);
+    const int col = static_cast<int>(local % grid.nCols);
+    out.push_back(cv::Rect(col * grid.stepX, row * grid.stepY,
+                           grid.winSize.width, grid.winSize.height));
+    if (++local == static_cast<size_t>(grid.nCols) * grid.nRows) {
+      ++g;
+      local = 0;
+    }
+  }
+}
+
+std::vector<cv::Rect> WindowRange::toVector() const {
+  std::vector<cv::Rect> rects;
+  chunk(0, mSize, rects);
+  return rects;
+}
+
 Sampling::Sampling() {
   // Constructor
 }
@@ -138,26 +227,52 @@ std::vector<cv::Rect> Sampling::sampleImage(const int width, const int height,
                                             const int winHeight,
                                             const float strideX,
                                             const float strideY) {
-  if (width <= 0) throw std::invalid_argument("Width must be greater than 0");
-  if (height <= 0) throw std::invalid_argument("height must be greater than 0");
-  if ((strideX <= 0 && strideX > 1.0f) || (strideY <= 0 && strideY > 1.0f))
-    throw std::invalid_argument("stride must be in range (0,1]");
-
-  std::vector<cv::Rect> rects;
+  auto range = windowRange(width, height, winWidth, winHeight,
+                           strideX, strideY);
+  if (range.empty())
+    throw std::runtime_error("No Rect produced for the set scales");
+  return range.toVector();
+}
 
-  int h = static_cast<int>(winHeight), w = static_cast<int>(winWidth);
-  for (int y = 0; y + h < height; y += static_cast<int>(strideY * h)) {
-    for (int x = 0; x + w < width; x += static_cast<int>(strideX * w)) {
-      cv::Rect rect(x, y, w, h);
-      rects.push_back(rect);
-    }
-  }
-  if (rects.size() <= 0)
+std::vector<cv::Rect> Sampling::sampleImage(
+  const int width, const int height, const int winWidth, const int winHeight,
+  const float minScale, const float maxScale, const int nScales,
+  const float strideX, const float strideY) {
+  auto range = windowRange(width, height, winWidth, winHeight,
+                           minScale, maxScale, nScales, strideX, strideY);
+  if (range.empty())
     throw std::runtime_error("No Rect produced for the set scales");
-  return rects;
+  return range.toVector();
 }
 
 std::vector<cv::Rect> Sampling::sampleImage(
+  const int width, const int height, const int winWidth, const int winHeight,
+  const float minScale, const float maxScale, const float deltaScale,
+  const float strideX, const float strideY) {
+  auto range = windowRange(width, height, winWidth, winHeight,
+                           minScale, maxScale, deltaScale, strideX, strideY);
+  if (range.empty())
+    throw std::runtime_error("No Rect produced for the scales set");
+  return range.toVector();
+}
+
+WindowRange Sampling::windowRange(const int width, const int height,
+                                  const int winWidth, const int winHeight,
+                                  const float strideX, const float strideY) {
+  if (width <= 0) throw std::invalid_argument("Width must be greater than 0");
+  if (height <= 0) throw std::invalid_argument("height must be greater than 0");
+  checkStride(strideX, strideY);
+
+  WindowRange range;
+  const int h = winHeight, w = winWidth;
+  const int stepX = strideStep(strideX, w), stepY = strideStep(strideY, h);
+  range.addGrid(cv::Size(w, h), stepX, stepY,
+                gridPositions(width, w, stepX, true),
+                gridPositions(height, h, stepY, true));
+  return range;
+}
+
+WindowRange Sampling::windowRange(
   const int width, const int height, const int winWidth, const int winHeight,
   const float minScale, const float maxScale, const int nScales,
   const float strideX, const float strideY) {
@@ -165,32 +280,25 @@ std::vector<cv::Rect> Sampling::sampleImage(
   if (height <= 0) throw std::invalid_argument("height must be greater than 0");
   if (minScale > maxScale)
     throw std::invalid_argument("minScale must be greater than maxScale");
-  if ((strideX <= 0 && strideX > 1.0f) || (strideY <= 0 && strideY > 1.0f))
-    throw std::invalid_argument("stride must be in range (0,1]");
+  checkStride(strideX, strideY);
 
   float deltaScale =
     pow((maxScale / minScale), 1 / static_cast<float>(nScales));
-  // int samples = ((height / winHeight)*(width / winWidth)) / (80 *
-  // 80)*nScales;
-  std::vector<cv::Rect> rects;
+  WindowRange range;
   float scale = minScale;
   do {
-    int h = static_cast<int>(winHeight * scale),
+    const int h = static_cast<int>(winHeight * scale),
       w = static_cast<int>(winWidth * scale);
-    for (int y = 0; y <= height - h; y += static_cast<int>(strideY * h)) {
-      for (int x = 0; x <= width - w; x += static_cast<int>(strideX * w)) {
-        cv::Rect rect(x, y, w, h);
-        rects.push_back(rect);
-      }
-    }
+    const int stepX = strideStep(strideX, w), stepY = strideStep(strideY, h);
+    range.addGrid(cv::Size(w, h), stepX, stepY,
+                  gridPositions(width, w, stepX, false),
+                  gridPositions(height, h, stepY, false));
     scale *= deltaScale;
   } while (scale < maxScale);
-  if (rects.size() <= 0)
-    throw std::runtime_error("No Rect produced for the set scales");
-  return rects;
+  return range;
 }
 
-std::vector<cv::Rect> Sampling::sampleImage(
+WindowRange Sampling::windowRange(
   const int width, const int height, const int winWidth, const int winHeight,
   const float minScale, const float maxScale, const float deltaScale,
   const float strideX, const float strideY) {
@@ -203,22 +311,24 @@ std::vector<cv::Rect> Sampling::sampleImage(
   if (minScale > maxScale)
     throw std::invalid_argument("minScale must be greater than maxScale");
 
-  std::vector<cv::Rect> rects;
+  WindowRange range;
   for (float scale = minScale; scale < maxScale; scale *= deltaScale) {
-    int h = static_cast<int>(winHeight * scale),
+    const int h = static_cast<int>(winHeight * scale),
       w = static_cast<int>(winWidth * scale);
-    for (int y = 0; y < height - h; y += static_cast<int>(strideY * h)) {
-      for (int x = 0; x < width - w; x += static_cast<int>(strideX * w)) {
-        cv::Rect rect(x, y, w, h);
-        rects.push_back(rect);
-      }
-    }
+    const int stepX = strideStep(strideX, w), stepY = strideStep(strideY, h);
+    range.addGrid(cv::Size(w, h), stepX, stepY,
+                  gridPositions(width, w, stepX, true),
+                  gridPositions(height, h, stepY, true));
   }
-  if (rects.size() <= 0)
-    throw std::runtime_error("No Rect produced for the scales set");
-  return rects;
+  return range;
 }
 
-}  // namespace ssig
-
+WindowRange Sampling::windowRange(
+  const ImagePyramid& pyramid, const int level, const int winWidth,
+  const int winHeight, const float strideX, const float strideY) {
+  const cv::Mat& image = pyramid.getLevel(level);
+  return windowRange(image.cols, image.rows, winWidth, winHeight,
+                     strideX, strideY);
+}
 
+}  // namespace ssig
@@ -0,0 +1,336 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include "ssiglib/core/simd.hpp"
+// c++
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+// ssiglib
+#include "simd_kernels.hpp"
+
+#ifdef SSIG_SIMD_X86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace ssig {
+namespace simd {
+
+namespace {
+float scalarDot(const float* x, const float* y, const int len) {
+  float ans = 0.f;
+  for (int i = 0; i < len; ++i)
+    ans += x[i] * y[i];
+  return ans;
+}
+
+void scalarAxpy(const float alpha, const float* x, float* y, const int len) {
+  for (int i = 0; i < len; ++i)
+    y[i] += alpha * x[i];
+}
+
+float scalarL1(const float* x, const float* y, const int len) {
+  float ans = 0.f;
+  for (int i = 0; i < len; ++i)
+    ans += std::abs(x[i] - y[i]);
+  return ans;
+}
+
+float scalarSquaredL2(const float* x, const float* y, const int len) {
+  float ans = 0.f;
+  for (int i = 0; i < len; ++i)
+    ans += (x[i] - y[i]) * (x[i] - y[i]);
+  return ans;
+}
+
+float scalarChi2(const float* x, const float* y, const int len) {
+  float ans = 0.f;
+  for (int i = 0; i < len; ++i) {
+    const float sum = x[i] + y[i];
+    if (sum != 0.f)
+      ans += (x[i] - y[i]) * (x[i] - y[i]) / sum;
+  }
+  return ans;
+}
+
+void scalarHistogram(const int* bins, const float* weights, const int len,
+                     float* hist) {
+  if (weights) {
+    for (int i = 0; i < len; ++i)
+      hist[bins[i]] += weights[i];
+  } else {
+    for (int i = 0; i < len; ++i)
+      hist[bins[i]] += 1.f;
+  }
+}
+
+void scalarExp(const float* x, float* y, const int len) {
+  for (int i = 0; i < len; ++i)
+    y[i] = std::exp(x[i]);
+}
+
+void scalarLog(const float* x, float* y, const int len) {
+  for (int i = 0; i < len; ++i)
+    y[i] = std::log(x[i]);
+}
+
+void scalarSigmoid(const float* x, float* y, const int len) {
+  for (int i = 0; i < len; ++i)
+    y[i] = 1.f / (1.f + std::exp(-x[i]));
+}
+
+void scalarTanh(const float* x, float* y, const int len) {
+  for (int i = 0; i < len; ++i)
+    y[i] = std::tanh(x[i]);
+}
+
+int scalarArgmax(const float* x, const int len) {
+  int ans = len > 0 ? 0 : -1;
+  for (int i = 1; i < len; ++i)
+    if (x[i] > x[ans])
+      ans = i;
+  return ans;
+}
+
+#ifdef SSIG_SIMD_X86
+void cpuid(const int leaf, uint32_t regs[4]) {
+#ifdef _MSC_VER
+  int info[4];
+  __cpuidex(info, leaf, 0);
+  for (int i = 0; i < 4; ++i)
+    regs[i] = static_cast<uint32_t>(info[i]);
+#else
+  __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// register state the OS saves on context switches
+uint64_t enabledXsaveState() {
+#ifdef _MSC_VER
+  return _xgetbv(0);
+#else
+  uint32_t eax, edx;
+  __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
+
+Isa detectCpuIsa() {
+  uint32_t regs[4];
+  cpuid(0, regs);
+  const uint32_t maxLeaf = regs[0];
+  if (maxLeaf < 1)
+    return ISA_SCALAR;
+  cpuid(1, regs);
+  const uint32_t ecx1 = regs[2];
+  const bool sse42 = (ecx1 & (1u << 19)) && (ecx1 & (1u << 20));
+  if (!sse42)
+    return ISA_SCALAR;
+  const bool osxsave = (ecx1 & (1u << 27)) != 0;
+  const bool avx = (ecx1 & (1u << 28)) != 0;
+  const bool fma = (ecx1 & (1u << 12)) != 0;
+  if (!osxsave || !avx || !fma || maxLeaf < 7)
+    return ISA_SSE42;
+  const uint64_t xcr0 = enabledXsaveState();
+  // xmm and ymm
+  if ((xcr0 & 0x6) != 0x6)
+    return ISA_SSE42;
+  cpuid(7, regs);
+  const uint32_t ebx7 = regs[1];
+  if (!(ebx7 & (1u << 5)))
+    return ISA_SSE42;
+  // opmask and both halves of the zmm registers
+  if ((ebx7 & (1u << 16)) && (xcr0 & 0xe6) == 0xe6)
+    return ISA_AVX512;
+  return ISA_AVX2;
+}
+#else
+Isa detectCpuIsa() {
+  return ISA_SCALAR;
+}
+#endif
+
+const KernelTable* getKernels(const Isa isa) {
+  switch (isa) {
+    case ISA_AVX512:
+      return getAvx512Kernels();
+    case ISA_AVX2:
+      return getAvx2Kernels();
+    case ISA_SSE42:
+      return getSse42Kernels();
+    default:
+      return &getScalarKernels();
+  }
+}
+
+// lowest of the cpu, the build and the SSIG_SIMD variable
+Isa initialIsa() {
+  Isa isa = detectIsa();
+  const char* name = std::getenv("SSIG_SIMD");
+  if (name) {
+    for (int i = ISA_SCALAR; i < isa; ++i) {
+      if (std::strcmp(name, getIsaName(static_cast<Isa>(i))) == 0)
+        isa = static_cast<Isa>(i);
+    }
+  }
+  return isa;
+}
+
+std::atomic<int>& activeIsa() {
+  static std::atomic<int> isa(initialIsa());
+  return isa;
+}
+
+std::atomic<const KernelTable*>& activeKernels() {
+  static std::atomic<const KernelTable*> kernels(
+    getKernels(static_cast<Isa>(activeIsa().load())));
+  return kernels;
+}
+
+const KernelTable& kernels() {
+  return *activeKernels().load(std::memory_order_relaxed);
+}
+}  // namespace
+
+const KernelTable& getScalarKernels() {
+  static const KernelTable table = {
+    &scalarDot,
+    &scalarAxpy,
+    &scalarL1,
+    &scalarSquaredL2,
+    &scalarChi2,
+    &scalarHistogram,
+    &scalarExp,
+    &scalarLog,
+    &scalarSigmoid,
+    &scalarTanh,
+    &scalarArgmax
+  };
+  return table;
+}
+
+Isa detectIsa() {
+  static const Isa isa = [] {
+    Isa ans = detectCpuIsa();
+    while (ans != ISA_SCALAR && !getKernels(ans))
+      ans = static_cast<Isa>(ans - 1);
+    return ans;
+  }();
+  return isa;
+}
+
+Isa getIsa() {
+  return static_cast<Isa>(activeIsa().load());
+}
+
+Isa setIsa(const Isa isa) {
+  const Isa ans = isa < detectIsa() ? isa : detectIsa();
+  activeKernels().store(getKernels(ans));
+  activeIsa().store(ans);
+  return ans;
+}
+
+const char* getIsaName(const Isa isa) {
+  switch (isa) {
+    case ISA_AVX512:
+      return "avx512";
+    case ISA_AVX2:
+      return "avx2";
+    case ISA_SSE42:
+      return "sse42";
+    default:
+      return "scalar";
+  }
+}
+
+float dot(const float* x, const float* y, const int len) {
+  return kernels().dot(x, y, len);
+}
+
+void axpy(const float alpha, const float* x, float* y, const int len) {
+  kernels().axpy(alpha, x, y, len);
+}
+
+float l1Distance(const float* x, const float* y, const int len) {
+  return kernels().l1Distance(x, y, len);
+}
+
+float squaredL2Distance(const float* x, const float* y, const int len) {
+  return kernels().squaredL2Distance(x, y, len);
+}
+
+float chi2Distance(const float* x, const float* y, const int len) {
+  return kernels().chi2Distance(x, y, len);
+}
+
+void accumulateHistogram(const int* bins, const float* weights,
+                         const int len, float* hist) {
+  kernels().accumulateHistogram(bins, weights, len, hist);
+}
+
+void exp(const float* x, float* y, const int len) {
+  kernels().exp(x, y, len);
+}
+
+void log(const float* x, float* y, const int len) {
+  kernels().log(x, y, len);
+}
+
+void sigmoid(const float* x, float* y, const int len) {
+  kernels().sigmoid(x, y, len);
+}
+
+void tanh(const float* x, float* y, const int len) {
+  kernels().tanh(x, y, len);
+}
+
+int argmax(const float* x, const int len) {
+  return kernels().argmax(x, len);
+}
+
+}  // namespace simd
+}  // namespace ssig
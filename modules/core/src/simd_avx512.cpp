@@ -0,0 +1,112 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include "simd_kernels.hpp"
+
+#if defined(SSIG_SIMD_X86) && defined(__AVX512F__)
+#define SSIG_SIMD_AVX512
+#include <immintrin.h>
+#include "simd_vector.hpp"
+#endif
+
+namespace ssig {
+namespace simd {
+
+#ifdef SSIG_SIMD_AVX512
+namespace {
+struct Avx512 {
+  typedef __m512 F;
+  static const int kWidth = 16;
+
+  static F load(const float* p) { return _mm512_loadu_ps(p); }
+  static void store(float* p, const F x) { _mm512_storeu_ps(p, x); }
+  static F set1(const float v) { return _mm512_set1_ps(v); }
+  static F zero() { return _mm512_setzero_ps(); }
+  static F add(const F a, const F b) { return _mm512_add_ps(a, b); }
+  static F sub(const F a, const F b) { return _mm512_sub_ps(a, b); }
+  static F mul(const F a, const F b) { return _mm512_mul_ps(a, b); }
+  static F div(const F a, const F b) { return _mm512_div_ps(a, b); }
+  static F min(const F a, const F b) { return _mm512_min_ps(a, b); }
+  static F max(const F a, const F b) { return _mm512_max_ps(a, b); }
+  static F abs(const F x) {
+    return _mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(x),
+      _mm512_set1_epi32(0x7fffffff)));
+  }
+  static F fmadd(const F a, const F b, const F c) {
+    return _mm512_fmadd_ps(a, b, c);
+  }
+  static F selectGreater(const F a, const F b, const F x, const F y) {
+    return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(a, b, _CMP_GT_OQ), y, x);
+  }
+  static F round(const F x) {
+    return _mm512_roundscale_ps(x,
+      _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  }
+  static F pow2(const F n) {
+    const __m512i bits = _mm512_add_epi32(_mm512_cvtps_epi32(n),
+                                          _mm512_set1_epi32(127));
+    return _mm512_castsi512_ps(_mm512_slli_epi32(bits, 23));
+  }
+  static F splitExponent(const F x, F* exponent) {
+    const __m512i bits = _mm512_castps_si512(x);
+    *exponent = _mm512_cvtepi32_ps(_mm512_sub_epi32(
+      _mm512_srli_epi32(bits, 23), _mm512_set1_epi32(126)));
+    return _mm512_castsi512_ps(_mm512_or_si512(
+      _mm512_and_si512(bits, _mm512_set1_epi32(0x007fffff)),
+      _mm512_set1_epi32(0x3f000000)));
+  }
+  static float reduceAdd(const F x) { return _mm512_reduce_add_ps(x); }
+  static float reduceMax(const F x) { return _mm512_reduce_max_ps(x); }
+};
+}  // namespace
+
+const KernelTable* getAvx512Kernels() {
+  static const KernelTable table = makeKernelTable<Avx512>();
+  return &table;
+}
+#else
+const KernelTable* getAvx512Kernels() {
+  return nullptr;
+}
+#endif
+
+}  // namespace simd
+}  // namespace ssig
@@ -0,0 +1,79 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#ifndef _SSIG_CORE_SIMD_KERNELS_HPP_
+#define _SSIG_CORE_SIMD_KERNELS_HPP_
+
+#if defined(__x86_64__) || defined(_M_X64) || \
+  defined(__i386__) || defined(_M_IX86)
+#define SSIG_SIMD_X86
+#endif
+
+namespace ssig {
+namespace simd {
+
+// One entry per kernel of ssiglib/core/simd.hpp
+struct KernelTable {
+  float (*dot)(const float*, const float*, int);
+  void (*axpy)(float, const float*, float*, int);
+  float (*l1Distance)(const float*, const float*, int);
+  float (*squaredL2Distance)(const float*, const float*, int);
+  float (*chi2Distance)(const float*, const float*, int);
+  void (*accumulateHistogram)(const int*, const float*, int, float*);
+  void (*exp)(const float*, float*, int);
+  void (*log)(const float*, float*, int);
+  void (*sigmoid)(const float*, float*, int);
+  void (*tanh)(const float*, float*, int);
+  int (*argmax)(const float*, int);
+};
+
+// Each variant lives in its own translation unit, built with the flags of
+// its instruction set (see ssig_set_simd_flags). They return null when the
+// compiler did not enable those instructions.
+const KernelTable& getScalarKernels();
+const KernelTable* getSse42Kernels();
+const KernelTable* getAvx2Kernels();
+const KernelTable* getAvx512Kernels();
+
+}  // namespace simd
+}  // namespace ssig
+
+#endif  // !_SSIG_CORE_SIMD_KERNELS_HPP_
@@ -0,0 +1,115 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include "simd_kernels.hpp"
+
+#if defined(SSIG_SIMD_X86) && \
+  (defined(__SSE4_2__) || (defined(_MSC_VER) && !defined(__clang__)))
+#define SSIG_SIMD_SSE42
+#include <nmmintrin.h>
+#include "simd_vector.hpp"
+#endif
+
+namespace ssig {
+namespace simd {
+
+#ifdef SSIG_SIMD_SSE42
+namespace {
+struct Sse42 {
+  typedef __m128 F;
+  static const int kWidth = 4;
+
+  static F load(const float* p) { return _mm_loadu_ps(p); }
+  static void store(float* p, const F x) { _mm_storeu_ps(p, x); }
+  static F set1(const float v) { return _mm_set1_ps(v); }
+  static F zero() { return _mm_setzero_ps(); }
+  static F add(const F a, const F b) { return _mm_add_ps(a, b); }
+  static F sub(const F a, const F b) { return _mm_sub_ps(a, b); }
+  static F mul(const F a, const F b) { return _mm_mul_ps(a, b); }
+  static F div(const F a, const F b) { return _mm_div_ps(a, b); }
+  static F min(const F a, const F b) { return _mm_min_ps(a, b); }
+  static F max(const F a, const F b) { return _mm_max_ps(a, b); }
+  static F abs(const F x) { return _mm_andnot_ps(_mm_set1_ps(-0.f), x); }
+  static F fmadd(const F a, const F b, const F c) {
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+  }
+  static F selectGreater(const F a, const F b, const F x, const F y) {
+    return _mm_blendv_ps(y, x, _mm_cmpgt_ps(a, b));
+  }
+  static F round(const F x) {
+    return _mm_round_ps(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  }
+  static F pow2(const F n) {
+    const __m128i bits = _mm_add_epi32(_mm_cvtps_epi32(n),
+                                       _mm_set1_epi32(127));
+    return _mm_castsi128_ps(_mm_slli_epi32(bits, 23));
+  }
+  static F splitExponent(const F x, F* exponent) {
+    const __m128i bits = _mm_castps_si128(x);
+    *exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23),
+                                              _mm_set1_epi32(126)));
+    return _mm_castsi128_ps(_mm_or_si128(
+      _mm_and_si128(bits, _mm_set1_epi32(0x007fffff)),
+      _mm_set1_epi32(0x3f000000)));
+  }
+  static float reduceAdd(const F x) {
+    const F pairs = _mm_add_ps(x, _mm_movehl_ps(x, x));
+    return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+  }
+  static float reduceMax(const F x) {
+    const F pairs = _mm_max_ps(x, _mm_movehl_ps(x, x));
+    return _mm_cvtss_f32(_mm_max_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+  }
+};
+}  // namespace
+
+const KernelTable* getSse42Kernels() {
+  static const KernelTable table = makeKernelTable<Sse42>();
+  return &table;
+}
+#else
+const KernelTable* getSse42Kernels() {
+  return nullptr;
+}
+#endif
+
+}  // namespace simd
+}  // namespace ssig
@@ -0,0 +1,289 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#ifndef _SSIG_CORE_SIMD_VECTOR_HPP_
+#define _SSIG_CORE_SIMD_VECTOR_HPP_
+// ssiglib
+#include "simd_kernels.hpp"
+
+// Kernels written once against a vector traits class V, which provides
+//   F                      the register type, holding kWidth floats
+//   load, store, set1, zero
+//   add, sub, mul, div, min, max, abs
+//   fmadd(a, b, c)         a * b + c
+//   selectGreater(a, b, x, y)
+//                          x where a > b, y elsewhere
+//   round(x)               nearest integral value
+//   pow2(n)                2^n for integral n in [-126, 127]
+//   splitExponent(x, &e)   mantissa in [0.5, 1) and exponent of x > 0
+//   reduceAdd, reduceMax
+// Every variant includes this header from its own translation unit, so it
+// only holds internal linkage code: nothing compiled here with wider
+// instructions may be merged with, or picked instead of, a generic symbol.
+// For the same reason the kernels call no inline library functions.
+
+namespace ssig {
+namespace simd {
+namespace {
+
+template <class V>
+float dotKernel(const float* x, const float* y, const int len) {
+  const int w = V::kWidth;
+  typename V::F acc0 = V::zero(), acc1 = V::zero();
+  int i = 0;
+  for (; i + 2 * w <= len; i += 2 * w) {
+    acc0 = V::fmadd(V::load(x + i), V::load(y + i), acc0);
+    acc1 = V::fmadd(V::load(x + i + w), V::load(y + i + w), acc1);
+  }
+  for (; i + w <= len; i += w)
+    acc0 = V::fmadd(V::load(x + i), V::load(y + i), acc0);
+  float ans = V::reduceAdd(V::add(acc0, acc1));
+  for (; i < len; ++i)
+    ans += x[i] * y[i];
+  return ans;
+}
+
+template <class V>
+void axpyKernel(const float alpha, const float* x, float* y, const int len) {
+  const int w = V::kWidth;
+  const typename V::F a = V::set1(alpha);
+  int i = 0;
+  for (; i + w <= len; i += w)
+    V::store(y + i, V::fmadd(a, V::load(x + i), V::load(y + i)));
+  for (; i < len; ++i)
+    y[i] += alpha * x[i];
+}
+
+template <class V>
+float l1Kernel(const float* x, const float* y, const int len) {
+  const int w = V::kWidth;
+  typename V::F acc = V::zero();
+  int i = 0;
+  for (; i + w <= len; i += w)
+    acc = V::add(acc, V::abs(V::sub(V::load(x + i), V::load(y + i))));
+  float ans = V::reduceAdd(acc);
+  for (; i < len; ++i)
+    ans += x[i] > y[i] ? x[i] - y[i] : y[i] - x[i];
+  return ans;
+}
+
+template <class V>
+float squaredL2Kernel(const float* x, const float* y, const int len) {
+  const int w = V::kWidth;
+  typename V::F acc = V::zero();
+  int i = 0;
+  for (; i + w <= len; i += w) {
+    const typename V::F diff = V::sub(V::load(x + i), V::load(y + i));
+    acc = V::fmadd(diff, diff, acc);
+  }
+  float ans = V::reduceAdd(acc);
+  for (; i < len; ++i)
+    ans += (x[i] - y[i]) * (x[i] - y[i]);
+  return ans;
+}
+
+template <class V>
+float chi2Kernel(const float* x, const float* y, const int len) {
+  const int w = V::kWidth;
+  const typename V::F zero = V::zero();
+  typename V::F acc = zero;
+  int i = 0;
+  for (; i + w <= len; i += w) {
+    const typename V::F a = V::load(x + i);
+    const typename V::F b = V::load(y + i);
+    const typename V::F diff = V::sub(a, b);
+    const typename V::F sum = V::add(a, b);
+    const typename V::F term = V::div(V::mul(diff, diff), sum);
+    acc = V::add(acc, V::selectGreater(V::abs(sum), zero, term, zero));
+  }
+  float ans = V::reduceAdd(acc);
+  for (; i < len; ++i) {
+    const float sum = x[i] + y[i];
+    if (sum != 0.f)
+      ans += (x[i] - y[i]) * (x[i] - y[i]) / sum;
+  }
+  return ans;
+}
+
+// Cephes expf: e^x = 2^n * e^r with |r| <= ln(2) / 2
+template <class V>
+typename V::F expVector(typename V::F x) {
+  x = V::min(V::max(x, V::set1(-87.3f)), V::set1(88.3f));
+  const typename V::F n = V::round(V::mul(x, V::set1(1.44269504088896341f)));
+  x = V::sub(x, V::mul(n, V::set1(0.693359375f)));
+  x = V::sub(x, V::mul(n, V::set1(-2.12194440e-4f)));
+  typename V::F p = V::set1(1.9875691500e-4f);
+  p = V::fmadd(p, x, V::set1(1.3981999507e-3f));
+  p = V::fmadd(p, x, V::set1(8.3334519073e-3f));
+  p = V::fmadd(p, x, V::set1(4.1665795894e-2f));
+  p = V::fmadd(p, x, V::set1(1.6666665459e-1f));
+  p = V::fmadd(p, x, V::set1(5.0000001201e-1f));
+  p = V::fmadd(p, V::mul(x, x), V::add(x, V::set1(1.f)));
+  return V::mul(p, V::pow2(n));
+}
+
+// Cephes logf: log(x) = e * ln(2) + log(m) with m in [sqrt(2) / 2, sqrt(2))
+template <class V>
+typename V::F logVector(const typename V::F x) {
+  typename V::F e;
+  typename V::F m = V::splitExponent(x, &e);
+  const typename V::F one = V::set1(1.f);
+  const typename V::F sqrtHalf = V::set1(0.707106781186547524f);
+  e = V::selectGreater(sqrtHalf, m, V::sub(e, one), e);
+  m = V::selectGreater(sqrtHalf, m, V::sub(V::add(m, m), one),
+                       V::sub(m, one));
+  const typename V::F z = V::mul(m, m);
+  typename V::F p = V::set1(7.0376836292e-2f);
+  p = V::fmadd(p, m, V::set1(-1.1514610310e-1f));
+  p = V::fmadd(p, m, V::set1(1.1676998740e-1f));
+  p = V::fmadd(p, m, V::set1(-1.2420140846e-1f));
+  p = V::fmadd(p, m, V::set1(1.4249322787e-1f));
+  p = V::fmadd(p, m, V::set1(-1.6668057665e-1f));
+  p = V::fmadd(p, m, V::set1(2.0000714765e-1f));
+  p = V::fmadd(p, m, V::set1(-2.4999993993e-1f));
+  p = V::fmadd(p, m, V::set1(3.3333331174e-1f));
+  p = V::mul(V::mul(p, m), z);
+  p = V::fmadd(e, V::set1(-2.12194440e-4f), p);
+  p = V::fmadd(z, V::set1(-0.5f), p);
+  return V::fmadd(e, V::set1(0.693359375f), V::add(m, p));
+}
+
+template <class V>
+struct ExpOp {
+  typename V::F operator()(const typename V::F x) const {
+    return expVector<V>(x);
+  }
+};
+
+template <class V>
+struct LogOp {
+  typename V::F operator()(const typename V::F x) const {
+    return logVector<V>(x);
+  }
+};
+
+template <class V>
+struct SigmoidOp {
+  typename V::F operator()(const typename V::F x) const {
+    const typename V::F one = V::set1(1.f);
+    return V::div(one, V::add(one, expVector<V>(V::sub(V::zero(), x))));
+  }
+};
+
+// tanh(x) = sign(x) * (1 - 2 / (e^(2|x|) + 1))
+template <class V>
+struct TanhOp {
+  typename V::F operator()(const typename V::F x) const {
+    const typename V::F one = V::set1(1.f);
+    const typename V::F a = V::abs(x);
+    const typename V::F t = V::sub(one, V::div(V::set1(2.f),
+      V::add(expVector<V>(V::add(a, a)), one)));
+    return V::selectGreater(V::zero(), x, V::sub(V::zero(), t), t);
+  }
+};
+
+// y = op(x) lane-wise; the tail goes through a padded register so that no
+// scalar fallback is needed
+template <class V, class Op>
+void mapKernel(const float* x, float* y, const int len) {
+  const int w = V::kWidth;
+  const Op op;
+  int i = 0;
+  for (; i + w <= len; i += w)
+    V::store(y + i, op(V::load(x + i)));
+  if (i < len) {
+    float tail[V::kWidth];
+    for (int k = 0; k < w; ++k)
+      tail[k] = i + k < len ? x[i + k] : 1.f;
+    V::store(tail, op(V::load(tail)));
+    for (int k = 0; i + k < len; ++k)
+      y[i + k] = tail[k];
+  }
+}
+
+template <class V>
+int argmaxKernel(const float* x, const int len) {
+  const int w = V::kWidth;
+  if (len < w) {
+    int ans = len > 0 ? 0 : -1;
+    for (int i = 1; i < len; ++i)
+      if (x[i] > x[ans])
+        ans = i;
+    return ans;
+  }
+  typename V::F best = V::load(x);
+  int i = w;
+  for (; i + w <= len; i += w)
+    best = V::max(best, V::load(x + i));
+  float maxValue = V::reduceMax(best);
+  for (; i < len; ++i)
+    if (x[i] > maxValue)
+      maxValue = x[i];
+  for (i = 0; i < len; ++i)
+    if (x[i] == maxValue)
+      return i;
+  return 0;
+}
+
+template <class V>
+KernelTable makeKernelTable() {
+  KernelTable table;
+  table.dot = &dotKernel<V>;
+  table.axpy = &axpyKernel<V>;
+  table.l1Distance = &l1Kernel<V>;
+  table.squaredL2Distance = &squaredL2Kernel<V>;
+  table.chi2Distance = &chi2Kernel<V>;
+  // the scattered increments do not vectorize, every variant shares the
+  // generic loop
+  table.accumulateHistogram = getScalarKernels().accumulateHistogram;
+  table.exp = &mapKernel<V, ExpOp<V>>;
+  table.log = &mapKernel<V, LogOp<V>>;
+  table.sigmoid = &mapKernel<V, SigmoidOp<V>>;
+  table.tanh = &mapKernel<V, TanhOp<V>>;
+  table.argmax = &argmaxKernel<V>;
+  return table;
+}
+
+}  // namespace
+}  // namespace simd
+}  // namespace ssig
+
+#endif  // !_SSIG_CORE_SIMD_VECTOR_HPP_
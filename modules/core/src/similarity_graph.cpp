@@ -0,0 +1,320 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include "ssiglib/core/similarity_graph.hpp"
+// c++
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+// flann
+#include <flann/flann.hpp>
+// ssiglib
+#include "ssiglib/core/executor.hpp"
+#include "ssiglib/core/util.hpp"
+
+namespace ssig {
+
+namespace {
+// number of rows scored at once by the exact builder
+const int kGraphBlock = 256;
+
+typedef std::pair<float, int> Candidate;
+typedef std::greater<Candidate> MinHeapOrder;
+
+// keeps the k candidates with the largest key in a min-heap
+void offer(std::vector<Candidate>& heap, const int k,
+           const float key, const int node) {
+  if (static_cast<int>(heap.size()) < k) {
+    heap.push_back(std::make_pair(key, node));
+    std::push_heap(heap.begin(), heap.end(), MinHeapOrder());
+  } else if (key > heap.front().first) {
+    std::pop_heap(heap.begin(), heap.end(), MinHeapOrder());
+    heap.back() = std::make_pair(key, node);
+    std::push_heap(heap.begin(), heap.end(), MinHeapOrder());
+  }
+}
+
+template <class Distance>
+void flannSearch(flann::Matrix<float>& dataset,
+                 const int trees,
+                 const int knn,
+                 const flann::SearchParams& params,
+                 flann::Matrix<int>& indices,
+                 flann::Matrix<float>& dists) {
+  flann::Index<Distance> index(dataset, flann::KDTreeIndexParams(trees));
+  index.buildIndex();
+  index.knnSearch(dataset, indices, dists, knn, params);
+}
+}  // namespace
+
+void SimilarityGraph::buildExact(
+  const cv::Mat_<float>& input,
+  const SimilarityFunctor& similarityFunction,
+  const int k,
+  SimilarityGraph& graph,
+  const NeighbourOrder order) {
+  if (k <= 0)
+    throw std::invalid_argument("k must be greater than 0");
+
+  const int len = input.rows;
+  const int degree = std::min(k, std::max(len - 1, 0));
+  const float sign = (order == HIGHEST_SCORE) ? 1.f : -1.f;
+
+  graph.mNodes = len;
+  graph.mRowPointers.resize(len + 1);
+  graph.mColumns.resize(static_cast<size_t>(len) * degree);
+  graph.mScores.resize(static_cast<size_t>(len) * degree);
+  for (int r = 0; r <= len; ++r) {
+    graph.mRowPointers[r] = r * degree;
+  }
+
+  const int nBlocks = (len + kGraphBlock - 1) / kGraphBlock;
+  Executor::global().parallelFor(0, nBlocks,
+    [&](const int first, const int last) {
+    cv::Mat_<float> block;
+    std::vector<std::vector<Candidate>> heaps(kGraphBlock);
+    for (int rb = first; rb < last; ++rb) {
+      const int rowBegin = rb * kGraphBlock;
+      const int rowEnd = std::min(rowBegin + kGraphBlock, len);
+      for (auto& heap : heaps) {
+        heap.clear();
+      }
+
+      for (int cb = 0; cb < nBlocks; ++cb) {
+        const int colBegin = cb * kGraphBlock;
+        const int colEnd = std::min(colBegin + kGraphBlock, len);
+        similarityFunction.manyToMany(input.rowRange(rowBegin, rowEnd),
+                                      input.rowRange(colBegin, colEnd),
+                                      block);
+        for (int i = rowBegin; i < rowEnd; ++i) {
+          const float* values = block[i - rowBegin];
+          auto& heap = heaps[i - rowBegin];
+          for (int j = colBegin; j < colEnd; ++j) {
+            if (i != j)
+              offer(heap, degree, sign * values[j - colBegin], j);
+          }
+        }
+      }
+
+      for (int i = rowBegin; i < rowEnd; ++i) {
+        auto& heap = heaps[i - rowBegin];
+        std::sort_heap(heap.begin(), heap.end(), MinHeapOrder());
+        const int offset = graph.mRowPointers[i];
+        for (int e = 0; e < static_cast<int>(heap.size()); ++e) {
+          graph.mColumns[offset + e] = heap[e].second;
+          graph.mScores[offset + e] = sign * heap[e].first;
+        }
+      }
+    }
+  });
+}
+
+void SimilarityGraph::buildApproximate(
+  const cv::Mat_<float>& input,
+  const SimilarityFunctor& similarityFunction,
+  const int k,
+  SimilarityGraph& graph,
+  const int checks,
+  const int trees) {
+  if (k <= 0)
+    throw std::invalid_argument("k must be greater than 0");
+
+  enum { COSINE, EUCLIDEAN, CHI2 } metric;
+  const std::type_info& type = typeid(similarityFunction);
+  const bool centered = (type == typeid(CorrelationSimilarity));
+  if (type == typeid(CosineSimilarity) || centered) {
+    metric = COSINE;
+  } else if (type == typeid(EuclideanDistance)) {
+    metric = EUCLIDEAN;
+  } else if (type == typeid(Chi2Similarity)) {
+    metric = CHI2;
+  } else {
+    throw std::invalid_argument(
+      "The approximate graph only supports the built-in similarities");
+  }
+
+  const int len = input.rows;
+  // flann needs one contiguous buffer and the cosine rows are normalized in
+  // place, so the samples are always copied
+  cv::Mat_<float> data = input.clone();
+  if (metric == COSINE) {
+    for (int r = 0; r < len; ++r) {
+      cv::Mat_<float> row = data.row(r);
+      if (centered)
+        row -= cv::mean(row)[0];
+      const double norm = cv::norm(row, cv::NORM_L2);
+      if (norm > 0)
+        row /= norm;
+    }
+  }
+
+  graph.mNodes = len;
+  graph.mRowPointers.assign(len + 1, 0);
+  graph.mColumns.clear();
+  graph.mScores.clear();
+  if (len < 2)
+    return;
+
+  // the sample itself is usually its own nearest neighbour
+  const int knn = std::min(k + 1, len);
+  std::vector<int> indicesBuffer(static_cast<size_t>(len) * knn, -1);
+  std::vector<float> distsBuffer(static_cast<size_t>(len) * knn);
+  flann::Matrix<int> indices(indicesBuffer.data(), len, knn);
+  flann::Matrix<float> dists(distsBuffer.data(), len, knn);
+  flann::Matrix<float> dataset = Util::convert<float>(data);
+
+  flann::SearchParams params(checks);
+  params.cores = 0;
+  if (metric == CHI2) {
+    flannSearch<flann::ChiSquareDistance<float>>(dataset, trees, knn, params,
+                                                 indices, dists);
+  } else {
+    flannSearch<flann::L2<float>>(dataset, trees, knn, params,
+                                  indices, dists);
+  }
+
+  graph.mColumns.reserve(static_cast<size_t>(len) * k);
+  graph.mScores.reserve(static_cast<size_t>(len) * k);
+  for (int r = 0; r < len; ++r) {
+    int kept = 0;
+    for (int e = 0; e < knn && kept < k; ++e) {
+      const int node = indices[r][e];
+      if (node < 0 || node == r)
+        continue;
+      // flann reports squared L2 distances
+      const float dist = dists[r][e];
+      float score;
+      switch (metric) {
+      case COSINE:
+        score = 1.f - 0.5f * dist;
+        break;
+      case EUCLIDEAN:
+        score = std::sqrt(dist);
+        break;
+      default:
+        score = -std::sqrt(0.5f * dist);
+        break;
+      }
+      graph.mColumns.push_back(node);
+      graph.mScores.push_back(score);
+      ++kept;
+    }
+    graph.mRowPointers[r + 1] = static_cast<int>(graph.mColumns.size());
+  }
+}
+
+void SimilarityGraph::symmetrize() {
+  std::vector<std::vector<std::pair<int, float>>> adjacency(mNodes);
+  for (int r = 0; r < mNodes; ++r) {
+    for (int e = mRowPointers[r]; e < mRowPointers[r + 1]; ++e) {
+      adjacency[r].push_back(std::make_pair(mColumns[e], mScores[e]));
+      adjacency[mColumns[e]].push_back(std::make_pair(r, mScores[e]));
+    }
+  }
+
+  mColumns.clear();
+  mScores.clear();
+  for (int r = 0; r < mNodes; ++r) {
+    auto& neighbourhood = adjacency[r];
+    std::sort(neighbourhood.begin(), neighbourhood.end(),
+              [](const std::pair<int, float>& a,
+                 const std::pair<int, float>& b) {
+                return a.first < b.first;
+              });
+    for (int e = 0; e < static_cast<int>(neighbourhood.size()); ++e) {
+      if (e > 0 && neighbourhood[e].first == neighbourhood[e - 1].first)
+        continue;
+      mColumns.push_back(neighbourhood[e].first);
+      mScores.push_back(neighbourhood[e].second);
+    }
+    mRowPointers[r + 1] = static_cast<int>(mColumns.size());
+    neighbourhood.clear();
+    neighbourhood.shrink_to_fit();
+  }
+}
+
+cv::Mat_<float> SimilarityGraph::toDense() const {
+  cv::Mat_<float> dense = cv::Mat_<float>::zeros(mNodes, mNodes);
+  for (int r = 0; r < mNodes; ++r) {
+    for (int e = mRowPointers[r]; e < mRowPointers[r + 1]; ++e) {
+      dense[r][mColumns[e]] = mScores[e];
+    }
+  }
+  return dense;
+}
+
+int SimilarityGraph::getNodes() const {
+  return mNodes;
+}
+
+int SimilarityGraph::getEdges() const {
+  return static_cast<int>(mColumns.size());
+}
+
+int SimilarityGraph::getDegree(const int node) const {
+  return mRowPointers[node + 1] - mRowPointers[node];
+}
+
+const int* SimilarityGraph::neighbours(const int node) const {
+  return mColumns.data() + mRowPointers[node];
+}
+
+const float* SimilarityGraph::scores(const int node) const {
+  return mScores.data() + mRowPointers[node];
+}
+
+const std::vector<int>& SimilarityGraph::getRowPointers() const {
+  return mRowPointers;
+}
+
+const std::vector<int>& SimilarityGraph::getColumns() const {
+  return mColumns;
+}
+
+const std::vector<float>& SimilarityGraph::getScores() const {
+  return mScores;
+}
+
+}  // namespace ssig
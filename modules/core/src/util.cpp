@@ -91,4 +91,38 @@ void Util::reorder(const cv::Mat& collection, cv::Mat_<int>& ordering,
   }
 }
 
+void Util::reorder(cv::Mat& collection, cv::Mat_<int>& ordering) {
+  CV_Assert(ordering.isContinuous() &&
+            static_cast<int>(ordering.total()) == collection.rows);
+  const int len = collection.rows;
+  const size_t rowBytes = collection.cols * collection.elemSize();
+  cv::AutoBuffer<uchar> scratch(rowBytes);
+  int* order = ordering.ptr<int>(0);
+  // visited positions are marked by storing -(source + 1)
+  for (int start = 0; start < len; ++start) {
+    if (order[start] < 0 || order[start] == start)
+      continue;
+    std::copy(collection.ptr(start), collection.ptr(start) + rowBytes,
+              static_cast<uchar*>(scratch));
+    int dst = start;
+    while (true) {
+      const int src = order[dst];
+      order[dst] = -src - 1;
+      if (src == start) {
+        std::copy(static_cast<uchar*>(scratch),
+                  static_cast<uchar*>(scratch) + rowBytes,
+                  collection.ptr(dst));
+        break;
+      }
+      std::copy(collection.ptr(src), collection.ptr(src) + rowBytes,
+                collection.ptr(dst));
+      dst = src;
+    }
+  }
+  for (int i = 0; i < len; ++i) {
+    if (order[i] < 0)
+      order[i] = -order[i] - 1;
+  }
+}
+
 }  // namespace ssig
@@ -0,0 +1,152 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include <gtest/gtest.h>
+// c++
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+// opencv
+#include <opencv2/core.hpp>
+// ssiglib
+#include "ssiglib/core/binary_storage.hpp"
+
+TEST(BinaryStorage, RoundTrip) {
+  cv::Mat_<float> mat(7, 3);
+  cv::randu(mat, -1.f, 1.f);
+  cv::Mat_<double> view = cv::Mat_<double>::eye(5, 5)(cv::Rect(1, 1, 2, 3));
+  std::unordered_map<int, int> ordering = {{1, 0}, {-1, 1}, {7, 2}};
+
+  ssig::BinaryWriter writer;
+  writer.write("mat", mat);
+  writer.beginScope("model");
+  writer.write("view", view);
+  writer.write("count", 42);
+  writer.beginScope("nested");
+  writer.write("rate", 0.125);
+  writer.write("name", std::string("logistic"));
+  writer.write("ordering", ordering);
+  writer.write("empty", cv::Mat());
+  writer.endScope();
+  writer.endScope();
+  writer.save("binary_storage.bin");
+
+  {
+    ssig::BinaryStorage storage("binary_storage.bin");
+    EXPECT_EQ(ssig::BinaryStorage::kVersion, storage.getVersion());
+    auto root = storage.root();
+    auto model = root["model"];
+
+    cv::Mat loaded = root.getMat("mat");
+    ASSERT_EQ(CV_32F, loaded.type());
+    EXPECT_EQ(0, cv::norm(loaded, mat, cv::NORM_INF));
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(loaded.data) % 64);
+    EXPECT_EQ(0, cv::norm(model.getMat("view"), view, cv::NORM_INF));
+
+    EXPECT_EQ(42, model.getInt("count"));
+    EXPECT_EQ(0.125, model["nested"].getDouble("rate"));
+    EXPECT_EQ("logistic", model["nested"].getString("name"));
+    EXPECT_EQ(ordering, model["nested"].getIntMap("ordering"));
+    EXPECT_TRUE(model["nested"].getMat("empty").empty());
+
+    EXPECT_TRUE(model.has("count"));
+    EXPECT_FALSE(root.has("count"));
+    EXPECT_THROW(model.getInt("missing"), std::runtime_error);
+    EXPECT_THROW(model.getDouble("count"), std::runtime_error);
+
+    // the mapping is private: writes never reach the file
+    loaded.at<float>(0) = 100.f;
+    ssig::BinaryStorage other("binary_storage.bin");
+    EXPECT_EQ(mat(0), other.root().getMat("mat").at<float>(0));
+  }
+  remove("binary_storage.bin");
+}
+
+TEST(BinaryStorage, ViewsOutliveTheStorage) {
+  cv::Mat_<float> mat(4, 6);
+  cv::randu(mat, -1.f, 1.f);
+  ssig::BinaryWriter writer;
+  writer.write("mat", mat);
+  writer.save("binary_storage.bin");
+
+  cv::Mat loaded;
+  {
+    ssig::BinaryStorage storage("binary_storage.bin");
+    loaded = storage.root().getMat("mat");
+  }
+  // the view holds the mapping, not the storage
+  remove("binary_storage.bin");
+  ASSERT_EQ(mat.size(), loaded.size());
+  EXPECT_EQ(0, cv::norm(loaded, mat, cv::NORM_INF));
+}
+
+TEST(BinaryStorage, RejectsInvalidFiles) {
+  ssig::BinaryWriter writer;
+  writer.write("a", 1);
+  writer.write("a", 2);
+  EXPECT_THROW(writer.save("binary_storage.bin"), std::invalid_argument);
+  EXPECT_THROW(writer.endScope(), std::logic_error);
+
+  EXPECT_THROW(ssig::BinaryStorage("missing_storage.bin"),
+               std::runtime_error);
+
+  std::ofstream("binary_storage.bin") << "not a model";
+  EXPECT_THROW(ssig::BinaryStorage("binary_storage.bin"),
+               std::runtime_error);
+
+  // a file written by a newer version of the format
+  ssig::BinaryWriter newer;
+  newer.write("a", 1);
+  newer.save("binary_storage.bin");
+  {
+    std::fstream file("binary_storage.bin",
+                      std::ios::in | std::ios::out | std::ios::binary);
+    const uint32_t version = ssig::BinaryStorage::kVersion + 1;
+    file.seekp(12);
+    file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+  }
+  EXPECT_THROW(ssig::BinaryStorage("binary_storage.bin"),
+               std::runtime_error);
+  remove("binary_storage.bin");
+}
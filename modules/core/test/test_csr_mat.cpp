@@ -0,0 +1,82 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include <gtest/gtest.h>
+// c++
+#include <stdexcept>
+#include <vector>
+// opencv
+#include <opencv2/core.hpp>
+// ssiglib
+#include "ssiglib/core/csr_mat.hpp"
+
+TEST(CsrMat, RoundTrip) {
+  cv::Mat_<float> dense = (cv::Mat_<float>(3, 4) <<
+    0, 2, 0, 0,
+    0, 0, 0, 0,
+    1, 0, 0, -3);
+  const ssig::CsrMat sparse(dense);
+  EXPECT_EQ(3, sparse.getNumRows());
+  EXPECT_EQ(4, sparse.getNumCols());
+  EXPECT_EQ(3, sparse.getNonZeros());
+  EXPECT_EQ(std::vector<int>({0, 1, 1, 3}), sparse.getRowPointers());
+  EXPECT_EQ(std::vector<int>({1, 0, 3}), sparse.getColumns());
+  EXPECT_EQ(0, cv::countNonZero(sparse.toDense() != dense));
+
+  const ssig::CsrMat copy(4, sparse.getRowPointers(), sparse.getColumns(),
+                          sparse.getValues());
+  EXPECT_EQ(0, cv::countNonZero(copy.toDense() != dense));
+  EXPECT_THROW(ssig::CsrMat(4, {0, 2}, {3, 1}, {1.f, 2.f}),
+               std::invalid_argument);
+}
+
+TEST(CsrMat, Multiply) {
+  cv::setRNGSeed(1234);
+  cv::Mat_<float> dense(50, 200), rhs(200, 7);
+  cv::randu(dense, -1, 1);
+  cv::randu(rhs, -1, 1);
+  // keep about a tenth of the elements
+  dense.setTo(0, cv::abs(dense) < 0.9);
+
+  cv::Mat_<float> expected = dense * rhs, out;
+  ssig::CsrMat(dense).multiply(rhs, out);
+  EXPECT_LT(cv::norm(expected, out, cv::NORM_INF), 1e-4);
+}
@@ -0,0 +1,114 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include <gtest/gtest.h>
+// c++
+#include <cmath>
+// opencv
+#include <opencv2/core.hpp>
+// ssiglib
+#include "ssiglib/core/distance_kernels.hpp"
+
+TEST(DistanceKernel, MatchesOpenCvNorms) {
+  cv::setRNGSeed(1234);
+  // the fixed-dimension paths and a runtime length
+  for (const int dims : {64, 128, 256, 512, 37}) {
+    SCOPED_TRACE(dims);
+    cv::Mat_<float> A(6, dims), B(9, dims);
+    cv::randu(A, 0, 1);
+    cv::randu(B, 0, 1);
+
+    cv::Mat_<float> l1, l2, sqrL2;
+    ssig::L1Kernel::manyToMany<float>(A, B, l1);
+    ssig::L2Kernel::manyToMany<float>(A, B, l2);
+    ssig::SquaredL2Kernel::manyToMany<float>(A, B, sqrL2);
+    ASSERT_EQ(A.rows, l1.rows);
+    ASSERT_EQ(B.rows, l1.cols);
+    for (int i = 0; i < A.rows; ++i) {
+      for (int j = 0; j < B.rows; ++j) {
+        const double refL1 = cv::norm(A.row(i), B.row(j), cv::NORM_L1);
+        const double refL2 = cv::norm(A.row(i), B.row(j), cv::NORM_L2);
+        EXPECT_NEAR(refL1, l1(i, j), 1e-4 * refL1);
+        EXPECT_NEAR(refL2, l2(i, j), 1e-5 * refL2);
+        EXPECT_NEAR(refL2 * refL2, sqrL2(i, j), 1e-4 * refL2 * refL2);
+      }
+    }
+
+    // other element types give the same answers
+    cv::Mat_<double> Ad;
+    A.convertTo(Ad, CV_64F);
+    EXPECT_NEAR(cv::norm(A.row(0), A.row(1), cv::NORM_L1),
+                ssig::L1Kernel::compute(Ad[0], Ad[1], dims), 1e-4);
+    cv::Mat_<uchar> A8;
+    A.convertTo(A8, CV_8U, 255);
+    EXPECT_FLOAT_EQ(
+      static_cast<float>(cv::norm(A8.row(0), A8.row(1), cv::NORM_L1)),
+      ssig::L1Kernel::compute(A8[0], A8[1], dims));
+  }
+}
+
+TEST(DistanceKernel, FunctorFrontEnd) {
+  cv::Mat_<float> A(5, 16), B(4, 16);
+  cv::randu(A, 0, 1);
+  cv::randu(B, 0, 1);
+  // a bin that is zero in both histograms does not count
+  A.col(3) = 0;
+  B.col(3) = 0;
+
+  ssig::KernelDistance<ssig::Chi2Kernel> chi2;
+  ssig::Chi2Similarity similarity;
+  cv::Mat_<float> scores;
+  chi2.manyToMany(A, B, scores);
+  for (int i = 0; i < A.rows; ++i) {
+    for (int j = 0; j < B.rows; ++j) {
+      const float distance = chi2(A.row(i), B.row(j));
+      EXPECT_FLOAT_EQ(distance, scores(i, j));
+      // Chi2Similarity reports -sqrt(chi2 / 2)
+      EXPECT_NEAR(similarity(A.row(i), B.row(j)),
+                  -std::sqrt(0.5f * distance), 1e-5);
+    }
+  }
+
+  // double rows are converted on the way in
+  cv::Mat_<double> Ad;
+  A.convertTo(Ad, CV_64F);
+  EXPECT_NEAR(scores(0, 0), chi2(Ad.row(0), B.row(0)), 1e-5);
+}
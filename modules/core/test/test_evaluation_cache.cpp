@@ -0,0 +1,153 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include <gtest/gtest.h>
+// c++
+#include <atomic>
+#include <limits>
+// opencv
+#include <opencv2/core.hpp>
+// ssiglib
+#include "ssiglib/core/evaluation_cache.hpp"
+#include "ssiglib/core/genetic_optimizator.hpp"
+#include "ssiglib/core/math.hpp"
+
+TEST(EvaluationCache, LeastRecentlyUsedEviction) {
+  ssig::EvaluationCache cache(2, 0.01f);
+  cv::Mat_<float> a = (cv::Mat_<float>(1, 2) << 1.f, 2.f);
+  cv::Mat_<float> b = (cv::Mat_<float>(1, 2) << 3.f, 4.f);
+  cv::Mat_<float> c = (cv::Mat_<float>(1, 2) << 5.f, 6.f);
+  cv::Mat_<float> nearA = (cv::Mat_<float>(1, 2) << 1.001f, 2.f);
+
+  float utility;
+  ASSERT_FALSE(cache.lookup(cache.makeKey(a), utility));
+  cache.insert(cache.makeKey(a), 10.f);
+  cache.insert(cache.makeKey(b), 20.f);
+  ASSERT_TRUE(cache.lookup(cache.makeKey(nearA), utility));
+  ASSERT_FLOAT_EQ(10.f, utility);
+
+  // a was used last, so b is the one evicted
+  cache.insert(cache.makeKey(c), 30.f);
+  ASSERT_EQ(2u, cache.getSize());
+  ASSERT_FALSE(cache.lookup(cache.makeKey(b), utility));
+  ASSERT_TRUE(cache.lookup(cache.makeKey(a), utility));
+  ASSERT_TRUE(cache.lookup(cache.makeKey(c), utility));
+  ASSERT_FLOAT_EQ(30.f, utility);
+
+  ASSERT_EQ(3u, cache.getHits());
+  ASSERT_EQ(2u, cache.getMisses());
+}
+
+TEST(EvaluationCache, NonFiniteKeys) {
+  ssig::EvaluationCache cache(8, 1e-6f);
+  const float inf = std::numeric_limits<float>::infinity();
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  cv::Mat_<float> a = (cv::Mat_<float>(1, 2) << nan, 1.f);
+  cv::Mat_<float> b = (cv::Mat_<float>(1, 2) << -nan, 1.f);
+  cv::Mat_<float> posInf = (cv::Mat_<float>(1, 2) << inf, 1.f);
+  cv::Mat_<float> negInf = (cv::Mat_<float>(1, 2) << -inf, 1.f);
+  cv::Mat_<float> huge = (cv::Mat_<float>(1, 2) << 1e30f, 1.f);
+  cv::Mat_<float> huger = (cv::Mat_<float>(1, 2) << 2e30f, 1.f);
+  cv::Mat_<float> small = (cv::Mat_<float>(1, 2) << 1.f, 1.f);
+
+  EXPECT_EQ(cache.makeKey(a), cache.makeKey(b));
+  EXPECT_NE(cache.makeKey(posInf), cache.makeKey(negInf));
+  EXPECT_NE(cache.makeKey(huge), cache.makeKey(huger));
+  EXPECT_NE(cache.makeKey(huge), cache.makeKey(posInf));
+  EXPECT_NE(cache.makeKey(a), cache.makeKey(small));
+
+  float utility;
+  cache.insert(cache.makeKey(a), 5.f);
+  ASSERT_TRUE(cache.lookup(cache.makeKey(b), utility));
+  EXPECT_FLOAT_EQ(5.f, utility);
+  EXPECT_FALSE(cache.lookup(cache.makeKey(posInf), utility));
+}
+
+namespace {
+std::atomic<int> gCalls(0);
+
+struct CountingUtility : ssig::UtilityFunctor {
+  float operator()(const cv::Mat& v) const override {
+    ++gCalls;
+    const float x = v.at<float>(0);
+    return -std::abs(x * x - 2);
+  }
+};
+
+struct MeanCrossover : ssig::GeneticOptimizator::CrossOverFunctor {
+  void operator()(const cv::Mat& indA,
+                  const cv::Mat& indB,
+                  cv::Mat& child) const override {
+    child = (indA + indB) / 2;
+  }
+};
+}  // namespace
+
+TEST(EvaluationCache, SkipsRepeatedCandidates) {
+  cv::Ptr<ssig::UtilityFunctor> util = cv::makePtr<CountingUtility>();
+  cv::Ptr<ssig::GeneticOptimizator::CrossOverFunctor> cross =
+    cv::makePtr<MeanCrossover>();
+  cv::Ptr<ssig::EvaluationCache> cache =
+    cv::makePtr<ssig::EvaluationCache>(100000, 0.f);
+
+  auto genOpt = ssig::GeneticOptimizator::create(4321, util, cross);
+  genOpt->setEvaluationCache(cache);
+  genOpt->setElistimFactor(0.2);
+  genOpt->setMutationRange(cv::Point2d(-5, 5));
+  genOpt->setMutationRate(0.2);
+  genOpt->setPopulationLength(100);
+  genOpt->setMutationType(ssig::GeneticOptimizator::Gaussian);
+  genOpt->setMaxIterations(20);
+  genOpt->setEps(0);
+  genOpt->setDimensions(1);
+
+  // a population full of duplicates is scored once per distinct value
+  cv::Mat_<float> input(100, 1);
+  for (int i = 0; i < input.rows; ++i)
+    input(i) = static_cast<float>(i % 10);
+  gCalls = 0;
+  genOpt->learn(input);
+
+  // the elites of every generation and the final re-scoring are cache hits
+  ASSERT_GE(cache->getHits(), 20u * 20u);
+  ASSERT_EQ(static_cast<size_t>(gCalls.load()), cache->getSize());
+  ASSERT_EQ(cache->getHits() + cache->getMisses(), 21u * 100u);
+}
@@ -0,0 +1,124 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include <gtest/gtest.h>
+// c++
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+// ssiglib
+#include "ssiglib/core/executor.hpp"
+
+TEST(Executor, ParallelForCoversRange) {
+  ssig::Executor executor(4);
+  std::vector<int> visits(10000, 0);
+  executor.parallelFor(0, 10000, [&](const int first, const int last) {
+    for (int i = first; i < last; ++i)
+      ++visits[i];
+  });
+  for (const int v : visits)
+    ASSERT_EQ(1, v);
+}
+
+TEST(Executor, NestedLoops) {
+  ssig::Executor executor(4);
+  std::atomic<long> total(0);
+  executor.parallelFor(0, 64, [&](const int first, const int last) {
+    for (int i = first; i < last; ++i) {
+      executor.parallelFor(0, 100, [&](const int a, const int b) {
+        long sum = 0;
+        for (int j = a; j < b; ++j)
+          sum += j;
+        total += sum;
+      });
+    }
+  });
+  ASSERT_EQ(64L * 4950, total.load());
+}
+
+TEST(Executor, DeterministicReduce) {
+  ssig::Executor executor(4);
+  auto map = [](const int first, const int last) {
+    float sum = 0;
+    for (int i = first; i < last; ++i)
+      sum += 1.f / (1 + i);
+    return sum;
+  };
+  auto reduce = [](const float a, const float b) { return a + b; };
+
+  executor.setConcurrency(1);
+  const float serial = executor.parallelReduce(0, 100000, 0.f, map, reduce);
+  executor.setConcurrency(0);
+  for (int rep = 0; rep < 10; ++rep)
+    ASSERT_EQ(serial, executor.parallelReduce(0, 100000, 0.f, map, reduce));
+}
+
+TEST(Executor, ExceptionPropagation) {
+  ssig::Executor executor(4);
+  ASSERT_THROW(executor.parallelFor(0, 100,
+    [](const int first, const int last) {
+    if (first <= 50 && 50 < last)
+      throw std::runtime_error("failure");
+  }), std::runtime_error);
+}
+
+TEST(Executor, ConcurrencyLimit) {
+  ssig::Executor executor(4);
+  std::atomic<int> running(0), peak(0);
+  executor.parallelFor(0, 256, [&](const int, const int) {
+    const int now = ++running;
+    int seen = peak;
+    while (now > seen && !peak.compare_exchange_weak(seen, now)) {}
+    for (volatile int k = 0; k < 10000; ++k) {}
+    --running;
+  }, 1, 2);
+  ASSERT_LE(peak.load(), 2);
+}
+
+TEST(Executor, TaskGroup) {
+  ssig::Executor executor(3);
+  std::atomic<int> done(0);
+  ssig::Executor::TaskGroup group(executor);
+  for (int i = 0; i < 100; ++i)
+    group.run([&]() { ++done; });
+  group.wait();
+  ASSERT_EQ(100, done.load());
+}
@@ -0,0 +1,126 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include <gtest/gtest.h>
+// c++
+#include <cstdio>
+#include <stdexcept>
+// opencv
+#include <opencv2/core.hpp>
+// ssiglib
+#include "ssiglib/core/feature_store.hpp"
+#include "ssiglib/core/math.hpp"
+
+TEST(FeatureStore, RowsLabelsAndStatistics) {
+  cv::Mat_<float> rows(10, 4);
+  cv::randu(rows, -5.f, 5.f);
+  cv::Mat_<int> labels(10, 1);
+  for (int r = 0; r < 10; ++r)
+    labels(r) = r % 3;
+
+  {
+    ssig::FeatureStoreWriter writer("feature_store.bin", 4);
+    writer.append(rows.rowRange(0, 7), labels.rowRange(0, 7));
+    writer.append(rows.row(7), 1);
+    writer.append(rows.rowRange(8, 10), labels.rowRange(8, 10));
+    writer.setMetadata("descriptor", "HOG");
+    EXPECT_THROW(writer.append(rows), std::logic_error);
+    writer.close();
+  }
+  labels(7) = 1;
+  // the labels were streamed through a side file that close() removes
+  EXPECT_EQ(nullptr, fopen("feature_store.bin.labels", "rb"));
+
+  cv::Mat_<float> mean, std;
+  ssig::computeMeanStd(rows, cv::ml::COL_SAMPLE, mean, std);
+
+  cv::Mat_<float> block;
+  {
+    ssig::FeatureStore store("feature_store.bin");
+    ASSERT_EQ(10, store.getNumRows());
+    ASSERT_EQ(4, store.getNumCols());
+    EXPECT_EQ(3, store.getNumBlocks());
+    EXPECT_EQ(0, cv::norm(store.getData(), rows, cv::NORM_INF));
+    EXPECT_EQ(0, cv::norm(store.getLabels(), labels, cv::NORM_INF));
+    EXPECT_EQ(0, cv::norm(store.getRows(3, 6), rows.rowRange(3, 6),
+                          cv::NORM_INF));
+    EXPECT_LT(cv::norm(store.getMean(), mean, cv::NORM_INF), 1e-5);
+    EXPECT_LT(cv::norm(store.getStd(), std, cv::NORM_INF), 1e-5);
+    double minVal, maxVal;
+    cv::minMaxIdx(rows.col(2), &minVal, &maxVal);
+    EXPECT_EQ(static_cast<float>(minVal), store.getMin()(2));
+    EXPECT_EQ(static_cast<float>(maxVal), store.getMax()(2));
+    EXPECT_EQ("HOG", store.getMetadata("descriptor"));
+    EXPECT_FALSE(store.hasMetadata("dataset"));
+    EXPECT_THROW(store.getRows(5, 11), std::out_of_range);
+    block = store.getBlock(2);
+  }
+  // views keep the file mapped after the store is gone
+  ASSERT_EQ(2, block.rows);
+  EXPECT_EQ(0, cv::norm(block, rows.rowRange(8, 10), cv::NORM_INF));
+  block.release();
+  remove("feature_store.bin");
+}
+
+TEST(FeatureStore, UnlabeledAndEmpty) {
+  {
+    ssig::FeatureStoreWriter writer("feature_store.bin");
+    writer.append(cv::Mat_<double>::ones(3, 5));
+    EXPECT_THROW(writer.append(cv::Mat_<float>::ones(1, 5), 1),
+                 std::logic_error);
+    EXPECT_THROW(writer.append(cv::Mat_<float>::ones(1, 4)),
+                 std::invalid_argument);
+  }
+  {
+    ssig::FeatureStore store("feature_store.bin");
+    EXPECT_FALSE(store.hasLabels());
+    EXPECT_TRUE(store.getLabels().empty());
+    EXPECT_EQ(15, cv::countNonZero(store.getData() == 1.f));
+    EXPECT_EQ(0.f, store.getStd()(0));
+  }
+  { ssig::FeatureStoreWriter writer("feature_store.bin"); }
+  {
+    ssig::FeatureStore store("feature_store.bin");
+    EXPECT_EQ(0, store.getNumRows());
+    EXPECT_TRUE(store.getData().empty());
+  }
+  remove("feature_store.bin");
+}
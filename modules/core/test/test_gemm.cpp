@@ -0,0 +1,136 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include <gtest/gtest.h>
+// c++
+#include <initializer_list>
+#include <string>
+// opencv
+#include <opencv2/core.hpp>
+// ssiglib
+#include "ssiglib/core/gemm.hpp"
+
+namespace {
+cv::Mat randomMat(const int rows, const int cols, const int type) {
+  cv::Mat ans(rows, cols, type);
+  cv::randu(ans, -1, 1);
+  return ans;
+}
+
+void expectNear(const cv::Mat& expected, const cv::Mat& actual) {
+  ASSERT_EQ(expected.size(), actual.size());
+  ASSERT_EQ(expected.type(), actual.type());
+  const double tol = expected.depth() == CV_32F ? 1e-4 : 1e-10;
+  EXPECT_LE(cv::norm(expected, actual, cv::NORM_INF),
+            tol * (1 + cv::norm(expected, cv::NORM_INF)));
+}
+}  // namespace
+
+TEST(Gemm, MatchesOpenCv) {
+  cv::setRNGSeed(1234);
+  const int m = 7, n = 5, k = 9;
+  for (int type : {CV_32FC1, CV_64FC1}) {
+    for (int flags = 0; flags < 8; ++flags) {
+      SCOPED_TRACE(flags);
+      const cv::Mat A = (flags & cv::GEMM_1_T) ? randomMat(k, m, type)
+                                               : randomMat(m, k, type);
+      const cv::Mat B = (flags & cv::GEMM_2_T) ? randomMat(n, k, type)
+                                               : randomMat(k, n, type);
+      const cv::Mat C = (flags & cv::GEMM_3_T) ? randomMat(n, m, type)
+                                               : randomMat(m, n, type);
+      cv::Mat expected, actual;
+      cv::gemm(A, B, 0.5, C, -2.0, expected, flags);
+      ssig::gemm(A, B, 0.5, C, -2.0, actual, flags);
+      expectNear(expected, actual);
+
+      cv::gemm(A, B, 1.0, cv::noArray(), 0.0, expected, flags);
+      ssig::gemm(A, B, actual, flags);
+      expectNear(expected, actual);
+    }
+  }
+}
+
+TEST(Gemm, VectorShapesAndViews) {
+  cv::setRNGSeed(42);
+  const cv::Mat big = randomMat(20, 20, CV_32FC1);
+  // non-continuous operands, matrix-vector and vector-matrix products
+  const cv::Mat A = big(cv::Rect(2, 3, 6, 8));
+  for (const cv::Mat& x : {randomMat(6, 1, CV_32FC1),
+                           cv::Mat(big.col(11).rowRange(0, 6))}) {
+    cv::Mat expected, actual;
+    cv::gemm(A, x, 1, cv::noArray(), 0, expected);
+    ssig::gemm(A, x, actual);
+    expectNear(expected, actual);
+  }
+  const cv::Mat y = randomMat(8, 1, CV_32FC1);
+  cv::Mat expected, actual;
+  cv::gemm(y, A, 1, cv::noArray(), 0, expected, cv::GEMM_1_T);
+  ssig::gemm(y, A, actual, cv::GEMM_1_T);
+  expectNear(expected, actual);
+}
+
+TEST(Gemm, InPlaceAndAliasedOutput) {
+  cv::setRNGSeed(7);
+  const cv::Mat t = randomMat(10, 1, CV_64FC1);
+  const cv::Mat p = randomMat(4, 1, CV_64FC1);
+  cv::Mat X = randomMat(10, 4, CV_64FC1);
+
+  // rank-one deflation X -= t * p'
+  cv::Mat expected = X - t * p.t();
+  ssig::gemm(t, p, -1, X, 1, X, cv::GEMM_2_T);
+  expectNear(expected, X);
+
+  // the output is also one of the factors
+  cv::Mat S = randomMat(4, 4, CV_64FC1);
+  expected = S * S;
+  ssig::gemm(S, S, S);
+  expectNear(expected, S);
+
+  // integer inputs are left to OpenCV, which rejects them just the same
+  const cv::Mat I(3, 3, CV_32SC1, cv::Scalar(1));
+  cv::Mat D;
+  EXPECT_THROW(ssig::gemm(I, I, D), cv::Exception);
+}
+
+TEST(Gemm, ReportsBackend) {
+  const std::string backend = ssig::getGemmBackend();
+  EXPECT_TRUE(backend == "cblas" || backend == "opencv");
+}
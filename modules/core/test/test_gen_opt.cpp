@@ -41,10 +41,12 @@
 #include <gtest/gtest.h>
 
 // c++
+#include <algorithm>
 #include <random>
 #include <numeric>
 // ssiglib
 #include <ssiglib/core/math.hpp>
+#include "ssiglib/core/executor.hpp"
 
 #include "ssiglib/core/genetic_optimizator.hpp"
 
@@ -144,3 +146,84 @@ TEST(GenOpt, 2Dimensions) {
 
   ASSERT_LE(abs(x*x + y), 0.1f);
 }
+
+TEST(GenOpt, Islands) {
+  struct Utility : ssig::UtilityFunctor {
+    float operator()(const cv::Mat& v) const override {
+      const float x = v.at<float>(0);
+      return -std::abs(x * x - 2);
+    }
+  };
+
+  cv::Ptr<ssig::UtilityFunctor> util = cv::makePtr<Utility>();
+  typedef cv::Ptr<ssig::GeneticOptimizator::CrossOverFunctor> crossPtr;
+  crossPtr cross = cv::makePtr<TestCrossover>();
+
+  // one thread, then every thread of the pool
+  auto& executor = ssig::Executor::global();
+  const int concurrency = executor.getConcurrency();
+  const int threads[2] = {1, std::max(2, executor.getThreads())};
+  cv::Mat states[2];
+  float best[2];
+  for (int run = 0; run < 2; ++run) {
+    executor.setConcurrency(threads[run]);
+    auto genOpt = ssig::GeneticOptimizator::create(12345, util, cross);
+    genOpt->setElistimFactor(0.1);
+    genOpt->setMutationRange(cv::Point2d(-5, 5));
+    genOpt->setMutationRate(0.2);
+    genOpt->setPopulationLength(400);
+    genOpt->setMutationType(ssig::GeneticOptimizator::Gaussian);
+    genOpt->setMaxIterations(100);
+    genOpt->setEps(0);
+    genOpt->setDimensions(1);
+    genOpt->setIslands(4);
+    genOpt->setMigrationInterval(5);
+    genOpt->setMigrants(2);
+
+    genOpt->learn(cv::Mat_<float>());
+    executor.setConcurrency(concurrency);
+    states[run] = genOpt->getState();
+    ASSERT_EQ(400, states[run].rows);
+
+    cv::Mat results = genOpt->getResults();
+    cv::Mat_<int> ordering;
+    cv::sortIdx(results, ordering,
+                cv::SORT_DESCENDING + cv::SORT_EVERY_COLUMN);
+    best[run] = states[run].at<float>(ordering.at<int>(0));
+    ASSERT_LT(std::abs(sqrt(2.f) - std::abs(best[run])), 0.1f);
+  }
+  // every island owns its generator, the number of threads does not matter
+  EXPECT_EQ(best[0], best[1]);
+  ASSERT_EQ(0, cv::countNonZero(states[0] != states[1]));
+}
+
+TEST(GenOpt, SteadyState) {
+  struct Utility : ssig::UtilityFunctor {
+    float operator()(const cv::Mat& v) const override {
+      const float x = v.at<float>(0);
+      return -std::abs(x * x - 2);
+    }
+  };
+
+  cv::Ptr<ssig::UtilityFunctor> util = cv::makePtr<Utility>();
+  typedef cv::Ptr<ssig::GeneticOptimizator::CrossOverFunctor> crossPtr;
+  crossPtr cross = cv::makePtr<TestCrossover>();
+  auto genOpt = ssig::GeneticOptimizator::create(12345, util, cross);
+  genOpt->setMutationRange(cv::Point2d(-5, 5));
+  genOpt->setMutationRate(0.2);
+  genOpt->setPopulationLength(200);
+  genOpt->setMutationType(ssig::GeneticOptimizator::Gaussian);
+  genOpt->setMaxIterations(50);
+  genOpt->setDimensions(1);
+  genOpt->setSteadyState(true);
+
+  genOpt->learn(cv::Mat_<float>());
+  cv::Mat results = genOpt->getResults();
+  ASSERT_EQ(200, results.rows);
+  double best;
+  cv::Point bestLoc;
+  cv::minMaxLoc(results, nullptr, &best, nullptr, &bestLoc);
+  auto actual = genOpt->getState().at<float>(bestLoc.y);
+  ASSERT_LT(std::abs(sqrt(2.f) - std::abs(actual)), 0.1f);
+  ASSERT_FLOAT_EQ(static_cast<float>(best), genOpt->getBestUtil());
+}
@@ -0,0 +1,69 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include <gtest/gtest.h>
+// opencv
+#include <opencv2/core.hpp>
+// ssiglib
+#include "ssiglib/core/image_pyramid.hpp"
+#include "ssiglib/core/sampling.hpp"
+
+TEST(ImagePyramid, Levels) {
+  cv::Mat image(480, 640, CV_8UC3);
+  cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(255));
+
+  ssig::ImagePyramid pyramid(image, 2.f, cv::Size(64, 64));
+  // 640x480, 320x240, 160x120, 80x60 is below the minimum
+  ASSERT_EQ(3, pyramid.getLevels());
+  EXPECT_EQ(0, cv::norm(image, pyramid.getLevel(0), cv::NORM_INF));
+  EXPECT_EQ(cv::Size(320, 240), pyramid.getLevel(1).size());
+  EXPECT_EQ(cv::Size(160, 120), pyramid.getLevel(2).size());
+  EXPECT_DOUBLE_EQ(4.0, pyramid.getScale(2));
+  EXPECT_EQ(cv::Rect(40, 80, 256, 512),
+            pyramid.toBase(cv::Rect(10, 20, 64, 128), 2));
+
+  auto windows = ssig::Sampling::windowRange(pyramid, 1, 64, 128,
+                                             0.5f, 0.5f);
+  auto expected = ssig::Sampling::sampleImage(320, 240, 64, 128,
+                                              0.5f, 0.5f);
+  ASSERT_EQ(expected.size(), windows.size());
+  EXPECT_EQ(expected.back(), windows[windows.size() - 1]);
+}
@@ -0,0 +1,108 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include <gtest/gtest.h>
+// c++
+#include <thread>
+#include <vector>
+// opencv
+#include <opencv2/core.hpp>
+// ssiglib
+#include "ssiglib/core/mat_pool.hpp"
+
+TEST(MatPool, ReusesBuffers) {
+  auto& pool = ssig::MatPool::instance();
+  cv::MatAllocator* previous = cv::Mat::getDefaultAllocator();
+  cv::Mat kept;
+  {
+    ssig::MatPoolScope scope;
+    ASSERT_EQ(&pool, cv::Mat::getDefaultAllocator());
+    pool.resetStats();
+    for (int i = 0; i < 100; ++i) {
+      cv::Mat_<float> tmp(32 + i % 3, 17);
+      tmp = static_cast<float>(i);
+      EXPECT_FLOAT_EQ(static_cast<float>(i), tmp(0, 0));
+    }
+    kept = cv::Mat_<double>(10, 10, 1.0);
+
+    auto stats = pool.getStats();
+    EXPECT_EQ(101u, stats.allocations);
+    EXPECT_GT(stats.getReuseRate(), 0.9);
+    EXPECT_GE(stats.peakBytes, stats.bytesInUse + stats.bytesCached);
+    EXPECT_GE(stats.bytesInUse, 10 * 10 * sizeof(double));
+  }
+  EXPECT_EQ(previous, cv::Mat::getDefaultAllocator());
+
+  // the matrix outlives the scope and is still released to the pool
+  EXPECT_DOUBLE_EQ(100.0, cv::sum(kept)[0]);
+  const auto inUse = pool.getStats().bytesInUse;
+  kept.release();
+  EXPECT_LT(pool.getStats().bytesInUse, inUse);
+
+  pool.trim();
+  EXPECT_EQ(0u, pool.getStats().bytesCached);
+}
+
+TEST(MatPool, ThreadsKeepTheirOwnFreeLists) {
+  auto& pool = ssig::MatPool::instance();
+  ssig::MatPoolScope scope;
+  pool.resetStats();
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([t]() {
+      ssig::MatPoolScope nested;
+      for (int i = 0; i < 200; ++i) {
+        cv::Mat_<int> tmp(8 + t, 64, i);
+        ASSERT_EQ(i, tmp(7, 63));
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  auto stats = pool.getStats();
+  EXPECT_EQ(800u, stats.allocations);
+  EXPECT_GE(stats.reused, 4u * 199u);
+  // the exiting threads gave their cached buffers back
+  EXPECT_EQ(0u, stats.bytesInUse);
+  EXPECT_EQ(0u, stats.bytesCached);
+}
@@ -0,0 +1,91 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include <gtest/gtest.h>
+// opencv
+#include <opencv2/core.hpp>
+// ssiglib
+#include <ssiglib/core/math.hpp>
+
+TEST(ColumnStatistics, MatchesMeanStdDev) {
+  // a large offset checks that the single pass does not cancel
+  cv::Mat_<float> samples(1000, 7);
+  cv::RNG rng(1234);
+  rng.fill(samples, cv::RNG::NORMAL, 1.0e4, 3.0);
+
+  cv::Mat_<float> mean, std;
+  ssig::computeMeanStd(samples, cv::ml::COL_SAMPLE, mean, std);
+
+  ASSERT_EQ(1, mean.rows);
+  ASSERT_EQ(samples.cols, mean.cols);
+  for (int c = 0; c < samples.cols; ++c) {
+    cv::Scalar expectedMean, expectedStd;
+    cv::meanStdDev(samples.col(c), expectedMean, expectedStd);
+    EXPECT_NEAR(expectedMean[0], mean[0][c], 1e-3);
+    EXPECT_NEAR(expectedStd[0], std[0][c], 1e-3);
+  }
+
+  ssig::computeMeanStd(samples, cv::ml::ROW_SAMPLE, mean, std);
+  ASSERT_EQ(samples.rows, mean.rows);
+  cv::Scalar expectedMean, expectedStd;
+  cv::meanStdDev(samples.row(3), expectedMean, expectedStd);
+  EXPECT_NEAR(expectedMean[0], mean[3][0], 1e-3);
+  EXPECT_NEAR(expectedStd[0], std[3][0], 1e-3);
+}
+
+TEST(ColumnStatistics, ZScore) {
+  cv::Mat_<float> samples = (cv::Mat_<float>(3, 2) <<
+    1, 5,
+    2, 5,
+    3, 5);
+
+  cv::Mat_<float> mean, std;
+  ssig::computeMeanStd(samples, cv::ml::COL_SAMPLE, mean, std);
+  ssig::computeZScore(samples, mean, std);
+
+  const float deviation = std::sqrt(2.f / 3.f);
+  EXPECT_FLOAT_EQ(-1 / deviation, samples[0][0]);
+  EXPECT_FLOAT_EQ(0, samples[1][0]);
+  EXPECT_FLOAT_EQ(1 / deviation, samples[2][0]);
+  // constant columns have zero deviation and are mapped to zero
+  EXPECT_FLOAT_EQ(0, samples[0][1]);
+  EXPECT_FLOAT_EQ(0, samples[2][1]);
+}
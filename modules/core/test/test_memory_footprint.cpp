@@ -0,0 +1,147 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include <gtest/gtest.h>
+// c++
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+// opencv
+#include <opencv2/core.hpp>
+// ssiglib
+#include "ssiglib/core/algorithm.hpp"
+#include "ssiglib/core/mapped_file.hpp"
+#include "ssiglib/core/memory_footprint.hpp"
+
+namespace {
+class Model : public ssig::Algorithm {
+ public:
+  explicit Model(const cv::Mat& weights) : mWeights(weights) {}
+
+  ssig::MemoryFootprint memoryFootprint() const override {
+    ssig::MemoryFootprint ans = Algorithm::memoryFootprint();
+    ans.addMat("weights", mWeights);
+    return ans;
+  }
+
+ protected:
+  void read(const cv::FileNode& fn) override {}
+  void write(cv::FileStorage& fs) const override {}
+
+ private:
+  cv::Mat mWeights;
+};
+}  // namespace
+
+TEST(MemoryFootprint, OwnedAndShared) {
+  const cv::Mat_<float> owned(100, 10);
+  cv::Mat_<float> shared(50, 10);
+  cv::Mat_<float> view = shared.rowRange(0, 5);
+
+  ssig::MemoryFootprint footprint;
+  footprint.addMat("owned", owned);
+  footprint.addMat("shared", view);
+  ssig::MemoryFootprint child;
+  child.addMat("shared", shared);
+  child.addOwned("other", 24);
+  footprint.addChild("child", child);
+
+  EXPECT_EQ(4000u + 24u, footprint.getOwnedBytes());
+  // the view and its parent are one buffer
+  EXPECT_EQ(2000u, footprint.getSharedBytes());
+  EXPECT_EQ(6024u, footprint.getTotalBytes());
+  ASSERT_EQ(1u, footprint.getChildren().size());
+  EXPECT_EQ("child", footprint.getChildren()[0].getName());
+}
+
+TEST(MemoryFootprint, MappedViews) {
+  {
+    std::ofstream out("memory_footprint.bin", std::ios::binary);
+    const std::vector<char> bytes(4096, 0);
+    out.write(bytes.data(), bytes.size());
+  }
+  {
+    auto file = std::make_shared<ssig::MappedFile>("memory_footprint.bin");
+    cv::Mat first = ssig::MappedFile::view(file, 0, 10, 10, CV_32F);
+    const cv::Mat second = ssig::MappedFile::view(file, 400, 5, 10, CV_32F);
+    file.reset();
+    EXPECT_NE(nullptr, ssig::MappedFile::getMapping(first.rowRange(2, 4)));
+    EXPECT_EQ(nullptr, ssig::MappedFile::getMapping(cv::Mat_<float>(2, 2)));
+
+    // a view with a single header is still the file, not owned memory
+    ssig::MemoryFootprint footprint;
+    footprint.addMat("first", first);
+    EXPECT_EQ(0u, footprint.getOwnedBytes());
+    EXPECT_EQ(4096u, footprint.getSharedBytes());
+    // every view of the file counts it once
+    footprint.addMat("second", second);
+    EXPECT_EQ(4096u, footprint.getSharedBytes());
+  }
+  remove("memory_footprint.bin");
+}
+
+TEST(MemoryFootprint, Tally) {
+  auto& tally = ssig::MemoryTally::instance();
+  const cv::Mat_<float> weights(100, 10);
+  {
+    Model a(cv::Mat_<float>(1000, 10)), b(weights), c(weights);
+    tally.track("a", a);
+    tally.track("b", b);
+    EXPECT_EQ(44000u, tally.getTotalBytes());
+    // c shares the weights of b
+    tally.track("c", c);
+    EXPECT_EQ(44000u, tally.getTotalBytes());
+    const auto footprints = tally.getFootprints();
+    ASSERT_EQ(3u, footprints.size());
+    EXPECT_EQ("a", footprints[0].getName());
+
+    tally.untrack("c");
+    tally.setLimit(50000);
+    Model d(cv::Mat_<float>(1000, 10));
+    EXPECT_THROW(tally.track("d", d), std::length_error);
+    EXPECT_EQ(2u, tally.getFootprints().size());
+    tally.setLimit(0);
+  }
+  // destroyed models are untracked
+  EXPECT_EQ(0u, tally.getTotalBytes());
+}
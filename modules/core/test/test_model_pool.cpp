@@ -0,0 +1,108 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include <gtest/gtest.h>
+// c++
+#include <atomic>
+#include <vector>
+// opencv
+#include <opencv2/core.hpp>
+// ssiglib
+#include "ssiglib/core/executor.hpp"
+#include "ssiglib/core/model_pool.hpp"
+
+namespace {
+struct Scratch {
+  cv::Mat_<float> weights;
+  int owner = -1;
+};
+}  // namespace
+
+TEST(ModelPool, ReusesInstances) {
+  cv::Mat_<float> weights(4, 4, 1.0f);
+  ssig::ModelPool<Scratch> pool([&weights] {
+    cv::Ptr<Scratch> model(new Scratch());
+    model->weights = weights;
+    return model;
+  });
+
+  {
+    auto first = pool.acquire();
+    auto second = pool.acquire();
+    EXPECT_NE(first.get(), second.get());
+    // the weights are shared by the instances, not copied
+    EXPECT_EQ(weights.data, first->weights.data);
+    EXPECT_EQ(weights.data, second->weights.data);
+    EXPECT_EQ(0u, pool.getNumIdle());
+  }
+  EXPECT_EQ(2u, pool.getNumInstances());
+  EXPECT_EQ(2u, pool.getNumIdle());
+
+  for (int i = 0; i < 10; ++i) {
+    auto lease = pool.acquire();
+    lease->owner = i;
+  }
+  EXPECT_EQ(2u, pool.getNumInstances());
+
+  pool.clear();
+  EXPECT_EQ(0u, pool.getNumInstances());
+  EXPECT_EQ(0u, pool.getNumIdle());
+}
+
+TEST(ModelPool, Concurrent) {
+  ssig::ModelPool<Scratch> pool([] {
+    return cv::Ptr<Scratch>(new Scratch());
+  });
+  ssig::Executor executor(4);
+  std::atomic<int> clashes(0);
+  executor.parallelFor(0, 1000, [&](const int first, const int last) {
+    for (int i = first; i < last; ++i) {
+      auto lease = pool.acquire();
+      lease->owner = i;
+      for (volatile int spin = 0; spin < 100; ++spin) {}
+      if (lease->owner != i)
+        ++clashes;
+    }
+  });
+  EXPECT_EQ(0, clashes.load());
+  EXPECT_GE(4u, pool.getNumInstances());
+  EXPECT_EQ(pool.getNumInstances(), pool.getNumIdle());
+}
@@ -0,0 +1,121 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include <gtest/gtest.h>
+// c++
+#include <string>
+#include <thread>
+#include <vector>
+// ssiglib
+#include "ssiglib/core/profiler.hpp"
+
+static const ssig::Profiler::Timing* findTiming(
+  const std::vector<ssig::Profiler::Timing>& timings,
+  const std::string& name) {
+  for (const auto& timing : timings) {
+    if (timing.name == name)
+      return &timing;
+  }
+  return nullptr;
+}
+
+TEST(Profiler, Percentiles) {
+  auto& profiler = ssig::Profiler::instance();
+  profiler.reset();
+  // 1ms to 100ms
+  for (int i = 1; i <= 100; ++i)
+    profiler.addSample("Profiler.Percentiles", i * 1e-3);
+
+  const auto timings = profiler.getTimings();
+  const auto* timing = findTiming(timings, "Profiler.Percentiles");
+  ASSERT_NE(nullptr, timing);
+  EXPECT_EQ(100, timing->calls);
+  EXPECT_NEAR(5.05, timing->total, 1e-9);
+  EXPECT_DOUBLE_EQ(1e-3, timing->min);
+  EXPECT_DOUBLE_EQ(0.1, timing->max);
+  // buckets are 1/16 of a power of two wide
+  EXPECT_NEAR(50e-3, timing->p50, 50e-3 / 16);
+  EXPECT_NEAR(99e-3, timing->p99, 99e-3 / 16);
+}
+
+TEST(Profiler, ThreadsAreMerged) {
+  auto& profiler = ssig::Profiler::instance();
+  profiler.reset();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([]() {
+      for (int i = 0; i < 1000; ++i) {
+        ssig::ScopedTimer timer("Profiler.Threads");
+        ssig::Profiler::instance().addCount("Profiler.Bytes", 8);
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  const auto timings = profiler.getTimings();
+  const auto* timing = findTiming(timings, "Profiler.Threads");
+  ASSERT_NE(nullptr, timing);
+  EXPECT_EQ(4000, timing->calls);
+
+  const auto counters = profiler.getCounters();
+  ASSERT_EQ(1u, counters.size());
+  EXPECT_EQ("Profiler.Bytes", counters[0].first);
+  EXPECT_EQ(32000, counters[0].second);
+}
+
+TEST(Profiler, Json) {
+  auto& profiler = ssig::Profiler::instance();
+  profiler.reset();
+  profiler.addSample("Profiler.\"Json\"", 2e-3);
+  profiler.addCount("Profiler.Count", 3);
+
+  const std::string json = profiler.toJson();
+  EXPECT_NE(std::string::npos,
+            json.find("\"name\": \"Profiler.\\\"Json\\\"\""));
+  EXPECT_NE(std::string::npos, json.find("\"calls\": 1"));
+  EXPECT_NE(std::string::npos, json.find("\"p50_ms\": 2.000000"));
+  EXPECT_NE(std::string::npos, json.find("\"value\": 3"));
+
+  profiler.reset();
+  EXPECT_TRUE(profiler.getTimings().empty());
+  EXPECT_TRUE(profiler.getCounters().empty());
+}
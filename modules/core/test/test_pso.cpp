@@ -44,6 +44,7 @@
 #include <ssiglib/core/math.hpp>
 
 #include "ssiglib/core/pso.hpp"
+#include "ssiglib/core/executor.hpp"
 
 
 struct Distance : ssig::DistanceFunctor {
@@ -123,3 +124,93 @@ TEST(PSO, 2Dimensions) {
 
   ASSERT_LE(abs(x*x + y), 0.1f);
 }
+
+TEST(PSO, BatchUtility) {
+  struct BatchUtility : ssig::BatchUtilityFunctor {
+    void operator()(const cv::Mat& population,
+                    cv::Mat_<float>& utilities) const override {
+      cv::Mat_<float> x = population.col(0);
+      utilities = -1 * cv::abs(x.mul(x) - 2);
+    }
+  };
+  cv::Ptr<ssig::UtilityFunctor> util;
+  cv::Ptr<ssig::BatchUtilityFunctor> batch = cv::makePtr<BatchUtility>();
+  cv::Ptr<ssig::DistanceFunctor> dist = cv::makePtr<Distance>();
+  auto pso = ssig::PSO::create(util, dist);
+  pso->setBatchUtilityFunctor(batch);
+  cv::Mat_<float> input;
+  cv::Vec3f inertia(0.8f, 0.8f, 1.f);
+  pso->setInertia(inertia);
+  pso->setDimensionality(1);
+  cv::Mat_<float> minRange = cv::Mat_<float>::zeros(1, 1);
+  cv::Mat_<float> maxRange = cv::Mat_<float>::zeros(1, 1);
+  minRange = -10.f;
+  maxRange = 10.f;
+  pso->setPopulationConstraint(minRange, maxRange);
+  pso->setEps(1.0e-5);
+  pso->setPopulationLength(300);
+  pso->setMaxIterations(1000);
+
+  pso->learn(input);
+  auto actual = pso->getBestPosition().at<float>(0);
+  ASSERT_LT(std::abs(sqrt(2.f) - std::abs(actual)), 0.1f);
+}
+
+TEST(PSO, Reproducible) {
+  struct Utility : ssig::UtilityFunctor {
+    float operator()(const cv::Mat& v) const override {
+      const float x = v.at<float>(0);
+      const float y = v.at<float>(1);
+      return -std::abs(x * x + y);
+    }
+  };
+  cv::Ptr<ssig::UtilityFunctor> util = cv::makePtr<Utility>();
+  cv::Ptr<ssig::DistanceFunctor> dist = cv::makePtr<Distance>();
+  cv::Mat_<float> minRange = cv::Mat_<float>::zeros(1, 2);
+  cv::Mat_<float> maxRange = cv::Mat_<float>::zeros(1, 2);
+  minRange = -10.f;
+  maxRange = 10.f;
+
+  cv::Mat positions[2];
+  for (int run = 0; run < 2; ++run) {
+    auto pso = ssig::PSO::create(util, dist);
+    pso->setInertia(cv::Vec3f(0.8f, 0.8f, 1.f));
+    pso->setDimensionality(2);
+    pso->setPopulationConstraint(minRange, maxRange);
+    pso->setPopulationLength(200);
+    pso->setMaxIterations(50);
+    pso->setSeed(7);
+    // the second run uses every thread of the executor
+    ssig::Executor::global().setConcurrency(run == 0 ? 1 : 0);
+    pso->learn(cv::Mat_<float>());
+    ssig::Executor::global().setConcurrency(0);
+    positions[run] = pso->getState();
+  }
+  ASSERT_EQ(0, cv::countNonZero(positions[0] != positions[1]));
+}
+
+TEST(PSO, SteadyState) {
+  struct Utility : ssig::UtilityFunctor {
+    float operator()(const cv::Mat& v) const override {
+      const float x = v.at<float>(0);
+      return -std::abs(x * x - 2);
+    }
+  };
+  cv::Ptr<ssig::UtilityFunctor> util = cv::makePtr<Utility>();
+  cv::Ptr<ssig::DistanceFunctor> dist = cv::makePtr<Distance>();
+  auto pso = ssig::PSO::create(util, dist);
+  cv::Mat_<float> minRange = cv::Mat_<float>::zeros(1, 1);
+  cv::Mat_<float> maxRange = cv::Mat_<float>::zeros(1, 1);
+  minRange = -10.f;
+  maxRange = 10.f;
+  pso->setInertia(cv::Vec3f(0.8f, 0.8f, 1.f));
+  pso->setDimensionality(1);
+  pso->setPopulationConstraint(minRange, maxRange);
+  pso->setPopulationLength(100);
+  pso->setMaxIterations(200);
+  pso->setSteadyState(true);
+
+  pso->learn(cv::Mat_<float>());
+  auto actual = pso->getBestPosition().at<float>(0);
+  ASSERT_LT(std::abs(sqrt(2.f) - std::abs(actual)), 0.1f);
+}
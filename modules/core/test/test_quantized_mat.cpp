@@ -0,0 +1,101 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include <gtest/gtest.h>
+// c++
+#include <cmath>
+#include <limits>
+// opencv
+#include <opencv2/core.hpp>
+// ssiglib
+#include "ssiglib/core/distance_kernels.hpp"
+#include "ssiglib/core/quantized_mat.hpp"
+
+TEST(QuantizedMat, HalfConversion) {
+  using ssig::QuantizedMat;
+  // every finite half survives the round trip
+  for (int bits = 0; bits < 0x10000; ++bits) {
+    const float value = QuantizedMat::fromHalf(static_cast<uint16_t>(bits));
+    if (std::isnan(value))
+      continue;
+    ASSERT_EQ(bits, QuantizedMat::toHalf(value));
+  }
+  EXPECT_EQ(1.f, QuantizedMat::fromHalf(QuantizedMat::toHalf(1.f)));
+  EXPECT_EQ(65504.f, QuantizedMat::fromHalf(QuantizedMat::toHalf(65504.f)));
+  EXPECT_TRUE(std::isinf(
+    QuantizedMat::fromHalf(QuantizedMat::toHalf(70000.f))));
+  EXPECT_TRUE(std::isnan(QuantizedMat::fromHalf(
+    QuantizedMat::toHalf(std::numeric_limits<float>::quiet_NaN()))));
+  // the smallest subnormal half
+  EXPECT_EQ(1, QuantizedMat::toHalf(std::ldexp(1.f, -24)));
+}
+
+TEST(QuantizedMat, DecodeAndScore) {
+  cv::setRNGSeed(1234);
+  cv::Mat_<float> samples(40, 128), queries(3, 128);
+  cv::randu(samples, -2, 6);
+  cv::randu(queries, -2, 6);
+  // a constant column is representable in both formats
+  samples.col(5) = 1.5f;
+
+  for (const auto format : {ssig::QuantizedMat::FLOAT16,
+                            ssig::QuantizedMat::UINT8}) {
+    const ssig::QuantizedMat quantized(samples, format);
+    ASSERT_EQ(samples.rows, quantized.getNumRows());
+    ASSERT_EQ(samples.cols, quantized.getNumCols());
+    EXPECT_LT(quantized.getMemorySize(), samples.total() * sizeof(float));
+
+    const cv::Mat_<float> decoded = quantized.toFloat();
+    // half keeps 11 significant bits, uint8 is off by half a step
+    const double tolerance =
+      format == ssig::QuantizedMat::FLOAT16 ? 6.0 / 2048 : 8.0 / 255 / 2;
+    EXPECT_LE(cv::norm(samples, decoded, cv::NORM_INF), tolerance + 1e-6);
+    EXPECT_EQ(1.5f, decoded(7, 5));
+
+    // scoring the codes equals scoring the decoded rows
+    cv::Mat_<float> scores, expected;
+    ssig::L2Kernel::manyToMany(quantized.rowRange(10, 30), queries, scores);
+    ssig::L2Kernel::manyToMany<float>(decoded.rowRange(10, 30), queries,
+                                      expected);
+    ASSERT_EQ(20, scores.rows);
+    EXPECT_LE(cv::norm(scores, expected, cv::NORM_INF), 1e-4);
+  }
+}
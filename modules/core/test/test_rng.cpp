@@ -0,0 +1,115 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include <gtest/gtest.h>
+// c++
+#include <cstdint>
+#include <random>
+#include <vector>
+// ssiglib
+#include "ssiglib/core/rng.hpp"
+
+namespace {
+// restores the seed the process started with
+struct SeedGuard {
+  uint64_t previous = ssig::getGlobalSeed();
+  ~SeedGuard() { ssig::setGlobalSeed(previous); }
+};
+
+std::vector<uint32_t> draw(ssig::PhiloxRng rng, const int len) {
+  std::vector<uint32_t> ans(len);
+  for (auto& value : ans)
+    value = rng();
+  return ans;
+}
+}  // namespace
+
+TEST(Rng, StreamsAreReproducibleAndDistinct) {
+  SeedGuard guard;
+  ssig::setGlobalSeed(42);
+  const uint64_t key = ssig::deriveSeed(ssig::RNG_PSO, 7);
+  EXPECT_EQ(key, ssig::deriveSeed(ssig::RNG_PSO, 7));
+  EXPECT_NE(key, ssig::deriveSeed(ssig::RNG_PSO, 8));
+  EXPECT_NE(key, ssig::deriveSeed(ssig::RNG_FIREFLY, 7));
+
+  const auto a = draw(ssig::PhiloxRng(key, 3), 64);
+  EXPECT_EQ(a, draw(ssig::PhiloxRng(key, 3), 64));
+  EXPECT_NE(a, draw(ssig::PhiloxRng(key, 4), 64));
+
+  // the global seed changes every derived key
+  ssig::setGlobalSeed(43);
+  EXPECT_NE(key, ssig::deriveSeed(ssig::RNG_PSO, 7));
+}
+
+TEST(Rng, DistributionsStayInRange) {
+  ssig::PhiloxRng rng(1234, 5);
+  double mean = 0, sqrMean = 0;
+  const int len = 20000;
+  std::vector<float> values(len);
+  rng.fillGaussian(values.data(), values.size(), 2.f);
+  for (const float v : values) {
+    mean += v;
+    sqrMean += v * v;
+  }
+  mean /= len;
+  sqrMean /= len;
+  EXPECT_NEAR(0.0, mean, 0.1);
+  EXPECT_NEAR(4.0, sqrMean - mean * mean, 0.2);
+
+  rng.fillUniform(values.data(), values.size(), -3.f, 5.f);
+  for (const float v : values) {
+    ASSERT_GE(v, -3.f);
+    ASSERT_LT(v, 5.f);
+  }
+  for (int i = 0; i < 1000; ++i) {
+    const int v = rng.uniform(-2, 3);
+    ASSERT_GE(v, -2);
+    ASSERT_LT(v, 3);
+  }
+
+  // usable as the engine of the standard distributions
+  std::uniform_int_distribution<int> dist(0, 9);
+  for (int i = 0; i < 1000; ++i) {
+    const int v = dist(rng);
+    ASSERT_GE(v, 0);
+    ASSERT_LE(v, 9);
+  }
+}
@@ -43,6 +43,9 @@
 #include <gtest/gtest.h>
 #include <opencv2/core.hpp>
 #include <opencv2/highgui.hpp>
+// c++
+#include <algorithm>
+#include <vector>
 
 #include <ssiglib/core/sampling.hpp>
 
@@ -62,3 +65,30 @@ TEST(ImageSampling, FeatureDetection) {
 
   auto samples = ssig::Sampling::sampleImage(img, maxPatches, winSize);
 }
+
+TEST(ImageSampling, WindowRange) {
+  auto range = ssig::Sampling::windowRange(640, 480, 64, 128, 1.0f, 2.0f,
+                                           1.2f, 0.25f, 0.25f);
+  auto samples = ssig::Sampling::sampleImage(640, 480, 64, 128, 1.0f, 2.0f,
+                                             1.2f, 0.25f, 0.25f);
+  ASSERT_EQ(samples.size(), range.size());
+  for (size_t i = 0; i < samples.size(); ++i)
+    ASSERT_EQ(samples[i], range[i]);
+
+  // chunks in any order rebuild the whole scan
+  std::vector<cv::Rect> chunk;
+  const size_t chunkSize = 1000;
+  for (size_t first = 0; first < range.size(); first += chunkSize) {
+    range.chunk(first, first + chunkSize, chunk);
+    ASSERT_EQ(std::min(chunkSize, range.size() - first), chunk.size());
+    for (size_t i = 0; i < chunk.size(); ++i)
+      ASSERT_EQ(samples[first + i], chunk[i]);
+  }
+
+  size_t count = 0;
+  for (auto window : range) {
+    ASSERT_EQ(samples[count], window);
+    ++count;
+  }
+  ASSERT_EQ(samples.size(), count);
+}
@@ -0,0 +1,150 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include <gtest/gtest.h>
+// c++
+#include <cmath>
+#include <random>
+#include <vector>
+// ssiglib
+#include "ssiglib/core/simd.hpp"
+
+namespace {
+// restores the kernels picked at startup
+struct IsaGuard {
+  ssig::simd::Isa previous = ssig::simd::getIsa();
+  ~IsaGuard() { ssig::simd::setIsa(previous); }
+};
+}  // namespace
+
+TEST(Simd, SetIsaIsClampedToTheCpu) {
+  IsaGuard guard;
+  const auto best = ssig::simd::detectIsa();
+  EXPECT_EQ(best, ssig::simd::setIsa(ssig::simd::ISA_AVX512));
+  EXPECT_EQ(best, ssig::simd::getIsa());
+  EXPECT_EQ(ssig::simd::ISA_SCALAR, ssig::simd::setIsa(ssig::simd::ISA_SCALAR));
+  EXPECT_STREQ("scalar", ssig::simd::getIsaName(ssig::simd::getIsa()));
+}
+
+TEST(Simd, VariantsMatchTheScalarReference) {
+  using namespace ssig::simd;
+  IsaGuard guard;
+  std::mt19937 gen(1234);
+  std::uniform_real_distribution<float> uniform(-20.f, 20.f);
+  std::uniform_real_distribution<float> positive(1e-6f, 50.f);
+
+  for (int isa = ISA_SSE42; isa <= detectIsa(); ++isa) {
+    SCOPED_TRACE(getIsaName(static_cast<Isa>(isa)));
+    // lengths around every vector width, to cover the tails
+    for (int len : {0, 1, 3, 4, 5, 8, 15, 16, 17, 33, 100, 1001}) {
+      SCOPED_TRACE(len);
+      std::vector<float> x(len), y(len), p(len);
+      std::vector<int> bins(len);
+      for (int i = 0; i < len; ++i) {
+        x[i] = uniform(gen);
+        y[i] = uniform(gen);
+        p[i] = positive(gen);
+        bins[i] = i % 7;
+      }
+      // a bin where x + y == 0
+      if (len > 2)
+        y[2] = -x[2];
+
+      setIsa(ISA_SCALAR);
+      const float refDot = dot(x.data(), y.data(), len);
+      const float refL1 = l1Distance(x.data(), y.data(), len);
+      const float refL2 = squaredL2Distance(x.data(), y.data(), len);
+      const float refChi2 = chi2Distance(x.data(), y.data(), len);
+      const int refArgmax = argmax(x.data(), len);
+      std::vector<float> refAxpy(y), refHist(7, 0.f);
+      axpy(0.5f, x.data(), refAxpy.data(), len);
+      accumulateHistogram(bins.data(), p.data(), len, refHist.data());
+      std::vector<float> refExp(len), refLog(len), refSigmoid(len),
+        refTanh(len);
+      exp(x.data(), refExp.data(), len);
+      log(p.data(), refLog.data(), len);
+      sigmoid(x.data(), refSigmoid.data(), len);
+      tanh(x.data(), refTanh.data(), len);
+
+      ASSERT_EQ(isa, setIsa(static_cast<Isa>(isa)));
+      EXPECT_NEAR(refDot, dot(x.data(), y.data(), len),
+                  1e-4f * (1 + std::abs(refDot)));
+      EXPECT_NEAR(refL1, l1Distance(x.data(), y.data(), len),
+                  1e-5f * (1 + refL1));
+      EXPECT_NEAR(refL2, squaredL2Distance(x.data(), y.data(), len),
+                  1e-5f * (1 + refL2));
+      const float chi2 = chi2Distance(x.data(), y.data(), len);
+      ASSERT_FALSE(std::isnan(chi2));
+      EXPECT_NEAR(refChi2, chi2, 1e-4f * (1 + std::abs(refChi2)));
+      EXPECT_EQ(refArgmax, argmax(x.data(), len));
+
+      std::vector<float> out(y), hist(7, 0.f);
+      axpy(0.5f, x.data(), out.data(), len);
+      for (int i = 0; i < len; ++i)
+        ASSERT_NEAR(refAxpy[i], out[i], 1e-5f * (1 + std::abs(refAxpy[i])));
+      accumulateHistogram(bins.data(), p.data(), len, hist.data());
+      for (int b = 0; b < 7; ++b)
+        ASSERT_FLOAT_EQ(refHist[b], hist[b]);
+
+      exp(x.data(), out.data(), len);
+      for (int i = 0; i < len; ++i)
+        ASSERT_NEAR(refExp[i], out[i], 2e-6f * refExp[i]);
+      log(p.data(), out.data(), len);
+      for (int i = 0; i < len; ++i)
+        ASSERT_NEAR(refLog[i], out[i], 2e-6f * (1 + std::abs(refLog[i])));
+      sigmoid(x.data(), out.data(), len);
+      for (int i = 0; i < len; ++i)
+        ASSERT_NEAR(refSigmoid[i], out[i], 1e-6f);
+      tanh(x.data(), out.data(), len);
+      for (int i = 0; i < len; ++i)
+        ASSERT_NEAR(refTanh[i], out[i], 1e-6f);
+    }
+  }
+}
+
+TEST(Simd, MapsInPlace) {
+  std::vector<float> x = {0.f, 1.f, -1.f, 2.f, 0.5f};
+  ssig::simd::exp(x.data(), x.data(), static_cast<int>(x.size()));
+  EXPECT_NEAR(1.f, x[0], 1e-6f);
+  EXPECT_NEAR(2.7182818f, x[1], 1e-5f);
+  EXPECT_NEAR(0.3678794f, x[2], 1e-6f);
+  EXPECT_NEAR(7.3890561f, x[3], 1e-5f);
+}
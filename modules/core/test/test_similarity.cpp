@@ -44,6 +44,7 @@
 #include <opencv2/core.hpp>
 
 #include <ssiglib/core/math.hpp>
+#include <ssiglib/core/distance_kernels.hpp>
 
 TEST(Cosine, PerpendicularitySimilarityTest) {
   cv::Mat_<float> samples = (cv::Mat_<float>(2, 2) << 0 , 1 , 1 , 0);
@@ -157,3 +158,119 @@ TEST(Chi2, Chi2Simple) {
   EXPECT_FLOAT_EQ(-1.37436854046f, simMat[0][1]);
 }
 
+
+// Deriving from a built-in functor forces the pairwise fallback path
+struct PairwiseCosine : ssig::CosineSimilarity {};
+struct PairwiseCorrelation : ssig::CorrelationSimilarity {};
+struct PairwiseEuclidean : ssig::EuclideanDistance {};
+struct PairwiseChi2 : ssig::Chi2Similarity {};
+
+// A derived functor that overrides only the pairwise operator
+struct ConstantCosine : ssig::CosineSimilarity {
+  float operator()(const cv::Mat& x,
+                   const cv::Mat& y) const override {
+    return 7.f;
+  }
+};
+
+struct ConstantL2 : ssig::KernelDistance<ssig::L2Kernel> {
+  float operator()(const cv::Mat& x,
+                   const cv::Mat& y) const override {
+    return 7.f;
+  }
+};
+
+template <class Engine, class Pairwise>
+void compareWithPairwise(const cv::Mat_<float>& samples) {
+  Engine engine;
+  Pairwise pairwise;
+  cv::Mat_<float> expected = ssig::Math::buildSimilarity(samples, pairwise);
+  cv::Mat_<float> actual = ssig::Math::buildSimilarity(samples, engine);
+
+  ASSERT_EQ(samples.rows, actual.rows);
+  ASSERT_EQ(samples.rows, actual.cols);
+  for (int i = 0; i < samples.rows; ++i) {
+    EXPECT_FLOAT_EQ(0, actual[i][i]);
+    for (int j = i + 1; j < samples.rows; ++j) {
+      EXPECT_NEAR(expected[i][j], actual[i][j], 1e-3);
+      EXPECT_FLOAT_EQ(actual[i][j], actual[j][i]);
+    }
+  }
+}
+
+template <class Functor>
+void expectConstant(const cv::Mat_<float>& samples) {
+  Functor functor;
+  cv::Mat_<float> simMat = ssig::Math::buildSimilarity(samples, functor);
+  cv::Mat_<float> oneToMany, manyToMany;
+  functor.oneToMany(samples.row(0), samples, oneToMany);
+  functor.manyToMany(samples, samples, manyToMany);
+  for (int i = 0; i < samples.rows; ++i) {
+    EXPECT_FLOAT_EQ(7.f, oneToMany[0][i]);
+    for (int j = 0; j < samples.rows; ++j) {
+      EXPECT_FLOAT_EQ(7.f, manyToMany[i][j]);
+      if (i != j) {
+        EXPECT_FLOAT_EQ(7.f, simMat[i][j]);
+      }
+    }
+  }
+}
+
+template <class Metric>
+void compareBatchWithPairwise(const cv::Mat_<float>& A,
+                              const cv::Mat_<float>& B) {
+  Metric metric;
+  cv::Mat_<float> oneToMany, manyToMany;
+  metric.oneToMany(A.row(0), B, oneToMany);
+  metric.manyToMany(A, B, manyToMany);
+
+  ASSERT_EQ(1, oneToMany.rows);
+  ASSERT_EQ(B.rows, oneToMany.cols);
+  ASSERT_EQ(A.rows, manyToMany.rows);
+  ASSERT_EQ(B.rows, manyToMany.cols);
+  for (int i = 0; i < A.rows; ++i) {
+    for (int j = 0; j < B.rows; ++j) {
+      const float expected = metric(A.row(i), B.row(j));
+      EXPECT_NEAR(expected, manyToMany[i][j], 1e-3);
+      if (i == 0) {
+        EXPECT_NEAR(expected, oneToMany[0][j], 1e-3);
+      }
+    }
+  }
+}
+
+TEST(SimilarityEngine, MatchesPairwiseAcrossTiles) {
+  // more rows than a single tile so off-diagonal tiles are exercised
+  cv::Mat_<float> samples(150, 37);
+  cv::RNG rng(1234);
+  rng.fill(samples, cv::RNG::UNIFORM, 0.f, 1.f);
+
+  compareWithPairwise<ssig::CosineSimilarity, PairwiseCosine>(samples);
+  compareWithPairwise<ssig::CorrelationSimilarity,
+                      PairwiseCorrelation>(samples);
+  compareWithPairwise<ssig::EuclideanDistance, PairwiseEuclidean>(samples);
+  compareWithPairwise<ssig::Chi2Similarity, PairwiseChi2>(samples);
+}
+
+TEST(SimilarityEngine, BatchMatchesPairwise) {
+  cv::Mat_<float> A(5, 13), B(9, 13);
+  cv::RNG rng(4321);
+  rng.fill(A, cv::RNG::UNIFORM, 0.f, 1.f);
+  rng.fill(B, cv::RNG::UNIFORM, 0.f, 1.f);
+
+  compareBatchWithPairwise<ssig::CosineSimilarity>(A, B);
+  compareBatchWithPairwise<ssig::CorrelationSimilarity>(A, B);
+  compareBatchWithPairwise<ssig::EuclideanDistance>(A, B);
+  compareBatchWithPairwise<ssig::Chi2Similarity>(A, B);
+  compareBatchWithPairwise<PairwiseCosine>(A, B);
+}
+
+TEST(SimilarityEngine, DerivedFunctorKeepsItsOperator) {
+  // more rows than a single tile so the tiled path is exercised
+  cv::Mat_<float> samples(70, 5);
+  cv::RNG rng(99);
+  rng.fill(samples, cv::RNG::UNIFORM, 0.f, 1.f);
+
+  expectConstant<ConstantCosine>(samples);
+  expectConstant<ConstantL2>(samples);
+}
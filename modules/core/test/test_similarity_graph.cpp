@@ -0,0 +1,119 @@
+/*L*****************************************************************************
+*
+*  Copyright (c) 2015, Smart Surveillance Interest Group, all rights reserved.
+*
+*  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+*
+*  By downloading, copying, installing or using the software you agree to this
+*  license. If you do not agree to this license, do not download, install, copy
+*  or use the software.
+*
+*                Software License Agreement (BSD License)
+*             For Smart Surveillance Interest Group Library
+*                         http://ssig.dcc.ufmg.br
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions are met:
+*
+*    1. Redistributions of source code must retain the above copyright notice,
+*       this list of conditions and the following disclaimer.
+*
+*    2. Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in the
+*       documentation and/or other materials provided with the distribution.
+*
+*    3. Neither the name of the copyright holder nor the names of its
+*       contributors may be used to endorse or promote products derived from
+*       this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+*  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+*  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+*  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+*  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+*  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+*  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+*  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+*  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+*  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*****************************************************************************L*/
+
+#include <gtest/gtest.h>
+// opencv
+#include <opencv2/core.hpp>
+// c++
+#include <algorithm>
+#include <vector>
+// ssiglib
+#include <ssiglib/core/math.hpp>
+#include <ssiglib/core/similarity_graph.hpp>
+
+TEST(SimilarityGraph, ExactMatchesDenseTopK) {
+  cv::Mat_<float> samples(300, 8);
+  cv::RNG rng(1234);
+  rng.fill(samples, cv::RNG::UNIFORM, 0.f, 1.f);
+  const int k = 5;
+
+  ssig::CosineSimilarity cosine;
+  cv::Mat_<float> dense = ssig::Math::buildSimilarity(samples, cosine);
+  ssig::SimilarityGraph graph;
+  ssig::SimilarityGraph::buildExact(samples, cosine, k, graph);
+
+  ASSERT_EQ(samples.rows, graph.getNodes());
+  ASSERT_EQ(samples.rows * k, graph.getEdges());
+  for (int r = 0; r < samples.rows; ++r) {
+    std::vector<float> row(dense[r], dense[r] + dense.cols);
+    row.erase(row.begin() + r);
+    std::sort(row.begin(), row.end(), std::greater<float>());
+
+    ASSERT_EQ(k, graph.getDegree(r));
+    for (int e = 0; e < k; ++e) {
+      EXPECT_NE(r, graph.neighbours(r)[e]);
+      EXPECT_NEAR(row[e], graph.scores(r)[e], 1e-5);
+    }
+  }
+}
+
+TEST(SimilarityGraph, ApproximateFindsNearestNeighbours) {
+  cv::Mat_<float> samples(200, 4);
+  cv::RNG rng(4321);
+  rng.fill(samples, cv::RNG::UNIFORM, 0.f, 1.f);
+  const int k = 3;
+
+  ssig::EuclideanDistance euclidean;
+  ssig::SimilarityGraph exact, approximate;
+  ssig::SimilarityGraph::buildExact(samples, euclidean, k, exact,
+                                    ssig::SimilarityGraph::LOWEST_SCORE);
+  ssig::SimilarityGraph::buildApproximate(samples, euclidean, k, approximate,
+                                          512);
+
+  int hits = 0;
+  for (int r = 0; r < samples.rows; ++r) {
+    const int* begin = exact.neighbours(r);
+    const int* end = begin + exact.getDegree(r);
+    for (int e = 0; e < approximate.getDegree(r); ++e) {
+      if (std::find(begin, end, approximate.neighbours(r)[e]) != end)
+        ++hits;
+    }
+  }
+  EXPECT_GT(hits, static_cast<int>(0.9 * exact.getEdges()));
+}
+
+TEST(SimilarityGraph, Symmetrize) {
+  cv::Mat_<float> samples = (cv::Mat_<float>(3, 1) << 0, 1, 10);
+
+  ssig::EuclideanDistance euclidean;
+  ssig::SimilarityGraph graph;
+  ssig::SimilarityGraph::buildExact(samples, euclidean, 1, graph,
+                                    ssig::SimilarityGraph::LOWEST_SCORE);
+  // 0 <-> 1 and 2 -> 1
+  EXPECT_EQ(3, graph.getEdges());
+
+  graph.symmetrize();
+  cv::Mat_<float> dense = graph.toDense();
+  EXPECT_EQ(4, graph.getEdges());
+  EXPECT_FLOAT_EQ(9, dense[1][2]);
+  EXPECT_FLOAT_EQ(9, dense[2][1]);
+  EXPECT_FLOAT_EQ(0, dense[0][2]);
+}
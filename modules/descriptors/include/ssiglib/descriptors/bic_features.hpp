@@ -53,6 +53,8 @@ class BIC : public Descriptor2D {
   DESCRIPTORS_EXPORT virtual ~BIC(void) = default;
   DESCRIPTORS_EXPORT BIC(const BIC& rhs);
 
+  DESCRIPTORS_EXPORT MemoryFootprint memoryFootprint() const override;
+
  protected:
   DESCRIPTORS_EXPORT void read(const cv::FileNode& fn) override;
   DESCRIPTORS_EXPORT void write(cv::FileStorage& fs) const override;
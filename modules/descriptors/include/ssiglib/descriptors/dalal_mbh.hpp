@@ -59,6 +59,8 @@ class DalalMBH : public TemporalDescriptors {
   DESCRIPTORS_EXPORT void setOpticalFlowMethod(
     const cv::Ptr<cv::DenseOpticalFlow>& method);
 
+  DESCRIPTORS_EXPORT MemoryFootprint memoryFootprint() const override;
+
  protected:
   DESCRIPTORS_EXPORT void read(const cv::FileNode& fn) override;
   DESCRIPTORS_EXPORT void write(cv::FileStorage& fs) const override;
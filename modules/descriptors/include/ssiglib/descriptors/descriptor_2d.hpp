@@ -45,9 +45,14 @@
 // opencv
 #include <opencv2/core.hpp>
 // c++
+#include <atomic>
+#include <mutex>
 #include <vector>
 // ssiglib
 #include "ssiglib/core/algorithm.hpp"
+#include "ssiglib/core/feature_store.hpp"
+#include "ssiglib/core/image_pyramid.hpp"
+#include "ssiglib/core/sampling.hpp"
 #include "ssiglib/descriptors/descriptors_defs.hpp"
 #include "ssiglib/descriptors/descriptor.hpp"
 
@@ -66,6 +71,10 @@ class Descriptor2D : public Descriptor {
   On the first call to this function it returns the feature vector
   of the mat set up in the constructor call.
 
+  The extract overloads may run concurrently on one instance: the first
+  call prepares the image once and extractFeatures() only reads the
+  prepared state. setData() must not race with them.
+
   @param out The matrix that will contain the feature vector for the current
   patch.
   */
@@ -74,8 +83,41 @@ class Descriptor2D : public Descriptor {
                                   cv::Mat& output);
   DESCRIPTORS_EXPORT void extract(const std::vector<cv::KeyPoint>& keypoints,
                                   cv::Mat& output);
+  /**
+  Extracts one feature row per window of the range. The output is
+  allocated once from the range size instead of growing row by row.
+  */
+  DESCRIPTORS_EXPORT void extract(const WindowRange& windows,
+                                  cv::Mat& output);
+  /**
+  Appends one feature row per window to the store instead of a matrix, so
+  the features of a whole dataset never need to fit in memory. The label
+  overloads tag every row with label.
+  */
+  DESCRIPTORS_EXPORT void extract(const std::vector<cv::Rect>& windows,
+                                  FeatureStoreWriter& store);
+  DESCRIPTORS_EXPORT void extract(const std::vector<cv::Rect>& windows,
+                                  const int label,
+                                  FeatureStoreWriter& store);
+  DESCRIPTORS_EXPORT void extract(const WindowRange& windows,
+                                  FeatureStoreWriter& store);
+  DESCRIPTORS_EXPORT void extract(const WindowRange& windows,
+                                  const int label,
+                                  FeatureStoreWriter& store);
 
   DESCRIPTORS_EXPORT void setData(const cv::Mat& img);
+  /**
+  Uses one level of a pyramid as the image. The level is shared, not copied,
+  so the pyramid built for a frame serves every descriptor.
+  */
+  DESCRIPTORS_EXPORT void setData(const ImagePyramid& pyramid,
+                                  const int level);
+
+  /**
+  The image is reported as shared when it is a pyramid level or the
+  caller's matrix, and as owned when it was converted or cloned.
+  */
+  DESCRIPTORS_EXPORT MemoryFootprint memoryFootprint() const override;
 
 
  protected:
@@ -83,11 +125,25 @@ class Descriptor2D : public Descriptor {
   DESCRIPTORS_EXPORT void write(cv::FileStorage& fs) const override = 0;
 
   DESCRIPTORS_EXPORT virtual void beforeProcess() = 0;
+  /**
+  Called concurrently by the extract overloads, so implementations keep
+  their scratch local and only read what beforeProcess() built.
+  */
   DESCRIPTORS_EXPORT virtual void extractFeatures(const cv::Rect& patch,
                                                   cv::Mat& output) = 0;
+  template <class Windows>
+  void extractToStore(const Windows& windows, const int* label,
+                      FeatureStoreWriter& store);
+
   std::vector<cv::Rect> mPatches;
   cv::Mat mImage;
-  bool mIsPrepared = false;
+  std::atomic<bool> mIsPrepared{false};
+
+ private:
+  // runs beforeProcess() once, even when extract is called from many threads
+  void prepare();
+
+  std::mutex mPrepareLock;
 };
 
 }  // namespace ssig
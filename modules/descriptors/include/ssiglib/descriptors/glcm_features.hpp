@@ -67,6 +67,8 @@ class GrayLevelCoOccurrence : public Descriptor2D {
   // Set the direction to count the co-occurrence
   DESCRIPTORS_EXPORT void setDirection(int x, int y);
 
+  DESCRIPTORS_EXPORT MemoryFootprint memoryFootprint() const override;
+
  protected:
   DESCRIPTORS_EXPORT void read(const cv::FileNode& fn) override;
   DESCRIPTORS_EXPORT void write(cv::FileStorage& fs) const override;
@@ -110,6 +110,8 @@ class HOG : public Descriptor2D {
 
   DESCRIPTORS_EXPORT void setSignedGradient(const bool signedGradient);
 
+  DESCRIPTORS_EXPORT MemoryFootprint memoryFootprint() const override;
+
  protected:
   DESCRIPTORS_EXPORT void beforeProcess() override;
   DESCRIPTORS_EXPORT void extractFeatures(const cv::Rect& patch,
@@ -92,6 +92,8 @@ class HOGUOCCTI : public ssig::Descriptor2D {
 
   DESCRIPTORS_EXPORT void setClipping(float clipping);
 
+  DESCRIPTORS_EXPORT MemoryFootprint memoryFootprint() const override;
+
 
  protected:
   DESCRIPTORS_EXPORT void read(const cv::FileNode& fn) override;
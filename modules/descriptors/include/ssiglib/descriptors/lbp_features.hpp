@@ -60,6 +60,8 @@ class LBP : public Descriptor2D {
 
   DESCRIPTORS_EXPORT void getLbpImage(cv::Mat& output) const;
 
+  DESCRIPTORS_EXPORT MemoryFootprint memoryFootprint() const override;
+
  protected:
   DESCRIPTORS_EXPORT void read(const cv::FileNode& fn) override;
   DESCRIPTORS_EXPORT void write(cv::FileStorage& fs) const override;
@@ -86,6 +86,8 @@ class TemporalDescriptors : Descriptor {
   DESCRIPTORS_EXPORT void setData(const std::vector<cv::Mat>& data);
   DESCRIPTORS_EXPORT int getNFrames() const;
 
+  DESCRIPTORS_EXPORT MemoryFootprint memoryFootprint() const override;
+
  protected:
   DESCRIPTORS_EXPORT void read(const cv::FileNode& fn) override = 0;
   DESCRIPTORS_EXPORT void write(cv::FileStorage& fs) const override = 0;
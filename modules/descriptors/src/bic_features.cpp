@@ -45,6 +45,7 @@
 #include <vector>
 // ssiglib
 #include "ssiglib/descriptors/bic_features.hpp"
+#include "ssiglib/core/profiler.hpp"
 
 
 namespace ssig {
@@ -70,6 +71,7 @@ void BIC::write(cv::FileStorage& fs) const {
 }
 
 void BIC::beforeProcess() {
+  SSIG_PROFILE_SCOPE("BIC::beforeProcess");
   std::vector<cv::Mat> channels;
   cv::Mat imageInt;
   mImage.convertTo(imageInt, CV_32SC3);
@@ -81,7 +83,10 @@ void BIC::beforeProcess() {
   const int MAX_VALUE = 255 + 256 * 255 + 65536 * 255;
   const int bucketLen = MAX_VALUE / 63;
   temp = temp / bucketLen;
-  temp.convertTo(mImage, CV_8U);
+  // a new matrix, mImage may share its data with the caller
+  cv::Mat quantized;
+  temp.convertTo(quantized, CV_8U);
+  mImage = quantized;
 
   cv::Mat_<int> filter = (cv::Mat_<int>(3, 3) << 0 , 1 , 0 ,
     1 , 1 , 1 ,
@@ -93,6 +98,7 @@ void BIC::beforeProcess() {
 }
 
 void BIC::extractFeatures(const cv::Rect& patch, cv::Mat& output) {
+  SSIG_PROFILE_SCOPE("BIC::extractFeatures");
   cv::Mat roi = mImage(patch);
   cv::Mat roiMask = mInteriorMask(patch);
 
@@ -162,5 +168,11 @@ float BIC::computeLog(float value) {
   return (result);
 }
 
+MemoryFootprint BIC::memoryFootprint() const {
+  MemoryFootprint ans = Descriptor2D::memoryFootprint();
+  ans.addMat("interiorMask", mInteriorMask);
+  return ans;
+}
+
 }  // namespace ssig
 
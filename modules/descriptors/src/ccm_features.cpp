@@ -44,6 +44,7 @@
 #include <vector>
 #include <stdexcept>
 #include <ssiglib/descriptors/co_occurrence.hpp>
+#include <ssiglib/core/profiler.hpp>
 
 namespace ssig {
 
@@ -92,6 +93,7 @@ void ColorCoOccurrence::read(const cv::FileNode& fn) { }
 void ColorCoOccurrence::write(cv::FileStorage& fs) const { }
 
 void ColorCoOccurrence::beforeProcess() {
+  SSIG_PROFILE_SCOPE("ColorCoOccurrence::beforeProcess");
   cv::split(mImage, mChannels);
   for (auto& m : mChannels) {
     m.convertTo(m, CV_32FC1);
@@ -101,6 +103,7 @@ void ColorCoOccurrence::beforeProcess() {
 void ColorCoOccurrence::extractFeatures(
   const cv::Rect& patch,
   cv::Mat& output) {
+  SSIG_PROFILE_SCOPE("ColorCoOccurrence::extractFeatures");
   const int nchannels = mImage.channels();
 
   for (int c1 = 0; c1 < nchannels; c1++) {
@@ -123,4 +126,10 @@ void ColorCoOccurrence::extractFeatures(
     }
   }
 }
+
+MemoryFootprint ColorCoOccurrence::memoryFootprint() const {
+  MemoryFootprint ans = Descriptor2D::memoryFootprint();
+  ans.addMats("channels", mChannels);
+  return ans;
+}
 }  // namespace ssig
@@ -38,16 +38,16 @@
 *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 *  POSSIBILITY OF SUCH DAMAGE.
 *****************************************************************************L*/
-#ifdef _OPENMP
-#include <omp.h>
-#endif
-
 #include "ssiglib/descriptors/co_occurrence.hpp"
 
+#include <algorithm>
 #include <vector>
 
 #include <opencv2/core.hpp>
 
+#include "ssiglib/core/executor.hpp"
+#include "ssiglib/core/simd.hpp"
+
 namespace ssig {
 
 void CoOccurrence::extractCoOccurrence(
@@ -56,46 +56,36 @@ void CoOccurrence::extractCoOccurrence(
   const int dx, const int dy,
   const int nbins, const int levels,
   cv::Mat& output) {
-#ifdef _OPENMP
-  int nthreads = omp_get_max_threads();
-  std::vector<cv::Mat> out;
-  out.resize(nthreads);
-  for (int i = 0; i < nthreads; ++i) {
-    out[i] = cv::Mat::zeros(nbins, nbins, CV_32FC1);
-  }
-#else
-  cv::Mat out = cv::Mat::zeros(nbins, nbins, CV_32FC1);
-#endif
   int binWidth = levels / nbins;
-#ifdef _OPENMP
-#pragma omp parallel for num_threads(nthreads)
-#endif
-  for (int i = patch.y; i < patch.height; i++) {
-    for (int j = patch.x; j < patch.width; j++) {
-      if (isValidPixel(i + dy, j + dx, mat.rows, mat.cols)) {
-        auto val1 = static_cast<int>(mat.at<float>(i, j) / binWidth);
-        auto val2 = static_cast<int>(
-          mat.at<float>(i + dy, j + dx) / binWidth);
-
-#ifdef _OPENMP
-        int currThread = omp_get_thread_num();
-        out[currThread].at<float>(val1, val2)++;
-#else
-        out.at<float>(val1, val2)++;
-#endif
+  // each chunk of rows counts into its own histogram, summed in order
+  output = Executor::global().parallelReduce(patch.y, patch.height,
+    cv::Mat(cv::Mat::zeros(nbins, nbins, CV_32FC1)),
+    [&](const int first, const int last) {
+    cv::Mat out = cv::Mat::zeros(nbins, nbins, CV_32FC1);
+    // columns whose displaced pixel falls inside the image
+    const int begin = std::max(patch.x, -dx);
+    const int end = std::min(patch.width, mat.cols - dx);
+    std::vector<int> bins(std::max(end - begin, 0));
+    for (int i = first; i < last; i++) {
+      if (bins.empty() || !isValidPixel(i + dy, 0, mat.rows, 1))
+        continue;
+      const float* row1 = mat.ptr<float>(i);
+      const float* row2 = mat.ptr<float>(i + dy);
+      for (int j = begin; j < end; j++) {
+        auto val1 = static_cast<int>(row1[j] / binWidth);
+        auto val2 = static_cast<int>(row2[j + dx] / binWidth);
+        bins[j - begin] = val1 * nbins + val2;
       }
+      simd::accumulateHistogram(bins.data(), nullptr,
+                                static_cast<int>(bins.size()),
+                                out.ptr<float>());
     }
-  }
-#ifdef _OPENMP
-  for (int i = 0; i < nthreads; ++i) {
-    if (output.empty())
-      output = out[i] + 0;
-    else
-      output += out[i];
-  }
-#else
-  output = out;
-#endif
+    return out;
+  },
+    [](cv::Mat& acc, const cv::Mat& partial) {
+    acc += partial;
+    return acc;
+  });
 
   output = output.reshape(1, 1);
 }
@@ -114,47 +104,37 @@ void CoOccurrence::extractPairCoOccurrence(
   mat1.convertTo(m1, CV_32F);
   mat2.convertTo(m2, CV_32F);
 
-#ifdef _OPENMP
-  int nthreads = omp_get_max_threads();
-  std::vector<cv::Mat> out;
-  out.resize(nthreads);
-  for (int i = 0; i < nthreads; ++i) {
-    out[i] = cv::Mat::zeros(bins1, bins2, CV_32FC1);
-  }
-#else
-  cv::Mat out = cv::Mat::zeros(bins1, bins2, CV_32FC1);
-#endif
   int binWidth1 = levels1 / bins1;
   int binWidth2 = levels2 / bins2;
 
-#ifdef _OPENMP
-#pragma omp parallel for num_threads(nthreads)
-#endif
-  for (int i = window.y; i < window.height; i++) {
-    for (int j = window.x; j < window.width; j++) {
-      if (isValidPixel(i + dy, j + dx, m2.rows, m2.cols)) {
-        auto val1 = static_cast<int>(m1.at<float>(i, j) / binWidth1);
-        auto val2 = static_cast<int>(m2.at<float>(i + dy, j + dx) / binWidth2);
-
-#ifdef _OPENMP
-        int currThread = omp_get_thread_num();
-        out[currThread].at<float>(val1, val2)++;
-#else
-        out.at<float>(val1, val2)++;
-#endif
+  output = Executor::global().parallelReduce(window.y, window.height,
+    cv::Mat(cv::Mat::zeros(bins1, bins2, CV_32FC1)),
+    [&](const int first, const int last) {
+    cv::Mat out = cv::Mat::zeros(bins1, bins2, CV_32FC1);
+    // columns whose displaced pixel falls inside the image
+    const int begin = std::max(window.x, -dx);
+    const int end = std::min(window.width, m2.cols - dx);
+    std::vector<int> bins(std::max(end - begin, 0));
+    for (int i = first; i < last; i++) {
+      if (bins.empty() || !isValidPixel(i + dy, 0, m2.rows, 1))
+        continue;
+      const float* row1 = m1.ptr<float>(i);
+      const float* row2 = m2.ptr<float>(i + dy);
+      for (int j = begin; j < end; j++) {
+        auto val1 = static_cast<int>(row1[j] / binWidth1);
+        auto val2 = static_cast<int>(row2[j + dx] / binWidth2);
+        bins[j - begin] = val1 * bins2 + val2;
       }
+      simd::accumulateHistogram(bins.data(), nullptr,
+                                static_cast<int>(bins.size()),
+                                out.ptr<float>());
     }
-  }
-#ifdef _OPENMP
-  for (int i = 0; i < nthreads; ++i) {
-    if (output.empty())
-      output = out[i] + 0;
-    else
-      output += out[i];
-  }
-#else
-  output = out;
-#endif
+    return out;
+  },
+    [](cv::Mat& acc, const cv::Mat& partial) {
+    acc += partial;
+    return acc;
+  });
   output = output.reshape(1, 1);
 }
 
@@ -40,6 +40,7 @@
 *****************************************************************************L*/
 
 #include "ssiglib/descriptors/color_histogram_hsv.hpp"
+#include "ssiglib/core/profiler.hpp"
 
 
 #include <stdexcept>
@@ -97,6 +98,7 @@ void ColorHistogramHSV::write(cv::FileStorage& fs) const {
 }
 
 void ColorHistogramHSV::beforeProcess() {
+  SSIG_PROFILE_SCOPE("ColorHistogramHSV::beforeProcess");
   if (mImage.channels() != 3)
     std::invalid_argument("Mat needs to have 3 channels");
   cv::Mat temp;
@@ -106,6 +108,7 @@ void ColorHistogramHSV::beforeProcess() {
 
 void ColorHistogramHSV::extractFeatures(const cv::Rect& patch,
                                         cv::Mat& output) {
+  SSIG_PROFILE_SCOPE("ColorHistogramHSV::extractFeatures");
   auto roi = mImage(patch);
 
   const int bins = mNumberHueBins * mNumberValueBins * mNumberSaturationBins;
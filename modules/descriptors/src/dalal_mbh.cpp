@@ -46,7 +46,9 @@
 
 #include <ssiglib/descriptors/hog_uoccti_features.hpp>
 #include <opencv2/video.hpp>
+#include <ssiglib/core/executor.hpp>
 #include <ssiglib/core/util.hpp>
+#include <ssiglib/core/profiler.hpp>
 
 namespace ssig {
 
@@ -78,23 +80,27 @@ void DalalMBH::read(const cv::FileNode& fn) {}
 void DalalMBH::write(cv::FileStorage& fs) const {}
 
 void DalalMBH::beforeProcess() {
+  SSIG_PROFILE_SCOPE("DalalMBH::beforeProcess");
   auto data = getData();
   mFlows.resize(static_cast<int>(data.size()) - 1);
 
-#pragma omp parallel for
-  for (int i = 0; i < static_cast<int>(data.size()) - 1; ++i) {
-    cv::Mat& frame0 = data[i];
-    cv::Mat& framef = data[i + 1];
-    cv::Mat flow;
-    if (!(frame0.empty() && framef.empty()))
-      of->calc(frame0, framef, flow);
-    mFlows[i] = flow;
-  }
+  Executor::global().parallelFor(0, static_cast<int>(data.size()) - 1,
+    [&](const int first, const int last) {
+    for (int i = first; i < last; ++i) {
+      cv::Mat& frame0 = data[i];
+      cv::Mat& framef = data[i + 1];
+      cv::Mat flow;
+      if (!(frame0.empty() && framef.empty()))
+        of->calc(frame0, framef, flow);
+      mFlows[i] = flow;
+    }
+  });
 }
 
 void DalalMBH::extractFeatures(const cv::Rect& patch,
   const cv::Point2i depth,
   cv::Mat& output) {
+  SSIG_PROFILE_SCOPE("DalalMBH::extractFeatures");
   int len = static_cast<int>(getNFrames());
   assert(depth.x >= 0 &&
     depth.y < len &&
@@ -104,12 +110,15 @@ void DalalMBH::extractFeatures(const cv::Rect& patch,
   std::vector<cv::Mat> flowFeatsX(len),
       flowFeatsY(len);
 
-#pragma omp parallel for
-  for (int i = depth.x; i < depth.y; ++i) {
-    cv::Mat roi;
-    roi = mFlows[i](patch);
-    extractStatistics(roi, flowFeatsX[i], flowFeatsY[i]);
-  }
+  Executor::global().parallelFor(depth.x, depth.y,
+    [&](const int first, const int last) {
+    for (int i = first; i < last; ++i) {
+      cv::Mat roi;
+      roi = mFlows[i](patch);
+      extractStatistics(roi, flowFeatsX[i - depth.x],
+                        flowFeatsY[i - depth.x]);
+    }
+  });
   frameCombination(flowFeatsX, flowFeatsY, output);
   output = output.reshape(0, 1);
 }
@@ -208,6 +217,12 @@ void DalalMBH::frameCombination(const std::vector<cv::Mat>& flowX,
   }
 }
 
+MemoryFootprint DalalMBH::memoryFootprint() const {
+  MemoryFootprint ans = TemporalDescriptors::memoryFootprint();
+  ans.addMats("flows", mFlows);
+  return ans;
+}
+
 }  // namespace ssig
 
 
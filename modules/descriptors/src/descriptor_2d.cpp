@@ -41,10 +41,13 @@
 
 #include "ssiglib/descriptors/descriptor_2d.hpp"
 
+#include <mutex>
 #include <vector>
 #include <stdexcept>
 #include <string>
 
+#include "ssiglib/core/profiler.hpp"
+
 namespace ssig {
 
   Descriptor2D::Descriptor2D(const cv::Mat& input) {
@@ -61,19 +64,17 @@ namespace ssig {
   }
 
   void Descriptor2D::extract(cv::Mat& output) {
-    if (!mIsPrepared) {
-      beforeProcess();
-      mIsPrepared = true;
-    }
+    SSIG_PROFILE_SCOPE("Descriptor2D::extract");
+    prepare();
     extractFeatures(cv::Rect(0, 0, mImage.cols, mImage.rows), output);
+    SSIG_PROFILE_COUNT("Descriptor2D::extract.bytes",
+                       output.total() * output.elemSize());
   }
 
   void Descriptor2D::extract(const std::vector<cv::Rect>& windows,
     cv::Mat& output) {
-    if (!mIsPrepared) {
-      beforeProcess();
-      mIsPrepared = true;
-    }
+    SSIG_PROFILE_SCOPE("Descriptor2D::extract");
+    prepare();
     for (auto& window : windows) {
       cv::Mat feat;
 
@@ -81,21 +82,93 @@ namespace ssig {
       auto intersection = windowRoi & window;
 
       if (intersection != window) {
-        std::runtime_error(
+        throw std::runtime_error(
           "Invalid patch, its intersection with the image is" +
           std::string("different than the patch itself"));
       }
       extractFeatures(window, feat);
       output.push_back(feat);
     }
+    SSIG_PROFILE_COUNT("Descriptor2D::extract.bytes",
+                       output.total() * output.elemSize());
+  }
+
+  void Descriptor2D::extract(const WindowRange& windows, cv::Mat& output) {
+    SSIG_PROFILE_SCOPE("Descriptor2D::extract");
+    prepare();
+    output.release();
+    const int len = static_cast<int>(windows.size());
+    const auto imageRoi = cv::Rect(0, 0, mImage.cols, mImage.rows);
+    cv::Mat feat;
+    for (int i = 0; i < len; ++i) {
+      const cv::Rect window = windows[i];
+      if ((imageRoi & window) != window) {
+        throw std::runtime_error(
+          "Invalid patch, its intersection with the image is" +
+          std::string("different than the patch itself"));
+      }
+      extractFeatures(window, feat);
+      // one single channel row per window, as feat.reshape(1, 1) lays it
+      if (output.empty())
+        output.create(len, static_cast<int>(feat.total() * feat.channels()),
+                      CV_MAKETYPE(feat.depth(), 1));
+      feat.reshape(1, 1).copyTo(output.row(i));
+    }
+    SSIG_PROFILE_COUNT("Descriptor2D::extract.bytes",
+                       output.total() * output.elemSize());
+  }
+
+  template <class Windows>
+  void Descriptor2D::extractToStore(const Windows& windows, const int* label,
+                                    FeatureStoreWriter& store) {
+    SSIG_PROFILE_SCOPE("Descriptor2D::extract");
+    prepare();
+    const int len = static_cast<int>(windows.size());
+    const auto imageRoi = cv::Rect(0, 0, mImage.cols, mImage.rows);
+    cv::Mat feat;
+    for (int i = 0; i < len; ++i) {
+      const cv::Rect window = windows[i];
+      if ((imageRoi & window) != window) {
+        throw std::runtime_error(
+          "Invalid patch, its intersection with the image is" +
+          std::string("different than the patch itself"));
+      }
+      extractFeatures(window, feat);
+      if (label)
+        store.append(feat.reshape(1, 1), *label);
+      else
+        store.append(feat.reshape(1, 1));
+    }
+    // the store keeps every row as floats
+    SSIG_PROFILE_COUNT("Descriptor2D::extract.bytes",
+                       static_cast<size_t>(len) * store.getNumCols() *
+                       sizeof(float));
+  }
+
+  void Descriptor2D::extract(const std::vector<cv::Rect>& windows,
+                             FeatureStoreWriter& store) {
+    extractToStore(windows, nullptr, store);
+  }
+
+  void Descriptor2D::extract(const std::vector<cv::Rect>& windows,
+                             const int label, FeatureStoreWriter& store) {
+    extractToStore(windows, &label, store);
+  }
+
+  void Descriptor2D::extract(const WindowRange& windows,
+                             FeatureStoreWriter& store) {
+    extractToStore(windows, nullptr, store);
+  }
+
+  void Descriptor2D::extract(const WindowRange& windows, const int label,
+                             FeatureStoreWriter& store) {
+    extractToStore(windows, &label, store);
   }
 
   void Descriptor2D::extract(const std::vector<cv::KeyPoint>& keypoints,
     cv::Mat& output) {
-    if (!mIsPrepared) {
-      beforeProcess();
-      mIsPrepared = true;
-    }
+    SSIG_PROFILE_SCOPE("Descriptor2D::extract");
+    prepare();
     const float SQROOT_TWO = 1.4142136237f;
     for (auto& keypoint : keypoints) {
       cv::Mat feat;
@@ -108,6 +181,8 @@ namespace ssig {
       extractFeatures(window, feat);
       output.push_back(feat);
     }
+    SSIG_PROFILE_COUNT("Descriptor2D::extract.bytes",
+                       output.total() * output.elemSize());
   }
 
   void Descriptor2D::setData(const cv::Mat& img) {
@@ -115,5 +190,29 @@ namespace ssig {
     beforeProcess();
     mIsPrepared = true;
   }
+
+  void Descriptor2D::setData(const ImagePyramid& pyramid, const int level) {
+    // beforeProcess() implementations must not write into mImage in place
+    mImage = pyramid.getLevel(level);
+    beforeProcess();
+    mIsPrepared = true;
+  }
+
+  void Descriptor2D::prepare() {
+    if (mIsPrepared.load(std::memory_order_acquire))
+      return;
+    std::lock_guard<std::mutex> lock(mPrepareLock);
+    if (!mIsPrepared.load(std::memory_order_relaxed)) {
+      beforeProcess();
+      mIsPrepared.store(true, std::memory_order_release);
+    }
+  }
+
+  MemoryFootprint Descriptor2D::memoryFootprint() const {
+    MemoryFootprint ans = Descriptor::memoryFootprint();
+    ans.addMat("image", mImage);
+    ans.addOwned("patches", mPatches.capacity() * sizeof(cv::Rect));
+    return ans;
+  }
 }  // namespace ssig
 
@@ -46,6 +46,7 @@
 #include <opencv2/imgproc.hpp>
 
 #include <ssiglib/descriptors/co_occurrence.hpp>
+#include <ssiglib/core/profiler.hpp>
 
 namespace ssig {
 GrayLevelCoOccurrence::GrayLevelCoOccurrence(const cv::Mat& input) :
@@ -93,6 +94,7 @@ void GrayLevelCoOccurrence::read(const cv::FileNode& fn) { }
 void GrayLevelCoOccurrence::write(cv::FileStorage& fs) const { }
 
 void GrayLevelCoOccurrence::beforeProcess() {
+  SSIG_PROFILE_SCOPE("GrayLevelCoOccurrence::beforeProcess");
   if (mImage.channels() == 3 || mImage.channels() == 4)
     cv::cvtColor(mImage, mGreyImg, CV_BGR2GRAY);
   else
@@ -103,6 +105,7 @@ void GrayLevelCoOccurrence::beforeProcess() {
 
 void GrayLevelCoOccurrence::extractFeatures(const cv::Rect& patch,
                                             cv::Mat& output) {
+  SSIG_PROFILE_SCOPE("GrayLevelCoOccurrence::extractFeatures");
   CoOccurrence::extractCoOccurrence(mGreyImg,
     patch,
     mDj, mDi,
@@ -114,4 +117,10 @@ int GrayLevelCoOccurrence::isValidPixel(int i, int j, int rows, int cols) {
   return ((i >= 0 && i < rows) && (j >= 0 && j < cols)) ? 1 : 0;
 }
 
+MemoryFootprint GrayLevelCoOccurrence::memoryFootprint() const {
+  MemoryFootprint ans = Descriptor2D::memoryFootprint();
+  ans.addMat("greyImg", mGreyImg);
+  return ans;
+}
+
 }  // namespace ssig
@@ -43,6 +43,8 @@
 
 #include <vector>
 
+#include "ssiglib/core/simd.hpp"
+
 namespace ssig {
 
 cv::Mat Haralick::compute(const cv::Mat& mat) {
@@ -73,9 +75,10 @@ cv::Mat Haralick::compute(const cv::Mat& mat) {
 float Haralick::f1ASM(const cv::Mat& mat) {
   float sum = 0.0;
 
-  for (auto i = 0; i < mat.rows; ++i)
-    for (auto j = 0; j < mat.cols; ++j)
-      sum += mat.at<float>(i, j) * mat.at<float>(i, j);
+  for (auto i = 0; i < mat.rows; ++i) {
+    const float* row = mat.ptr<float>(i);
+    sum += simd::dot(row, row, mat.cols);
+  }
 
   return sum;
   /*
@@ -216,14 +219,18 @@ float Haralick::f8SumEntropy(const cv::Mat& mat) {
 }
 
 float Haralick::f9Entropy(const cv::Mat& mat) {
+  // log10(p) = ln(p) / ln(10)
+  std::vector<float> logs(mat.cols);
   float entropy = 0.0;
-  for (auto i = 0; i < mat.rows; ++i)
+  for (auto i = 0; i < mat.rows; ++i) {
+    const float* row = mat.ptr<float>(i);
     for (auto j = 0; j < mat.cols; ++j)
-      entropy +=
-          mat.at<float>(i, j) *
-          log10(mat.at<float>(i, j) + static_cast<float>(HARALICK_EPSILON));
+      logs[j] = row[j] + static_cast<float>(HARALICK_EPSILON);
+    simd::log(logs.data(), logs.data(), mat.cols);
+    entropy += simd::dot(row, logs.data(), mat.cols);
+  }
 
-  return -entropy;
+  return -entropy / 2.302585093f;
   /* Entropy */
 }
 
@@ -39,11 +39,6 @@
 *  POSSIBILITY OF SUCH DAMAGE.
 *****************************************************************************L*/
 
-
-#ifdef _OPENMP
-#include <omp.h>
-#endif
-
 // opencv
 #include <opencv2/core.hpp>
 #include <opencv2/objdetect.hpp>
@@ -56,6 +51,8 @@
 // ssiglib
 #include "ssiglib/descriptors/hog_features.hpp"
 #include "ssiglib/core/exception.hpp"
+#include "ssiglib/core/executor.hpp"
+#include "ssiglib/core/profiler.hpp"
 
 namespace ssig {
 
@@ -176,88 +173,72 @@ std::vector<cv::Mat_<double>> HOG::computeIntegralGradientImages(
   const int cellWidth = mBlockConfiguration.width / mCellConfiguration.width;
   const int cellHeight = mBlockConfiguration.height / mCellConfiguration.height;
 
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-  for (int i = 0; i < grad.rows; ++i) {
+  /* Weights of the current cell center and of its neighbours, from the
+   distance of the pixel to each center. The order of the centers is
+   center, top, bottom, left, right. They are the same for every pixel. */
+  const int CENTER = 0, TOP = 1, BOTTOM = 2, LEFT = 3, RIGHT = 4;
+  cv::Mat_<float> centerDistances(1, 5, 0.f);
+  centerDistances(TOP) = centerDistances(BOTTOM) =
+    cv::sqrt(static_cast<float>(cellHeight * cellHeight));
+  centerDistances(LEFT) = centerDistances(RIGHT) =
+    cv::sqrt(static_cast<float>(cellWidth * cellWidth));
+  cv::normalize(centerDistances, centerDistances, 1, 0, cv::NORM_L1);
+  centerDistances = 1 - centerDistances;
+  cv::normalize(centerDistances, centerDistances, 1, 0, cv::NORM_L1);
+  const float* weights = centerDistances[0];
+
+  // a pixel also adds to the rows 8 above and below it, so the rows are
+  // taken in stripes of 16 and adjacent stripes never run at the same time
+  const int kStripe = 16;
+  auto accumulateRow = [&](const int i) {
+    const uint8_t* binRows[2] = {angles[0][i], angles[1][i]};
+    const float* gradRows[2] = {gradients[0][i], gradients[1][i]};
     for (int j = 0; j < grad.cols; ++j) {
       for (int k = 0; k < 2; ++k) {
-        auto angle = angles[k];
-        auto bin = (angle.at<uint8_t>(i, j));
-        auto bingrad = gradients[k];
-        float mag = bingrad[i][j];
-
-        int centerCol = static_cast<int>(j / cellWidth) + 4;
-        int centerRow = static_cast<int>(i / cellHeight) + 4;
-        cv::Mat_<int> centerRows = (cv::Mat_<int>(1, 5) <<
-          centerRow , centerRow - cellHeight ,
-          centerRow + cellHeight , centerRow , centerRow);
-        cv::Mat_<int> centerCols = (cv::Mat_<int>(1, 5) <<
-          centerCol , centerCol , centerCol ,
-          centerCol - cellWidth , centerCol + cellWidth);
-
-
-        /* This mat stores the values of the distance of
-         the current pixel to each cell center
-         The order of the centers are center, top, bottom, left, right*/
-        cv::Mat_<float> centerDistances(1, 5, 0.f);
-        const int CENTER = 0, TOP = 1, BOTTOM = 2, LEFT = 3, RIGHT = 4;
-
-        for (int n = 1; n < 5; ++n) {
-          centerDistances.at<float>(n) = static_cast<float>(
-            (centerRows.at<int>(n) - centerRow) *
-            (centerRows.at<int>(n) - centerRow));
-          centerDistances.at<float>(n) += static_cast<float>(
-            (centerCols.at<int>(n) - centerCol) *
-            (centerCols.at<int>(n) - centerCol));
-          centerDistances.at<float>(n) = cv::sqrt(centerDistances.at<float>(n));
-        }
-        cv::normalize(centerDistances, centerDistances, 1, 0, cv::NORM_L1);
-        centerDistances = 1 - centerDistances;
-        cv::normalize(centerDistances, centerDistances, 1, 0, cv::NORM_L1);
-
-        integralImages[bin][i][j] += mag *
-          centerDistances.at<float>(CENTER);
-        if (i >= 0 && i < img.rows
-          && j + cellWidth >= 0
-          && j + cellWidth < img.cols)
-          integralImages[bin][i][j + 8] += mag *
-            centerDistances.at<float>(TOP);
-        if (i >= 0 && i < img.rows
-          && j - cellWidth >= 0
-          && j - cellWidth < img.cols)
-          integralImages[bin][i][j - 8] += mag *
-            centerDistances.at<float>(BOTTOM);
-        if (i + cellHeight >= 0 &&
-          i + cellHeight < img.rows &&
-          j >= 0 && j < img.cols)
-          integralImages[bin][i + 8][j] += mag *
-            centerDistances.at<float>(LEFT);
-        if (i - cellHeight >= 0 &&
-          i - cellHeight < img.rows &&
-          j >= 0 &&
-          j < img.cols)
-          integralImages[bin][i - 8][j] += mag *
-            centerDistances.at<float>(RIGHT);
+        const int bin = binRows[k][j];
+        const float mag = gradRows[k][j];
+        cv::Mat_<double>& integralImage = integralImages[bin];
+
+        integralImage[i][j] += mag * weights[CENTER];
+        if (j + cellWidth < img.cols)
+          integralImage[i][j + 8] += mag * weights[TOP];
+        if (j - cellWidth >= 0)
+          integralImage[i][j - 8] += mag * weights[BOTTOM];
+        if (i + cellHeight < img.rows)
+          integralImage[i + 8][j] += mag * weights[LEFT];
+        if (i - cellHeight >= 0)
+          integralImage[i - 8][j] += mag * weights[RIGHT];
       }
     }
+  };
+  const int nStripes = (grad.rows + kStripe - 1) / kStripe;
+  for (int parity = 0; parity < 2; ++parity) {
+    Executor::global().parallelFor(0, (nStripes + 1 - parity) / 2,
+      [&](const int first, const int last) {
+      for (int s = first; s < last; ++s) {
+        const int stripe = 2 * s + parity;
+        const int end = std::min(grad.rows, (stripe + 1) * kStripe);
+        for (int i = stripe * kStripe; i < end; ++i)
+          accumulateRow(i);
+      }
+    });
   }
 
-#ifdef _OPENMP
-  #pragma omp parallel for
-#endif
-  for (int bin = 0; bin < mNumberOfBins; ++bin) {
-    cv::Mat intImage;
-    auto bingrad = integralImages[bin];
-    cv::integral(integralImages[bin], intImage, CV_64F);
-    intImage =
-      intImage(cv::Range(1, intImage.rows), cv::Range(1, intImage.cols));
-    intImage.copyTo(integralImages[bin]);
-  }
+  Executor::global().parallelFor(0, mNumberOfBins,
+    [&](const int first, const int last) {
+    for (int bin = first; bin < last; ++bin) {
+      cv::Mat intImage;
+      cv::integral(integralImages[bin], intImage, CV_64F);
+      intImage =
+        intImage(cv::Range(1, intImage.rows), cv::Range(1, intImage.cols));
+      intImage.copyTo(integralImages[bin]);
+    }
+  });
   return integralImages;
 }
 
 void HOG::extractFeatures(const cv::Rect& patch, cv::Mat& output) {
+  SSIG_PROFILE_SCOPE("HOG::extractFeatures");
   const int imgRows = patch.height;
   const int imgCols = patch.width;
 
@@ -438,6 +419,7 @@ void HOG::setSignedGradient(const bool signedGradient) {
 }
 
 void HOG::beforeProcess() {
+  SSIG_PROFILE_SCOPE("HOG::beforeProcess");
   if (mImage.empty())return;
   mIntegralImages = computeIntegralGradientImages(mImage);
 }
@@ -479,6 +461,14 @@ void HOG::computeVisualization(const cv::Mat_<float> feat,
   }
 }
 
+MemoryFootprint HOG::memoryFootprint() const {
+  MemoryFootprint ans = Descriptor2D::memoryFootprint();
+  for (size_t i = 0; i < mIntegralImages.size(); ++i)
+    ans.addMat("integralImages[" + std::to_string(i) + "]",
+               mIntegralImages[i]);
+  return ans;
+}
+
 }  // namespace ssig
 
 
@@ -40,6 +40,8 @@
 *****************************************************************************L*/
 // ssiglib
 #include "ssiglib/descriptors/hog_uoccti_features.hpp"
+#include "ssiglib/core/executor.hpp"
+#include "ssiglib/core/profiler.hpp"
 // opencv
 #include <opencv2/imgproc.hpp>
 #include <opencv2/objdetect.hpp>
@@ -47,6 +49,7 @@
 #include <vector>
 #include <algorithm>
 #include <stdexcept>
+#include <string>
 
 
 namespace ssig {
@@ -72,6 +75,7 @@ HOGUOCCTI::HOGUOCCTI(const ssig::HOGUOCCTI& descriptor) :
 }
 
 void HOGUOCCTI::extractFeatures(const cv::Rect& patch, cv::Mat& output) {
+  SSIG_PROFILE_SCOPE("HOGUOCCTI::extractFeatures");
   const int imgRows = patch.height;
   const int imgCols = patch.width;
 
@@ -99,6 +103,7 @@ void HOGUOCCTI::extractFeatures(const cv::Rect& patch, cv::Mat& output) {
 }
 
 void HOGUOCCTI::beforeProcess() {
+  SSIG_PROFILE_SCOPE("HOGUOCCTI::beforeProcess");
   if (mImage.empty())return;
   mIntegralImages = computeIntegralGradientImages(mImage, false);
   mSignedIntegralImages = computeIntegralGradientImages(mImage, true);
@@ -126,9 +131,7 @@ void HOGUOCCTI::computeBlockDescriptor(
 
   std::vector<cv::Mat_<float>> cellHistograms(ncells);
   std::vector<cv::Mat_<float>> cellSignedHistograms(ncells);
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
+  // a handful of cells per block, not worth a parallel loop
   for (int i = 0; i < ncells; ++i) {
     cellHistograms[i].create(1, mNumberOfBins);
     cellHistograms[i] = FLT_MAX;
@@ -240,10 +243,10 @@ std::vector<cv::Mat_<double>> HOGUOCCTI::computeIntegralGradientImages(
   cv::split(grad, gradients);
   cv::split(angleOfs, angles);
 
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-  for (int i = 0; i < grad.rows; ++i) {
+  // a pixel also adds to the rows 8 above and below it, so the rows are
+  // taken in stripes of 16 and adjacent stripes never run at the same time
+  const int kStripe = 16;
+  auto accumulateRow = [&](const int i) {
     for (int j = 0; j < grad.cols; ++j) {
       for (int k = 0; k < 2; ++k) {
         auto angle = angles[k];
@@ -294,19 +297,30 @@ std::vector<cv::Mat_<double>> HOGUOCCTI::computeIntegralGradientImages(
             centerDistances.at<float>(RIGHT);
       }
     }
+  };
+  const int nStripes = (grad.rows + kStripe - 1) / kStripe;
+  for (int parity = 0; parity < 2; ++parity) {
+    Executor::global().parallelFor(0, (nStripes + 1 - parity) / 2,
+      [&](const int first, const int last) {
+      for (int s = first; s < last; ++s) {
+        const int stripe = 2 * s + parity;
+        const int end = std::min(grad.rows, (stripe + 1) * kStripe);
+        for (int i = stripe * kStripe; i < end; ++i)
+          accumulateRow(i);
+      }
+    });
   }
 
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-  for (int bin = 0; bin < nbins; ++bin) {
-    cv::Mat intImage;
-    auto bingrad = integralImages[bin];
-    cv::integral(integralImages[bin], intImage, CV_64F);
-    intImage =
-      intImage(cv::Range(1, intImage.rows), cv::Range(1, intImage.cols));
-    intImage.copyTo(integralImages[bin]);
-  }
+  Executor::global().parallelFor(0, nbins,
+    [&](const int first, const int last) {
+    for (int bin = first; bin < last; ++bin) {
+      cv::Mat intImage;
+      cv::integral(integralImages[bin], intImage, CV_64F);
+      intImage =
+        intImage(cv::Range(1, intImage.rows), cv::Range(1, intImage.cols));
+      intImage.copyTo(integralImages[bin]);
+    }
+  });
   return integralImages;
 }
 
@@ -371,6 +385,17 @@ void HOGUOCCTI::setClipping(float clipping1) {
 void HOGUOCCTI::read(const cv::FileNode& fn) {}
 
 void HOGUOCCTI::write(cv::FileStorage& fs) const {}
+
+MemoryFootprint HOGUOCCTI::memoryFootprint() const {
+  MemoryFootprint ans = Descriptor2D::memoryFootprint();
+  for (size_t i = 0; i < mIntegralImages.size(); ++i)
+    ans.addMat("integralImages[" + std::to_string(i) + "]",
+               mIntegralImages[i]);
+  for (size_t i = 0; i < mSignedIntegralImages.size(); ++i)
+    ans.addMat("signedIntegralImages[" + std::to_string(i) + "]",
+               mSignedIntegralImages[i]);
+  return ans;
+}
 }  // namespace ssig
 
 
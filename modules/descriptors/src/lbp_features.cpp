@@ -42,10 +42,12 @@
 
 #include "ssiglib/descriptors/lbp_features.hpp"
 
-#ifdef _OPENMP
-#include <omp.h>
-#endif
 #include <stdexcept>
+#include <vector>
+
+#include "ssiglib/core/executor.hpp"
+#include "ssiglib/core/profiler.hpp"
+#include "ssiglib/core/simd.hpp"
 
 namespace ssig {
 
@@ -89,49 +91,67 @@ void LBP::write(cv::FileStorage& fs) const {
 }
 
 void LBP::beforeProcess() {
+  SSIG_PROFILE_SCOPE("LBP::beforeProcess");
   if (mKernel.empty())
     setDefaultKernel();
   cv::Mat_<int> kernel = mKernel;
   const int width = mImage.cols, height = mImage.rows;
   mBinaryPattern.create(height, width);
-  cv::Mat_<int> lbpImg = mBinaryPattern;
-  lbpImg = 0;
   cv::Mat img = mImage;
   const int kernelLen = kernel.rows;
   const int offset = kernelLen / 2;
-  for (int i = 0; i < height; ++i) {
-    for (int j = 0; j < width; ++j) {
-      uchar value = 0;
-      for (int ki = 0; ki < kernelLen; ++ki) {
-        for (int kj = 0; kj < kernelLen; ++kj) {
-          int indexI = i + (ki - offset), indexJ = j + (kj - offset);
+  // neighbour offsets and the bit each one sets, -1 entries are ignored
+  std::vector<cv::Point> neighbours;
+  std::vector<int> bits;
+  for (int ki = 0; ki < kernelLen; ++ki) {
+    for (int kj = 0; kj < kernelLen; ++kj) {
+      if (kernel[ki][kj] < 0) continue;
+      neighbours.push_back(cv::Point(kj - offset, ki - offset));
+      bits.push_back(kernel[ki][kj]);
+    }
+  }
+  const int nNeighbours = static_cast<int>(neighbours.size());
+  Executor::global().parallelFor(0, height,
+    [&](const int first, const int last) {
+    for (int i = first; i < last; ++i) {
+      const uchar* center = img.ptr<uchar>(i);
+      uchar* out = mBinaryPattern[i];
+      for (int j = 0; j < width; ++j) {
+        uchar value = 0;
+        for (int n = 0; n < nNeighbours; ++n) {
+          const int indexI = i + neighbours[n].y;
+          const int indexJ = j + neighbours[n].x;
           if (!inValidRange(indexI, indexJ)) continue;
-          if (img.at<uchar>(indexI, indexJ) >=
-            img.at<uchar>(i, j)) {
-            value = (1 << kernel[ki][kj]) | value;
-          }
+          if (img.ptr<uchar>(indexI)[indexJ] >= center[j])
+            value = static_cast<uchar>((1 << bits[n]) | value);
         }
+        out[j] = value;
       }
-      lbpImg[i][j] = value;
     }
-  }
-  mBinaryPattern = lbpImg;
+  }, 16);
 }
 
 void LBP::extractFeatures(const cv::Rect& patch, cv::Mat& output) {
-  output.create(1, 256, CV_32F);
-  output = 0;
-  cv::Mat_<float> feat = output;
-
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-  for (int i = 0; i < patch.width; ++i) {
-    for (int j = 0; j < patch.height; ++j) {
-      int bin = mBinaryPattern[j + patch.y][i + patch.x];
-      feat[0][bin] += 1;
+  SSIG_PROFILE_SCOPE("LBP::extractFeatures");
+  // every chunk of rows fills its own histogram, so no bin is shared
+  output = Executor::global().parallelReduce(patch.y,
+    patch.y + patch.height,
+    cv::Mat(cv::Mat::zeros(1, 256, CV_32F)),
+    [&](const int first, const int last) {
+    cv::Mat_<float> feat = cv::Mat_<float>::zeros(1, 256);
+    std::vector<int> bins(patch.width);
+    for (int i = first; i < last; ++i) {
+      const uchar* codes = mBinaryPattern[i] + patch.x;
+      for (int j = 0; j < patch.width; ++j)
+        bins[j] = codes[j];
+      simd::accumulateHistogram(bins.data(), nullptr, patch.width, feat[0]);
     }
-  }
+    return cv::Mat(feat);
+  },
+    [](cv::Mat& acc, const cv::Mat& partial) {
+    acc += partial;
+    return acc;
+  }, 16);
 }
 
 bool LBP::inValidRange(const int i, const int j) const {
@@ -151,6 +171,13 @@ void LBP::setDefaultKernel() {
     5 , 6 , 7);
 }
 
+MemoryFootprint LBP::memoryFootprint() const {
+  MemoryFootprint ans = Descriptor2D::memoryFootprint();
+  ans.addMat("binaryPattern", mBinaryPattern);
+  ans.addMat("kernel", mKernel);
+  return ans;
+}
+
 }  // namespace ssig
 
 
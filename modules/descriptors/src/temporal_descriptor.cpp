@@ -152,6 +152,12 @@ std::vector<cv::Mat> TemporalDescriptors::getData() const {
   return mData;
 }
 
+MemoryFootprint TemporalDescriptors::memoryFootprint() const {
+  MemoryFootprint ans = Descriptor::memoryFootprint();
+  ans.addMats("data", mData);
+  return ans;
+}
+
 }  // namespace ssig
 
 
@@ -42,6 +42,7 @@
 #ifndef _SSF_HASHING_PLSH_HPP_
 #define _SSF_HASHING_PLSH_HPP_
 
+#include <string>
 #include <vector>
 #include <random>
 #include <utility>
@@ -54,15 +55,25 @@ class EPLSH {
  public:
   typedef std::vector<std::pair<int, float>> CandListType;
 
+  /**
+  Each hash model splits the subjects at random; seed tells runs apart, on
+  top of the global seed.
+  */
   HASHING_EXPORT EPLSH(const cv::Mat_<float> samples,
                        const cv::Mat_<int> labels,
                        const int models,
                        const int factors = 10,
-                       const int ndim = 5000);
+                       const int ndim = 5000,
+                       const int seed = 0);
 
   HASHING_EXPORT CandListType& query(const cv::Mat_<float> sample,
                                      CandListType& candidates);
 
+  // one child per hash model
+  HASHING_EXPORT MemoryFootprint memoryFootprint() const;
+
+  HASHING_EXPORT int getSeed() const;
+
  private:
   struct HashModel {
     PLS mHashFunc;
@@ -74,6 +85,7 @@ class EPLSH {
   std::vector<int> mSubjects;
 
   int mFactors;
+  int mSeed;
 };
 
 }  // namespace ssig
@@ -41,17 +41,20 @@
 
 #include "ssiglib/hashing/plsh.hpp"
 
-#include <time.h>
+#include <string>
 #include <vector>
 #include <utility>
 #include <algorithm>
 #include <unordered_set>
 
+#include "ssiglib/core/rng.hpp"
+
 namespace ssig {
 PLSH::PLSH(const cv::Mat_<float> samples, const cv::Mat_<int> labels,
-           const int models, const int factors)
-  : mHashModels(models), mFactors(factors) {
-  std::mt19937 gen(static_cast<uint>(time(nullptr)));
+           const int models, const int factors, const int seed)
+  : mHashModels(models), mFactors(factors), mSeed(seed) {
+  // model m splits the subjects with stream m
+  const uint64_t key = deriveSeed(RNG_HASHING, static_cast<uint64_t>(mSeed));
 
   std::unordered_set<int> ulab;
   for (const int label : labels)
@@ -59,14 +62,13 @@ PLSH::PLSH(const cv::Mat_<float> samples, const cv::Mat_<int> labels,
   for (const int label : ulab)
     mSubjects.push_back(label);
 
-  std::uniform_int_distribution<int> dist(0, 1);
-
   for (size_t m = 0; m < mHashModels.size(); ++m) {
+    PhiloxRng gen(key, static_cast<uint64_t>(m));
     cv::Mat_<float> responses(samples.rows, 1);
     responses = -1.0f;
 
     for (int l = 0; l < static_cast<int>(mSubjects.size()); ++l) {
-      if (dist(gen) == 0) {
+      if (gen.uniform(0, 2) == 0) {
         for (int row = 0; row < samples.rows; ++row)
           if (labels.at<int>(row, 0) == mSubjects[l]) {
             mHashModels[m].mSubjects.push_back(l);
@@ -106,6 +108,23 @@ PLSH::CandListType& PLSH::query(const cv::Mat_<float> sample,
   return candidates;
 }
 
+MemoryFootprint PLSH::memoryFootprint() const {
+  MemoryFootprint ans;
+  ans.addOwned("subjects", mSubjects.capacity() * sizeof(int));
+  for (size_t i = 0; i < mHashModels.size(); ++i) {
+    const HashModel& model = mHashModels[i];
+    const std::string index = std::to_string(i);
+    ans.addChild("hashFunc[" + index + "]", model.mHashFunc.memoryFootprint());
+    ans.addOwned("subjects[" + index + "]",
+                 model.mSubjects.capacity() * sizeof(int));
+  }
+  return ans;
+}
+
+int PLSH::getSeed() const {
+  return mSeed;
+}
+
 };  // namespace ssig
 
 
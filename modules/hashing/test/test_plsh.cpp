@@ -88,3 +88,27 @@ TEST(PLSH, Retrieval) {
   EXPECT_EQ(cand.size(), static_cast<size_t>(3));
   EXPECT_EQ(3, cand[0].first);
 }
+
+TEST(PLSH, SeedSelectsTheSplits) {
+  cv::Mat_<int> labels = (cv::Mat_<int>(6, 1) << 1, 1, 2, 2, 3, 4);
+  cv::Mat_<float> gallery = (cv::Mat_<float>(6, 2) <<
+                             2, 1,
+                             3, 1,
+                             1, 2,
+                             1, 3,
+                             1, 1,
+                             4, 4);
+  cv::Mat_<float> query = (cv::Mat_<float>(1, 2) << 3, 0);
+
+  ssig::PLSH first(gallery, labels, 20, 1, 7);
+  ssig::PLSH same(gallery, labels, 20, 1, 7);
+  ssig::PLSH other(gallery, labels, 20, 1, 8);
+  EXPECT_EQ(7, first.getSeed());
+
+  ssig::PLSH::CandListType a, b, c;
+  first.query(query, a);
+  same.query(query, b);
+  other.query(query, c);
+  EXPECT_EQ(a, b);
+  EXPECT_NE(a, c);
+}
@@ -74,6 +74,7 @@ class MultilayerPerceptron : public ssig::Multiclass {
     cv::Mat_<float>& resp,
     cv::Mat_<int>& labels) const override;
 
+  using Classifier::learn;
   ML_EXPORT void learn(
     const cv::Mat_<float>& input,
     const cv::Mat& labels) override;
@@ -111,6 +112,14 @@ class MultilayerPerceptron : public ssig::Multiclass {
 
   ML_EXPORT void setNumLayers(const int numLayers);
 
+  /**
+  @brief Seed of the initial weights, each layer is drawn from its own
+  stream of the global random number service.
+  */
+  ML_EXPORT int getSeed() const;
+
+  ML_EXPORT void setSeed(const int seed);
+
   ML_EXPORT std::vector<cv::Mat> getWeightMatrices() const;
 
   ML_EXPORT void setWeights(const std::vector<cv::Mat>& weights);
@@ -149,6 +158,8 @@ class MultilayerPerceptron : public ssig::Multiclass {
 
   ML_EXPORT bool isTrained() const override;
 
+  ML_EXPORT MemoryFootprint memoryFootprint() const override;
+
   ML_EXPORT Classifier* clone() const override;
 
  protected:
@@ -257,11 +268,16 @@ class MultilayerPerceptron : public ssig::Multiclass {
 
   ML_EXPORT void write(cv::FileStorage& fs) const override;
 
+  ML_EXPORT void readBinary(const BinaryNode& node) override;
+
+  ML_EXPORT void writeBinary(BinaryWriter& writer) const override;
+
  private:
   // private members
   bool mIsTrained = false;;
   float mLearningRate = 0.5f;
   int mNumLayers = 2;
+  int mSeed = 0;
 
   std::string mLoss = "quadratic";
 
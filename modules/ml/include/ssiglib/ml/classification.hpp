@@ -50,6 +50,8 @@
 // ssiglib
 #include "ssiglib/ml/ml_defs.hpp"
 #include "ssiglib/core/algorithm.hpp"
+#include "ssiglib/core/feature_store.hpp"
+#include "ssiglib/core/csr_mat.hpp"
 
 namespace ssig {
 
@@ -64,6 +66,15 @@ class Classifier : public Algorithm {
     const cv::Mat_<float>& inp,
     cv::Mat_<float>& resp) const;
 
+  /**
+  Predicts sparse samples. The default densifies the input, classifiers
+  with a native sparse path override it.
+  */
+  ML_EXPORT virtual int predict(
+    const CsrMat& inp,
+    cv::Mat_<float>& resp,
+    cv::Mat_<int>& labels) const;
+
   ML_EXPORT Classifier(void) = default;
   ML_EXPORT virtual ~Classifier(void) = default;
 
@@ -71,6 +82,19 @@ class Classifier : public Algorithm {
     const cv::Mat_<float>& input,
     const cv::Mat& labels) = 0;
 
+  /**
+  Learns from every row of a labeled store. The rows are read straight from
+  the mapped file instead of being loaded in memory first.
+  */
+  ML_EXPORT virtual void learn(const FeatureStore& store);
+
+  /**
+  Learns from sparse samples, densifying them unless overridden.
+  */
+  ML_EXPORT virtual void learn(
+    const CsrMat& input,
+    const cv::Mat& labels);
+
   ML_EXPORT virtual cv::Mat getLabels() const = 0;
   ML_EXPORT virtual std::unordered_map<int, int> getLabelsOrdering() const = 0;
   ML_EXPORT virtual std::unordered_map<int, int> getIndexLabelsMap() const;
@@ -84,9 +108,12 @@ class Classifier : public Algorithm {
   ML_EXPORT virtual bool empty() const = 0;
   ML_EXPORT virtual bool isTrained() const = 0;
   ML_EXPORT virtual bool isClassifier() const = 0;
+  ML_EXPORT MemoryFootprint memoryFootprint() const override;
 
   ML_EXPORT void read(const cv::FileNode& fn) override = 0;
   ML_EXPORT void write(cv::FileStorage& fs) const override = 0;
+  using Algorithm::readBinary;
+  using Algorithm::writeBinary;
 
   ML_EXPORT virtual Classifier* clone() const = 0;
 
@@ -58,6 +58,7 @@ class ClassifierClustering : public Clustering {
 
   ML_EXPORT void setup(const cv::Mat_<float>& input) override;
 
+  using Clustering::learn;
   ML_EXPORT void learn(const cv::Mat_<float>& input) override;
 
   ML_EXPORT void predict(
@@ -68,6 +69,7 @@ class ClassifierClustering : public Clustering {
   ML_EXPORT bool empty() const override = 0;
   ML_EXPORT bool isTrained() const override = 0;
   ML_EXPORT bool isClassifier() const override = 0;
+  ML_EXPORT MemoryFootprint memoryFootprint() const override;
 
   ML_EXPORT bool iterate();
 
@@ -50,6 +50,8 @@
 // ssiglib
 #include "ssiglib/ml/ml_defs.hpp"
 #include "ssiglib/core/algorithm.hpp"
+#include "ssiglib/core/feature_store.hpp"
+#include "ssiglib/core/quantized_mat.hpp"
 #include "oaa_classifier.hpp"
 
 namespace ssig {
@@ -72,6 +74,11 @@ class Clustering : public Algorithm {
   ML_EXPORT virtual void setup(
     const cv::Mat_<float>& input) = 0;
 
+  /**
+  Clusters every row of the store, read straight from the mapped file.
+  */
+  ML_EXPORT virtual void learn(const FeatureStore& store);
+
   ML_EXPORT virtual void learn(
     const cv::Mat_<float>& input) = 0;
 
@@ -96,14 +103,27 @@ class Clustering : public Algorithm {
     const PredictionType normtype,
     cv::Mat_<float>& resp);
 
+  /**
+  Quantized samples are decoded row by row while scored, only NORM_L1 and
+  NORM_L2 are supported.
+  */
+  ML_EXPORT static void predict(
+    const QuantizedMat& samples,
+    const cv::Mat_<float>& centroids,
+    const PredictionType normtype,
+    cv::Mat_<float>& resp);
+
   ML_EXPORT virtual size_t getSize() const;
 
   ML_EXPORT virtual bool empty() const = 0;
   ML_EXPORT virtual bool isTrained() const = 0;
   ML_EXPORT virtual bool isClassifier() const = 0;
+  ML_EXPORT MemoryFootprint memoryFootprint() const override;
 
   ML_EXPORT void read(const cv::FileNode& fn) override = 0;
   ML_EXPORT void write(cv::FileStorage& fs) const override = 0;
+  using Algorithm::readBinary;
+  using Algorithm::writeBinary;
 
   ML_EXPORT float getCompactness() const;
 
@@ -126,19 +146,27 @@ class Clustering : public Algorithm {
   ML_EXPORT void setPredictionDistanceType(
     const ssig::Clustering::PredictionType predictionDistanceType);
 
+  /**
+  Predicts with a one-against-all copy of predictionClassifier trained on
+  the clusters. It is trained once by learn(), or right away if the
+  clustering is already learned, so predict() never touches it.
+  */
   ML_EXPORT void setPredictionDistanceType(
     ssig::Classifier& predictionClassifier);
 
   ML_EXPORT int getPredictionDistanceType() const;
 
  protected:
+  // trains mPredictionClassifier with one label per cluster of mSamples
+  ML_EXPORT void learnPredictionClassifier();
+
   cv::Mat_<float> mSamples;
   std::vector<Cluster> mClusters;
   int mK;
   int mMaxIterations;
   bool mReady;
 
-  ssig::Clustering::PredictionType mPredictionDistanceType;
+  ssig::Clustering::PredictionType mPredictionDistanceType = NORM_L2;
   cv::Ptr<ssig::OAAClassifier> mPredictionClassifier;
 };
 
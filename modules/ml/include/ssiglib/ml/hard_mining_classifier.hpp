@@ -61,6 +61,7 @@ class HardMiningClassifier : public ssig::Classifier {
     const cv::Mat_<float>& inp,
     cv::Mat_<float>& resp,
     cv::Mat_<int>& labels) const override;
+  using Classifier::learn;
   ML_EXPORT void learn(
     const cv::Mat_<float>& input,
     const cv::Mat& labels) override;
@@ -70,6 +71,7 @@ class HardMiningClassifier : public ssig::Classifier {
   ML_EXPORT bool empty() const override;
   ML_EXPORT bool isTrained() const override;
   ML_EXPORT bool isClassifier() const override;
+  ML_EXPORT MemoryFootprint memoryFootprint() const override;
   ML_EXPORT void read(const cv::FileNode& fn) override;
   ML_EXPORT void write(cv::FileStorage& fs) const override;
   ML_EXPORT Classifier* clone() const override;
@@ -71,6 +71,7 @@ class HierarchicalKmeans : public Clustering {
   ML_EXPORT HierarchicalKmeans& operator=(const HierarchicalKmeans& rhs);
 
   ML_EXPORT void setup(const cv::Mat_<float>& input) override;
+  using Clustering::learn;
   ML_EXPORT void learn(const cv::Mat_<float>& input) override;
   ML_EXPORT void predict(
     const cv::Mat_<float>& inp,
@@ -80,6 +81,7 @@ class HierarchicalKmeans : public Clustering {
   ML_EXPORT bool empty() const override;
   ML_EXPORT bool isTrained() const override;
   ML_EXPORT bool isClassifier() const override;
+  ML_EXPORT MemoryFootprint memoryFootprint() const override;
   ML_EXPORT void read(const cv::FileNode& fn) override;
   ML_EXPORT void write(cv::FileStorage& fs) const override;
 
@@ -60,6 +60,7 @@ class Kmeans : public Clustering {
   Kmeans(const Kmeans& rhs);
   Kmeans& operator=(const Kmeans& rhs);
 
+  using Clustering::learn;
   ML_EXPORT void learn(const cv::Mat_<float>& input) override;
 
   ML_EXPORT void predict(const cv::Mat_<float>& inp,
@@ -73,11 +74,14 @@ class Kmeans : public Clustering {
   ML_EXPORT bool empty() const override;
   ML_EXPORT bool isTrained() const override;
   ML_EXPORT bool isClassifier() const override;
+  ML_EXPORT MemoryFootprint memoryFootprint() const override;
 
   ML_EXPORT void setup(const cv::Mat_<float>& input) override;
 
   ML_EXPORT void read(const cv::FileNode& fn) override;
   ML_EXPORT void write(cv::FileStorage& fs) const override;
+  ML_EXPORT void readBinary(const BinaryNode& node) override;
+  ML_EXPORT void writeBinary(BinaryWriter& writer) const override;
 
   ML_EXPORT int getFlags() const;
 
@@ -55,6 +55,7 @@ class MSTreeClustering : public Clustering {
   virtual ~MSTreeClustering(void) = default;
 
   ML_EXPORT void setup(const cv::Mat_<float>& input) override;
+  using Clustering::learn;
   ML_EXPORT void learn(const cv::Mat_<float>& input) override;
   ML_EXPORT void predict(const cv::Mat_<float>& inp,
                          cv::Mat_<float>& resp) const override;
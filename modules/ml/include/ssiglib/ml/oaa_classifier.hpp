@@ -66,6 +66,7 @@ class OAAClassifier : public Multiclass {
     cv::Mat_<float>& resp,
     cv::Mat_<int>& labels) const override;
 
+  using Classifier::learn;
   ML_EXPORT void learn(
     const cv::Mat_<float>& input,
     const cv::Mat& labels) override;
@@ -76,6 +77,7 @@ class OAAClassifier : public Multiclass {
   ML_EXPORT bool empty() const override;
   ML_EXPORT bool isTrained() const override;
   ML_EXPORT bool isClassifier() const override;
+  ML_EXPORT MemoryFootprint memoryFootprint() const override;
 
   ML_EXPORT void load(const std::string& filename,
                       const std::string& nodename) override;
@@ -84,6 +86,8 @@ class OAAClassifier : public Multiclass {
 
   ML_EXPORT void read(const cv::FileNode& fn) override;
   ML_EXPORT void write(cv::FileStorage& fs) const override;
+  ML_EXPORT void readBinary(const BinaryNode& node) override;
+  ML_EXPORT void writeBinary(BinaryWriter& writer) const override;
 
   ML_EXPORT Classifier* clone() const override;
 
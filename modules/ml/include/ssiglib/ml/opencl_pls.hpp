@@ -49,6 +49,7 @@
 #include <opencv2/core.hpp>
 // ssiglib
 #include "ssiglib/ml/ml_defs.hpp"
+#include "ssiglib/core/binary_storage.hpp"
 
 namespace ssig {
 class OpenClPLS {
@@ -64,7 +65,7 @@ class OpenClPLS {
   ML_EXPORT void predict(
                           const cv::Mat_<float>& X,
                           cv::Mat_<float>& projX,
-                          int nfactors);
+                          int nfactors) const;
 
   // retrieve the number of factors
   ML_EXPORT int getNFactors() const;
@@ -73,15 +74,17 @@ class OpenClPLS {
   // maximum)
   ML_EXPORT void predict(
                           const cv::Mat_<float>& X,
-                          cv::Mat_<float>& ret);
+                          cv::Mat_<float>& ret) const;
 
   // save OpenClPLS model
   ML_EXPORT void save(std::string filename) const;
   ML_EXPORT void save(cv::FileStorage& storage) const;
+  ML_EXPORT void save(BinaryWriter& writer) const;
 
   // load OpenClPLS model
   ML_EXPORT void load(std::string filename);
   ML_EXPORT void load(const cv::FileNode& node);
+  ML_EXPORT void load(const BinaryNode& node);
 
   // compute OpenClPLS using cross-validation to define the number of factors
   ML_EXPORT void learnWithCrossValidation(int folds, cv::Mat_<float>& X,
@@ -102,7 +105,6 @@ class OpenClPLS {
   cv::UMat mWstar;
   cv::UMat mBstar;
 
-  cv::UMat mZDataV;
   cv::UMat mYscaled;
   int mNFactors;
 };
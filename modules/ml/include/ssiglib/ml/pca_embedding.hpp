@@ -62,6 +62,8 @@ class PCAEmbedding : Embedding {
     cv::InputArray sample,
     cv::OutputArray output) override;
 
+  ML_EXPORT MemoryFootprint memoryFootprint() const override;
+
  protected:
   ML_EXPORT PCAEmbedding(void) = default;
 
@@ -43,6 +43,7 @@
 #ifndef _SSIG_ML_PLS_HPP_
 #define _SSIG_ML_PLS_HPP_
 // c++
+#include <memory>
 #include <stdexcept>
 #include <vector>
 #include <string>
@@ -50,6 +51,11 @@
 #include <opencv2/core.hpp>
 // ssiglib
 #include <ssiglib/ml/ml_defs.hpp>
+#include <ssiglib/core/binary_storage.hpp>
+#include <ssiglib/core/feature_store.hpp>
+#include <ssiglib/core/quantized_mat.hpp>
+#include <ssiglib/core/csr_mat.hpp>
+#include <ssiglib/core/memory_footprint.hpp>
 
 namespace ssig {
 
@@ -65,12 +71,27 @@ class PLS {
   // factors of the PLS model)
   void computeBstar(int nfactors);
 
+  // compute PLS model with precomputed column statistics of X
+  void learn(cv::Mat_<float>& X, const cv::Mat_<float>& Xmean,
+             const cv::Mat_<float>& Xstd, cv::Mat_<float>& Y, int nfactors);
+
+  // NIPALS iterations given the column statistics of X; Operand provides
+  // the products with the z-scored and deflated X (see pls.cpp)
+  template <class Operand>
+  void learnFactors(Operand& X, cv::Mat_<float>& Y, int nfactors);
+
  public:
   PLS() = default;
   virtual ~PLS() = default;
   // compute PLS model
   ML_EXPORT void learn(cv::Mat_<float>& X, cv::Mat_<float>& Y, int nfactors);
 
+  // compute PLS model on the rows of a store, using its column statistics;
+  // the rows are only read, a block at a time, and the deflation is kept as
+  // the factors, so memory grows with rows * factors, not rows * columns
+  ML_EXPORT void learn(const FeatureStore& store, cv::Mat_<float>& Y,
+                       int nfactors);
+
   // return projection considering n factors
   ML_EXPORT void predict(
     const cv::Mat_<float>& X,
@@ -83,6 +104,11 @@ class PLS {
   // projection Bstar considering a number of factors (must be smaller than the
   // maximum)
   ML_EXPORT void predict(const cv::Mat_<float>& X, cv::Mat_<float>& ret) const;
+  // same projection for quantized rows, decoded a block at a time
+  ML_EXPORT void predict(const QuantizedMat& X, cv::Mat_<float>& ret) const;
+  // same projection for sparse rows; the z-scoring is folded into Bstar so
+  // only the stored elements are visited
+  ML_EXPORT void predict(const CsrMat& X, cv::Mat_<float>& ret) const;
 
   // save PLS model
   ML_EXPORT void save(std::string filename) const;
@@ -92,6 +118,13 @@ class PLS {
   ML_EXPORT void load(std::string filename);
   ML_EXPORT void load(const cv::FileNode& node);
 
+  // binary (memory mapped) counterparts of save and load; the loaded
+  // matrices point into the file, which loadBinary keeps mapped
+  ML_EXPORT void saveBinary(const std::string& filename) const;
+  ML_EXPORT void save(BinaryWriter& writer) const;
+  ML_EXPORT void loadBinary(const std::string& filename);
+  ML_EXPORT void load(const BinaryNode& node);
+
   // compute PLS using cross-validation to define the number of factors
   ML_EXPORT void learnWithCrossValidation(
     int folds,
@@ -123,6 +156,10 @@ class PLS {
   ML_EXPORT cv::Mat_<float> getBstar() const;
   ML_EXPORT void setBstar(const cv::Mat_<float>& bstar);
 
+  // bytes of the model matrices and of the file mapped by loadBinary; T and
+  // Yscaled are training matrices kept for computeBstar
+  ML_EXPORT MemoryFootprint memoryFootprint() const;
+
  protected:
   cv::Mat_<float> mXmean;
   cv::Mat_<float> mXstd;
@@ -139,6 +176,8 @@ class PLS {
 
   cv::Mat_<float> mYscaled;
   int mNFactors;
+
+  std::shared_ptr<const BinaryStorage> mStorage;
 };
 
 }  // namespace ssig
@@ -64,17 +64,38 @@ class PLSClassifier : public Multiclass {
     const cv::Mat_<float>& inp,
               cv::Mat_<float>& resp,
               cv::Mat_<int>& labels) const override;
+  /**
+  Predicts quantized samples without expanding them to float; the OpenCL
+  path is not used for them.
+  */
+  ML_EXPORT int predict(
+    const QuantizedMat& inp,
+    cv::Mat_<float>& resp,
+    cv::Mat_<int>& labels) const;
+  ML_EXPORT int predict(
+    const CsrMat& inp,
+    cv::Mat_<float>& resp,
+    cv::Mat_<int>& labels) const override;
+  using Classifier::learn;
   ML_EXPORT void learn(
     const cv::Mat_<float>& input,
     const cv::Mat& labels) override;
+  /**
+  Unlike learn(input, labels) the samples are not cloned: PLS scales them
+  in a private mapping of the store file and uses the store statistics.
+  */
+  ML_EXPORT void learn(const FeatureStore& store) override;
   ML_EXPORT cv::Mat getLabels() const override;
   ML_EXPORT std::unordered_map<int, int> getLabelsOrdering() const override;
   ML_EXPORT bool empty() const override;
   ML_EXPORT bool isTrained() const override;
   ML_EXPORT bool isClassifier() const override;
+  ML_EXPORT MemoryFootprint memoryFootprint() const override;
 
   ML_EXPORT void read(const cv::FileNode& fn) override;
   ML_EXPORT void write(cv::FileStorage& fs) const override;
+  ML_EXPORT void readBinary(const BinaryNode& node) override;
+  ML_EXPORT void writeBinary(BinaryWriter& writer) const override;
 
   ML_EXPORT Classifier* clone() const override;
 
@@ -98,6 +119,9 @@ class PLSClassifier : public Multiclass {
   bool mIsMulticlass = false;
 
   void setClassWeights(const int classLabel, const float weight) override;
+
+  // turns the PLS responses into labels, returns the predict() result
+  int assignLabels(cv::Mat_<float>& resp, cv::Mat_<int>& labels) const;
 };
 
 }  // namespace ssig
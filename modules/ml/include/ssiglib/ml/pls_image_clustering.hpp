@@ -48,6 +48,7 @@
 // ssiglib
 #include <ssiglib/core/util.hpp>
 #include <ssiglib/core/math.hpp>
+#include <ssiglib/core/similarity_graph.hpp>
 #include <ssiglib/ml/classifier_clustering.hpp>
 #include <ssiglib/ml/multiclass.hpp>
 
@@ -75,6 +76,8 @@ class PLSImageClustering : public ClassifierClustering {
 
   ML_EXPORT bool isClassifier() const override;
 
+  ML_EXPORT MemoryFootprint memoryFootprint() const override;
+
   ML_EXPORT void getCentroids(cv::Mat_<float>& centroidsMatrix) const override;
 
   ML_EXPORT void setClassifier(Classifier& classifier) override;
@@ -152,6 +155,10 @@ class PLSImageClustering : public ClassifierClustering {
   ML_EXPORT bool findClosestClusters(const cv::Mat& similarityMatrix,
                                      const float threshold,
                                      std::pair<int, int>& closestPair);
+  static
+  ML_EXPORT bool findClosestClusters(const SimilarityGraph& graph,
+                                     const float threshold,
+                                     std::pair<int, int>& closestPair);
 
   ML_EXPORT void buildClusterRepresentation(
     const cv::Mat_<float>& samples,
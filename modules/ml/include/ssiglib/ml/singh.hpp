@@ -63,6 +63,7 @@ class Singh : public ClassifierClustering {
   ML_EXPORT bool empty() const override;
   ML_EXPORT bool isTrained() const override;
   ML_EXPORT bool isClassifier() const override;
+  ML_EXPORT MemoryFootprint memoryFootprint() const override;
   ML_EXPORT void getCentroids(cv::Mat_<float>& centroidsMatrix) const override;
 
   ML_EXPORT void setClassifier(Classifier& classifier) override;
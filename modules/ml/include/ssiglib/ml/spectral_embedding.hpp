@@ -75,6 +75,8 @@ class SpectralEmbedding : public ssig::Algorithm {
   ML_EXPORT int getDimensions() const;
   ML_EXPORT void setDimensions(const int dimensions);
 
+  ML_EXPORT MemoryFootprint memoryFootprint() const override;
+
  protected:
   ML_EXPORT SpectralEmbedding(void);
   ML_EXPORT void read(const cv::FileNode& fn) override;
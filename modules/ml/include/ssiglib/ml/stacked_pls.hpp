@@ -84,6 +84,8 @@ class StackedPLS : public ssig::Algorithm {
   ML_EXPORT void setFilters(const std::vector<std::vector<cv::Mat>>& filters);
   ML_EXPORT void getTrainingOutput(cv::Mat& trainSamplesOut) const;
 
+  ML_EXPORT MemoryFootprint memoryFootprint() const override;
+
  protected:
   StackedPLS(void);
   void read(const cv::FileNode& fn) override;
@@ -54,16 +54,19 @@
 
 namespace ssig {
 class SVMClassifier : public Classifier {
-  static svm_problem* convertToLibSVM(
+  static void convertToLibSVM(
     const cv::Mat_<int>& labels,
-    const cv::Mat_<float>& features,
     int& numLabels,
-    double* & y,
-    svm_node** & x);
+    double* & y);
 
   static svm_node** convertToLibSVM(
     const cv::Mat_<float>& features);
 
+  static svm_node** convertToLibSVM(
+    const CsrMat& features);
+
+  static void releaseLibSVM(svm_node** nodes, const int len);
+
   static void convertToLibSVM(
     const std::unordered_map<int, float>& weights,
     svm_parameter &params);
@@ -88,15 +91,27 @@ class SVMClassifier : public Classifier {
   ML_EXPORT static cv::Ptr<SVMClassifier> create();
   ML_EXPORT virtual ~SVMClassifier(void);
 
+  using Classifier::learn;
   ML_EXPORT void learn(
     const cv::Mat_<float>& input,
     const cv::Mat& labels) override;
+  /**
+  The libsvm nodes are built straight from the CSR arrays, the samples are
+  never densified.
+  */
+  ML_EXPORT void learn(
+    const CsrMat& input,
+    const cv::Mat& labels) override;
 
   using Classifier::predict;
   ML_EXPORT int predict(
     const cv::Mat_<float>& inp,
     cv::Mat_<float>& resp,
     cv::Mat_<int>& labels) const override;
+  ML_EXPORT int predict(
+    const CsrMat& inp,
+    cv::Mat_<float>& resp,
+    cv::Mat_<int>& labels) const override;
 
   ML_EXPORT cv::Mat getLabels() const override;
   ML_EXPORT std::unordered_map<int, int> getLabelsOrdering() const override;
@@ -107,9 +122,19 @@ class SVMClassifier : public Classifier {
   ML_EXPORT bool empty() const override;
   ML_EXPORT bool isTrained() const override;
   ML_EXPORT bool isClassifier() const override;
+  /**
+  Counts the libsvm nodes kept from learn and the model; the support vectors
+  of a trained model point into the former.
+  */
+  ML_EXPORT MemoryFootprint memoryFootprint() const override;
 
   ML_EXPORT void read(const cv::FileNode& fn) override;
   ML_EXPORT void write(cv::FileStorage& fs) const override;
+  /**
+  The support vectors are not copied: the model points into the mapped file.
+  */
+  ML_EXPORT void readBinary(const BinaryNode& node) override;
+  ML_EXPORT void writeBinary(BinaryWriter& writer) const override;
 
   ML_EXPORT Classifier* clone() const override;
 
@@ -161,10 +186,17 @@ class SVMClassifier : public Classifier {
 
  private:
   ML_EXPORT inline void cleanup();
+  // trains on the nodes in mX
+  void train(const cv::Mat_<int>& labels);
+  int predictNodes(svm_node** featNode, const int len,
+                   cv::Mat_<float>& resp, cv::Mat_<int>& labels) const;
 
   bool mIsMulticlass = false;
   // private members
   svm_model* mModel = nullptr;
+  // the support vectors of a model read by readBinary point into this
+  // view of the mapped file, it keeps the mapping alive for mModel
+  cv::Mat mMappedNodes;
   double* mY = nullptr;
   svm_node** mX = nullptr;
   int mSamplesLen = 0;
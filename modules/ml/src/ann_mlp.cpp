@@ -49,8 +49,34 @@
 
 // local
 #include "ssiglib/ml/ann_mlp.hpp"
+#include "ssiglib/core/gemm.hpp"
+#include "ssiglib/core/profiler.hpp"
+#include "ssiglib/core/rng.hpp"
+#include "ssiglib/core/simd.hpp"
 
 namespace ssig {
+namespace {
+// applies an element-wise ssig::simd kernel to a CV_32F matrix
+void applyKernel(const cv::Mat& inp, cv::Mat& out,
+                 void (*kernel)(const float*, float*, int)) {
+  out.create(inp.size(), CV_32F);
+  for (int r = 0; r < inp.rows; ++r)
+    kernel(inp.ptr<float>(r), out.ptr<float>(r), inp.cols);
+}
+
+// D = op(A) * op(B); the Mat passes go through ssig::gemm, the UMat ones
+// stay on OpenCL
+void matMul(const cv::Mat& A, const cv::Mat& B, cv::Mat& D,
+            const int flags = 0) {
+  ssig::gemm(A, B, D, flags);
+}
+
+void matMul(const cv::UMat& A, const cv::UMat& B, cv::UMat& D,
+            const int flags = 0) {
+  cv::gemm(A, B, 1, cv::noArray(), 0, D, flags);
+}
+}  // namespace
+
 MultilayerPerceptron::MultilayerPerceptron() {
   // Constructor
 }
@@ -150,7 +176,7 @@ void MultilayerPerceptron::doForwardPass(
 
   for (int l = 0; l < numLayers; ++l) {
     MatType layerResponse;
-    cv::gemm(weights[l], activations[l], 1, cv::noArray(), 0, layerResponse);
+    matMul(weights[l], activations[l], layerResponse);
 
     outputs[l] = layerResponse;
     applyActivation(activationTypes[l], layerResponse, layerResponse);
@@ -165,33 +191,33 @@ void MultilayerPerceptron::setWeights(const int startNodes) {
   mWeights.resize(mActivationsTypes.size());
   const int numWeights = static_cast<int>(mWeights.size());
   const int weightEnd = numWeights - 1;
+  const uint64_t key = deriveSeed(RNG_MLP, static_cast<uint64_t>(mSeed));
+  // standard normal weights, layer l draws from stream l
+  auto randomize = [key](const int layer, cv::Mat& weights) {
+    PhiloxRng rng(key, static_cast<uint64_t>(layer));
+    rng.fillGaussian(weights.ptr<float>(), weights.total(), 1.f);
+  };
   mWeights[0] = cv::Mat::zeros(
     mNumNodesConfiguration[0] + 1,
     startNodes, CV_32F);
-  cv::randn(mWeights[0],
-            cv::Mat(1, 1, CV_32F, 0.f),
-            cv::Mat(1, 1, CV_32F, 1.f));
+  randomize(0, mWeights[0]);
   for (int i = 1; i < weightEnd - 1; ++i) {
     const int ncols = mNumNodesConfiguration[i - 1] + 1,
       nrows = mNumNodesConfiguration[i] + 1;
     // plus one due to the bias factor
     mWeights[i] = cv::Mat::zeros(nrows, ncols, CV_32F);
-    cv::randn(
-      mWeights[i], cv::Mat(1, 1, CV_32F, 0.f),
-      cv::Mat(1, 1, CV_32F, 1.f));
+    randomize(i, mWeights[i]);
   }
   mWeights[weightEnd] = cv::Mat::zeros(
     mNumNodesConfiguration[weightEnd],
     mWeights[weightEnd - 1].rows, CV_32F);
-  cv::randn(
-    mWeights[weightEnd],
-    cv::Mat(1, 1, CV_32F, 0.f),
-    cv::Mat(1, 1, CV_32F, 1.f));
+  randomize(weightEnd, mWeights[weightEnd]);
 }
 
 void MultilayerPerceptron::learn(
   const cv::Mat_<float>& _input,
   const cv::Mat& labels) {
+  SSIG_PROFILE_SCOPE("MultilayerPerceptron::learn");
   mIsTrained = false;
 
   if (mOpenClEnabled) {
@@ -258,6 +284,7 @@ int MultilayerPerceptron::predict(
   const cv::Mat_<float>& _inp,
   cv::Mat_<float>& resp,
   cv::Mat_<int>& labels) const {
+  SSIG_PROFILE_SCOPE("MultilayerPerceptron::predict");
   std::vector<cv::Mat> layerOut;
   std::vector<cv::Mat> activations;
   cv::Mat inp;
@@ -302,9 +329,13 @@ void MultilayerPerceptron::predict(
   resp = activations.back().t();
   labels = cv::Mat(resp.rows, 1, CV_32S, -1);
   for (int r = 0; r < resp.rows; ++r) {
-    int maxIdx[2];
-    cv::minMaxIdx(resp.row(r), nullptr, nullptr, nullptr, maxIdx);
-    labels.at<int>(r) = maxIdx[1];
+    if (resp.type() == CV_32F) {
+      labels.at<int>(r) = simd::argmax(resp.ptr<float>(r), resp.cols);
+    } else {
+      int maxIdx[2];
+      cv::minMaxIdx(resp.row(r), nullptr, nullptr, nullptr, maxIdx);
+      labels.at<int>(r) = maxIdx[1];
+    }
   }
 }
 
@@ -391,8 +422,7 @@ void MultilayerPerceptron::computeErrors(
                         errors.back());
   for (int L = numLayers - 1; L > 0; --L) {
     MatType aux;
-    cv::gemm(weights[L], errors[L + 1], 1,
-             cv::noArray(), 0, aux, cv::GEMM_1_T);
+    matMul(weights[L], errors[L + 1], aux, cv::GEMM_1_T);
     MatType derivative;
     applyDerivative(activationTypes[L - 1], outputs[L - 1], derivative);
     cv::multiply(aux, derivative, errors[L]);
@@ -409,9 +439,7 @@ void MultilayerPerceptron::gradientUpdate(
   std::vector<MatType> newWeights(weights.size());
   for (int i = 1; i <= len; ++i) {
     MatType G_l;
-    cv::gemm(
-      errors[i], activations[i - 1],
-      1, cv::noArray(), 1, G_l, cv::GEMM_2_T);
+    matMul(errors[i], activations[i - 1], G_l, cv::GEMM_2_T);
     cv::addWeighted(
       weights[i - 1], 1, G_l, -learningRate, 0, newWeights[i - 1]);
   }
@@ -481,10 +509,14 @@ void MultilayerPerceptron::logistic(
   } else {
     cv::Mat inp = _inp.getMat();
     cv::Mat out;
-    cv::multiply(-1, inp, out);
-    cv::exp(out, out);
-    cv::add(1, out, out);
-    cv::divide(1, out, out);
+    if (inp.type() == CV_32F) {
+      applyKernel(inp, out, &simd::sigmoid);
+    } else {
+      cv::multiply(-1, inp, out);
+      cv::exp(out, out);
+      cv::add(1, out, out);
+      cv::divide(1, out, out);
+    }
     out.copyTo(_out);
   }
 }
@@ -504,7 +536,10 @@ void MultilayerPerceptron::softmax(
   } else {
     cv::Mat inp = _inp.getMat();
     cv::Mat out;
-    cv::exp(inp, out);
+    if (inp.type() == CV_32F)
+      applyKernel(inp, out, &simd::exp);
+    else
+      cv::exp(inp, out);
     cv::min(out, 1e10, out);
     cv::add(out, FLT_EPSILON, out);
     for (int c = 0; c < out.cols; ++c) {
@@ -638,6 +673,72 @@ void MultilayerPerceptron::write(cv::FileStorage& fs) const {
   fs << "loss" << mLoss;
 }
 
+void MultilayerPerceptron::readBinary(const BinaryNode& node) {
+  const int numWeights = node.getInt("numWeights");
+  auto weightsNode = node["weights"];
+  mWeights.resize(numWeights);
+  for (int i = 0; i < numWeights; ++i) {
+    mWeights[i] = weightsNode.getMat("weight_" + std::to_string(i));
+  }
+
+  mNumLayers = node.getInt("numLayers");
+
+  const int numActivations = node.getInt("numActivations");
+  auto activationsNode = node["activations"];
+  mActivationsTypes.resize(numActivations);
+  for (int i = 0; i < numActivations; ++i) {
+    mActivationsTypes[i] = activationsNode.getString(std::to_string(i));
+  }
+
+  mLearningRate = static_cast<float>(node.getDouble("learningRate"));
+  const cv::Mat_<int> numNodes = node.getMat("numNodesConfig");
+  mNumNodesConfiguration.assign(numNodes.begin(), numNodes.end());
+  const cv::Mat_<float> dropoutWeights = node.getMat("dropoutWeights");
+  mDropoutWeights.assign(dropoutWeights.begin(), dropoutWeights.end());
+
+  const int numDropouts = node.getInt("numDropouts");
+  auto dropoutsNode = node["dropouts"];
+  mDropouts.resize(numDropouts);
+  for (int i = 0; i < numDropouts; ++i) {
+    mDropouts[i] = dropoutsNode.getMat("dropout_" + std::to_string(i));
+  }
+  mLoss = node.getString("loss");
+  mIsTrained = !mWeights.empty();
+}
+
+void MultilayerPerceptron::writeBinary(BinaryWriter& writer) const {
+  const int numWeights = static_cast<int>(mWeights.size());
+  writer.write("numWeights", numWeights);
+  writer.beginScope("weights");
+  for (int i = 0; i < numWeights; ++i) {
+    writer.write("weight_" + std::to_string(i), mWeights[i]);
+  }
+  writer.endScope();
+
+  writer.write("numLayers", mNumLayers);
+
+  const int numActivations = static_cast<int>(mActivationsTypes.size());
+  writer.write("numActivations", numActivations);
+  writer.beginScope("activations");
+  for (int i = 0; i < numActivations; ++i) {
+    writer.write(std::to_string(i), mActivationsTypes[i]);
+  }
+  writer.endScope();
+
+  writer.write("learningRate", static_cast<double>(mLearningRate));
+  writer.write("numNodesConfig", cv::Mat(mNumNodesConfiguration, true));
+  writer.write("dropoutWeights", cv::Mat(mDropoutWeights, true));
+
+  const int numDropouts = static_cast<int>(mDropouts.size());
+  writer.write("numDropouts", numDropouts);
+  writer.beginScope("dropouts");
+  for (int i = 0; i < numDropouts; ++i) {
+    writer.write("dropout_" + std::to_string(i), mDropouts[i]);
+  }
+  writer.endScope();
+  writer.write("loss", mLoss);
+}
+
 cv::Mat MultilayerPerceptron::getLabels() const {
   return cv::Mat();
 }
@@ -667,6 +768,14 @@ void MultilayerPerceptron::setNumLayers(const int numLayers) {
   mNumLayers = numLayers;
 }
 
+int MultilayerPerceptron::getSeed() const {
+  return mSeed;
+}
+
+void MultilayerPerceptron::setSeed(const int seed) {
+  mSeed = seed;
+}
+
 std::vector<cv::Mat> MultilayerPerceptron::getWeightMatrices() const {
   return mWeights;
 }
@@ -730,4 +839,13 @@ void MultilayerPerceptron::setDropoutWeights(
 std::string MultilayerPerceptron::getLossType() const {
   return mLoss;
 }
+
+MemoryFootprint MultilayerPerceptron::memoryFootprint() const {
+  MemoryFootprint ans = Multiclass::memoryFootprint();
+  ans.addMats("weights", mWeights);
+  ans.addMats("dropouts", mDropouts);
+  ans.addMats("layerActivations", mLayerActivations);
+  ans.addMats("layerOut", mLayerOut);
+  return ans;
+}
 }  // namespace ssig
@@ -41,6 +41,7 @@
 
 // c++
 #include <unordered_map>
+#include <stdexcept>
 #include <string>
 // opencv
 #include <opencv2/core.hpp>
@@ -57,6 +58,25 @@ int Classifier::predict(
   return predict(inp, resp, empty);
 }
 
+int Classifier::predict(
+  const CsrMat& inp,
+  cv::Mat_<float>& resp,
+  cv::Mat_<int>& labels) const {
+  return predict(inp.toDense(), resp, labels);
+}
+
+void Classifier::learn(const FeatureStore& store) {
+  if (!store.hasLabels())
+    throw std::invalid_argument("The feature store has no labels");
+  learn(store.getData(), store.getLabels());
+}
+
+void Classifier::learn(
+  const CsrMat& input,
+  const cv::Mat& labels) {
+  learn(input.toDense(), labels);
+}
+
 std::unordered_map<int, int> Classifier::getIndexLabelsMap() const {
   return mIdx2Labels;
 }
@@ -99,4 +119,11 @@ int Classifier::getMaxIterations() const {
 void Classifier::setMaxIterations(int maxIterations) {
   mMaxIterations = maxIterations;
 }
+
+MemoryFootprint Classifier::memoryFootprint() const {
+  MemoryFootprint ans = Algorithm::memoryFootprint();
+  ans.addMat("samples", mSamples);
+  ans.addMat("labels", mLabels);
+  return ans;
+}
 }  // namespace ssig
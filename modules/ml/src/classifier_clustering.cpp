@@ -41,6 +41,7 @@
 
 
 #include <ssiglib/ml/classifier_clustering.hpp>
+#include <ssiglib/core/profiler.hpp>
 
 #include <algorithm>
 #include <vector>
@@ -154,6 +155,7 @@ void ClassifierClustering::precondition() {
 }
 
 void ClassifierClustering::learn(const cv::Mat_<float>& input) {
+  SSIG_PROFILE_SCOPE("ClassifierClustering::learn");
   setup(input);
   /********
     **main loop
@@ -172,6 +174,17 @@ const {
   return mClustersResponses;
 }
 
+MemoryFootprint ClassifierClustering::memoryFootprint() const {
+  MemoryFootprint ans = Clustering::memoryFootprint();
+  ans.addMat("naturalSamples", mNaturalSamples);
+  ans.addVectors("discovery", mDiscovery);
+  ans.addVectors("natural", mNatural);
+  ans.addVectors("clustersOld", mClustersOld);
+  ans.addVectors("newClusters", mNewClusters);
+  ans.addVectors("clustersResponses", mClustersResponses);
+  return ans;
+}
+
 }  // namespace ssig
 
 
@@ -38,10 +38,32 @@
 *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 *  POSSIBILITY OF SUCH DAMAGE.
 *****************************************************************************L*/
+#include <stdexcept>
 #include <vector>
 
 #include "ssiglib/ml/clustering.hpp"
 #include "ssiglib/ml/classification.hpp"
+#include "ssiglib/core/distance_kernels.hpp"
+#include "ssiglib/core/executor.hpp"
+#include "ssiglib/core/math.hpp"
+#include "ssiglib/core/profiler.hpp"
+
+namespace {
+// one sample per cluster member, labeled with the cluster index
+void learnClusters(const cv::Mat_<float>& samples,
+                   const std::vector<ssig::Cluster>& clusters,
+                   ssig::Classifier& classifier) {
+  cv::Mat_<float> inp;
+  cv::Mat_<int> labels;
+  for (int c = 0; c < static_cast<int>(clusters.size()); ++c) {
+    for (const auto& id : clusters[c]) {
+      inp.push_back(samples.row(id));
+      labels.push_back(c);
+    }
+  }
+  classifier.learn(inp, labels);
+}
+}  // namespace
 
 namespace ssig {
 
@@ -50,6 +72,10 @@ void Clustering::setup(const cv::Mat_<float>& input) {
   mSamples = input;
 }
 
+void Clustering::learn(const FeatureStore& store) {
+  learn(store.getData());
+}
+
 size_t Clustering::getSize() const {
   return mClusters.size();
 }
@@ -93,6 +119,12 @@ void Clustering::setPredictionDistanceType(
   Classifier& predictionClassifier) {
   mPredictionDistanceType = CLASSIFIER_PREDICTION;
   mPredictionClassifier = ssig::OAAClassifier::create(predictionClassifier);
+  if (!mClusters.empty() && !mSamples.empty())
+    learnPredictionClassifier();
+}
+
+void Clustering::learnPredictionClassifier() {
+  learnClusters(mSamples, mClusters, *mPredictionClassifier);
 }
 
 int Clustering::getPredictionDistanceType() const {
@@ -104,21 +136,64 @@ void Clustering::predict(
   const cv::Mat_<float>& centroids,
   const ssig::Clustering::PredictionType normtype,
   cv::Mat_<float>& resp) {
+  SSIG_PROFILE_SCOPE("Clustering::predict");
   const int n = centroids.rows;
   const int nsamples = samples.rows;
 
-  resp = cv::Mat_<float>::zeros(nsamples, n);
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-  for (int r = 0; r < nsamples; ++r) {
-    cv::Mat_<float> sample = samples.row(r);
-    for (int i = 0; i < n; ++i) {
-      auto cvNorm = static_cast<cv::NormTypes>(normtype);
-      resp[r][i] = -1 * static_cast<float>(
-        cv::norm(sample - centroids.row(i), cvNorm));
+  resp.create(nsamples, n);
+  if (normtype == NORM_L1 || normtype == NORM_L2) {
+    // direct kernels rather than the GEMM expansion of the L2 distance,
+    // which cancels when a sample is close to a centroid and can flip the
+    // nearest one
+    Executor::global().parallelFor(0, nsamples,
+      [&](const int first, const int last) {
+      // the block already has its final size, so it is filled in place
+      cv::Mat_<float> block = resp.rowRange(first, last);
+      if (normtype == NORM_L1)
+        L1Kernel::manyToMany<float>(samples.rowRange(first, last), centroids,
+                                    block);
+      else
+        L2Kernel::manyToMany<float>(samples.rowRange(first, last), centroids,
+                                    block);
+      block *= -1;
+    });
+    return;
+  }
+
+  Executor::global().parallelFor(0, nsamples,
+    [&](const int first, const int last) {
+    for (int r = first; r < last; ++r) {
+      cv::Mat_<float> sample = samples.row(r);
+      for (int i = 0; i < n; ++i) {
+        auto cvNorm = static_cast<cv::NormTypes>(normtype);
+        resp[r][i] = -1 * static_cast<float>(
+          cv::norm(sample, centroids.row(i), cvNorm));
+      }
     }
+  });
+}
+
+void Clustering::predict(
+  const QuantizedMat& samples,
+  const cv::Mat_<float>& centroids,
+  const ssig::Clustering::PredictionType normtype,
+  cv::Mat_<float>& resp) {
+  SSIG_PROFILE_SCOPE("Clustering::predict");
+  if (normtype != NORM_L1 && normtype != NORM_L2) {
+    throw std::invalid_argument(
+      "Quantized samples are only predicted with NORM_L1 or NORM_L2");
   }
+  resp.create(samples.getNumRows(), centroids.rows);
+  Executor::global().parallelFor(0, samples.getNumRows(),
+    [&](const int first, const int last) {
+    const QuantizedMat rows = samples.rowRange(first, last);
+    cv::Mat_<float> block = resp.rowRange(first, last);
+    if (normtype == NORM_L1)
+      L1Kernel::manyToMany(rows, centroids, block);
+    else
+      L2Kernel::manyToMany(rows, centroids, block);
+    block *= -1;
+  });
 }
 
 void Clustering::predict(
@@ -128,14 +203,19 @@ void Clustering::predict(
   cv::Ptr<ssig::Classifier>& classifier,
   cv::Mat_<float>& resp) {
   if (!classifier)
-    std::runtime_error("Please Set the Classifier before hand!");
-  for (int c = 0; c < static_cast<int>(clusters.size()); ++c) {
-    cv::Mat_<int> labels(samples.rows, 1, -1);
-    for (const auto& id : clusters[c]) {
-      labels.at<int>(id) = c;
-    }
-    classifier->learn(samples, labels);
-  }
+    throw std::runtime_error("Please Set the Classifier before hand!");
+  learnClusters(samples, clusters, *classifier);
   classifier->predict(probes, resp);
 }
+
+MemoryFootprint Clustering::memoryFootprint() const {
+  MemoryFootprint ans = Algorithm::memoryFootprint();
+  ans.addMat("samples", mSamples);
+  ans.addVectors("clusters", mClusters);
+  if (mPredictionClassifier) {
+    ans.addChild("predictionClassifier",
+                 mPredictionClassifier->memoryFootprint());
+  }
+  return ans;
+}
 }  // namespace ssig
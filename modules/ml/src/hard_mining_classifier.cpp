@@ -40,6 +40,7 @@
 *****************************************************************************L*/
 
 #include "ssiglib/ml/hard_mining_classifier.hpp"
+#include "ssiglib/core/profiler.hpp"
 
 namespace ssig {
 
@@ -73,6 +74,7 @@ int HardMiningClassifier::predict(
 void HardMiningClassifier::learn(
   const cv::Mat_<float>& input,
   const cv::Mat& labels) {
+  SSIG_PROFILE_SCOPE("HardMiningClassifier::learn");
   cv::Mat_<float> inp = input.clone();
   mLabels = labels.clone();
 
@@ -135,6 +137,13 @@ Classifier* HardMiningClassifier::clone() const {
   return ans;
 }
 
+MemoryFootprint HardMiningClassifier::memoryFootprint() const {
+  MemoryFootprint ans = Classifier::memoryFootprint();
+  if (mClassifier)
+    ans.addChild("classifier", mClassifier->memoryFootprint());
+  return ans;
+}
+
 }  // namespace ssig
 
 
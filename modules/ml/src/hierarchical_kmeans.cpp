@@ -45,6 +45,7 @@
 // ssiglib
 #include "ssiglib/core/util.hpp"
 #include "ssiglib/ml/hierarchical_kmeans.hpp"
+#include "ssiglib/core/profiler.hpp"
 // flann
 #include <flann/flann.hpp>
 
@@ -78,6 +79,7 @@ HierarchicalKmeans::operator=(const HierarchicalKmeans& rhs) {
 void HierarchicalKmeans::setup(const cv::Mat_<float>& input) { }
 
 void HierarchicalKmeans::learn(const cv::Mat_<float>& input) {
+  SSIG_PROFILE_SCOPE("HierarchicalKmeans::learn");
   mSamples = input.clone();
   cv::Mat temp = input;
   cv::Mat_<float> centers(getK(), input.cols, CV_32F);
@@ -173,6 +175,7 @@ void HierarchicalKmeans::learn(const cv::Mat_<float>& input) {
 
 void HierarchicalKmeans::predict(const cv::Mat_<float>& inp,
   cv::Mat_<float>& resp) const {
+  SSIG_PROFILE_SCOPE("HierarchicalKmeans::predict");
   // TODO(Ricardo): implement this
 }
 
@@ -256,4 +259,10 @@ void HierarchicalKmeans::setCBIndex(const float cbIndex) {
 float HierarchicalKmeans::getCBIndex() const {
   return mCBIndex;
 }
+
+MemoryFootprint HierarchicalKmeans::memoryFootprint() const {
+  MemoryFootprint ans = Clustering::memoryFootprint();
+  ans.addMat("centers", mCenters);
+  return ans;
+}
 }  // namespace ssig
@@ -41,7 +41,9 @@
 
 
 #include "ssiglib/ml/kmeans.hpp"
+#include "ssiglib/core/profiler.hpp"
 
+#include <stdexcept>
 #include <unordered_map>
 #include <vector>
 #include <string>
@@ -70,6 +72,7 @@ Kmeans& Kmeans::operator=(const Kmeans& rhs) {
 
 void Kmeans::learn(
   const cv::Mat_<float>& input) {
+  SSIG_PROFILE_SCOPE("Kmeans::learn");
   mCentroids.release();
   mSamples.release();
   mClusters.clear();
@@ -93,22 +96,19 @@ void Kmeans::learn(
     auto cluster = clusters[i];
     mClusters.push_back(cluster);
   }
+  if (mPredictionDistanceType == CLASSIFIER_PREDICTION && mPredictionClassifier)
+    learnPredictionClassifier();
 }
 
 void Kmeans::predict(
   const cv::Mat_<float>& sample,
   cv::Mat_<float>& resp) const {
+  SSIG_PROFILE_SCOPE("Kmeans::predict");
   if (mPredictionDistanceType == CLASSIFIER_PREDICTION) {
-    if (!mPredictionClassifier)
-      std::runtime_error("Please Set the Classifier before hand!");
-    cv::Ptr<ssig::Classifier> classifier =
-        cv::Ptr<ssig::Classifier>(mPredictionClassifier->clone());
-    ssig::Clustering::predict(
-                              mSamples,
-                              sample,
-                              mClusters,
-                              classifier,
-                              resp);
+    // trained by learn(), so concurrent calls only read the classifier
+    if (!mPredictionClassifier || !mPredictionClassifier->isTrained())
+      throw std::logic_error("The prediction classifier is not trained");
+    mPredictionClassifier->predict(sample, resp);
   } else {
     ssig::Clustering::predict(
                               sample,
@@ -160,19 +160,30 @@ void Kmeans::write(cv::FileStorage& fs) const {
   fs << "PredictionType" << mPredictionDistanceType;
   fs << "Centroids" << mCentroids;
   if (mPredictionDistanceType == CLASSIFIER_PREDICTION) {
-    cv::Mat_<float> inp;
-    cv::Mat_<int> labels;
-    int label = 0;
-    for (const auto& cluster : mClusters) {
-      for (const auto& clusterElement : cluster) {
-        inp.push_back(mSamples.row(clusterElement));
-        labels.push_back(label);
-      }
-      ++label;
+    mPredictionClassifier->write(fs);
+  }
+}
+
+void Kmeans::readBinary(const BinaryNode& node) {
+  mPredictionDistanceType = static_cast<ssig::Clustering::PredictionType>(
+    node.getInt("PredictionType"));
+  mCentroids = node.getMat("Centroids");
+  mK = mCentroids.rows;
+  if (mPredictionDistanceType == CLASSIFIER_PREDICTION) {
+    if (mPredictionClassifier == nullptr) {
+      throw std::runtime_error("Classifier not set for this prediction type");
     }
-    mPredictionClassifier->learn(inp, labels);
+    mPredictionClassifier->readBinary(node["classifier"]);
+  }
+}
 
-    mPredictionClassifier->write(fs);
+void Kmeans::writeBinary(BinaryWriter& writer) const {
+  writer.write("PredictionType", static_cast<int>(mPredictionDistanceType));
+  writer.write("Centroids", mCentroids);
+  if (mPredictionDistanceType == CLASSIFIER_PREDICTION) {
+    writer.beginScope("classifier");
+    mPredictionClassifier->writeBinary(writer);
+    writer.endScope();
   }
 }
 
@@ -212,4 +223,10 @@ void Kmeans::setupLabelMatFromInitialization(cv::Mat& labels) {
   }
 }
 
+MemoryFootprint Kmeans::memoryFootprint() const {
+  MemoryFootprint ans = Clustering::memoryFootprint();
+  ans.addMat("centroids", mCentroids);
+  return ans;
+}
+
 }  // namespace ssig
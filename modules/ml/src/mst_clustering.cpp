@@ -38,9 +38,6 @@
 *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 *  POSSIBILITY OF SUCH DAMAGE.
 *****************************************************************************L*/
-#define L2Dist(sampleA, sampleB) static_cast<float>(\
-                                  cv::norm((sampleA) - (sampleB)))
-
 #include "ssiglib/ml/mst_clustering.hpp"
 
 #include <vector>
@@ -48,7 +45,11 @@
 #include <numeric>
 #include <algorithm>
 #include <utility>
-#include <ctime>
+
+#include "ssiglib/core/distance_kernels.hpp"
+#include "ssiglib/core/executor.hpp"
+#include "ssiglib/core/profiler.hpp"
+#include "ssiglib/core/rng.hpp"
 
 namespace ssig {
 static void computeMST(
@@ -62,21 +63,30 @@ cv::Ptr<MSTreeClustering> MSTreeClustering::create() {
 void MSTreeClustering::setup(const cv::Mat_<float>& input) {}
 
 void MSTreeClustering::learn(const cv::Mat_<float>& input) {
+  SSIG_PROFILE_SCOPE("MSTreeClustering::learn");
   mSamples = input;
   // cv::Mat_<float> adjMat;
   std::vector<std::pair<int, int>> edges;
   // computeAdjacencyMatrix(mSamples, adjMat);
   computeMST(input, edges);
 
-  std::sort(edges.begin(), edges.end(),
-            [&input](const std::pair<int, int>& a,
-              const std::pair<int, int>& b) {
-              float weightA = L2Dist(input.row(a.first),
-                    input.row(a.second)),
-                  weightB = L2Dist(input.row(b.first),
-                    input.row(b.second));
-              return weightA > weightB;
+  // each weight is computed once, not twice per comparison
+  const int nEdges = static_cast<int>(edges.size());
+  std::vector<float> edgeWeights(nEdges);
+  for (int e = 0; e < nEdges; ++e) {
+    edgeWeights[e] = L2Kernel::compute(input[edges[e].first],
+                                       input[edges[e].second], input.cols);
+  }
+  std::vector<int> ordering(nEdges);
+  std::iota(ordering.begin(), ordering.end(), 0);
+  std::sort(ordering.begin(), ordering.end(),
+            [&edgeWeights](const int a, const int b) {
+              return edgeWeights[a] > edgeWeights[b];
             });
+  std::vector<std::pair<int, int>> sortedEdges(nEdges);
+  for (int e = 0; e < nEdges; ++e)
+    sortedEdges[e] = edges[ordering[e]];
+  edges.swap(sortedEdges);
   edges.erase(edges.begin(), edges.begin() + (mK - 1));
 
   // find the components after pruning
@@ -115,6 +125,7 @@ void MSTreeClustering::learn(const cv::Mat_<float>& input) {
 void MSTreeClustering::predict(
   const cv::Mat_<float>& inp,
   cv::Mat_<float>& resp) const {
+  SSIG_PROFILE_SCOPE("MSTreeClustering::predict");
   cv::Mat_<float> centroids;
   getCentroids(centroids);
   ssig::Clustering::predict(
@@ -167,8 +178,7 @@ void MSTreeClustering::computeMinimumSpanningTree(
   std::vector<std::pair<int, int>>& edges) {
   // Simple Prim since the graph is dense
   const int nrows = input.rows;
-  std::srand(static_cast<unsigned int>(time(nullptr)));
-  int u = std::rand() % nrows;
+  int u = PhiloxRng(deriveSeed(RNG_CLUSTERING)).uniform(0, nrows);
   int solLen = 0;
   std::vector<bool> inSolution(nrows);
   std::vector<float> weights(nrows, FLT_MAX);
@@ -240,18 +250,17 @@ void MSTreeClustering::computeAdjacencyMatrix(
   adjMatrix = cv::Mat_<float>::zeros(nrows, nrows);
   adjMatrix = FLT_MAX;
 
-#ifdef _OPENMP
-  #pragma omp parallel for
-#endif
-  for (int i = 0; i < nrows; ++i) {
-    cv::Mat_<float> sampleA = input.row(i);
-    for (int j = i + 1; j < nrows; ++j) {
-      cv::Mat_<float> sampleB = input.row(j);
-      float weight = static_cast<float>(cv::norm(sampleA - sampleB));
-      adjMatrix[i][j] = weight;
-      adjMatrix[j][i] = weight;
+  Executor::global().parallelFor(0, nrows,
+    [&](const int first, const int last) {
+    for (int i = first; i < last; ++i) {
+      for (int j = i + 1; j < nrows; ++j) {
+        const float weight = L2Kernel::compute(input[i], input[j],
+                                               input.cols);
+        adjMatrix[i][j] = weight;
+        adjMatrix[j][i] = weight;
+      }
     }
-  }
+  });
 }
 
 void computeMST(
@@ -259,8 +268,7 @@ void computeMST(
   std::vector<std::pair<int, int>>& edges) {
   // Simple Prim since the graph is dense
   const int nrows = samples.rows;
-  std::srand(static_cast<unsigned int>(time(nullptr)));
-  int u = std::rand() % nrows;
+  int u = PhiloxRng(deriveSeed(RNG_CLUSTERING)).uniform(0, nrows);
   int solLen = 0;
   std::vector<bool> inSolution(nrows);
   std::vector<float> weights(nrows, FLT_MAX);
@@ -281,9 +289,13 @@ void computeMST(
     ++solLen;
     inSolution[pos] = true;
 
+    // the squared distance yields the same tree and skips the sqrt
     for (int j = 0; j < nrows; ++j) {
-      float dist = L2Dist(samples.row(pos), samples.row(j));
-      if (!inSolution[j] && dist < weights[j]) {
+      if (inSolution[j])
+        continue;
+      const float dist = SquaredL2Kernel::compute(samples[pos], samples[j],
+                                                  samples.cols);
+      if (dist < weights[j]) {
         weights[j] = dist;
         predecessors[j] = pos;
       }
@@ -41,10 +41,9 @@
 
 #include "ssiglib/ml/oaa_classifier.hpp"
 
+#include <ssiglib/core/executor.hpp>
 #include <ssiglib/core/util.hpp>
-#ifdef _OPENMP
-#include <omp.h>
-#endif
+#include <ssiglib/core/profiler.hpp>
 
 #include <vector>
 
@@ -61,6 +60,7 @@ OAAClassifier::OAAClassifier(const Classifier& prototypeClassifier) {
 void OAAClassifier::learn(
   const cv::Mat_<float>& input,
   const cv::Mat& labels) {
+  SSIG_PROFILE_SCOPE("OAAClassifier::learn");
   if (!mClassifiers.empty()) {
     mClassifiers.clear();
   }
@@ -85,29 +85,29 @@ void OAAClassifier::learn(
     mClassifiers[i] =
         std::move(std::unique_ptr<Classifier>(mUnderlyingClassifier->clone()));
 
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-  for (int i = 0; i < static_cast<int>(labelOrdering.size()); ++i) {
-    const int label = labelOrdering[i];
-    float nPos = 0;
-    float nNeg = 0;
-    cv::Mat_<int> localLabels = cv::Mat_<int>::zeros(mSamples.rows, 1);
-    for (int j = 0; j < labels.rows; ++j) {
-      if (labels.at<int>(j)  == label) {
-        localLabels.at<int>(j) = 1;
-        ++nPos;
-      } else {
-        localLabels.at<int>(j) = -1;
-        ++nNeg;
+  Executor::global().parallelFor(0, static_cast<int>(labelOrdering.size()),
+    [&](const int first, const int last) {
+    for (int i = first; i < last; ++i) {
+      const int label = labelOrdering[i];
+      float nPos = 0;
+      float nNeg = 0;
+      cv::Mat_<int> localLabels = cv::Mat_<int>::zeros(mSamples.rows, 1);
+      for (int j = 0; j < labels.rows; ++j) {
+        if (labels.at<int>(j)  == label) {
+          localLabels.at<int>(j) = 1;
+          ++nPos;
+        } else {
+          localLabels.at<int>(j) = -1;
+          ++nNeg;
+        }
       }
-    }
-    nPos = nPos / (nPos + nNeg);
+      nPos = nPos / (nPos + nNeg);
 
-    mClassifiers[i]->setClassWeights(1, nPos);
-    mClassifiers[i]->setClassWeights(-1, 1 - nPos);
-    mClassifiers[i]->learn(mSamples, localLabels);
-  }
+      mClassifiers[i]->setClassWeights(1, nPos);
+      mClassifiers[i]->setClassWeights(-1, 1 - nPos);
+      mClassifiers[i]->learn(mSamples, localLabels);
+    }
+  });
   mTrained = true;
   mIndex2Label = labelOrdering;
 }
@@ -116,34 +116,35 @@ int OAAClassifier::predict(
   const cv::Mat_<float>& inp,
   cv::Mat_<float>& resp,
   cv::Mat_<int>& labels) const {
+  SSIG_PROFILE_SCOPE("OAAClassifier::predict");
   resp =
       cv::Mat_<float>::zeros(inp.rows, static_cast<int>(mClassifiers.size()));
   labels =
     cv::Mat_<int>::zeros(inp.rows, 1);
-  float maxResp = -FLT_MAX;
-  int bestLabel = 0;
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-  for (int r = 0; r < inp.rows; ++r) {
-    int c = 0;
-    for (auto& classifier : mClassifiers) {
-      cv::Mat_<float> auxResp;
-      cv::Mat_<float> rowFeat = inp.row(r);
-      classifier->predict(rowFeat, auxResp);
-      auto ordering = classifier->getLabelsOrdering();
-      const int idx = ordering[1];
-      float response = auxResp[0][idx];
-      resp[r][c] = response;
-      if (response > maxResp) {
-        bestLabel = c;
-        maxResp = response;
+  Executor::global().parallelFor(0, inp.rows,
+    [&](const int first, const int last) {
+    for (int r = first; r < last; ++r) {
+      float maxResp = -FLT_MAX;
+      int bestLabel = 0;
+      int c = 0;
+      for (auto& classifier : mClassifiers) {
+        cv::Mat_<float> auxResp;
+        cv::Mat_<float> rowFeat = inp.row(r);
+        classifier->predict(rowFeat, auxResp);
+        auto ordering = classifier->getLabelsOrdering();
+        const int idx = ordering[1];
+        float response = auxResp[0][idx];
+        resp[r][c] = response;
+        if (response > maxResp) {
+          bestLabel = c;
+          maxResp = response;
+        }
+        ++c;
       }
-      ++c;
+      labels.at<int>(r) = mIndex2Label[bestLabel];
     }
-    labels.at<int>(r) = mIndex2Label[bestLabel];
-  }
-  return inp.rows > 1 ? 0 : mIndex2Label[bestLabel];
+  });
+  return inp.rows == 1 ? labels.at<int>(0) : 0;
 }
 
 cv::Mat OAAClassifier::getLabels() const {
@@ -188,6 +189,7 @@ void OAAClassifier::read(const cv::FileNode& fn) {
   for (const auto& p : mLabel2Index) {
     mIndex2Label[p.second] = p.first;
   }
+  mClassifiers.clear();
   auto classifiersNode = fn["classifiers"];
   auto it = classifiersNode.begin();
   for (; it != classifiersNode.end(); ++it) {
@@ -196,6 +198,7 @@ void OAAClassifier::read(const cv::FileNode& fn) {
     mClassifiers.push_back(std::move(newClassifier));
     mClassifiers.back()->read(*it);
   }
+  mTrained = true;
 }
 
 void OAAClassifier::write(cv::FileStorage& fs) const {
@@ -215,6 +218,34 @@ void OAAClassifier::write(cv::FileStorage& fs) const {
   fs << "}";
 }
 
+void OAAClassifier::readBinary(const BinaryNode& node) {
+  mLabel2Index = node.getIntMap("labelOrdering");
+  mIndex2Label.resize(mLabel2Index.size());
+  for (const auto& p : mLabel2Index) {
+    mIndex2Label[p.second] = p.first;
+  }
+  mClassifiers.clear();
+  const int nClassifiers = node.getInt("nClassifiers");
+  for (int i = 0; i < nClassifiers; ++i) {
+    auto newClassifier = std::unique_ptr<Classifier>(
+      mUnderlyingClassifier->clone());
+    mClassifiers.push_back(std::move(newClassifier));
+    mClassifiers.back()->readBinary(node["c" + std::to_string(i)]);
+  }
+  mTrained = true;
+}
+
+void OAAClassifier::writeBinary(BinaryWriter& writer) const {
+  writer.write("labelOrdering", mLabel2Index);
+  writer.write("nClassifiers", static_cast<int>(mClassifiers.size()));
+  int i = 0;
+  for (auto& c : mClassifiers) {
+    writer.beginScope("c" + std::to_string(i++));
+    c->writeBinary(writer);
+    writer.endScope();
+  }
+}
+
 Classifier* OAAClassifier::clone() const {
   auto copy = new OAAClassifier(*getUnderlyingClassifier());
   copy->setMaxIterations(getMaxIterations());
@@ -245,4 +276,18 @@ void OAAClassifier::addLabels(const cv::Mat_<int>& labels) {
   labels.convertTo(mLabels, CV_32SC1);
 }
 
+MemoryFootprint OAAClassifier::memoryFootprint() const {
+  MemoryFootprint ans = Multiclass::memoryFootprint();
+  ans.addMat("oaaLabels", mLabels);
+  for (size_t i = 0; i < mClassifiers.size(); ++i) {
+    ans.addChild("classifiers[" + std::to_string(i) + "]",
+                 mClassifiers[i]->memoryFootprint());
+  }
+  if (mUnderlyingClassifier) {
+    ans.addChild("underlyingClassifier",
+                 mUnderlyingClassifier->memoryFootprint());
+  }
+  return ans;
+}
+
 }  // namespace ssig
@@ -46,6 +46,7 @@
 // ssiglib
 #include "ssiglib/core/math.hpp"
 #include "ssiglib/ml/opencl_pls.hpp"
+#include "ssiglib/core/profiler.hpp"
 
 
 namespace ssig {
@@ -58,6 +59,7 @@ void OpenClPLS::learn(
   cv::Mat_<float>& Xmat,
   cv::Mat_<float>& Ymat,
   int nfactors) {
+  SSIG_PROFILE_SCOPE("OpenClPLS::learn");
   cv::ocl::setUseOpenCL(true);
 
   cv::UMat X, Y;
@@ -180,13 +182,12 @@ void OpenClPLS::learn(
 void OpenClPLS::predict(
   const cv::Mat_<float>& X,
   cv::Mat_<float>& projX,
-  int nfactors) {
-  cv::UMat aux, aux2;
+  int nfactors) const {
+  cv::UMat aux, aux2, zDataV;
   int i, y;
 
   if (nfactors > this->mNFactors) {
-    char msg[2048];
-    throw(std::logic_error(msg));
+    throw std::logic_error("More factors requested than were learned");
   }
 
   projX.create(X.rows, nfactors);
@@ -194,12 +195,12 @@ void OpenClPLS::predict(
   for (y = 0; y < X.rows; y++) {
     X.row(y).copyTo(aux);
     // zscore
-    cv::subtract(aux, mXmean, mZDataV);
-    cv::divide(mZDataV, mXstd, mZDataV);
+    cv::subtract(aux, mXmean, zDataV);
+    cv::divide(zDataV, mXstd, zDataV);
 
     for (i = 0; i < nfactors; i++) {
       aux2 = mWstar.col(i);
-      projX[y][i] = static_cast<float>(mZDataV.dot(aux2.t()));
+      projX[y][i] = static_cast<float>(zDataV.dot(aux2.t()));
     }
   }
 }
@@ -210,11 +211,12 @@ int OpenClPLS::getNFactors() const {
 
 void OpenClPLS::predict(
   const cv::Mat_<float>& X,
-  cv::Mat_<float>& ret) {
+  cv::Mat_<float>& ret) const {
   ret.create(X.rows, mBstar.cols);
 
   for (int y = 0; y < X.rows; y++) {
-    cv::UMat aux;
+    // per-call scratch, so one model serves concurrent predicts
+    cv::UMat aux, zDataV;
     X.row(y).copyTo(aux);
 
     if (aux.cols != mXmean.cols) {
@@ -222,12 +224,12 @@ void OpenClPLS::predict(
     }
 
     // zscore
-    cv::subtract(aux, mXmean, mZDataV);
-    cv::divide(mZDataV, mXstd, mZDataV);
+    cv::subtract(aux, mXmean, zDataV);
+    cv::divide(zDataV, mXstd, zDataV);
 
     // X * Bstar .* Ydata.std +  Ydata.mean;
     cv::UMat tmp;
-    cv::gemm(mZDataV, mBstar, 1, cv::noArray(), 0, tmp);
+    cv::gemm(zDataV, mBstar, 1, cv::noArray(), 0, tmp);
     tmp = tmp.mul(mYstd);
     cv::add(tmp, mYmean, tmp);
 
@@ -274,6 +276,26 @@ void OpenClPLS::save(cv::FileStorage& storage) const {
   storage << "}";
 }
 
+void OpenClPLS::save(BinaryWriter& writer) const {
+  cv::Mat Xmean, Xstd, Ymean, Ystd, Wstar, Bstar;
+  mXmean.copyTo(Xmean);
+  mXstd.copyTo(Xstd);
+  mYmean.copyTo(Ymean);
+  mYstd.copyTo(Ystd);
+  mWstar.copyTo(Wstar);
+  mBstar.copyTo(Bstar);
+
+  writer.beginScope("PLS");
+  writer.write("nfactors", mNFactors);
+  writer.write("Xmean", Xmean);
+  writer.write("Xstd", Xstd);
+  writer.write("Wstar", Wstar);
+  writer.write("Bstar", Bstar);
+  writer.write("Ymean", Ymean);
+  writer.write("Ystd", Ystd);
+  writer.endScope();
+}
+
 void OpenClPLS::load(std::string filename) {
   cv::FileStorage storage;
 
@@ -304,6 +326,18 @@ void OpenClPLS::load(const cv::FileNode& node) {
   Bstar.copyTo(mBstar);
 }
 
+void OpenClPLS::load(const BinaryNode& node) {
+  auto n = node["PLS"];
+
+  mNFactors = n.getInt("nfactors");
+  n.getMat("Xmean").copyTo(mXmean);
+  n.getMat("Xstd").copyTo(mXstd);
+  n.getMat("Wstar").copyTo(mWstar);
+  n.getMat("Bstar").copyTo(mBstar);
+  n.getMat("Ymean").copyTo(mYmean);
+  n.getMat("Ystd").copyTo(mYstd);
+}
+
 void OpenClPLS::learnWithCrossValidation(
   int folds,
   cv::Mat_<float>& X,
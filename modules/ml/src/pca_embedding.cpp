@@ -40,6 +40,7 @@
 *****************************************************************************L*/
 
 #include "ssiglib/ml/pca_embedding.hpp"
+#include "ssiglib/core/profiler.hpp"
 
 namespace ssig {
 cv::Ptr<PCAEmbedding> PCAEmbedding::create(const int dimensions) {
@@ -61,6 +62,7 @@ PCAEmbedding& PCAEmbedding::operator=(const PCAEmbedding& rhs) {
 }
 
 void PCAEmbedding::learn(cv::InputArray input) {
+  SSIG_PROFILE_SCOPE("PCAEmbedding::learn");
 #ifdef _WIN32
   mPCA = std::make_unique<cv::PCA>();
 #else
@@ -86,4 +88,14 @@ void PCAEmbedding::project(
 void PCAEmbedding::read(const cv::FileNode& fn) {}
 
 void PCAEmbedding::write(cv::FileStorage& fs) const {}
+
+MemoryFootprint PCAEmbedding::memoryFootprint() const {
+  MemoryFootprint ans = Embedding::memoryFootprint();
+  if (mPCA) {
+    ans.addMat("eigenvectors", mPCA->eigenvectors);
+    ans.addMat("eigenvalues", mPCA->eigenvalues);
+    ans.addMat("mean", mPCA->mean);
+  }
+  return ans;
+}
 }  // namespace ssig
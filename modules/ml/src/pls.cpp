@@ -41,13 +41,16 @@
 
 #include "ssiglib/ml/pls.hpp"
 
+#include <algorithm>
 #include <random>
 #include <map>
 #include <utility>
 #include <vector>
 #include <string>
 
+#include <ssiglib/core/gemm.hpp>
 #include <ssiglib/core/math.hpp>
+#include <ssiglib/core/profiler.hpp>
 #include <opencv2/ml.hpp>
 
 namespace ssig {
@@ -56,7 +59,145 @@ namespace ssig {
 //  return cv::Ptr<PLS>(new PLS);
 // }
 
+namespace {
+// X of the NIPALS iterations, deflated in place
+class DenseOperand {
+ public:
+  explicit DenseOperand(cv::Mat_<float>& X) : mX(X) {}
+
+  // ans = X' * v
+  void multiplyTransposed(const cv::Mat_<float>& v, cv::Mat_<float>& ans) {
+    ssig::gemm(mX, v, ans, cv::GEMM_1_T);
+  }
+
+  // ans = X * v
+  void multiply(const cv::Mat_<float>& v, cv::Mat_<float>& ans) {
+    ssig::gemm(mX, v, ans);
+  }
+
+  // X = X - t * p'
+  void deflate(const cv::Mat_<float>& t, const cv::Mat_<float>& p) {
+    ssig::gemm(t, p, -1, mX, 1, mX, cv::GEMM_2_T);
+  }
+
+ private:
+  cv::Mat_<float>& mX;
+};
+
+// X of the NIPALS iterations over the rows of a store. The mapping is only
+// read: each product z-scores one block of rows at a time into a scratch
+// buffer, and the deflation is kept as the factors found so far,
+// X = Z - T * P', so memory does not grow with the rows of the store
+class StoreOperand {
+ public:
+  StoreOperand(const FeatureStore& store, const cv::Mat_<float>& mean,
+               const cv::Mat_<float>& std)
+    : mStore(store), mMean(mean.clone()), mStd(std.clone()) {}
+
+  void multiplyTransposed(const cv::Mat_<float>& v, cv::Mat_<float>& ans) {
+    ans = cv::Mat_<float>::zeros(mStore.getNumCols(), v.cols);
+    cv::Mat_<float> partial;
+    forEachBlock([&](const int begin, const int end,
+                     const cv::Mat_<float>& block) {
+      ssig::gemm(block, v.rowRange(begin, end), partial, cv::GEMM_1_T);
+      ans += partial;
+    });
+    if (!mT.empty()) {
+      cv::Mat_<float> tv;
+      ssig::gemm(mT, v, tv, cv::GEMM_1_T);
+      ssig::gemm(mP, tv, -1, ans, 1, ans);
+    }
+  }
+
+  void multiply(const cv::Mat_<float>& v, cv::Mat_<float>& ans) {
+    ans.create(mStore.getNumRows(), v.cols);
+    cv::Mat_<float> partial;
+    forEachBlock([&](const int begin, const int end,
+                     const cv::Mat_<float>& block) {
+      ssig::gemm(block, v, partial);
+      partial.copyTo(ans.rowRange(begin, end));
+    });
+    if (!mT.empty()) {
+      cv::Mat_<float> pv;
+      ssig::gemm(mP, v, pv, cv::GEMM_1_T);
+      ssig::gemm(mT, pv, -1, ans, 1, ans);
+    }
+  }
+
+  void deflate(const cv::Mat_<float>& t, const cv::Mat_<float>& p) {
+    if (mT.empty()) {
+      mT = t.clone();
+      mP = p.clone();
+    } else {
+      cv::hconcat(mT, t, mT);
+      cv::hconcat(mP, p, mP);
+    }
+  }
+
+ private:
+  template <class Function>
+  void forEachBlock(Function function) {
+    const int rows = mStore.getNumRows(), step = mStore.getBlockSize();
+    for (int begin = 0; begin < rows; begin += step) {
+      const int end = std::min(rows, begin + step);
+      mStore.getRows(begin, end).copyTo(mBlock);
+      computeZScore(mBlock, mMean, mStd);
+      function(begin, end, mBlock);
+    }
+  }
+
+  const FeatureStore& mStore;
+  cv::Mat_<float> mMean;
+  cv::Mat_<float> mStd;
+  cv::Mat_<float> mBlock;
+  cv::Mat_<float> mT;
+  cv::Mat_<float> mP;
+};
+
+// 1 / std of every column, zero for a zero deviation as in computeZScore;
+// every predict path scales by it so they agree on constant columns
+cv::Mat_<float> inverseDeviation(const cv::Mat_<float>& std) {
+  cv::Mat_<float> ans(std.size());
+  for (int c = 0; c < static_cast<int>(std.total()); ++c)
+    ans(c) = std(c) != 0 ? 1.f / std(c) : 0.f;
+  return ans;
+}
+}  // namespace
+
 void PLS::learn(cv::Mat_<float>& X, cv::Mat_<float>& Y, int nfactors) {
+  cv::Mat_<float> xmean, xstd;
+  computeMeanStd(X, cv::ml::COL_SAMPLE, xmean, xstd);
+  learn(X, xmean, xstd, Y, nfactors);
+}
+
+void PLS::learn(const FeatureStore& store, cv::Mat_<float>& Y,
+                int nfactors) {
+  if (store.getNumRows() != Y.rows)
+    throw std::invalid_argument("Expected one response per stored row");
+  mXmean = store.getMean().clone();
+  mXstd = store.getStd().clone();
+  StoreOperand operand(store, mXmean, mXstd);
+  learnFactors(operand, Y, nfactors);
+}
+
+void PLS::learn(cv::Mat_<float>& X, const cv::Mat_<float>& Xmean,
+                const cv::Mat_<float>& Xstd, cv::Mat_<float>& Y,
+                int nfactors) {
+  if (X.rows != Y.rows) {
+    char msg[2048];
+    throw(std::invalid_argument(msg));
+  }
+
+  mXmean = Xmean.clone();
+  mXstd = Xstd.clone();
+  computeZScore(X, mXmean, mXstd);
+  DenseOperand operand(X);
+  learnFactors(operand, Y, nfactors);
+}
+
+template <class Operand>
+void PLS::learnFactors(Operand& X, cv::Mat_<float>& Y, int nfactors) {
+  SSIG_PROFILE_SCOPE("PLS::learn");
   int i;
   float dt;
   int maxsteps, step;
@@ -65,18 +206,10 @@ void PLS::learn(cv::Mat_<float>& X, cv::Mat_<float>& Y, int nfactors) {
   cv::Mat_<float> tmpM;
 
   // initially, clear current PLS model (if there is one)
-  nsamples = X.rows;
-  nfeatures = X.cols;
-
-  if (X.rows != Y.rows) {
-    char msg[2048];
-    throw(std::invalid_argument(msg));
-  }
+  nsamples = Y.rows;
+  nfeatures = mXmean.cols;
 
   maxsteps = 100;
-  computeMeanStd(X, cv::ml::COL_SAMPLE, mXmean, mXstd);
-  computeZScore(X, mXmean, mXstd);
-
   computeMeanStd(Y, cv::ml::COL_SAMPLE, mYmean, mYstd);
   computeZScore(Y, mYmean, mYstd);
 
@@ -97,16 +230,16 @@ void PLS::learn(cv::Mat_<float>& X, cv::Mat_<float>& Y, int nfactors) {
     do {
       t0 = t.clone();
 
-      w = X.t() * u;
+      X.multiplyTransposed(u, w);
       cv::normalize(w, w, 1, 0, cv::NORM_L2);
 
-      t = X * w;
+      X.multiply(w, t);
       cv::normalize(t, t, 1, 0, cv::NORM_L2);
 
-      c = Y.t() * t;
+      ssig::gemm(Y, t, c, cv::GEMM_1_T);
       cv::normalize(c, c, 1, 0, cv::NORM_L2);
 
-      u = Y * c;
+      ssig::gemm(Y, c, u);
 
       dt = 0;
       cv::Mat_<float> tempT = t0 - t;
@@ -122,7 +255,7 @@ void PLS::learn(cv::Mat_<float>& X, cv::Mat_<float>& Y, int nfactors) {
       // disp(['Latent Variable #',int2str(l),'  Iteration #:',int2str(nstep)])
     } while (dt > 0.000001 && step < maxsteps);
 
-    p = X.t() * t;
+    X.multiplyTransposed(t, p);
 
     b_l = (t.t() * t).inv() * (u.t() * t);
 
@@ -135,15 +268,19 @@ void PLS::learn(cv::Mat_<float>& X, cv::Mat_<float>& Y, int nfactors) {
     u.copyTo(U.col(i));
 
     // deflation of X and Y
-    X = X - (t * p.t());
+    X.deflate(t, p);
 
-    Y = Y - (b_l[0][0] * (t * c.t()));
+    ssig::gemm(t, c, -b_l[0][0], Y, 1, Y, cv::GEMM_2_T);
   }
-  tmpM = mP.t() * mW;
-  mWstar = mW * tmpM.inv();
+  ssig::gemm(mP, mW, tmpM, cv::GEMM_1_T);
+  ssig::gemm(mW, cv::Mat(tmpM.inv()), mWstar);
 
-  tmpM = (mT.t() * mT).inv();
-  mBstar = mWstar * tmpM * mT.t() * mYscaled;
+  // Wstar * (T' * T)^-1 * T' * Y, right to left so every product is thin
+  cv::Mat_<float> TtY, aux;
+  ssig::gemm(mT, mT, tmpM, cv::GEMM_1_T);
+  ssig::gemm(mT, mYscaled, TtY, cv::GEMM_1_T);
+  ssig::gemm(cv::Mat(tmpM.inv()), TtY, aux);
+  ssig::gemm(mWstar, aux, mBstar);
 
   // set max number of factors
   this->mNFactors = nfactors;
@@ -157,9 +294,12 @@ void PLS::computeBstar(int nfactors) {
     throw(std::logic_error(msg));
   }
 
-  tmpM = (mT.colRange(0, nfactors).t() * mT.colRange(0, nfactors)).inv();
-  this->mBstar = mWstar.colRange(0, nfactors) * tmpM *
-                 mT.colRange(0, nfactors).t() * mYscaled;
+  const cv::Mat T = mT.colRange(0, nfactors);
+  cv::Mat_<float> TtY, aux;
+  ssig::gemm(T, T, tmpM, cv::GEMM_1_T);
+  ssig::gemm(T, mYscaled, TtY, cv::GEMM_1_T);
+  ssig::gemm(cv::Mat(tmpM.inv()), TtY, aux);
+  ssig::gemm(mWstar.colRange(0, nfactors), aux, this->mBstar);
 }
 
 int PLS::getNFactors() const { return this->mNFactors; }
@@ -174,16 +314,19 @@ void PLS::predict(const cv::Mat_<float>& X,
 
   projX.create(X.rows, nfactors);
 
-  cv::Mat ZData = X.clone();
+  const cv::Mat_<float> inverse = inverseDeviation(mXstd);
+  cv::Mat_<float> ZData(X.rows, X.cols);
   for (int y = 0; y < X.rows; y++) {
-    ZData.row(y) = ZData.row(y) - mXmean;
-    ZData.row(y) = ZData.row(y) / mXstd;
+    cv::Mat_<float> row = ZData.row(y);
+    cv::multiply(X.row(y) - mXmean, inverse, row);
   }
-  projX = ZData * (mWstar.colRange(0, nfactors));
+  ssig::gemm(ZData, mWstar.colRange(0, nfactors), projX);
 }
 
 void PLS::predict(const cv::Mat_<float>& X, cv::Mat_<float>& ret) const {
+  SSIG_PROFILE_SCOPE("PLS::predict");
   ret.create(X.rows, mBstar.cols);
+  const cv::Mat_<float> inverse = inverseDeviation(mXstd);
   for (int y = 0; y < X.rows; y++) {
     cv::Mat_<float> aux = X.row(y);
 
@@ -193,16 +336,71 @@ void PLS::predict(const cv::Mat_<float>& X, cv::Mat_<float>& ret) const {
 
     cv::Mat zData;
     // zscore
-    zData = aux - mXmean;
-    zData /= mXstd;
+    cv::multiply(aux - mXmean, inverse, zData);
 
     // X * Bstar .* Ydata.std +  Ydata.mean;
-    cv::Mat_<float> tmp = zData * mBstar;
+    cv::Mat_<float> tmp;
+    ssig::gemm(zData, mBstar, tmp);
     tmp = tmp.mul(mYstd) + mYmean;
     tmp.copyTo(ret.row(y));
   }
 }
 
+void PLS::predict(const QuantizedMat& X, cv::Mat_<float>& ret) const {
+  SSIG_PROFILE_SCOPE("PLS::predict");
+  if (X.getNumCols() != mXmean.cols) {
+    throw std::logic_error("Inconsistent data matrix");
+  }
+  const int kBlock = 256;
+  const int rows = X.getNumRows(), cols = X.getNumCols();
+  ret.create(rows, mBstar.cols);
+
+  const cv::Mat_<float> inverse = inverseDeviation(mXstd);
+
+  cv::Mat_<float> block, out;
+  for (int begin = 0; begin < rows; begin += kBlock) {
+    const int end = std::min(rows, begin + kBlock);
+    X.decodeRows(begin, end, block);
+    for (int r = 0; r < block.rows; ++r) {
+      float* row = block[r];
+      for (int c = 0; c < cols; ++c)
+        row[c] = (row[c] - mXmean(c)) * inverse(c);
+    }
+    ssig::gemm(block, mBstar, out);
+    for (int r = 0; r < out.rows; ++r) {
+      for (int c = 0; c < out.cols; ++c)
+        ret(begin + r, c) = out(r, c) * mYstd(c) + mYmean(c);
+    }
+  }
+}
+
+void PLS::predict(const CsrMat& X, cv::Mat_<float>& ret) const {
+  SSIG_PROFILE_SCOPE("PLS::predict");
+  if (X.getNumCols() != mXmean.cols) {
+    throw std::logic_error("Inconsistent data matrix");
+  }
+  // ((x - Xmean) ./ Xstd) * Bstar == x * (Bstar ./ Xstd') - c, where
+  // c = (Xmean ./ Xstd) * Bstar does not depend on the sample. 1 / Xstd is
+  // the inverse deviation of the dense path, so constant columns add nothing
+  const int cols = X.getNumCols(), k = mBstar.cols;
+  const cv::Mat_<float> inverse = inverseDeviation(mXstd);
+  cv::Mat_<float> scaled(cols, k);
+  cv::Mat_<float> offset = cv::Mat_<float>::zeros(1, k);
+  for (int r = 0; r < cols; ++r) {
+    const float inv = inverse(r);
+    const float shift = mXmean(r) * inv;
+    for (int c = 0; c < k; ++c) {
+      scaled(r, c) = mBstar(r, c) * inv;
+      offset(c) += shift * mBstar(r, c);
+    }
+  }
+  X.multiply(scaled, ret);
+  for (int r = 0; r < ret.rows; ++r) {
+    for (int c = 0; c < k; ++c)
+      ret(r, c) = (ret(r, c) - offset(c)) * mYstd(c) + mYmean(c);
+  }
+}
+
 void PLS::save(cv::FileStorage& storage) const {
   if (storage.isOpened() == false) {
     throw std::logic_error("Invalid file storage!");
@@ -259,6 +457,42 @@ void PLS::load(std::string filename) {
   storage.release();
 }
 
+void PLS::save(BinaryWriter& writer) const {
+  writer.beginScope("PLS");
+  writer.write("nfactors", mNFactors);
+  writer.write("Xmean", mXmean);
+  writer.write("Xstd", mXstd);
+  writer.write("Wstar", mWstar);
+  writer.write("Bstar", mBstar);
+  writer.write("Ymean", mYmean);
+  writer.write("Ystd", mYstd);
+  writer.endScope();
+}
+
+void PLS::load(const BinaryNode& node) {
+  auto n = node["PLS"];
+
+  mNFactors = n.getInt("nfactors");
+  mXmean = n.getMat("Xmean");
+  mXstd = n.getMat("Xstd");
+  mWstar = n.getMat("Wstar");
+  mBstar = n.getMat("Bstar");
+  mYmean = n.getMat("Ymean");
+  mYstd = n.getMat("Ystd");
+}
+
+void PLS::saveBinary(const std::string& filename) const {
+  BinaryWriter writer;
+  this->save(writer);
+  writer.save(filename);
+}
+
+void PLS::loadBinary(const std::string& filename) {
+  auto storage = std::make_shared<const BinaryStorage>(filename);
+  this->load(storage->root());
+  mStorage = storage;
+}
+
 void PLS::setMatrix(
                     cv::Mat_<float>& input,
                     cv::Mat_<float>& output,
@@ -480,4 +714,23 @@ cv::Mat_<float> PLS::getBstar() const {
 void PLS::setBstar(const cv::Mat_<float>& bstar) {
   mBstar = bstar;
 }
+
+MemoryFootprint PLS::memoryFootprint() const {
+  MemoryFootprint ans;
+  ans.addMat("Xmean", mXmean);
+  ans.addMat("Xstd", mXstd);
+  ans.addMat("Ymean", mYmean);
+  ans.addMat("Ystd", mYstd);
+  ans.addMat("B", mB);
+  ans.addMat("T", mT);
+  ans.addMat("P", mP);
+  ans.addMat("W", mW);
+  ans.addMat("Wstar", mWstar);
+  ans.addMat("Bstar", mBstar);
+  ans.addMat("Yscaled", mYscaled);
+  if (mStorage)
+    ans.addShared("binaryStorage", mStorage->getSize(),
+                  mStorage->getMapping());
+  return ans;
+}
 }  // namespace ssig
@@ -42,9 +42,11 @@
 #include <ssiglib/ml/pls_classifier.hpp>
 
 #include <cassert>
+#include <stdexcept>
 #include <string>
 #include <unordered_set>
 #include <ssiglib/core/util.hpp>
+#include <ssiglib/core/profiler.hpp>
 
 namespace ssig {
 
@@ -64,18 +66,43 @@ int PLSClassifier::predict(
   const cv::Mat_<float>& inp,
   cv::Mat_<float>& resp,
   cv::Mat_<int>& labels) const {
+  SSIG_PROFILE_SCOPE("PLSClassifier::predict");
   if (mOpenClEnabled) {
     mClPls->predict(inp, resp);
   } else {
     mPls->predict(inp, resp);
   }
+  return assignLabels(resp, labels);
+}
+
+int PLSClassifier::predict(
+  const QuantizedMat& inp,
+  cv::Mat_<float>& resp,
+  cv::Mat_<int>& labels) const {
+  SSIG_PROFILE_SCOPE("PLSClassifier::predict");
+  mPls->predict(inp, resp);
+  return assignLabels(resp, labels);
+}
+
+int PLSClassifier::predict(
+  const CsrMat& inp,
+  cv::Mat_<float>& resp,
+  cv::Mat_<int>& labels) const {
+  SSIG_PROFILE_SCOPE("PLSClassifier::predict");
+  mPls->predict(inp, resp);
+  return assignLabels(resp, labels);
+}
+
+int PLSClassifier::assignLabels(cv::Mat_<float>& resp,
+                                cv::Mat_<int>& labels) const {
+  const int rows = resp.rows;
   cv::Mat_<float> r;
-  r.create(inp.rows, mYColumns);
-  labels = cv::Mat_<int>::zeros(inp.rows, 1);
+  r.create(rows, mYColumns);
+  labels = cv::Mat_<int>::zeros(rows, 1);
 
   int labelIdx = -1;
   if (!mIsMulticlass) {
-    for (int row = 0; row < inp.rows; ++row) {
+    for (int row = 0; row < rows; ++row) {
       r[row][0] = resp[row][0];
       r[row][1] = -1 * resp[row][0];
       if (r[row][0] > 0) {
@@ -100,7 +127,7 @@ int PLSClassifier::predict(
     }
   }
 
-  return inp.rows > 1 || mIsMulticlass ? 0 : labelIdx;
+  return rows > 1 || mIsMulticlass ? 0 : labelIdx;
 }
 
 void PLSClassifier::addLabels(const cv::Mat& labels) {
@@ -150,6 +177,7 @@ cv::Ptr<PLSClassifier> PLSClassifier::create() {
 void PLSClassifier::learn(
   const cv::Mat_<float>& input,
   const cv::Mat& labels) {
+  SSIG_PROFILE_SCOPE("PLSClassifier::learn");
   mIsMulticlass = false;
   mLabels.release();
   mSamples.release();
@@ -173,6 +201,28 @@ void PLSClassifier::learn(
   mTrained = true;
 }
 
+void PLSClassifier::learn(const FeatureStore& store) {
+  if (mOpenClEnabled) {
+    Classifier::learn(store);
+    return;
+  }
+  if (!store.hasLabels())
+    throw std::invalid_argument("The feature store has no labels");
+  SSIG_PROFILE_SCOPE("PLSClassifier::learn");
+  mIsMulticlass = false;
+  mLabels.release();
+  mSamples.release();
+
+  addLabels(store.getLabels());
+  assert(!mLabels.empty());
+
+  cv::Mat_<float> l;
+  mLabels.convertTo(l, CV_32F);
+  mPls = std::unique_ptr<PLS>(new PLS());
+  mPls->learn(store, l, mNumberOfFactors);
+  mTrained = true;
+}
+
 cv::Mat PLSClassifier::getLabels() const {
   return mLabels;
 }
@@ -222,6 +272,29 @@ void PLSClassifier::write(cv::FileStorage& fs) const {
   fs << "}";
 }
 
+void PLSClassifier::readBinary(const BinaryNode& node) {
+  mPls = std::unique_ptr<PLS>(new PLS());
+
+  mLabels2Idx = node.getIntMap("Labels2Idx");
+  mIdx2Labels = node.getIntMap("Idx2Labels");
+  mIsMulticlass = node.getInt("multiclass") != 0;
+
+  mPls->load(node);
+  mNumberOfFactors = mPls->getNFactors();
+  mTrained = true;
+}
+
+void PLSClassifier::writeBinary(BinaryWriter& writer) const {
+  if (mOpenClEnabled) {
+    mClPls->save(writer);
+  } else {
+    mPls->save(writer);
+  }
+  writer.write("Labels2Idx", mLabels2Idx);
+  writer.write("Idx2Labels", mIdx2Labels);
+  writer.write("multiclass", static_cast<int>(mIsMulticlass));
+}
+
 Classifier* PLSClassifier::clone() const {
   auto copy = new PLSClassifier;
 
@@ -238,5 +311,11 @@ void PLSClassifier::setNumberOfFactors(int numberOfFactors) {
   mNumberOfFactors = numberOfFactors;
 }
 
+MemoryFootprint PLSClassifier::memoryFootprint() const {
+  MemoryFootprint ans = Multiclass::memoryFootprint();
+  if (mPls)
+    ans.addChild("pls", mPls->memoryFootprint());
+  return ans;
+}
 
 }  // namespace ssig
@@ -43,6 +43,7 @@
 #include <opencv2/core.hpp>
 // ssiglib
 #include "ssiglib/ml/pls_embedding.hpp"
+#include "ssiglib/core/profiler.hpp"
 
 namespace ssig {
 
@@ -72,6 +73,7 @@ PLSEmbedding& PLSEmbedding::operator=(const PLSEmbedding& rhs) {
 
 void PLSEmbedding::learn(
   cv::InputArray input) {
+  SSIG_PROFILE_SCOPE("PLSEmbedding::learn");
 #ifdef _WIN32
   mPLS = std::make_unique<ssig::PLS>();
 #else
@@ -122,4 +124,13 @@ void PLSEmbedding::setWstarMat(const cv::Mat_<float>& wstarMat) {
 void PLSEmbedding::read(const cv::FileNode& fn) {}
 
 void PLSEmbedding::write(cv::FileStorage& fs) const {}
+
+MemoryFootprint PLSEmbedding::memoryFootprint() const {
+  MemoryFootprint ans = Embedding::memoryFootprint();
+  ans.addMat("labels", mLabels);
+  ans.addMat("wstarMat", mWstarMat);
+  if (mPLS)
+    ans.addChild("pls", mPLS->memoryFootprint());
+  return ans;
+}
 }  // namespace ssig
@@ -40,6 +40,7 @@
 *****************************************************************************L*/
 
 // c++
+#include <algorithm>
 #include <string>
 #include <random>
 #include <memory>
@@ -48,7 +49,9 @@
 #include <vector>
 // ssiglib
 #include "ssiglib/core/math.hpp"
+#include "ssiglib/core/similarity_graph.hpp"
 #include "ssiglib/ml/pls_image_clustering.hpp"
+#include "ssiglib/core/profiler.hpp"
 
 
 namespace ssig {
@@ -158,11 +161,12 @@ void PLSImageClustering::merge(std::vector<Cluster>& clusters) {
     cv::Mat_<float> clusterRepresentation;
     buildClusterRepresentation(mSamples, clusters, clusterRepresentation);
 
-    cv::Mat_<float> similarity = Math::buildSimilarity(
-      clusterRepresentation,
-      *mSimilarityFunction);
+    // the closest pair is the best neighbour of some cluster, so a top-1
+    // graph is enough and avoids the dense N x N similarity matrix
+    SimilarityGraph similarity;
+    SimilarityGraph::buildExact(clusterRepresentation, *mSimilarityFunction,
+                                1, similarity);
 
-    // similarity = cv::abs(similarity);
     std::pair<int, int> mergedPair;
     hasMerged = findClosestClusters(similarity, mMergeThreshold, mergedPair);
     if (hasMerged) {
@@ -183,7 +187,6 @@ void PLSImageClustering::merge(std::vector<Cluster>& clusters) {
       ans.push_back(mergeResult);
     }
 
-    similarity.release();
     if (nMergesPerIteration > 0 && merges >= nMergesPerIteration)
       break;
   } while (hasMerged);
@@ -260,6 +263,7 @@ cv::Ptr<PLSImageClustering> PLSImageClustering::create(
 void PLSImageClustering::predict(
   const cv::Mat_<float>& inp,
   cv::Mat_<float>& resp) const {
+  SSIG_PROFILE_SCOPE("PLSImageClustering::predict");
   resp.release();
   mClassifier->predict(inp, resp);
 }
@@ -476,8 +480,36 @@ bool PLSImageClustering::findClosestClusters(const cv::Mat& similarityMatrix,
   double max = 0;
   int idxs[] = {0, 0};
   cv::minMaxIdx(similarityMatrix, nullptr, &max, nullptr, idxs);
-  closestPair = std::make_pair(idxs[0], idxs[1]);
+  // the similarity matrix is symmetric, merge expects the pair ordered
+  closestPair = std::make_pair(std::min(idxs[0], idxs[1]),
+                               std::max(idxs[0], idxs[1]));
   return max >= threshold;
 }
 
+bool PLSImageClustering::findClosestClusters(const SimilarityGraph& graph,
+                                             const float threshold,
+                                             std::pair<int, int>& closestPair) {
+  float max = -FLT_MAX;
+  closestPair = std::make_pair(0, 0);
+  for (int r = 0; r < graph.getNodes(); ++r) {
+    const int* neighbours = graph.neighbours(r);
+    const float* scores = graph.scores(r);
+    for (int e = 0; e < graph.getDegree(r); ++e) {
+      if (scores[e] > max) {
+        max = scores[e];
+        closestPair = std::make_pair(std::min(r, neighbours[e]),
+                                     std::max(r, neighbours[e]));
+      }
+    }
+  }
+  return max >= threshold;
+}
+
+MemoryFootprint PLSImageClustering::memoryFootprint() const {
+  MemoryFootprint ans = ClassifierClustering::memoryFootprint();
+  if (mClassifier)
+    ans.addChild("classifier", mClassifier->memoryFootprint());
+  return ans;
+}
+
 }  // namespace ssig
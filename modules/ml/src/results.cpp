@@ -39,9 +39,6 @@
 *  POSSIBILITY OF SUCH DAMAGE.
 *****************************************************************************L*/
 
-#ifdef _OPENMP
-#include <omp.h>
-#endif
 // c++
 #include <sstream>
 #include <algorithm>
@@ -50,8 +47,6 @@
 #include <utility>
 #include <vector>
 // c
-#include <ctime>
-#include <random>
 #include <cstdio>
 #include <climits>
 // opencv
@@ -61,6 +56,7 @@
 // ssiglib
 #include "ssiglib/ml/classification.hpp"
 #include "ssiglib/ml/results.hpp"
+#include "ssiglib/core/rng.hpp"
 
 
 #ifdef _WIN32
@@ -81,13 +77,10 @@ cv::Mat Results::getRandomConfusion() {
     invertedLabelMap[it.second] = it.first;
   }
 
-  std::uniform_int_distribution<int> lRandu(
-                                            0,
-                                            max - 1);
-  std::mt19937 gen(static_cast<uint>(time(nullptr)));
+  PhiloxRng gen(deriveSeed(RNG_SAMPLING));
   cv::Mat_<int> actual(mGroundTruth.size());
   for (int i = 0; i < mGroundTruth.rows; ++i) {
-    actual.at<int>(i) = invertedLabelMap[lRandu(gen)];
+    actual.at<int>(i) = invertedLabelMap[gen.uniform(0, max)];
   }
   cv::Mat_<int> ans;
   compute(mGroundTruth, actual, mLabelMap, ans);
@@ -220,12 +213,13 @@ std::pair<float, float> Results::crossValidation(
   ssig::Classifier& classifier,
   std::vector<Results>& out) {
   cv::Mat_<float> accuracies(nfolds, 1, 0.0f);
-  cv::RNG rng(static_cast<uint64>(seed));
+  PhiloxRng rng(deriveSeed(RNG_SAMPLING, static_cast<uint64_t>(seed)));
   const int len = features.rows;
   cv::Mat_<int> ordering(len, 1);
   for (int i = 0; i < len; ++i)
     ordering.at<int>(i) = i;
-  cv::randShuffle(ordering, 5, &rng);
+  for (int i = len - 1; i > 0; --i)
+    std::swap(ordering(i), ordering(rng.uniform(0, i + 1)));
   int foldLen = static_cast<int>(len / static_cast<float>(nfolds));
   cv::Mat_<float> test, train;
 
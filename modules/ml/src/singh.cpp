@@ -41,6 +41,7 @@
 
 
 #include "ssiglib/ml/singh.hpp"
+#include "ssiglib/core/profiler.hpp"
 
 #include <utility>
 #include <algorithm>
@@ -60,6 +61,7 @@ Singh::~Singh() {
 void Singh::predict(
   const cv::Mat_<float>& inp,
   cv::Mat_<float>& resp) const {
+  SSIG_PROFILE_SCOPE("Singh::predict");
   resp =
       cv::Mat_<float>::zeros(inp.rows, static_cast<int>(mClassifiers.size()));
   for (int r = 0; r < inp.rows; ++r) {
@@ -297,4 +299,17 @@ void Singh::setClassifier(Classifier& classifier) {
   mUnderlyingClassifier = std::unique_ptr<Classifier>(classifier.clone());
 }
 
+MemoryFootprint Singh::memoryFootprint() const {
+  MemoryFootprint ans = ClassifierClustering::memoryFootprint();
+  for (size_t i = 0; i < mClassifiers.size(); ++i) {
+    ans.addChild("classifiers[" + std::to_string(i) + "]",
+                 mClassifiers[i]->memoryFootprint());
+  }
+  if (mUnderlyingClassifier) {
+    ans.addChild("underlyingClassifier",
+                 mUnderlyingClassifier->memoryFootprint());
+  }
+  return ans;
+}
+
 }  // namespace ssig
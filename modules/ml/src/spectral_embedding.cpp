@@ -45,6 +45,7 @@
 // ssiglib
 #include "ssiglib/ml/spectral_embedding.hpp"
 #include "ssiglib/core/util.hpp"
+#include "ssiglib/core/profiler.hpp"
 // flann
 #include <flann/flann.hpp>
 
@@ -79,6 +80,7 @@ SpectralEmbedding& SpectralEmbedding::operator=(const SpectralEmbedding& rhs) {
 void SpectralEmbedding::learn(
   cv::InputArray input,
   cv::OutputArray output) {
+  SSIG_PROFILE_SCOPE("SpectralEmbedding::learn");
   cv::Mat inpMat = input.getMat();
 
   const int nSamples = inpMat.rows;
@@ -170,4 +172,11 @@ void SpectralEmbedding::read(const cv::FileNode& fn) {}
 
 void SpectralEmbedding::write(cv::FileStorage& fs) const {}
 
+MemoryFootprint SpectralEmbedding::memoryFootprint() const {
+  MemoryFootprint ans = Algorithm::memoryFootprint();
+  ans.addMat("eigenVectors", mEigenVectors);
+  ans.addMat("eigenValues", mEigenValues);
+  return ans;
+}
+
 }  // namespace ssig
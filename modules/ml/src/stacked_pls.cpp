@@ -40,6 +40,7 @@
 *****************************************************************************L*/
 // c++
 #include <algorithm>
+#include <string>
 #include <vector>
 // opencv
 #include <opencv2/imgproc.hpp>
@@ -47,6 +48,8 @@
 #include "ssiglib/ml/stacked_pls.hpp"
 #include "ssiglib/ml/pls_classifier.hpp"
 #include "ssiglib/ml/pls_embedding.hpp"
+#include "ssiglib/core/executor.hpp"
+#include "ssiglib/core/profiler.hpp"
 
 typedef std::vector<cv::Mat> ImgCollection;
 
@@ -89,6 +92,7 @@ void StackedPLS::write(cv::FileStorage& fs) const {
 void StackedPLS::learn(
   const std::vector<cv::Mat>& input,
   const cv::Mat& labels) {
+  SSIG_PROFILE_SCOPE("StackedPLS::learn");
   std::vector<std::vector<ImgCollection>> inputs(mNumLayers);
   std::vector<cv::Size> canonicalSizes(mNumLayers);
   canonicalSizes[0] = mCanonicalSize;
@@ -214,12 +218,12 @@ void StackedPLS::pass(
   const int nImages = static_cast<int>(input.size());
   std::vector<cv::Mat> unpackeds(nImages);
 
-#ifdef _OPENMP
-  #pragma omp parallel for num_threads(2)
-#endif
-  for (int imgIt = 0; imgIt < nImages; ++imgIt) {
-    unpack(input[imgIt], convSize, unpackeds[imgIt]);
-  }
+  Executor::global().parallelFor(0, nImages,
+    [&](const int first, const int last) {
+    for (int imgIt = first; imgIt < last; ++imgIt) {
+      unpack(input[imgIt], convSize, unpackeds[imgIt]);
+    }
+  }, 1, 2);
 
   filters.resize(numFactors);
   // compute filters
@@ -468,4 +472,12 @@ void StackedPLS::setFilters(const std::vector<std::vector<cv::Mat>>& filters) {
 void StackedPLS::getTrainingOutput(cv::Mat& trainSamplesOut) const {
   mTrainOut.copyTo(trainSamplesOut);
 }
+
+MemoryFootprint StackedPLS::memoryFootprint() const {
+  MemoryFootprint ans = Algorithm::memoryFootprint();
+  for (size_t i = 0; i < mFilters.size(); ++i)
+    ans.addMats("filters[" + std::to_string(i) + "]", mFilters[i]);
+  ans.addMat("trainOut", mTrainOut);
+  return ans;
+}
 }  // namespace ssig
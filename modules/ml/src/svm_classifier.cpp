@@ -41,7 +41,12 @@
 
 // ssiglib
 #include <ssiglib/ml/svm_classifier.hpp>
+#include <ssiglib/core/executor.hpp>
+#include <ssiglib/core/profiler.hpp>
 // c++
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
 #include <vector>
 #include <string>
 #include <unordered_set>
@@ -108,18 +113,13 @@ void SVMClassifier::setMulticlassState(const bool isMulticlass) {
   mIsMulticlass = isMulticlass;
 }
 
-svm_problem* SVMClassifier::convertToLibSVM(
+void SVMClassifier::convertToLibSVM(
   const cv::Mat_<int>& labels,
-  const cv::Mat_<float>& features,
   int& numLabels,
-  double* & y,
-  svm_node** & x) {
+  double* & y) {
   const int nSamples = labels.rows;
 
-  svm_problem* ans = new svm_problem[nSamples];
   y = new double[nSamples];
-  ans->l = nSamples;
-  ans->y = y;
   std::unordered_set<int> labelsSet;
   for (int i = 0; i < nSamples; ++i) {
     y[i] = static_cast<double>(labels.at<int>(i));
@@ -128,11 +128,6 @@ svm_problem* SVMClassifier::convertToLibSVM(
     }
   }
   numLabels = static_cast<int>(labelsSet.size());
-
-  x = convertToLibSVM(features);
-  ans->x = x;
-
-  return ans;
 }
 
 svm_node** SVMClassifier::convertToLibSVM(
@@ -159,6 +154,30 @@ svm_node** SVMClassifier::convertToLibSVM(
   return featNode;
 }
 
+svm_node** SVMClassifier::convertToLibSVM(
+  const CsrMat& features) {
+  const int nSamples = features.getNumRows();
+  svm_node** featNode = new svm_node*[nSamples];
+
+  for (int i = 0; i < nSamples; ++i) {
+    const int len = features.getRowLength(i);
+    const int* columns = features.columns(i);
+    const float* values = features.values(i);
+    featNode[i] = new svm_node[len + 1];
+    for (int j = 0; j < len; ++j) {
+      featNode[i][j] = svm_node{columns[j], values[j]};
+    }
+    featNode[i][len] = svm_node{-1, 0.0};
+  }
+  return featNode;
+}
+
+void SVMClassifier::releaseLibSVM(svm_node** nodes, const int len) {
+  for (int i = 0; i < len; ++i)
+    delete[] nodes[i];
+  delete[] nodes;
+}
+
 void SVMClassifier::convertToLibSVM(
   const std::unordered_map<int, float>& weights,
   svm_parameter& params) {
@@ -183,63 +202,110 @@ cv::Ptr<SVMClassifier> SVMClassifier::create() {
 void SVMClassifier::learn(
   const cv::Mat_<float>& input,
   const cv::Mat& labels) {
+  SSIG_PROFILE_SCOPE("SVMClassifier::learn");
   cleanup();
   mSamplesLen = input.rows;
+  mX = convertToLibSVM(input);
+  train(labels);
+}
+
+void SVMClassifier::learn(
+  const CsrMat& input,
+  const cv::Mat& labels) {
+  SSIG_PROFILE_SCOPE("SVMClassifier::learn");
+  cleanup();
+  mSamplesLen = input.getNumRows();
+  mX = convertToLibSVM(input);
+  train(labels);
+}
+
+void SVMClassifier::train(const cv::Mat_<int>& labels) {
   mParams.eps = mEpsilon;
   convertToLibSVM(mMapLabel2Weight, mParams);
   int numLabels = 0;
-  svm_problem* problem = convertToLibSVM(
-                                         labels, input, numLabels, mY, mX);
+  convertToLibSVM(labels, numLabels, mY);
   if (numLabels > 2)
     setMulticlassState(true);
 
-  const char* errMsg = svm_check_parameter(problem, &mParams);
+  // the model keeps pointers into mX, which lives until cleanup
+  svm_problem problem;
+  problem.l = mSamplesLen;
+  problem.y = mY;
+  problem.x = mX;
+
+  const char* errMsg = svm_check_parameter(&problem, &mParams);
   if (errMsg) {
     printf("%s", errMsg);
     exit(-1);
   }
-  mModel = svm_train(problem, &mParams);
+  mModel = svm_train(&problem, &mParams);
 }
 
 int SVMClassifier::predict(
   const cv::Mat_<float>& inp,
   cv::Mat_<float>& resp,
   cv::Mat_<int>& labels) const {
+  SSIG_PROFILE_SCOPE("SVMClassifier::predict");
   if (!isTrained())
     return -1;
+  auto featNode = convertToLibSVM(inp);
+  const int label = predictNodes(featNode, inp.rows, resp, labels);
+  releaseLibSVM(featNode, inp.rows);
+  return label;
+}
 
+int SVMClassifier::predict(
+  const CsrMat& inp,
+  cv::Mat_<float>& resp,
+  cv::Mat_<int>& labels) const {
+  SSIG_PROFILE_SCOPE("SVMClassifier::predict");
+  if (!isTrained())
+    return -1;
+  auto featNode = convertToLibSVM(inp);
+  const int label = predictNodes(featNode, inp.getNumRows(), resp, labels);
+  releaseLibSVM(featNode, inp.getNumRows());
+  return label;
+}
+
+int SVMClassifier::predictNodes(
+  svm_node** featNode,
+  const int len,
+  cv::Mat_<float>& resp,
+  cv::Mat_<int>& labels) const {
   if (!mIsMulticlass) {
-    resp = cv::Mat_<float>::zeros(inp.rows, 2);
+    resp = cv::Mat_<float>::zeros(len, 2);
   }
-  labels = cv::Mat_<float>::zeros(inp.rows, 1);
+  labels = cv::Mat_<float>::zeros(len, 1);
 
   int label = 0;
-  auto featNode = convertToLibSVM(inp);
-  const int len = inp.rows;
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-  for (int i = 0; i < len; ++i) {
-    double dec_value = 0;
-    if (getProbabilisticModel()) {
-      if (svm_check_probability_model(mModel)) {
-        label = static_cast<int>(
-          svm_predict_probability(mModel, featNode[i], &dec_value));
-      } else {
-        std::runtime_error("Model not fit for probability estimates");
-      }
-    } else {
-      if (mIsMulticlass) {
-        label = static_cast<int>(svm_predict(mModel, featNode[i]));
-        labels.at<int>(i) = label;
+  Executor::global().parallelFor(0, len,
+    [&](const int first, const int last) {
+    for (int i = first; i < last; ++i) {
+      double dec_value = 0;
+      int rowLabel = 0;
+      if (getProbabilisticModel()) {
+        if (svm_check_probability_model(mModel)) {
+          rowLabel = static_cast<int>(
+            svm_predict_probability(mModel, featNode[i], &dec_value));
+        } else {
+          throw std::runtime_error("Model not fit for probability estimates");
+        }
       } else {
-        label = static_cast<int>(
-          svm_predict_values(mModel, featNode[i], &dec_value));
-        resp[i][0] = static_cast<float>(dec_value);
-        labels.at<int>(i) = resp.at<float>(i) > 0 ? 1 : 0;
+        if (mIsMulticlass) {
+          rowLabel = static_cast<int>(svm_predict(mModel, featNode[i]));
+          labels.at<int>(i) = rowLabel;
+        } else {
+          rowLabel = static_cast<int>(
+            svm_predict_values(mModel, featNode[i], &dec_value));
+          resp[i][0] = static_cast<float>(dec_value);
+          labels.at<int>(i) = resp.at<float>(i) > 0 ? 1 : 0;
+        }
       }
+      // the label of the last sample is returned, as in a serial loop
+      if (i == len - 1)
+        label = rowLabel;
     }
-  }
+  });
   if (!isMulticlass()) {
     if (getProbabilisticModel()) {
       resp.col(1) = 1 - resp.col(0);
@@ -248,8 +314,6 @@ int SVMClassifier::predict(
     }
   }
 
-  delete[] featNode;
-
   return label;
 }
 
@@ -289,6 +353,118 @@ void SVMClassifier::write(cv::FileStorage& fs) const {
   fclose(tmpf);
 }
 
+namespace {
+// copies n elements into a malloc'ed array, the way libsvm frees them
+template <class T>
+T* mallocCopy(const cv::Mat& mat, const size_t n) {
+  if (mat.empty())
+    return nullptr;
+  if (mat.total() != n)
+    throw std::runtime_error("Inconsistent svm model");
+  T* ans = static_cast<T*>(malloc(n * sizeof(T)));
+  memcpy(ans, mat.data, n * sizeof(T));
+  return ans;
+}
+}  // namespace
+
+void SVMClassifier::readBinary(const BinaryNode& node) {
+  if (node.getInt("nodeSize") != static_cast<int>(sizeof(svm_node)))
+    throw std::runtime_error("svm model saved with another svm_node layout");
+  if (mModel)
+    svm_free_and_destroy_model(&mModel);
+
+  mParams.svm_type = node.getInt("svm_type");
+  mParams.kernel_type = node.getInt("kernel_type");
+  mParams.degree = node.getInt("degree");
+  mParams.gamma = node.getDouble("gamma");
+  mParams.coef0 = node.getDouble("coef0");
+  mParams.probability = node.getInt("probability");
+  mIsMulticlass = node.getInt("multiclass") != 0;
+
+  auto model = static_cast<svm_model*>(calloc(1, sizeof(svm_model)));
+  model->param = mParams;
+  model->nr_class = node.getInt("nr_class");
+  model->l = node.getInt("l");
+  const int k = model->nr_class;
+  const int l = model->l;
+  model->rho = mallocCopy<double>(node.getMat("rho"), k * (k - 1) / 2);
+  model->label = mallocCopy<int>(node.getMat("label"), k);
+  model->probA = mallocCopy<double>(node.getMat("probA"), k * (k - 1) / 2);
+  model->probB = mallocCopy<double>(node.getMat("probB"), k * (k - 1) / 2);
+  model->nSV = mallocCopy<int>(node.getMat("nSV"), k);
+
+  const cv::Mat_<double> coef = node.getMat("sv_coef");
+  model->sv_coef = static_cast<double**>(malloc((k - 1) * sizeof(double*)));
+  for (int i = 0; i < k - 1; ++i)
+    model->sv_coef[i] = mallocCopy<double>(coef.row(i), l);
+
+  // free_sv = 0 keeps libsvm from freeing the nodes, they live in the file
+  // and mMappedNodes keeps the mapping alive as long as the model uses it
+  mMappedNodes = node.getMat("SV");
+  const cv::Mat_<int> offsets = node.getMat("SVoffsets");
+  auto first = reinterpret_cast<svm_node*>(mMappedNodes.data);
+  model->SV = static_cast<svm_node**>(malloc(l * sizeof(svm_node*)));
+  for (int i = 0; i < l; ++i)
+    model->SV[i] = first + offsets(i);
+  model->free_sv = 0;
+
+  mModel = model;
+}
+
+void SVMClassifier::writeBinary(BinaryWriter& writer) const {
+  if (!mModel)
+    throw std::logic_error("Saving an untrained svm");
+  const int k = mModel->nr_class;
+  const int l = mModel->l;
+  const int nPairs = k * (k - 1) / 2;
+
+  writer.write("nodeSize", static_cast<int>(sizeof(svm_node)));
+  writer.write("svm_type", mModel->param.svm_type);
+  writer.write("kernel_type", mModel->param.kernel_type);
+  writer.write("degree", mModel->param.degree);
+  writer.write("gamma", mModel->param.gamma);
+  writer.write("coef0", mModel->param.coef0);
+  writer.write("probability", mModel->probA ? 1 : 0);
+  writer.write("multiclass", static_cast<int>(mIsMulticlass));
+  writer.write("nr_class", k);
+  writer.write("l", l);
+
+  auto array = [](const void* data, const int n, const int type) {
+    return data ? cv::Mat(1, n, type, const_cast<void*>(data)).clone()
+                : cv::Mat();
+  };
+  writer.write("rho", array(mModel->rho, nPairs, CV_64F));
+  writer.write("label", array(mModel->label, k, CV_32S));
+  writer.write("probA", array(mModel->probA, nPairs, CV_64F));
+  writer.write("probB", array(mModel->probB, nPairs, CV_64F));
+  writer.write("nSV", array(mModel->nSV, k, CV_32S));
+
+  cv::Mat_<double> coef(k - 1, l);
+  for (int i = 0; i < k - 1; ++i)
+    memcpy(coef[i], mModel->sv_coef[i], l * sizeof(double));
+  writer.write("sv_coef", coef);
+
+  // every support vector is a -1 terminated run of nodes; they are stored
+  // back to back, so loading only needs to point into the blob
+  cv::Mat_<int> offsets(l, 1);
+  int nNodes = 0;
+  for (int i = 0; i < l; ++i) {
+    offsets(i) = nNodes;
+    const svm_node* sv = mModel->SV[i];
+    while (sv->index != -1)
+      ++sv;
+    nNodes += static_cast<int>(sv - mModel->SV[i]) + 1;
+  }
+  cv::Mat nodes(1, nNodes * static_cast<int>(sizeof(svm_node)), CV_8U);
+  auto dst = reinterpret_cast<svm_node*>(nodes.data);
+  for (int i = 0; i < l; ++i) {
+    const int len = (i + 1 < l ? offsets(i + 1) : nNodes) - offsets(i);
+    memcpy(dst + offsets(i), mModel->SV[i], len * sizeof(svm_node));
+  }
+  writer.write("SVoffsets", offsets);
+  writer.write("SV", nodes);
+}
+
 int SVMClassifier::getKernelType() const {
   return mParams.kernel_type;
 }
@@ -370,13 +546,10 @@ void SVMClassifier::cleanup() {
     svm_free_and_destroy_model(&mModel);
     mModel = nullptr;
   }
+  mMappedNodes.release();
 
   if (mX) {
-    for (int i = 0; i < mSamplesLen; ++i) {
-      if (mX[i])
-        delete mX[i];
-    }
-    delete[] mX;
+    releaseLibSVM(mX, mSamplesLen);
     mX = nullptr;
   }
   if (mY) {
@@ -388,4 +561,43 @@ void SVMClassifier::cleanup() {
 cv::Mat SVMClassifier::getLabels() const {
   return mLabels;
 }
+
+MemoryFootprint SVMClassifier::memoryFootprint() const {
+  MemoryFootprint ans = Classifier::memoryFootprint();
+  // every row is a run of nodes terminated by index -1
+  auto nodeBytes = [](svm_node* const* rows, const int len) {
+    size_t count = 0;
+    for (int i = 0; i < len; ++i) {
+      const svm_node* node = rows[i];
+      while (node->index != -1)
+        ++node;
+      count += static_cast<size_t>(node - rows[i]) + 1;
+    }
+    return count * sizeof(svm_node) + len * sizeof(svm_node*);
+  };
+  if (mX)
+    ans.addOwned("trainingNodes", nodeBytes(mX, mSamplesLen));
+  if (mY)
+    ans.addOwned("trainingLabels", mSamplesLen * sizeof(double));
+  if (mModel) {
+    const size_t k = mModel->nr_class;
+    const size_t l = mModel->l;
+    const size_t nPairs = k * (k - 1) / 2;
+    size_t bytes = sizeof(svm_model) + l * sizeof(svm_node*) +
+      (k - 1) * (sizeof(double*) + l * sizeof(double)) +
+      nPairs * sizeof(double);
+    if (mModel->probA)
+      bytes += 2 * nPairs * sizeof(double);
+    if (mModel->label)
+      bytes += 2 * k * sizeof(int);
+    if (mModel->sv_indices)
+      bytes += l * sizeof(int);
+    // only a model read from text owns its support vectors
+    if (mModel->free_sv)
+      bytes += nodeBytes(mModel->SV, mModel->l);
+    ans.addOwned("model", bytes);
+    ans.addMat("supportVectors", mMappedNodes);
+  }
+  return ans;
+}
 }  // namespace ssig
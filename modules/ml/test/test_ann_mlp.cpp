@@ -101,6 +101,29 @@ TEST_F(ANN_IrisTest, SampleMultilayerPerceptron) {
   EXPECT_GT(acc, 0.9f);
 }
 
+TEST_F(ANN_IrisTest, BinaryPersistence) {
+  ann_mlp->addLayer(5, 0);
+  ann_mlp->addLayer(3, 0);
+  ann_mlp->setMaxIterations(100);
+  ann_mlp->setLearningRate(static_cast<float>(1e-2));
+  ann_mlp->learn(X, Y);
+  ann_mlp->saveBinary("ann_mlp.bin");
+
+  auto loaded = ssig::MultilayerPerceptron::create();
+  loaded->loadBinary("ann_mlp.bin");
+  remove("ann_mlp.bin");
+
+  EXPECT_TRUE(loaded->isTrained());
+  EXPECT_EQ(ann_mlp->getActivationsTypes(), loaded->getActivationsTypes());
+  EXPECT_EQ(ann_mlp->getLossType(), loaded->getLossType());
+  cv::Mat_<int> expectedLabels, actualLabels;
+  cv::Mat_<float> expected, resp;
+  ann_mlp->predict(testX, expected, expectedLabels);
+  loaded->predict(testX, resp, actualLabels);
+  EXPECT_EQ(0, cv::norm(expected, resp, cv::NORM_INF));
+  EXPECT_EQ(0, cv::countNonZero(expectedLabels != actualLabels));
+}
+
 TEST_F(ANN_IrisTest, Relu) {
   // Adding the input
   ann_mlp->addLayer(5, 0);
@@ -45,6 +45,7 @@
 // opencv
 #include <opencv2/core.hpp>
 // ssiglib
+#include "ssiglib/core/executor.hpp"
 #include "ssiglib/ml/kmeans.hpp"
 #include "ssiglib/ml/pls_classifier.hpp"
 
@@ -100,7 +101,7 @@ class KmeansClusteringClassifierTest : public ::testing::Test {
     kmeans->setNAttempts(1);
 
     auto pls = ssig::PLSClassifier::create();
-    pls->setNumberOfFactors(5);
+    pls->setNumberOfFactors(2);
     kmeans->setPredictionDistanceType(*pls);
 
     kmeans->learn(inp);
@@ -135,6 +136,22 @@ TEST_F(KmeansClusteringClassifierTest, SanityClusteringTest) {
   }
 }
 
+TEST_F(KmeansClusteringClassifierTest, ConcurrentPredict) {
+  cv::Mat_<float> expected;
+  kmeans->predict(inp, expected);
+  ASSERT_EQ(inp.rows, expected.rows);
+
+  // one trained model serves every thread, nothing is retrained per call
+  std::vector<cv::Mat_<float>> resps(inp.rows);
+  ssig::Executor executor(4);
+  executor.parallelFor(0, inp.rows, [&](const int first, const int last) {
+    for (int r = first; r < last; ++r)
+      kmeans->predict(inp.row(r), resps[r]);
+  });
+  for (int r = 0; r < inp.rows; ++r)
+    EXPECT_EQ(0, cv::norm(expected.row(r), resps[r], cv::NORM_INF));
+}
+
 TEST_F(KmeansClusteringTest, Persistence) {
   auto clusters = kmeans->getClustering();
   std::vector<int> gt1 = {0, 1, 2};
@@ -168,3 +185,23 @@ TEST_F(KmeansClusteringTest, Persistence) {
   auto nonzeros = cv::countNonZero(diff);
   EXPECT_EQ(c1.rows * c1.cols, nonzeros);
 }
+
+TEST_F(KmeansClusteringTest, BinaryPersistence) {
+  kmeans->saveBinary("kmeans_.bin");
+
+  auto loaded = ssig::Kmeans::create();
+  loaded->loadBinary("kmeans_.bin");
+  remove("kmeans_.bin");
+
+  cv::Mat_<float> c1, c2;
+  loaded->getCentroids(c1);
+  kmeans->getCentroids(c2);
+  ASSERT_EQ(c2.size(), c1.size());
+  EXPECT_EQ(0, cv::norm(c1, c2, cv::NORM_INF));
+  EXPECT_EQ(2, loaded->getK());
+
+  cv::Mat_<float> expected, resp;
+  kmeans->predict(inp, expected);
+  loaded->predict(inp, resp);
+  EXPECT_EQ(0, cv::norm(expected, resp, cv::NORM_INF));
+}
@@ -256,6 +256,39 @@ TEST(OAAClassifier, SVMPersistence) {
   EXPECT_GE(resp[0][label3], maxResp);
 }
 
+TEST(OAAClassifier, SVMBinaryPersistence) {
+  cv::Mat_<float> inp;
+  cv::Mat_<int> labels;
+
+  cv::FileStorage stg("oaaData.yml", cv::FileStorage::READ);
+  ASSERT_TRUE(stg.isOpened());
+  stg["inp"] >> inp;
+  stg["labels"] >> labels;
+
+  auto underlying = ssig::SVMClassifier::create();
+  underlying->setKernelType(ssig::SVMClassifier::LINEAR);
+  underlying->setModelType(ssig::SVMClassifier::C_SVC);
+  underlying->setC(10.f);
+  underlying->setEpsilon(1e-4f);
+
+  auto classifier = ssig::OAAClassifier::create(*underlying);
+  classifier->learn(inp, labels);
+  classifier->saveBinary("svmp_oaa.bin");
+
+  auto loaded = ssig::OAAClassifier::create(*underlying);
+  loaded->loadBinary("svmp_oaa.bin");
+  remove("svmp_oaa.bin");
+
+  EXPECT_TRUE(loaded->isTrained());
+  EXPECT_EQ(classifier->getLabelsOrdering(), loaded->getLabelsOrdering());
+  cv::Mat_<float> expected, resp;
+  cv::Mat_<int> expectedLabels, actualLabels;
+  classifier->predict(inp, expected, expectedLabels);
+  loaded->predict(inp, resp, actualLabels);
+  EXPECT_EQ(0, cv::norm(expected, resp, cv::NORM_INF));
+  EXPECT_EQ(0, cv::countNonZero(expectedLabels != actualLabels));
+}
+
 TEST(OAAClassifier, PLSPersistence) {
   cv::Mat_<float> inp = (cv::Mat_<float>(9, 2) <<
     3., 4., 0., 0., 2., 1.,
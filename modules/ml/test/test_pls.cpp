@@ -40,6 +40,8 @@
 *****************************************************************************L*/
 
 #include <gtest/gtest.h>
+// c++
+#include <fstream>
 // opencv
 #include <opencv2/core/ocl.hpp>
 #include <opencv2/core.hpp>
@@ -110,6 +112,130 @@ TEST(PLSClassifier, Persistence) {
   EXPECT_GE(resp[0][idx], 0);
 }
 
+TEST(PLSClassifier, BinaryPersistence) {
+  cv::Mat_<int> labels = (cv::Mat_<int>(6, 1) << 1 , 1 , 1 , -1 , -1 , -1);
+  cv::Mat_<float> inp =
+      (cv::Mat_<float>(6, 2) <<
+      1 , 2 , 2 , 2 , 4 , 6 ,
+      102 , 100 , 104 , 105 , 99 , 101);
+
+  auto classifier = ssig::PLSClassifier::create();
+  classifier->setNumberOfFactors(2);
+  classifier->learn(inp, labels);
+  classifier->saveBinary("pls.bin");
+
+  auto loaded = ssig::PLSClassifier::create();
+  loaded->loadBinary("pls.bin");
+  remove("pls.bin");
+
+  EXPECT_TRUE(loaded->isTrained());
+  EXPECT_EQ(classifier->getLabelsOrdering(), loaded->getLabelsOrdering());
+  cv::Mat_<float> expected, resp;
+  classifier->predict(inp, expected);
+  loaded->predict(inp, resp);
+  EXPECT_EQ(0, cv::norm(expected, resp, cv::NORM_INF));
+}
+
+TEST(PLS, BinaryFootprint) {
+  cv::Mat_<float> X =
+      (cv::Mat_<float>(6, 2) <<
+      1 , 2 , 2 , 2 , 4 , 6 ,
+      102 , 100 , 104 , 105 , 99 , 101);
+  cv::Mat_<float> Y = (cv::Mat_<float>(6, 1) << 1 , 1 , 1 , -1 , -1 , -1);
+  ssig::PLS pls;
+  pls.learn(X, Y, 2);
+  pls.saveBinary("pls_footprint.bin");
+  size_t fileSize;
+  {
+    std::ifstream file("pls_footprint.bin", std::ios::binary | std::ios::ate);
+    fileSize = static_cast<size_t>(file.tellg());
+  }
+
+  {
+    ssig::PLS loaded;
+    loaded.loadBinary("pls_footprint.bin");
+    // the storage and the matrices read from it are one mapping
+    const ssig::MemoryFootprint footprint = loaded.memoryFootprint();
+    EXPECT_EQ(fileSize, footprint.getSharedBytes());
+  }
+  remove("pls_footprint.bin");
+}
+
+TEST(PLSClassifier, LearnFromFeatureStore) {
+  cv::Mat_<int> labels = (cv::Mat_<int>(6, 1) << 1 , 1 , 1 , -1 , -1 , -1);
+  cv::Mat_<float> inp =
+      (cv::Mat_<float>(6, 2) <<
+      1 , 2 , 2 , 2 , 4 , 6 ,
+      102 , 100 , 104 , 105 , 99 , 101);
+  {
+    ssig::FeatureStoreWriter writer("pls_features.bin", 4);
+    writer.append(inp, labels);
+  }
+  ssig::FeatureStore store("pls_features.bin");
+
+  auto fromMat = ssig::PLSClassifier::create();
+  fromMat->setNumberOfFactors(2);
+  fromMat->learn(inp, labels);
+  auto fromStore = ssig::PLSClassifier::create();
+  fromStore->setNumberOfFactors(2);
+  fromStore->learn(store);
+
+  // the store itself is left untouched by the scaling
+  EXPECT_EQ(0, cv::norm(store.getData(), inp, cv::NORM_INF));
+  cv::Mat_<float> expected, resp;
+  fromMat->predict(inp, expected);
+  fromStore->predict(inp, resp);
+  EXPECT_LT(cv::norm(expected, resp, cv::NORM_INF), 1e-4);
+  remove("pls_features.bin");
+}
+
+TEST(PLSClassifier, PredictQuantized) {
+  cv::Mat_<int> labels = (cv::Mat_<int>(6, 1) << 1 , 1 , 1 , -1 , -1 , -1);
+  // the last column is constant: its zero deviation must not give NaN
+  cv::Mat_<float> inp =
+      (cv::Mat_<float>(6, 3) <<
+      1 , 2 , 7 , 2 , 2 , 7 , 4 , 6 , 7 ,
+      102 , 100 , 7 , 104 , 105 , 7 , 99 , 101 , 7);
+  auto classifier = ssig::PLSClassifier::create();
+  classifier->setNumberOfFactors(2);
+  classifier->learn(inp, labels);
+
+  cv::Mat_<float> expected, resp;
+  cv::Mat_<int> expectedLabels, quantizedLabels;
+  classifier->predict(inp, expected, expectedLabels);
+  ASSERT_TRUE(cv::checkRange(expected));
+  for (const auto format : {ssig::QuantizedMat::FLOAT16,
+                            ssig::QuantizedMat::UINT8}) {
+    const ssig::QuantizedMat quantized(inp, format);
+    classifier->predict(quantized, resp, quantizedLabels);
+    EXPECT_TRUE(cv::checkRange(resp));
+    EXPECT_LT(cv::norm(expected, resp, cv::NORM_INF), 0.05);
+    EXPECT_EQ(0, cv::countNonZero(expectedLabels != quantizedLabels));
+  }
+}
+
+TEST(PLSClassifier, PredictSparse) {
+  cv::Mat_<int> labels = (cv::Mat_<int>(6, 1) << 1 , 1 , 1 , -1 , -1 , -1);
+  // constant columns, one of them never stored: their zero deviation must
+  // not give NaN
+  cv::Mat_<float> inp =
+      (cv::Mat_<float>(6, 4) <<
+      1 , 0 , 7 , 0 , 2 , 0 , 7 , 0 , 4 , 6 , 7 , 0 ,
+      102 , 0 , 7 , 0 , 0 , 105 , 7 , 0 , 99 , 101 , 7 , 0);
+  auto classifier = ssig::PLSClassifier::create();
+  classifier->setNumberOfFactors(2);
+  classifier->learn(inp, labels);
+
+  cv::Mat_<float> expected, resp;
+  cv::Mat_<int> expectedLabels, sparseLabels;
+  classifier->predict(inp, expected, expectedLabels);
+  classifier->predict(ssig::CsrMat(inp), resp, sparseLabels);
+  ASSERT_TRUE(cv::checkRange(expected));
+  EXPECT_TRUE(cv::checkRange(resp));
+  EXPECT_LT(cv::norm(expected, resp, cv::NORM_INF), 1e-3);
+  EXPECT_EQ(0, cv::countNonZero(expectedLabels != sparseLabels));
+}
+
 TEST(PLSClassifier, MultiClassification) {
   cv::Mat_<int> labels = (cv::Mat_<int>(6, 1) << 1, 1, 2, 2, 3, 3);
   cv::Mat_<float> inp =
@@ -75,6 +75,31 @@ TEST(SVMClassifier, BinaryClassification) {
   EXPECT_GE(resp[0][idx], 0);
 }
 
+TEST(SVMClassifier, SparseInput) {
+  cv::Mat_<int> labels = (cv::Mat_<int>(6, 1) << 1 , 1 , 1 , -1 , -1 , -1);
+  cv::Mat_<float> inp =
+      (cv::Mat_<float>(6, 4) <<
+        0.8f , 0 , 0.8f , 0 , 0.7f , 0 , 0 , 0.7f , 0.9f , 0 , 0.8f , 0 ,
+        0 , -0.8f , 0 , -0.9f , -0.8f , 0 , 0 , -0.7f , 0 , -0.7f , -0.7f , 0);
+
+  auto dense = ssig::SVMClassifier::create();
+  dense->setEpsilon(0.01f);
+  dense->learn(inp, labels);
+  auto sparse = ssig::SVMClassifier::create();
+  sparse->setEpsilon(0.01f);
+  sparse->learn(ssig::CsrMat(inp), labels);
+
+  cv::Mat_<float> query = (cv::Mat_<float>(2, 4) <<
+      0.6f , 0 , 0.7f , 0 , 0 , -0.6f , -0.7f , 0);
+  cv::Mat_<float> expected, resp;
+  cv::Mat_<int> expectedLabels, sparseLabels;
+  dense->predict(query, expected, expectedLabels);
+  sparse->predict(ssig::CsrMat(query), resp, sparseLabels);
+  EXPECT_LT(cv::norm(expected, resp, cv::NORM_INF), 1e-5);
+  EXPECT_EQ(1, sparseLabels(0));
+  EXPECT_EQ(0, sparseLabels(1));
+}
+
 TEST(SVMClassifier, Persistence) {
   cv::Mat_<int> labels = (cv::Mat_<int>(6, 1) << 1 , 1 , 1 , -1 , -1 , -1);
   cv::Mat_<float> inp =
@@ -118,6 +143,35 @@ TEST(SVMClassifier, Persistence) {
   EXPECT_GE(resp[0][idx], 0);
 }
 
+TEST(SVMClassifier, BinaryPersistence) {
+  cv::Mat_<int> labels = (cv::Mat_<int>(6, 1) << 1 , 1 , 1 , -1 , -1 , -1);
+  cv::Mat_<float> inp =
+      (cv::Mat_<float>(6, 2) <<
+        0.8f , 0.8f , 0.7f , 0.7f , 0.9f , 0.8f ,
+               -0.8f , -0.9f , -0.8f , -0.7f , -0.7f , -0.7f);
+
+  auto classifier = ssig::SVMClassifier::create();
+  classifier->setC(0.1f);
+  classifier->setKernelType(ssig::SVMClassifier::RBF);
+  classifier->setGamma(0.5);
+  classifier->setModelType(ssig::SVMClassifier::C_SVC);
+  classifier->setEpsilon(0.01f);
+  classifier->learn(inp, labels);
+  classifier->saveBinary("svm.bin");
+
+  auto loaded = ssig::SVMClassifier::create();
+  loaded->loadBinary("svm.bin");
+  remove("svm.bin");
+
+  EXPECT_TRUE(loaded->isTrained());
+  cv::Mat_<float> query = (cv::Mat_<float>(3, 2) <<
+    0.6f , 0.7f , -0.7f , -0.6f , 0.1f , -0.2f);
+  cv::Mat_<float> expected, resp;
+  classifier->predict(query, expected);
+  loaded->predict(query, resp);
+  EXPECT_EQ(0, cv::norm(expected, resp, cv::NORM_INF));
+}
+
 TEST(SVMClassifier, SVMTernaryClassification) {
   cv::Mat_<float> inp;
   cv::Mat_<int> labels;